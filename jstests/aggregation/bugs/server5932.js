@@ -81,6 +81,26 @@ var res = t.runCommand(buildAggCmd([{$project:{cantAddString: {$add:[1, '$bigStr
 assert.commandWorked(res);
 assert.throws(function() { makeCursor(res).itcount(); });
 
+// results of blocking stages are streamed back in order through small batches
+var cursor = aggCursor([{$project: {bigArray: 1}}, {$unwind: '$bigArray'},
+                        {$sort: {bigArray: -1, _id: 1}}], 3, 50);
+var first = cursor.next();
+assert.eq(first.bigArray, 999);
+assert.eq(first._id, 0);
+assert.eq(cursor.itcount(), bigArray.length * t.count() - 1);
+
+// a cursor whose input was consumed by a blocking stage still returns it after a drop
+var t2 = db.server5932_drop;
+t2.drop();
+for (var i = 0; i < 10; i++) {
+    t2.insert({_id: i});
+}
+var res = db.runCommand({aggregate: t2.getName(), pipeline: [{$sort: {_id: 1}}],
+                         cursor: {batchSize: 1}});
+var cursor = makeCursor(res, 2);
+t2.drop();
+assert.eq(cursor.itcount(), 10);
+
 // error if collection dropped after first batch
 var cursor = aggCursor([{$unwind:'$bigArray'}], 0);
 t.drop();
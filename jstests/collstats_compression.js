@@ -0,0 +1,31 @@
+// collStats compressionSample estimates snappy block compression for a collection
+
+var t = db.collstats_compression;
+t.drop();
+
+for ( var i = 0; i < 2000; i++ ) {
+    t.insert( { _id : i, level : "info", msg : "applied batch of " + ( i % 50 ) + " operations" } );
+}
+
+// not reported unless asked for
+assert.isnull( t.stats().compression, "A" );
+
+var c = db.runCommand( { collStats : t.getName(), compressionSample : 500 } ).compression;
+assert( c, "B" );
+assert.eq( 500, c.sampledRecords, "C" );
+assert.lt( 0, c.blocks, "D" );
+assert.lt( c.compressedSize, c.uncompressedSize, "E" );
+assert.lt( 1, c.ratio, "F" );
+
+// true samples a default number of records
+c = db.runCommand( { collStats : t.getName(), compressionSample : true } ).compression;
+assert.eq( 1000, c.sampledRecords, "G" );
+
+// sampling more than the collection holds covers every record
+c = db.runCommand( { collStats : t.getName(), compressionSample : 10000 } ).compression;
+assert.eq( t.count(), c.sampledRecords, "H" );
+
+assert.commandFailed( db.runCommand( { collStats : t.getName(), compressionSample : -1 } ) );
+assert.commandFailed( db.runCommand( { collStats : t.getName(), compressionSample : 10001 } ) );
+
+t.drop();
@@ -0,0 +1,34 @@
+// collStats reports record allocation counters, and free list fragmentation on request
+
+var t = db.collstats_freelist;
+t.drop();
+db.createCollection( t.getName() );
+assert.commandWorked( db.runCommand( { collMod : t.getName(), usePowerOf2Sizes : true } ) );
+
+var big = new Array( 200 ).toString();
+for ( var i = 0; i < 1000; i++ ) {
+    t.insert( { _id : i, s : big } );
+}
+
+var s = t.stats();
+assert( s.allocation, "A" );
+assert.gte( s.allocation.allocs, 1000, "B" );
+assert.isnull( s.freeList, "C" );
+
+// free every other record, then refill the holes
+t.remove( { _id : { $mod : [ 2, 0 ] } } );
+s = db.runCommand( { collStats : t.getName(), freeList : true } );
+assert.lte( 500, s.freeList.count, "D" );
+assert.lt( 0, s.freeList.fragmentation, "E" );
+
+var before = s.allocation;
+for ( i = 0; i < 500; i += 2 ) {
+    t.insert( { _id : i, s : big } );
+}
+s = t.stats();
+assert.eq( before.allocs + 250, s.allocation.allocs, "F" );
+// every hole is exactly the size of a new record, so each allocation stops at the first one
+assert.eq( 0, s.allocation.newExtents - before.newExtents, "G" );
+assert.gte( 250, s.allocation.probes - before.probes, "H" );
+
+t.drop();
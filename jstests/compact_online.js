@@ -0,0 +1,55 @@
+// compact with online:true moves records out of the tail extents a batch at a time
+
+var t = db.jstests_compact_online;
+t.drop();
+db.createCollection( t.getName(), { $nExtents : [ 64 * 1024, 64 * 1024, 64 * 1024, 64 * 1024 ] } );
+t.ensureIndex( { x : 1 }, { unique : true } );
+
+var big = new Array( 400 ).toString();
+for ( var i = 0; i < 500; i++ ) {
+    t.insert( { _id : i, x : i, s : big } );
+}
+assert( !db.getLastError() );
+
+// leave most of the collection empty
+t.remove( { _id : { $mod : [ 5, 1 ] } } );
+t.remove( { _id : { $mod : [ 5, 2 ] } } );
+t.remove( { _id : { $mod : [ 5, 3 ] } } );
+assert( !db.getLastError() );
+
+var before = t.stats();
+var count = t.count();
+
+var res = t.runCommand( "compact", { online : true, batchSize : 7, maxBytesPerSec : 1024 * 1024 } );
+assert.commandWorked( res );
+printjson( res );
+assert.lt( 0, res.extentsFreed, "no extents freed" );
+assert.lt( 0, res.recordsMoved, "no records moved" );
+// stops at the first extent, or once the records left can't fit in front of the tail
+assert.contains( res.stopReason, [ "done", "not enough free space", "out of free space" ] );
+
+var after = t.stats();
+assert.eq( before.numExtents - res.extentsFreed, after.numExtents );
+assert.eq( count, after.count );
+assert.eq( count, t.find().itcount() );
+assert.eq( count, t.find().hint( { x : 1 } ).itcount() );
+for ( i = 0; i < 500; i++ ) {
+    var expected = ( i % 5 == 0 || i % 5 == 4 ) ? 1 : 0;
+    assert.eq( expected, t.find( { _id : i } ).itcount(), "_id " + i );
+    assert.eq( expected, t.find( { x : i } ).hint( { x : 1 } ).itcount(), "x " + i );
+}
+assert( t.validate( true ).valid );
+
+// the collection keeps working as usual
+for ( i = 500; i < 600; i++ ) {
+    t.insert( { _id : i, x : i, s : big } );
+}
+assert( !db.getLastError() );
+assert.eq( count + 100, t.count() );
+assert( t.validate( true ).valid );
+
+// padding options only apply to the offline compaction
+assert.commandFailed( t.runCommand( "compact", { online : true, paddingFactor : 1.5 } ) );
+assert.commandFailed( t.runCommand( "compact", { online : true, batchSize : 0 } ) );
+
+t.drop();
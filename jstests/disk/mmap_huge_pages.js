@@ -0,0 +1,23 @@
+// mmapHugePages asks for transparent huge pages on data file views and reports on them
+var port = allocatePorts( 1 )[ 0 ];
+var baseName = "mmap_huge_pages";
+
+var m = startMongod( "--port", port, "--dbpath", MongoRunner.dataPath + baseName,
+                     "--nohttpinterface", "--bind_ip", "127.0.0.1", "--smallfiles",
+                     "--setParameter", "mmapHugePages=true" );
+var db = m.getDB( baseName );
+
+db.c.insert( { x : 1 } );
+assert.eq( 1, db.c.count() );
+
+var status = db.serverStatus().hugePages;
+assert( status, "hugePages section missing" );
+assert( status.enabled );
+assert.gt( status.viewsAdvised, 0 );
+assert.lte( status.adviceFailures, status.viewsAdvised );
+
+// it can't be turned on or off once files are mapped
+assert.commandFailed( db.adminCommand( { setParameter : 1, mmapHugePages : false } ) );
+assert.eq( true, db.adminCommand( { getParameter : 1, mmapHugePages : 1 } ).mmapHugePages );
+
+stopMongod( port );
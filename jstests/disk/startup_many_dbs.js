@@ -0,0 +1,51 @@
+// databases are opened and checked in parallel at startup, and listDatabases reports on them
+// without opening them again
+var port = allocatePorts( 1 )[ 0 ];
+var baseName = "startup_many_dbs";
+var dbpath = MongoRunner.dataPath + baseName;
+var nDbs = 20;
+
+var m = startMongod( "--port", port, "--dbpath", dbpath, "--nohttpinterface",
+                     "--bind_ip", "127.0.0.1", "--smallfiles",
+                     "--setParameter", "startupDatabaseOpenThreads=4" );
+for ( var i = 0; i < nDbs; i++ ) {
+    var db = m.getDB( baseName + i );
+    db.c.insert( { x : i } );
+    assert.isnull( db.getLastError() );
+}
+
+function sizes( conn ) {
+    var res = conn.getDB( "admin" ).runCommand( { listDatabases : 1 } );
+    assert.commandWorked( res );
+    var s = {};
+    res.databases.forEach( function( d ) {
+        s[ d.name ] = d;
+    } );
+    return s;
+}
+
+stopMongod( port );
+
+m = startMongodNoReset( "--port", port, "--dbpath", dbpath, "--nohttpinterface",
+                        "--bind_ip", "127.0.0.1", "--smallfiles",
+                        "--setParameter", "startupDatabaseOpenThreads=4" );
+
+// nothing is open yet, so sizes come from the files
+var closed = sizes( m );
+for ( var i = 0; i < nDbs; i++ ) {
+    var name = baseName + i;
+    assert( closed[ name ], name + " missing" );
+    assert.gt( closed[ name ].sizeOnDisk, 0, name );
+    assert( !closed[ name ].empty, name );
+    assert.eq( i, m.getDB( name ).c.findOne().x, name );
+}
+
+// once open, they come from the database itself and should agree
+var open = sizes( m );
+for ( var i = 0; i < nDbs; i++ ) {
+    var name = baseName + i;
+    assert.eq( closed[ name ].sizeOnDisk, open[ name ].sizeOnDisk, name );
+    assert( !open[ name ].empty, name );
+}
+
+stopMongod( port );
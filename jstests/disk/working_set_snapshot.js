@@ -0,0 +1,45 @@
+// working set snapshots are saved at clean shutdown and replayed at the next startup
+var port = allocatePorts( 1 )[ 0 ];
+var baseName = "working_set_snapshot";
+var dbpath = MongoRunner.dataPath + baseName;
+
+var m = startMongod(
+    "--port", port, "--dbpath", dbpath, "--nohttpinterface", "--bind_ip", "127.0.0.1",
+    "--smallfiles", "--setParameter", "workingSetSnapshotIntervalSecs=3600" );
+
+var db = m.getDB( baseName );
+var status = db.serverStatus().workingSetSnapshot;
+assert( status, "workingSetSnapshot section missing" );
+assert.eq( 3600, status.intervalSecs );
+assert.eq( "none", status.replay.state );
+
+for ( var i = 0; i < 1000; i++ ) {
+    db.c.insert( { _id : i, x : "working set" } );
+}
+db.c.ensureIndex( { x : 1 } );
+assert.eq( 1000, db.c.find().hint( { x : 1 } ).itcount() );
+
+stopMongod( port );
+
+var files = listFiles( dbpath ).map( function( f ) { return f.baseName; } );
+if ( files.indexOf( "mongod.workingset" ) < 0 ) {
+    // page residency checks aren't supported on this platform
+    print( "no working set snapshot written, skipping replay checks" );
+}
+else {
+    m = startMongodNoReset(
+        "--port", port, "--dbpath", dbpath, "--nohttpinterface", "--bind_ip", "127.0.0.1",
+        "--smallfiles", "--setParameter", "workingSetSnapshotIntervalSecs=3600" );
+    db = m.getDB( baseName );
+
+    assert.soon( function() {
+        status = db.serverStatus().workingSetSnapshot;
+        return status.replay.state == "done";
+    }, "working set replay didn't finish" );
+    assert.gt( status.replay.pages, 0 );
+    assert.gt( status.replay.pagesTouched, 0, "replay touched no pages" );
+    assert.lte( status.replay.pagesTouched, status.replay.pages );
+    assert.lte( status.replay.priorityPages, status.replay.pagesTouched );
+
+    stopMongod( port );
+}
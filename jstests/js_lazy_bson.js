@@ -0,0 +1,40 @@
+// Documents handed to JavaScript are decoded lazily and converted back field by field when
+// modified.  Check that untouched fields, including nested ones, come back unchanged and in
+// order, and that changes made through decoded subobjects are not lost.
+
+t = db.js_lazy_bson;
+t.drop();
+
+t.save( { _id : 1, a : NumberInt( 5 ), b : { c : NumberInt( 1 ), d : "x" }, e : [ 1, 2 ],
+          f : "unchanged" } );
+
+function run( map ) {
+    var res = t.mapReduce( map, function( k, v ) { return v[0]; }, { out : { inline : 1 } } );
+    assert.eq( 1, res.results.length );
+    return res.results[0].value;
+}
+
+// reading a subobject doesn't force a conversion
+var v = run( function() { var x = this.b.c; emit( this._id, this ); } );
+assert.eq( "NumberInt(1)", tojson( v.b.c ) );
+assert.eq( "NumberInt(5)", tojson( v.a ) );
+
+// a change to a decoded subobject is seen through the parent
+v = run( function() { this.b.c = 7; emit( this._id, this ); } );
+assert.eq( 7, v.b.c );
+assert.eq( "x", v.b.d );
+assert.eq( "NumberInt(5)", tojson( v.a ) );
+assert.eq( [ "_id", "a", "b", "e", "f" ], Object.keySet( v ) );
+
+// added, removed and replaced fields
+v = run( function() { delete this.e; this.g = 3; this.a = 6; emit( this._id, this ); } );
+assert.eq( [ "_id", "a", "b", "f", "g" ], Object.keySet( v ) );
+assert.eq( 6, v.a );
+assert.eq( 3, v.g );
+assert.eq( "unchanged", v.f );
+
+// arrays are not lazy, so any access has to be treated as a change
+v = run( function() { this.e.push( 3 ); emit( this._id, this ); } );
+assert.eq( [ 1, 2, 3 ], v.e );
+
+t.drop();
@@ -0,0 +1,73 @@
+// Check that mapThreads runs the map phase on several threads with the same results as the
+// single threaded map.
+
+t = db.mr_parallel_map;
+t.drop();
+
+for (var i = 0; i < 5000; ++i) {
+    t.save( { x : i % 37, y : i } );
+}
+
+function m() {
+    emit( this.x, { count : 1, sum : this.y } );
+}
+
+function r( key, values ) {
+    var res = { count : 0, sum : 0 };
+    values.forEach( function( v ) {
+        res.count += v.count;
+        res.sum += v.sum;
+    } );
+    return res;
+}
+
+function reformat( r ) {
+    var x = {};
+    r.results.forEach( function( z ) { x[z._id] = z.value; } );
+    return x;
+}
+
+var serial = t.mapReduce( m, r, { out : { inline : 1 } } );
+var parallel = t.mapReduce( m, r, { out : { inline : 1 }, mapThreads : 4, verbose : true } );
+assert.eq( reformat( serial ), reformat( parallel ), "inline results differ" );
+assert.eq( 5000, parallel.counts.input );
+assert.eq( 5000, parallel.counts.emit );
+assert.eq( 37, parallel.counts.output );
+
+// on disk output, with a limit applied by the scanning thread
+var res = t.mapReduce( m, r, { out : "mr_parallel_map_out", mapThreads : 3, limit : 1000 } );
+assert.eq( 1000, res.counts.input );
+assert.eq( 37, db.mr_parallel_map_out.count() );
+var total = 0;
+db.mr_parallel_map_out.find().forEach( function( z ) { total += z.value.count; } );
+assert.eq( 1000, total );
+res.drop();
+
+// unique keys don't reduce, so workers hand their maps off to be dumped to the inc collection
+var big = new Array( 512 ).join( "x" );
+res = t.mapReduce( function() { emit( this.y, { count : 1, pad : big } ); },
+                   function( key, values ) { return values[0]; },
+                   { out : "mr_parallel_map_out", mapThreads : 4, scope : { big : big } } );
+assert.eq( 5000, res.counts.input );
+assert.eq( 5000, res.counts.emit );
+assert.eq( 5000, db.mr_parallel_map_out.count() );
+res.drop();
+
+// errors raised by a map thread are reported
+assert.throws( function() {
+    t.mapReduce( function() { throw "boom"; }, r, { out : { inline : 1 }, mapThreads : 2 } );
+} );
+
+// map functions can't use the database from map threads
+assert.throws( function() {
+    t.mapReduce( function() { db.foo.findOne(); emit( 1, 1 ); }, r,
+                 { out : { inline : 1 }, mapThreads : 2 } );
+} );
+
+// option validation
+assert.throws( function() { t.mapReduce( m, r, { out : { inline : 1 }, mapThreads : 0 } ); } );
+assert.throws( function() {
+    t.mapReduce( m, r, { out : { inline : 1 }, mapThreads : 2, jsMode : true } );
+} );
+
+t.drop();
@@ -0,0 +1,68 @@
+// Tests the presorted merge of a sharded $sort + $limit: the merged result has the right
+// documents, and a shard whose cursor is exhausted part way through the merge gives its
+// connection back while the merge is still running.
+
+var st = new ShardingTest({ shards: 2, mongos: 1, other: { separateConfig: true } });
+
+var mongos = st.s;
+var admin = mongos.getDB("admin");
+var coll = mongos.getCollection("aggSortLimit.coll");
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB().getName() }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll.getFullName(), key: { _id: 1 } }));
+
+// The merge runs on the primary shard.  Leave it most of the data, and give the other shard a
+// single document which sorts first, so its cursor is done after the first merged result.
+var primary = st.getServer(coll.getDB().getName());
+var other = st.getOther(primary);
+
+assert.commandWorked(admin.runCommand({ split: coll.getFullName(), middle: { _id: 100 } }));
+assert.commandWorked(admin.runCommand({ moveChunk: coll.getFullName(),
+                                        find: { _id: 100 },
+                                        to: other.name }));
+
+for (var i = 0; i <= 100; i++) {
+    coll.insert({ _id: i });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+var pipeline = [{ $sort: { _id: -1 } }, { $limit: 50 }];
+
+// Merged results
+var results = coll.aggregate(pipeline).toArray();
+assert.eq(50, results.length);
+for (var i = 0; i < results.length; i++) {
+    assert.eq(100 - i, results[i]._id);
+}
+
+// Connections the merging shard has checked out of its pool to the other shard
+function connsInUse() {
+    var stats = primary.getDB("admin").runCommand({ connPoolStats: 1 });
+    assert.commandWorked(stats);
+    var hostStats = stats.hosts[other.host + "::0"];
+    return hostStats ? hostStats.created - hostStats.available : 0;
+}
+
+// Keep the merge open after the first batch
+var cmdRes = coll.runCommand("aggregate", { pipeline: pipeline, cursor: { batchSize: 1 } });
+assert.commandWorked(cmdRes);
+assert.neq(0, cmdRes.cursor.id);
+assert.eq(100, cmdRes.cursor.firstBatch[0]._id);
+
+// The primary shard's own cursor is still feeding the merge, but the other shard's connection
+// is back in the pool
+assert.gt(primary.getDB("admin").serverStatus().cursors.totalOpen, 0);
+assert.eq(0, connsInUse());
+
+var cursor = new DBCommandCursor(mongos, cmdRes, 10);
+var rest = cursor.toArray();
+assert.eq(49, rest.length);
+assert.eq(99, rest[0]._id);
+assert.eq(51, rest[rest.length - 1]._id);
+
+// Once the merge is over nothing is left open on either shard
+assert.eq(0, primary.getDB("admin").serverStatus().cursors.totalOpen);
+assert.eq(0, other.getDB("admin").serverStatus().cursors.totalOpen);
+assert.eq(0, connsInUse());
+
+st.stop();
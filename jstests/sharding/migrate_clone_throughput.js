@@ -0,0 +1,54 @@
+//
+// Tests that a migration into an empty collection clones through several batches, builds the
+// unique indexes up front and the other secondary indexes afterwards in the background, and
+// reports clone throughput in the changelog
+//
+
+var options = { separateConfig : true };
+
+var st = new ShardingTest({ shards : 2, mongos : 1, other : options });
+st.stopBalancer();
+
+var mongos = st.s0;
+var shards = mongos.getDB( "config" ).shards.find().toArray();
+var admin = mongos.getDB( "admin" );
+var coll = mongos.getCollection( "foo.bar" );
+
+assert( admin.runCommand({ enableSharding : coll.getDB() + "" }).ok );
+printjson( admin.runCommand({ movePrimary : coll.getDB() + "", to : shards[0]._id }) );
+assert( admin.runCommand({ shardCollection : coll + "", key : { skey : 1 } }).ok );
+coll.ensureIndex({ x : 1 });
+coll.ensureIndex({ u : 1 }, { unique : true });
+assert.eq( null, coll.getDB().getLastError() );
+
+// big enough documents that one _migrateClone batch can't hold them all
+var bigStr = new Array( 1024 * 64 ).join( "x" );
+var nDocs = 600;
+for ( var i = 0; i < nDocs; i++ ) {
+    coll.insert({ skey : i, x : i, u : i, s : bigStr });
+}
+assert.eq( null, coll.getDB().getLastError() );
+
+assert( admin.runCommand({ moveChunk : coll + "", find : { skey : 0 },
+                           to : shards[1]._id, _waitForDelete : true }).ok );
+
+var shard1Coll = st.shard1.getCollection( coll + "" );
+assert.eq( nDocs, shard1Coll.find().itcount() );
+assert.eq( 4, shard1Coll.getIndexes().length );
+assert( shard1Coll.getDB().system.indexes.findOne({ ns : coll + "", key : { x : 1 } }).background );
+assert( !shard1Coll.getDB().system.indexes.findOne({ ns : coll + "", key : { u : 1 } }).background );
+assert.eq( 1, shard1Coll.find({ x : 10 }).hint({ x : 1 }).itcount() );
+
+var entry = mongos.getDB( "config" ).changelog.findOne({ what : "moveChunk.to", ns : coll + "" });
+printjson( entry );
+assert.eq( nDocs, entry.details.clonedDocs );
+assert.gt( entry.details.clonedBytes, 0 );
+assert( entry.details.cloneMBPerSec > 0 );
+assert.eq( 1, entry.details.deferredIndexes );
+
+var fromEntry = mongos.getDB( "config" ).changelog.findOne({ what : "moveChunk.from",
+                                                            ns : coll + "" });
+printjson( fromEntry );
+assert.eq( nDocs, fromEntry.details.counts.cloned );
+
+st.stop();
@@ -0,0 +1,71 @@
+// Tests the btree sampling estimator of the splitVector command against the exact index scan.
+
+var f = db.jstests_splitvector_sampling;
+f.drop();
+f.ensureIndex( { x: 1 } );
+
+var filler = "";
+while ( filler.length < 200 ) filler += "a";
+
+var numDocs = 60000;
+for ( var i = 0; i < numDocs; i++ ) {
+    f.insert( { x: i, y: filler } );
+}
+assert.eq( null, db.getLastError() );
+
+var splitVector = function( extra ) {
+    var cmd = { splitVector: f.getFullName(), keyPattern: { x: 1 }, maxChunkSize: 1 };
+    for ( var k in extra ) {
+        cmd[k] = extra[k];
+    }
+    var res = db.runCommand( cmd );
+    assert.commandWorked( res );
+    return res;
+};
+
+// The exact scan walks every key.
+var exact = splitVector( { estimate: false } );
+assert.eq( "scan", exact.splitStats.method, tojson( exact.splitStats ) );
+assert( !exact.splitStats.sampling, tojson( exact.splitStats ) );
+
+// The estimate should be close to the exact scan, and each chunk close to the target size.
+var sampled = splitVector( { estimate: true } );
+printjson( sampled.splitStats );
+assert.eq( "sampled", sampled.splitStats.method, tojson( sampled.splitStats ) );
+assert.lt( sampled.splitStats.sampling.bucketsRead, sampled.splitStats.sampling.leafBuckets,
+           tojson( sampled.splitStats ) );
+assert.close( exact.splitKeys.length, sampled.splitKeys.length, "number of split keys", -1 );
+
+var target = sampled.splitStats.targetChunkKeys;
+var bounds = [ { x: MinKey } ].concat( sampled.splitKeys );
+for ( var i = 0; i < bounds.length - 1; i++ ) {
+    var n = f.find( { x: { $gte: bounds[i].x, $lt: bounds[i + 1].x } } ).count();
+    assert.gt( n, target * 0.75, "chunk " + i + " too small" );
+    assert.lt( n, target * 1.25, "chunk " + i + " too large" );
+}
+
+// Forced median split.
+var median = splitVector( { estimate: true, force: true } );
+assert.eq( "sampled", median.splitStats.method, tojson( median.splitStats ) );
+assert.eq( 1, median.splitKeys.length, tojson( median ) );
+assert.close( numDocs / 2, median.splitKeys[0].x, "median", -4 );
+
+// maxSplitPoints is honored.
+var limited = splitVector( { estimate: true, maxSplitPoints: 2 } );
+assert.eq( "sampled", limited.splitStats.method, tojson( limited.splitStats ) );
+assert.eq( 2, limited.splitKeys.length, tojson( limited ) );
+
+// A range that spans few btree buckets falls back to the exact scan.
+var small = db.runCommand( { splitVector: f.getFullName(), keyPattern: { x: 1 },
+                             min: { x: 0 }, max: { x: 1000 }, force: true, estimate: true } );
+assert.commandWorked( small );
+assert.eq( "scan", small.splitStats.method, tojson( small.splitStats ) );
+assert( small.splitStats.fallbackReason, tojson( small.splitStats ) );
+assert.eq( 500, small.splitKeys[0].x, tojson( small ) );
+
+// Without 'estimate', a range this small is scanned exactly.
+var byDefault = splitVector( {} );
+assert.eq( "scan", byDefault.splitStats.method, tojson( byDefault.splitStats ) );
+assert.eq( exact.splitKeys, byDefault.splitKeys );
+
+f.drop();
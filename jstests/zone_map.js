@@ -0,0 +1,85 @@
+// Extent zone maps let collection scans skip extents that can't match
+
+var t = db.zone_map;
+t.drop();
+
+assert.commandWorked( db.createCollection( t.getName(), { zoneMapFields : [ "ts", "a.b" ] } ) );
+
+var big = new Array( 1024 ).toString();
+for ( var i = 0; i < 5000; i++ ) {
+    t.insert( { ts : i, a : { b : i % 10 }, big : big } );
+}
+assert.gt( t.stats().numExtents, 2 );
+
+// the first scan summarizes the extents it reads in full
+var ex = t.find( { ts : { $gte : 4990 } } ).hint( { $natural : 1 } ).explain();
+assert.eq( 10, ex.n );
+assert.eq( 0, ex.nExtentsSkipped );
+
+ex = t.find( { ts : { $gte : 4990 } } ).hint( { $natural : 1 } ).explain();
+assert.eq( 10, ex.n );
+assert.gt( ex.nExtentsSkipped, 0 );
+assert.lt( ex.nscanned, 5000 );
+
+// same going backwards
+ex = t.find( { ts : { $lt : 10 } } ).sort( { $natural : -1 } ).explain();
+assert.eq( 10, ex.n );
+ex = t.find( { ts : { $lt : 10 } } ).sort( { $natural : -1 } ).explain();
+assert.eq( 10, ex.n );
+assert.gt( ex.nExtentsSkipped, 0 );
+
+// $or skips only extents none of its clauses can match
+ex = t.find( { $or : [ { ts : 0 }, { ts : 4999 } ] } ).explain();
+assert.eq( 2, ex.n );
+assert.gt( ex.nExtentsSkipped, 0 );
+
+// predicates on fields without zone maps, or of another type, don't confuse it
+assert.eq( 500, t.find( { ts : { $gte : 0 }, "a.b" : 3 } ).itcount() );
+assert.eq( 0, t.find( { ts : "4999" } ).itcount() );
+assert.eq( 1, t.find( { ts : { $gt : 4998 } } ).itcount() );
+
+// in place and moving updates widen the summaries
+t.update( { ts : 0 }, { $set : { ts : 100000 } } );
+assert.eq( 1, t.find( { ts : 100000 } ).itcount() );
+t.update( { ts : 1 }, { ts : 100001, a : { b : 1 }, big : big + big } );
+assert.eq( 1, t.find( { ts : 100001 } ).itcount() );
+
+// arrays and missing fields make a summary unusable for skipping on that field
+t.update( { ts : 2 }, { $set : { "a.b" : [ 50 ] } } );
+assert.eq( 1, t.find( { "a.b" : 50 } ).itcount() );
+t.update( { ts : 3 }, { $unset : { ts : 1 } } );
+assert.eq( 1, t.find( { ts : null } ).itcount() );
+
+// new documents in already summarized extents are found
+t.remove( { ts : { $lt : 100 } } );
+for ( var i = 0; i < 50; i++ ) {
+    t.insert( { ts : -1, a : { b : -1 } } );
+}
+assert.eq( 50, t.find( { ts : -1 } ).itcount() );
+assert.eq( 50, t.find( { "a.b" : { $lt : 0 } } ).itcount() );
+
+// collMod declares fields on an existing collection
+var u = db.zone_map_collmod;
+u.drop();
+for ( var i = 0; i < 100; i++ ) {
+    u.insert( { x : i } );
+}
+var res = db.runCommand( { collMod : u.getName(), zoneMapFields : [ "x" ] } );
+assert.commandWorked( res );
+assert.eq( [], res.zoneMapFields_old );
+assert.eq( [ "x" ], res.zoneMapFields_new );
+u.find( { x : 5 } ).itcount();
+assert.eq( 0, u.find( { x : 5 } ).explain().nExtentsSkipped );
+assert.eq( 1, u.find( { x : 5 } ).itcount() );
+
+// ...and collections without zone maps don't report skipped extents
+db.runCommand( { collMod : u.getName(), zoneMapFields : [] } );
+assert.eq( undefined, u.find( { x : 5 } ).explain().nExtentsSkipped );
+
+// bad specs
+assert.commandFailed( db.runCommand( { collMod : u.getName(), zoneMapFields : "x" } ) );
+assert.commandFailed( db.runCommand( { collMod : u.getName(), zoneMapFields : [ 1 ] } ) );
+db.zone_map_capped.drop();
+assert.commandFailed( db.createCollection( "zone_map_capped",
+                                           { capped : true, size : 4096,
+                                             zoneMapFields : [ "x" ] } ) );
@@ -57,7 +57,10 @@
 
 namespace mongo {
 
-    ClientCursor::CCById ClientCursor::clientCursorsById;
+    ClientCursor::CCStripe* const ClientCursor::stripes(
+            new ClientCursor::CCStripe[ClientCursor::NumStripes] );
+    ClientCursor::CCByNs ClientCursor::clientCursorsByNs;
+    unsigned ClientCursor::numberOpen = 0;
     boost::recursive_mutex& ClientCursor::ccmutex( *(new boost::recursive_mutex()) );
     long long ClientCursor::numberTimedOut = 0;
     set<Runner*> ClientCursor::nonCachedRunners;
@@ -69,15 +72,16 @@ namespace mongo {
 
     ClientCursor::ClientCursor(int qopts, const shared_ptr<Cursor>& c, const StringData& ns,
                                BSONObj query)
-        : _ns(ns.toString()), _query(query), _runner(NULL), _c(c), _yieldSometimesTracker(128, 10) {
+        : _ns(ns.toString()), _query(query), _runner(NULL), _isAggCursor(false), _c(c),
+          _yieldSometimesTracker(128, 10) {
 
         _queryOptions = qopts;
         _doingDeletes = false;
         init();
     }
 
-    ClientCursor::ClientCursor(Runner* runner, int qopts, const BSONObj query)
-        : _yieldSometimesTracker(128, 10) {
+    ClientCursor::ClientCursor(Runner* runner, int qopts, const BSONObj query, bool isAggCursor)
+        : _isAggCursor(isAggCursor), _yieldSometimesTracker(128, 10) {
 
         _runner.reset(runner);
         _ns = runner->ns();
@@ -89,6 +93,7 @@ namespace mongo {
     ClientCursor::ClientCursor(const string& ns)
         : _ns(ns),
           _queryOptions(QueryOption_NoCursorTimeout),
+          _isAggCursor(false),
           _yieldSometimesTracker(128, 10) {
 
         init();
@@ -114,7 +119,12 @@ namespace mongo {
 
         recursive_scoped_lock lock(ccmutex);
         _cursorid = allocCursorId_inlock();
-        clientCursorsById.insert( make_pair(_cursorid, this) );
+        clientCursorsByNs[_ns].insert( make_pair(_cursorid, this) );
+        ++numberOpen;
+
+        CCStripe& stripe = stripeFor(_cursorid);
+        scoped_lock stripeLock(stripe.mutex);
+        stripe.cursors.insert( make_pair(_cursorid, this) );
     }
 
     ClientCursor::~ClientCursor() {
@@ -131,7 +141,20 @@ namespace mongo {
                 setLastLoc_inlock( DiskLoc() );
             }
 
-            clientCursorsById.erase(_cursorid);
+            {
+                // No-op if we were already detached from the stripe for deletion
+                CCStripe& stripe = stripeFor(_cursorid);
+                scoped_lock stripeLock(stripe.mutex);
+                stripe.cursors.erase(_cursorid);
+            }
+
+            CCByNs::iterator nsIt = clientCursorsByNs.find(_ns);
+            verify(nsIt != clientCursorsByNs.end());
+            nsIt->second.erase(_cursorid);
+            if (nsIt->second.empty()) {
+                clientCursorsByNs.erase(nsIt);
+            }
+            --numberOpen;
 
             // defensive:
             _cursorid = INVALID_CURSOR_ID;
@@ -143,11 +166,16 @@ namespace mongo {
     // static
     void ClientCursor::assertNoCursors() {
         recursive_scoped_lock lock(ccmutex);
-        if (clientCursorsById.size() > 0) {
+        if (!clientCursorsByNs.empty()) {
             log() << "ERROR clientcursors exist but should not at this point" << endl;
-            ClientCursor *cc = clientCursorsById.begin()->second;
+            ClientCursor *cc = clientCursorsByNs.begin()->second.begin()->second;
             log() << "first one: " << cc->_cursorid << ' ' << cc->_ns << endl;
-            clientCursorsById.clear();
+            clientCursorsByNs.clear();
+            for (int i = 0; i < NumStripes; i++) {
+                scoped_lock stripeLock(stripes[i].mutex);
+                stripes[i].cursors.clear();
+            }
+            numberOpen = 0;
             verify(false);
         }
     }
@@ -179,77 +207,92 @@ namespace mongo {
             }
         }
 
-        // Look at all cached ClientCursor(s).  The CC may have a Runner, a Cursor, or nothing (see
-        // sharding_block.h).
-        CCById::const_iterator it = clientCursorsById.begin();
-        while (it != clientCursorsById.end()) {
-            ClientCursor* cc = it->second;
-
-            // We're only interested in cursors over one db.
-            if (cc->_db != db) {
-                ++it;
-                continue;
+        // Look at the cached ClientCursor(s) on the namespace, or on every namespace in the db.
+        // The CC may have a Runner, a Cursor, or nothing (see sharding_block.h).
+        vector<ClientCursor*> toDelete;
+        CCByNs::iterator nsIt = isDB ? clientCursorsByNs.lower_bound(ns.toString())
+                                     : clientCursorsByNs.find(ns.toString());
+        for (; nsIt != clientCursorsByNs.end(); ++nsIt) {
+            if (isDB ? !StringData(nsIt->first).startsWith(ns) : ns != nsIt->first) {
+                break;
             }
 
-            // Note that a valid ClientCursor state is "no cursor no runner."  This is because
-            // the set of active cursor IDs in ClientCursor is used as representation of query
-            // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
-            if (NULL == cc->c() && NULL == cc->_runner.get()) {
-                ++it;
-                continue;
-            }
+            const CCById& nsCursors = nsIt->second;
+            for (CCById::const_iterator it = nsCursors.begin(); it != nsCursors.end(); ++it) {
+                ClientCursor* cc = it->second;
 
-            bool shouldDelete = false;
+                // We're only interested in cursors over one db.
+                if (cc->_db != db) {
+                    continue;
+                }
 
-            // We will only delete CCs with runners that are not actively in use.  The runners that
-            // are actively in use are instead kill()-ed.
-            if (NULL != cc->_runner.get()) {
-                verify(NULL == cc->c());
+                // Note that a valid ClientCursor state is "no cursor no runner."  This is because
+                // the set of active cursor IDs in ClientCursor is used as representation of query
+                // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
+                if (NULL == cc->c() && NULL == cc->_runner.get()) {
+                    continue;
+                }
 
-                if (isDB || cc->_runner->ns() == ns) {
-                    // If there is a pinValue >= 100, somebody is actively using the CC and we do
-                    // not delete it.  Instead we notify the holder that we killed it.  The holder
-                    // will then delete the CC.
-                    if (cc->_pinValue >= 100) {
-                        cc->_runner->kill();
-                    }
-                    else {
-                        // pinvalue is <100, so there is nobody actively holding the CC.  We can
-                        // safely delete it as nobody is holding the CC.
-                        shouldDelete = true;
-                    }
+                // Aggregation results don't depend on the namespace once computed, and the
+                // pipeline's own cursor is invalidated separately, so leave the CC alone as we did
+                // for the old PipelineCursor.
+                if (cc->_isAggCursor) {
+                    continue;
                 }
-            }
-            // Begin cursor-only DEPRECATED
-            else if (cc->c()->shouldDestroyOnNSDeletion()) {
-                verify(NULL == cc->_runner.get());
-
-                if (isDB) {
-                    // already checked that db matched above
-                    dassert( StringData(cc->_ns).startsWith( ns ) );
-                    shouldDelete = true;
+
+                bool shouldDelete = false;
+
+                // We will only delete CCs with runners that are not actively in use.  The runners
+                // that are actively in use are instead kill()-ed.
+                if (NULL != cc->_runner.get()) {
+                    verify(NULL == cc->c());
+
+                    if (isDB || cc->_runner->ns() == ns) {
+                        CCStripe& stripe = stripeFor(cc->_cursorid);
+                        scoped_lock stripeLock(stripe.mutex);
+
+                        // If there is a pinValue >= 100, somebody is actively using the CC and we
+                        // do not delete it.  Instead we notify the holder that we killed it.  The
+                        // holder will then delete the CC.
+                        if (cc->_pinValue >= 100) {
+                            cc->_runner->kill();
+                        }
+                        else {
+                            // pinvalue is <100, so there is nobody actively holding the CC.  We
+                            // can safely delete it as nobody is holding the CC.  Detach it so it
+                            // can't be pinned before we get to it.
+                            stripe.cursors.erase(cc->_cursorid);
+                            shouldDelete = true;
+                        }
+                    }
                 }
-                else {
-                    if ( ns == cc->_ns ) {
+                // Begin cursor-only DEPRECATED
+                else if (cc->c()->shouldDestroyOnNSDeletion()) {
+                    verify(NULL == cc->_runner.get());
+
+                    if (isDB) {
+                        // already checked that db matched above
+                        dassert( StringData(cc->_ns).startsWith( ns ) );
                         shouldDelete = true;
                     }
+                    else {
+                        if ( ns == cc->_ns ) {
+                            shouldDelete = true;
+                        }
+                    }
+                }
+                // End cursor-only DEPRECATED
+
+                if (shouldDelete) {
+                    toDelete.push_back(cc);
                 }
-            }
-            // End cursor-only DEPRECATED
-
-            if (shouldDelete) {
-                ClientCursor* toDelete = it->second;
-                CursorId id = toDelete->cursorid();
-                delete toDelete;
-                // We're not following the usual paradigm of saving it, ++it, and deleting the saved
-                // 'it' because deleting 'it' might invalidate the next thing in clientCursorsById.
-                // TODO: Why?
-                it = clientCursorsById.upper_bound(id);
-            }
-            else {
-                ++it;
             }
         }
+
+        // Deleting a cursor removes it from clientCursorsByNs, so wait until we're done iterating
+        for (vector<ClientCursor*>::iterator it = toDelete.begin(); it != toDelete.end(); ++it) {
+            delete *it;
+        }
     }
 
     /* must call this on a delete so we clean up the cursors. */
@@ -277,21 +320,20 @@ namespace mongo {
             }
         }
 
-        // TODO: This requires optimization.  We walk through *all* CCs and send the delete to every
-        // CC open on the db we're deleting from.  We could:
-        // 1. Map from ns to open runners,
-        // 2. Map from ns -> (a map of DiskLoc -> runners who care about that DL)
-        //
-        // We could also queue invalidations somehow and have them processed later in the runner's
-        // read locks.
-        for (CCById::const_iterator it = clientCursorsById.begin(); it != clientCursorsById.end();
-             ++it) {
+        // Only the CCs open on the namespace we're deleting from can hold the DiskLoc.
+        // TODO: We could map from ns -> (a map of DiskLoc -> runners who care about that DL), or
+        // queue invalidations somehow and have them processed later in the runner's read locks.
+        CCByNs::const_iterator nsIt = clientCursorsByNs.find(ns.toString());
+        if (nsIt != clientCursorsByNs.end()) {
+            const CCById& nsCursors = nsIt->second;
+            for (CCById::const_iterator it = nsCursors.begin(); it != nsCursors.end(); ++it) {
 
-            ClientCursor* cc = it->second;
-            // We're only interested in cursors over one db.
-            if (cc->_db != db) { continue; }
-            if (NULL == cc->_runner.get()) { continue; }
-            cc->_runner->invalidate(dl);
+                ClientCursor* cc = it->second;
+                // We're only interested in cursors over one db.
+                if (cc->_db != db) { continue; }
+                if (NULL == cc->_runner.get()) { continue; }
+                cc->_runner->invalidate(dl);
+            }
         }
 
         // Begin cursor-only.  Only cursors that are in ccByLoc are processed here.
@@ -369,6 +411,23 @@ namespace mongo {
         // End cursor-only
     }
 
+    bool ClientCursor::hasCursorsOrRunners(const StringData& ns) {
+        recursive_scoped_lock lock(ccmutex);
+
+        CCByNs::const_iterator nsIt = clientCursorsByNs.find(ns.toString());
+        if (nsIt != clientCursorsByNs.end() && !nsIt->second.empty()) {
+            return true;
+        }
+
+        for (set<Runner*>::iterator it = nonCachedRunners.begin(); it != nonCachedRunners.end();
+             ++it) {
+            if (0 == ns.compare((*it)->ns())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     void ClientCursor::registerRunner(Runner* runner) {
         recursive_scoped_lock lock(ccmutex);
         verify(nonCachedRunners.end() == nonCachedRunners.find(runner));
@@ -467,21 +526,21 @@ namespace mongo {
         // two passes so that we don't need to readlock unless we really do some timeouts
         // we assume here that incrementing _idleAgeMillis outside readlock is ok.
         {
-            recursive_scoped_lock lock(ccmutex);
-            {
-                unsigned sz = clientCursorsById.size();
-                static time_t last;
-                if( sz >= 100000 ) { 
-                    if( time(0) - last > 300 ) {
-                        last = time(0);
-                        log() << "warning number of open cursors is very large: " << sz << endl;
-                    }
+            unsigned sz = numberOpen;
+            static time_t last;
+            if( sz >= 100000 ) { 
+                if( time(0) - last > 300 ) {
+                    last = time(0);
+                    log() << "warning number of open cursors is very large: " << sz << endl;
                 }
             }
-            for ( CCById::iterator i = clientCursorsById.begin(); i != clientCursorsById.end();  ) {
-                CCById::iterator j = i;
-                i++;
-                if( j->second->shouldTimeout( millis ) ) {
+        }
+
+        for (int i = 0; i < NumStripes; i++) {
+            CCStripe& stripe = stripes[i];
+            scoped_lock stripeLock(stripe.mutex);
+            for ( CCById::iterator it = stripe.cursors.begin(); it != stripe.cursors.end(); ++it ) {
+                if( it->second->shouldTimeout( millis ) ) {
                     foundSomeToTimeout = true;
                 }
             }
@@ -491,23 +550,31 @@ namespace mongo {
             Lock::GlobalRead lk;
 
             recursive_scoped_lock cclock(ccmutex);
-            CCById::const_iterator it = clientCursorsById.begin();
-            while (it != clientCursorsById.end()) {
-                ClientCursor* cc = it->second;
-                if( cc->shouldTimeout(0) ) {
-                    numberTimedOut++;
-                    LOG(1) << "killing old cursor " << cc->_cursorid << ' ' << cc->_ns
-                           << " idle:" << cc->idleTime() << "ms\n";
-                    ClientCursor* toDelete = it->second;
-                    CursorId id = toDelete->cursorid();
-                    // This is what winds up removing it from the map.
-                    delete toDelete;
-                    it = clientCursorsById.upper_bound(id);
-                }
-                else {
-                    ++it;
+            vector<ClientCursor*> toDelete;
+            for (int i = 0; i < NumStripes; i++) {
+                CCStripe& stripe = stripes[i];
+                scoped_lock stripeLock(stripe.mutex);
+                CCById::iterator it = stripe.cursors.begin();
+                while (it != stripe.cursors.end()) {
+                    ClientCursor* cc = it->second;
+                    if( cc->shouldTimeout(0) ) {
+                        numberTimedOut++;
+                        LOG(1) << "killing old cursor " << cc->_cursorid << ' ' << cc->_ns
+                               << " idle:" << cc->idleTime() << "ms\n";
+                        toDelete.push_back(cc);
+                        stripe.cursors.erase(it++);
+                    }
+                    else {
+                        ++it;
+                    }
                 }
             }
+
+            // Cursors are never deleted under a stripe lock, since deletion takes it again
+            for (vector<ClientCursor*>::iterator it = toDelete.begin(); it != toDelete.end();
+                 ++it) {
+                delete *it;
+            }
         }
     }
 
@@ -533,17 +600,21 @@ namespace mongo {
 
     void ClientCursor::appendStats( BSONObjBuilder& result ) {
         recursive_scoped_lock lock(ccmutex);
-        result.appendNumber("totalOpen", clientCursorsById.size() );
+        result.appendNumber("totalOpen", static_cast<size_t>(numberOpen) );
         result.appendNumber("clientCursors_size", (int) numCursors());
         result.appendNumber("timedOut" , numberTimedOut);
         unsigned pinned = 0;
         unsigned notimeout = 0;
-        for ( CCById::iterator i = clientCursorsById.begin(); i != clientCursorsById.end(); i++ ) {
-            unsigned p = i->second->_pinValue;
-            if( p >= 100 )
-                pinned++;
-            else if( p > 0 )
-                notimeout++;
+        for (int s = 0; s < NumStripes; s++) {
+            CCStripe& stripe = stripes[s];
+            scoped_lock stripeLock(stripe.mutex);
+            for ( CCById::iterator i = stripe.cursors.begin(); i != stripe.cursors.end(); i++ ) {
+                unsigned p = i->second->_pinValue;
+                if( p >= 100 )
+                    pinned++;
+                else if( p > 0 )
+                    notimeout++;
+            }
         }
         if( pinned ) 
             result.append("pinned", pinned);
@@ -551,6 +622,41 @@ namespace mongo {
             result.append("totalNoTimeout", notimeout);
     }
 
+    namespace {
+        struct NamespaceCursorCounts {
+            NamespaceCursorCounts() : open(0), pinned(0), notimeout(0) {}
+            int open;
+            int pinned;
+            int notimeout;
+        };
+    }
+
+    void ClientCursor::appendNamespaceStats( BSONObjBuilder& result ) {
+        map<string, NamespaceCursorCounts> counts;
+        for (int s = 0; s < NumStripes; s++) {
+            CCStripe& stripe = stripes[s];
+            scoped_lock stripeLock(stripe.mutex);
+            for ( CCById::iterator i = stripe.cursors.begin(); i != stripe.cursors.end(); i++ ) {
+                NamespaceCursorCounts& nsCounts = counts[i->second->_ns];
+                nsCounts.open++;
+                unsigned p = i->second->_pinValue;
+                if( p >= 100 )
+                    nsCounts.pinned++;
+                else if( p > 0 )
+                    nsCounts.notimeout++;
+            }
+        }
+
+        for ( map<string, NamespaceCursorCounts>::const_iterator i = counts.begin();
+              i != counts.end(); ++i ) {
+            BSONObjBuilder nsBuilder( result.subobjStart( i->first ) );
+            nsBuilder.append( "open", i->second.open );
+            nsBuilder.append( "pinned", i->second.pinned );
+            nsBuilder.append( "totalNoTimeout", i->second.notimeout );
+            nsBuilder.done();
+        }
+    }
+
     //
     // ClientCursor creation/deletion/access.
     //
@@ -579,7 +685,11 @@ namespace mongo {
 
             if ( x < 0 ) { x *= -1; }
 
-            if ( ts != cursorGenTSLast || ClientCursor::find_inlock(x, false) == 0 )
+            if ( ts != cursorGenTSLast )
+                break;
+
+            scoped_lock stripeLock( stripeFor(x).mutex );
+            if ( ClientCursor::find_inlock(x, false) == 0 )
                 break;
         }
 
@@ -589,8 +699,9 @@ namespace mongo {
 
     // static
     ClientCursor* ClientCursor::find_inlock(CursorId id, bool warn) {
-        CCById::iterator it = clientCursorsById.find(id);
-        if ( it == clientCursorsById.end() ) {
+        CCStripe& stripe = stripeFor(id);
+        CCById::iterator it = stripe.cursors.find(id);
+        if ( it == stripe.cursors.end() ) {
             if ( warn ) {
                 OCCASIONALLY out() << "ClientCursor::find(): cursor not found in map '" << id
                     << "' (ok after a drop)" << endl;
@@ -603,15 +714,18 @@ namespace mongo {
     void ClientCursor::find( const string& ns , set<CursorId>& all ) {
         recursive_scoped_lock lock(ccmutex);
 
-        for ( CCById::iterator i=clientCursorsById.begin(); i!=clientCursorsById.end(); ++i ) {
-            if ( i->second->_ns == ns )
-                all.insert( i->first );
+        CCByNs::const_iterator nsIt = clientCursorsByNs.find(ns);
+        if ( nsIt == clientCursorsByNs.end() )
+            return;
+
+        for ( CCById::const_iterator i = nsIt->second.begin(); i != nsIt->second.end(); ++i ) {
+            all.insert( i->first );
         }
     }
 
     // static
     ClientCursor* ClientCursor::find(CursorId id, bool warn) {
-        recursive_scoped_lock lock(ccmutex);
+        scoped_lock stripeLock(stripeFor(id).mutex);
         ClientCursor *c = find_inlock(id, warn);
         // if this asserts, your code was not thread safe - you either need to set no timeout
         // for the cursor or keep a ClientCursor::Pointer in scope for it.
@@ -619,20 +733,27 @@ namespace mongo {
         return c;
     }
 
-    void ClientCursor::_erase_inlock(ClientCursor* cursor) {
+    ClientCursor* ClientCursor::_detachUnpinned_inlock(CursorId id) {
+        CCStripe& stripe = stripeFor(id);
+        scoped_lock stripeLock(stripe.mutex);
+
+        ClientCursor* cursor = find_inlock(id);
+        if (!cursor) { return NULL; }
+
         // Must not have an active ClientCursor::Pin.
         massert( 16089,
                 str::stream() << "Cannot kill active cursor " << cursor->cursorid(),
                 cursor->_pinValue < 100 );
 
-        delete cursor;
+        stripe.cursors.erase(id);
+        return cursor;
     }
 
     bool ClientCursor::erase(CursorId id) {
         recursive_scoped_lock lock(ccmutex);
-        ClientCursor* cursor = find_inlock(id);
+        ClientCursor* cursor = _detachUnpinned_inlock(id);
         if (!cursor) { return false; }
-        _erase_inlock(cursor);
+        delete cursor;
         return true;
     }
 
@@ -651,7 +772,7 @@ namespace mongo {
     bool ClientCursor::eraseIfAuthorized(CursorId id) {
         NamespaceString ns;
         {
-            recursive_scoped_lock lock(ccmutex);
+            scoped_lock stripeLock(stripeFor(id).mutex);
             ClientCursor* cursor = find_inlock(id);
             if (!cursor) {
                 audit::logKillCursorsAuthzCheck(
@@ -680,18 +801,25 @@ namespace mongo {
         // of 2 invariants: that the cursor ID won't be re-used in a short period of time, and that
         // the namespace associated with a cursor cannot change.
         recursive_scoped_lock lock(ccmutex);
-        ClientCursor* cursor = find_inlock(id);
-        if (!cursor) {
-            // Cursor was deleted in another thread since we found it earlier in this function.
-            return false;
+        {
+            scoped_lock stripeLock(stripeFor(id).mutex);
+            ClientCursor* cursor = find_inlock(id);
+            if (!cursor) {
+                // Cursor was deleted in another thread since we found it earlier in this function.
+                return false;
+            }
+            if (ns != cursor->ns()) {
+                warning() << "Cursor namespace changed. Previous ns: " << ns << ", current ns: "
+                        << cursor->ns() << endl;
+                return false;
+            }
         }
-        if (ns != cursor->ns()) {
-            warning() << "Cursor namespace changed. Previous ns: " << ns << ", current ns: "
-                    << cursor->ns() << endl;
+
+        ClientCursor* cursor = _detachUnpinned_inlock(id);
+        if (!cursor) {
             return false;
         }
-
-        _erase_inlock(cursor);
+        delete cursor;
         return true;
     }
 
@@ -863,7 +991,7 @@ namespace mongo {
     //
 
     ClientCursorPin::ClientCursorPin(long long cursorid) : _cursorid( INVALID_CURSOR_ID ) {
-        recursive_scoped_lock lock( ClientCursor::ccmutex );
+        scoped_lock stripeLock( ClientCursor::stripeFor( cursorid ).mutex );
         ClientCursor *cursor = ClientCursor::find_inlock( cursorid, true );
         if (NULL != cursor) {
             uassert( 12051, "clientcursor already in use? driver problem?",
@@ -879,8 +1007,11 @@ namespace mongo {
         if ( _cursorid == INVALID_CURSOR_ID ) {
             return;
         }
-        ClientCursor *cursor = c();
+        CursorId cursorid = _cursorid;
         _cursorid = INVALID_CURSOR_ID;
+
+        scoped_lock stripeLock( ClientCursor::stripeFor( cursorid ).mutex );
+        ClientCursor *cursor = ClientCursor::find_inlock( cursorid );
         if ( cursor ) {
             verify( cursor->_pinValue >= 100 );
             cursor->_pinValue -= 100;
@@ -1021,7 +1152,7 @@ namespace mongo {
         CmdCursorInfo() : Command( "cursorInfo", true ) {}
         virtual bool slaveOk() const { return true; }
         virtual void help( stringstream& help ) const {
-            help << " example: { cursorInfo : 1 }";
+            help << " example: { cursorInfo : 1, byNamespace : true }";
         }
         virtual LockType locktype() const { return NONE; }
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -1034,6 +1165,11 @@ namespace mongo {
         bool run(const string& dbname, BSONObj& jsobj, int, string& errmsg, BSONObjBuilder& result,
                  bool fromRepl ) {
             ClientCursor::appendStats( result );
+            if ( jsobj["byNamespace"].trueValue() ) {
+                BSONObjBuilder nsBuilder( result.subobjStart( "byNamespace" ) );
+                ClientCursor::appendNamespaceStats( nsBuilder );
+                nsBuilder.done();
+            }
             return true;
         }
     } cmdCursorInfo;
@@ -55,13 +55,23 @@ namespace mongo {
     /**
      * ClientCursor is a wrapper that represents a cursorid from our database application's
      * perspective.
+     *
+     * The registry of open ClientCursors is indexed two ways: by namespace, under ccmutex, and by
+     * id, partitioned into stripes which each have their own lock.  Lookups, pins and unpins by
+     * id only take the lock of the cursor's stripe, and invalidation only visits the cursors on
+     * the affected namespace.
      */
     class ClientCursor : private boost::noncopyable {
     public:
         ClientCursor(int qopts, const shared_ptr<Cursor>& c, const StringData& ns,
                      BSONObj query = BSONObj());
 
-        ClientCursor(Runner* runner, int qopts = 0, const BSONObj query = BSONObj());
+        /**
+         * @param isAggCursor the runner serves results already computed by an aggregation
+         *        pipeline, so the cursor is not invalidated when its namespace is dropped
+         */
+        ClientCursor(Runner* runner, int qopts = 0, const BSONObj query = BSONObj(),
+                     bool isAggCursor = false);
 
         ClientCursor(const string& ns);
 
@@ -99,6 +109,12 @@ namespace mongo {
                                   const NamespaceDetails* nsd,
                                   const DiskLoc& dl);
 
+        /**
+         * @return true if a ClientCursor or a registered (yielded) runner is open on 'ns', i.e.
+         * something that holds a position in the collection across a yield.
+         */
+        static bool hasCursorsOrRunners(const StringData& ns);
+
         /**
          * Register a runner so that it can be notified of deletion/invalidation during yields.
          * Must be called before a runner yields.  If a runner is cached (inside a ClientCursor) it
@@ -123,11 +139,14 @@ namespace mongo {
 
         static void appendStats( BSONObjBuilder& result );
 
+        /** Appends open/pinned/noTimeout cursor counts for each namespace with open cursors. */
+        static void appendNamespaceStats( BSONObjBuilder& result );
+
         //
         // ClientCursor creation/deletion.
         //
 
-        static unsigned numCursors() { return clientCursorsById.size(); }
+        static unsigned numCursors() { return numberOpen; }
         static void find( const string& ns , set<CursorId>& all );
         static ClientCursor* find(CursorId id, bool warn = true);
 
@@ -162,7 +181,8 @@ namespace mongo {
 
         /**
          * @param millis amount of idle passed time since last call
-         * note called outside of locks (other than ccmutex) so care must be exercised
+         * note called outside of locks (other than the cursor's stripe lock) so care must be
+         * exercised
          */
         bool shouldTimeout( unsigned millis );
         unsigned idleTime() const { return _idleAgeMillis; }
@@ -195,6 +215,7 @@ namespace mongo {
 
         Runner* getRunner() const { return _runner.get(); }
         int queryOptions() const { return _queryOptions; }
+        bool isAggCursor() const { return _isAggCursor; }
 
         // Used by ops/query.cpp to stash how many results have been returned by a query.
         int pos() const { return _pos; }
@@ -277,7 +298,34 @@ namespace mongo {
         // A map from the CursorId to the ClientCursor behind it.
         // TODO: Consider making this per-connection.
         typedef map<CursorId, ClientCursor*> CCById;
-        static CCById clientCursorsById;
+
+        // One partition of the open cursors by id.  The pin value of a cursor is guarded by the
+        // lock of its stripe.
+        //
+        // Lock order is ccmutex, then a stripe's lock.  A stripe's lock may be taken on its own
+        // (finding and pinning a cursor only need its stripe) or while holding ccmutex, but
+        // ccmutex is never taken while holding a stripe's lock, and only one stripe's lock is
+        // held at a time.  So no cursor is deleted under a stripe's lock, since ~ClientCursor
+        // takes ccmutex.
+        struct CCStripe {
+            CCStripe() : mutex( "ClientCursorStripe" ) {}
+            mongo::mutex mutex;
+            CCById cursors;
+        };
+
+        static const int NumStripes = 16;
+        static CCStripe* const stripes;
+
+        static CCStripe& stripeFor( CursorId id ) {
+            return stripes[ static_cast<unsigned long long>( id ) % NumStripes ];
+        }
+
+        // The open cursors on each namespace.  Namespaces without open cursors have no entry.
+        typedef map<string, CCById> CCByNs;
+        static CCByNs clientCursorsByNs;
+
+        // How many cursors are open?
+        static unsigned numberOpen;
 
         // A list of NON-CACHED runners.  Any runner that yields must be put into this map before
         // yielding in order to be notified of invalidation and namespace deletion.  Before the
@@ -289,7 +337,8 @@ namespace mongo {
         // How many cursors have timed out?
         static long long numberTimedOut;
 
-        // This must be held when modifying any static member.
+        // This must be held when modifying clientCursorsByNs, nonCachedRunners, numberOpen,
+        // numberTimedOut or a database's ccByLoc map, and when deleting a cursor.
         static boost::recursive_mutex& ccmutex;
 
         /**
@@ -306,15 +355,17 @@ namespace mongo {
 
         /**
          * Find the ClientCursor with the provided ID.  Optionally warn if it's not found.
-         * Assumes ccmutex is held.
+         * Assumes the stripe for the ID is locked.
          */
 
         static ClientCursor* find_inlock(CursorId id, bool warn = true);
 
         /**
-         * Delete the ClientCursor with the provided ID.  masserts if the cursor is pinned.
+         * Removes the ClientCursor with the provided ID from its stripe, so it can no longer be
+         * found or pinned, and returns it for the caller to delete.  Returns NULL if there is no
+         * such cursor.  masserts if the cursor is pinned.  Assumes ccmutex is held.
          */
-        static void _erase_inlock(ClientCursor* cursor);
+        static ClientCursor* _detachUnpinned_inlock(CursorId id);
 
         //
         // ClientCursor-specific data, independent of the underlying execution type.
@@ -367,6 +418,9 @@ namespace mongo {
         // The new world: a runner.
         scoped_ptr<Runner> _runner;
 
+        // Aggregation cursors outlive drops of their namespace, see invalidate().
+        bool _isAggCursor;
+
         //
         // Cursor-only private data and methods.  DEPRECATED.
         //
@@ -32,6 +32,8 @@
 
 #include "mongo/db/commands/mr.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/client/connpool.h"
 #include "mongo/client/parallel.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -69,7 +71,11 @@ namespace mongo {
         }
 
         void JSFunction::init( State * state ) {
-            _scope = state->scope();
+            init( state->scope() );
+        }
+
+        void JSFunction::init( Scope * scope ) {
+            _scope = scope;
             verify( _scope );
             _scope->init( &_wantedScope );
 
@@ -85,6 +91,11 @@ namespace mongo {
             _params = state->config().mapParams;
         }
 
+        void JSMapper::init( Scope * scope , const BSONObj& params ) {
+            _func.init( scope );
+            _params = params;
+        }
+
         /**
          * Applies the map function to an object, which should internally call emit()
          */
@@ -118,6 +129,10 @@ namespace mongo {
             _func.init( state );
         }
 
+        void JSReducer::init( Scope * scope ) {
+            _func.init( scope );
+        }
+
         /**
          * Reduces a list of tuple objects (key, value) to a single tuple {"0": key, "1": value}
          */
@@ -280,8 +295,10 @@ namespace mongo {
                 if ( cmdObj["scope"].type() == Object )
                     scopeSetup = cmdObj["scope"].embeddedObjectUserCheck();
 
-                mapper.reset( new JSMapper( cmdObj["map"] ) );
-                reducer.reset( new JSReducer( cmdObj["reduce"] ) );
+                mapCode = cmdObj["map"].wrap();
+                reduceCode = cmdObj["reduce"].wrap();
+                mapper.reset( new JSMapper( mapCode.firstElement() ) );
+                reducer.reset( new JSReducer( reduceCode.firstElement() ) );
                 if ( cmdObj["finalize"].type() && cmdObj["finalize"].trueValue() )
                     finalizer.reset( new JSFinalizer( cmdObj["finalize"] ) );
 
@@ -291,6 +308,15 @@ namespace mongo {
 
             }
 
+            mapThreads = 1;
+            if ( cmdObj["mapThreads"].isNumber() ) {
+                mapThreads = cmdObj["mapThreads"].numberInt();
+                uassert( 17287 , "mapThreads must be between 1 and 64" ,
+                         mapThreads >= 1 && mapThreads <= 64 );
+            }
+            uassert( 17288 , "mapThreads can't be combined with jsMode" ,
+                     mapThreads == 1 || ! jsMode );
+
             {
                 // query options
                 BSONElement q = cmdObj["query"];
@@ -1023,6 +1049,15 @@ namespace mongo {
             _add( _temp.get() , a , _size );
         }
 
+        void State::addToInMemory( const InMemory& im , long long numEmits ) {
+            for ( InMemory::const_iterator i = im.begin(); i != im.end(); ++i ) {
+                const BSONList& all = i->second;
+                for ( BSONList::const_iterator j = all.begin(); j != all.end(); ++j )
+                    _add( _temp.get() , *j , _size );
+            }
+            _numEmits += numEmits;
+        }
+
         void State::_add( InMemory* im, const BSONObj& a , long& size ) {
             BSONList& all = (*im)[a];
             all.push_back( a );
@@ -1073,27 +1108,275 @@ namespace mongo {
         }
 
         /**
-         * emit that will be called by js function
+         * validates the arguments of an emit() call and returns the (key, value) tuple to store
          */
-        BSONObj fast_emit( const BSONObj& args, void* data ) {
+        static BSONObj emitTuple( const BSONObj& args ) {
             uassert( 10077 , "fast_emit takes 2 args" , args.nFields() == 2 );
             uassert( 13069 , "an emit can't be more than half max bson size" , args.objsize() < ( BSONObjMaxUserSize / 2 ) );
-            
-            State* state = (State*) data;
+
             if ( args.firstElement().type() == Undefined ) {
                 BSONObjBuilder b( args.objsize() );
                 b.appendNull( "" );
                 BSONObjIterator i( args );
                 i.next();
                 b.append( i.next() );
-                state->emit( b.obj() );
-            }
-            else {
-                state->emit( args );
+                return b.obj();
             }
+            return args;
+        }
+
+        /**
+         * emit that will be called by js function
+         */
+        BSONObj fast_emit( const BSONObj& args, void* data ) {
+            State* state = (State*) data;
+            state->emit( emitTuple( args ) );
             return BSONObj();
         }
 
+        // ------------ parallel map -----------
+
+        /**
+         * One map thread: owns a Scope with its own copies of the map and reduce functions, and
+         * an in memory map that only this thread touches until it has been joined.
+         */
+        class ParallelMapper::Worker : boost::noncopyable {
+        public:
+            Worker( const Config& config , auto_ptr<Scope> scope , long maxSize ) :
+                _config( config ),
+                _scope( scope.release() ),
+                _mapper( config.mapCode.firstElement() ),
+                _reducer( config.reduceCode.firstElement() ),
+                _maxSize( maxSize ),
+                _size( 0 ),
+                _dupCount( 0 ),
+                _numEmits( 0 ),
+                _mapMicros( 0 ) {
+
+                if ( ! _config.scopeSetup.isEmpty() )
+                    _scope->init( &_config.scopeSetup );
+                _mapper.init( _scope.get() , _config.mapParams );
+                _reducer.init( _scope.get() );
+                _scope->injectNative( "emit" , emit , this );
+            }
+
+            void start( ParallelMapper* parent ) {
+                _thread.reset( new boost::thread( boost::bind( &Worker::run , this , parent ) ) );
+            }
+
+            void join() {
+                if ( _thread )
+                    _thread->join();
+                _thread.reset();
+            }
+
+            /**
+             * reduces every key with more than one value, leaving a single tuple per key
+             */
+            void reduceInMemory() {
+                InMemory n;
+                long nSize = 0;
+                for ( InMemory::iterator i = _temp.begin(); i != _temp.end(); ++i ) {
+                    BSONList& all = i->second;
+                    BSONObj res = all.size() > 1 ? _reducer.reduce( all ) : all[0];
+                    n[res].push_back( res );
+                    nSize += res.objsize() + 16;
+                }
+                _temp.swap( n );
+                _size = nSize;
+                _dupCount = 0;
+            }
+
+            const InMemory& inMemory() const { return _temp; }
+            long long numEmits() const { return _numEmits; }
+            long long numReduces() const { return _reducer.numReduces; }
+            long long mapMicros() const { return _mapMicros; }
+
+        private:
+            void _handOff( ParallelMapper* parent ) {
+                auto_ptr<InMemory> im( new InMemory() );
+                im->swap( _temp );
+                parent->_handOff( im.release() , _numEmits );
+                _size = 0;
+                _dupCount = 0;
+                _numEmits = 0;
+            }
+
+            static BSONObj emit( const BSONObj& args, void* data ) {
+                Worker* worker = static_cast<Worker*>( data );
+                BSONObj tuple = emitTuple( args );
+                BSONList& all = worker->_temp[tuple];
+                all.push_back( tuple );
+                worker->_size += tuple.objsize() + 16;
+                if ( all.size() > 1 )
+                    ++worker->_dupCount;
+                worker->_numEmits++;
+                return BSONObj();
+            }
+
+            void run( ParallelMapper* parent ) {
+                Scope::NoDBAccess noDB = _scope->disableDBAccess( "can't access db inside parallel map" );
+                bool failed = false;
+                while ( true ) {
+                    BSONObj o = parent->_queue.blockingPop();
+                    if ( o.objdata() == parent->_stopMarker.objdata() )
+                        break;
+
+                    // keep draining after a failure so the scanning thread never blocks on us
+                    if ( failed )
+                        continue;
+
+                    try {
+                        Timer t;
+                        _mapper.map( o );
+                        _mapMicros += t.micros();
+
+                        if ( _size > _maxSize ||
+                             _dupCount > ( _temp.size() * _config.reduceTriggerRatio ) ) {
+                            long oldSize = _size;
+                            reduceInMemory();
+
+                            // same test as State::checkSize(): if reducing didn't help, give
+                            // the map to the scanning thread so it can be dumped to disk,
+                            // rather than re-reducing it for every following emit
+                            if ( _size > _maxSize || _size > oldSize / 2 )
+                                _handOff( parent );
+                        }
+                    }
+                    catch ( const std::exception& e ) {
+                        failed = true;
+                        parent->_setError( e.what() );
+                    }
+                }
+            }
+
+            const Config& _config;
+            scoped_ptr<Scope> _scope;
+            JSMapper _mapper;
+            JSReducer _reducer;
+            scoped_ptr<boost::thread> _thread;
+            const long _maxSize;
+
+            InMemory _temp;
+            long _size;
+            long _dupCount;
+            long long _numEmits;
+            long long _mapMicros;
+        };
+
+        ParallelMapper::ParallelMapper( State* state , int numThreads ) :
+            _state( state ),
+            _queue( 1000 * numThreads ),
+            _stopMarker( BSON( "stop" << true ) ),
+            _stopped( false ),
+            _errorMutex( "ParallelMapper" ),
+            _spillMutex( "ParallelMapper spill" ),
+            _spilledEmits( 0 ) {
+
+            const string userToken = ClientBasic::getCurrent()->getAuthorizationSession()
+                                                              ->getAuthenticatedUserNamesToken();
+            // the workers share the memory budget of a single threaded map
+            const long maxSize = std::max( state->config().maxInMemSize / numThreads , 1L );
+            try {
+                // scopes are acquired here since loading stored functions needs this client, and
+                // so that each one is registered with this operation for killOp
+                for ( int i = 0; i < numThreads; i++ ) {
+                    _workers.mutableVector().push_back( new Worker( state->config() ,
+                                                    globalScriptEngine->getPooledScope(
+                                                        state->config().dbname,
+                                                        "mapreduce" + userToken ) ,
+                                                    maxSize ) );
+                }
+                for ( size_t i = 0; i < _workers.size(); i++ )
+                    _workers.vector()[i]->start( this );
+            }
+            catch ( ... ) {
+                _stopWorkers( true );
+                throw;
+            }
+        }
+
+        ParallelMapper::~ParallelMapper() {
+            _stopWorkers( true );
+        }
+
+        void ParallelMapper::map( const BSONObj& o ) {
+            _checkForError();
+            _queue.push( o.getOwned() );
+        }
+
+        bool ParallelMapper::spillPending() const {
+            scoped_lock lk( _spillMutex );
+            return ! _spills.empty();
+        }
+
+        void ParallelMapper::spill() {
+            OwnedPointerVector<InMemory> spills;
+            long long numEmits;
+            {
+                scoped_lock lk( _spillMutex );
+                spills.mutableVector().swap( _spills.mutableVector() );
+                numEmits = _spilledEmits;
+                _spilledEmits = 0;
+            }
+
+            for ( size_t i = 0; i < spills.size(); i++ ) {
+                _state->addToInMemory( *spills.vector()[i] , i == 0 ? numEmits : 0 );
+                _state->checkSize();
+            }
+        }
+
+        void ParallelMapper::finish() {
+            _stopWorkers( false );
+            _checkForError();
+
+            spill();
+            for ( size_t i = 0; i < _workers.size(); i++ ) {
+                Worker* w = _workers.vector()[i];
+                w->reduceInMemory();
+                _state->addToInMemory( w->inMemory() , w->numEmits() );
+                _state->config().reducer->numReduces += w->numReduces();
+                _state->checkSize();
+            }
+        }
+
+        long long ParallelMapper::mapMicros() const {
+            long long total = 0;
+            for ( size_t i = 0; i < _workers.size(); i++ )
+                total += _workers.vector()[i]->mapMicros();
+            return total;
+        }
+
+        void ParallelMapper::_stopWorkers( bool discard ) {
+            if ( ! _stopped ) {
+                _stopped = true;
+                // only this thread pushes, so nothing can be queued behind the clear
+                if ( discard )
+                    _queue.clear();
+                for ( size_t i = 0; i < _workers.size(); i++ )
+                    _queue.push( _stopMarker );
+                for ( size_t i = 0; i < _workers.size(); i++ )
+                    _workers.vector()[i]->join();
+            }
+        }
+
+        void ParallelMapper::_checkForError() {
+            scoped_lock lk( _errorMutex );
+            uassert( 17289 , str::stream() << "parallel map failed: " << _error , _error.empty() );
+        }
+
+        void ParallelMapper::_setError( const string& msg ) {
+            scoped_lock lk( _errorMutex );
+            if ( _error.empty() )
+                _error = msg;
+        }
+
+        void ParallelMapper::_handOff( InMemory* im , long long numEmits ) {
+            scoped_lock lk( _spillMutex );
+            _spills.mutableVector().push_back( im );
+            _spilledEmits += numEmits;
+        }
+
         /**
          * function is called when we realize we cant use js mode for m/r on the 1st key
          */
@@ -1208,6 +1491,9 @@ namespace mongo {
 
                     wassert( config.limit < 0x4000000 ); // see case on next line to 32 bit unsigned
                     long long mapTime = 0;
+                    scoped_ptr<ParallelMapper> parallelMapper;
+                    if ( config.mapThreads > 1 )
+                        parallelMapper.reset( new ParallelMapper( &state , config.mapThreads ) );
                     {
                         // We've got a cursor preventing migrations off, now re-establish our useful cursor
 
@@ -1250,13 +1536,32 @@ namespace mongo {
                             }
 
                             // do map
-                            if ( config.verbose ) mt.reset();
-                            config.mapper->map( o );
-                            if ( config.verbose ) mapTime += mt.micros();
+                            if ( parallelMapper ) {
+                                parallelMapper->map( o );
+                            }
+                            else {
+                                if ( config.verbose ) mt.reset();
+                                config.mapper->map( o );
+                                if ( config.verbose ) mapTime += mt.micros();
+                            }
 
                             num++;
                             if ( num % 100 == 0 ) {
                                 killCurrentOp.checkForInterrupt();
+
+                                if ( parallelMapper && parallelMapper->spillPending() ) {
+                                    // spilling writes to the inc collection, so let go of
+                                    // the read lock while the State dumps worker output
+                                    runner->saveState();
+                                    {
+                                        dbtempreleasecond yield;
+                                        // if nested in another lock, finish() folds it later
+                                        if ( yield.unlocked() )
+                                            parallelMapper->spill();
+                                    }
+                                    if ( ! runner->restoreState() )
+                                        break;
+                                }
                             }
                             pm.hit();
 
@@ -1264,6 +1569,11 @@ namespace mongo {
                                 break;
                         }
                     }
+                    if ( parallelMapper ) {
+                        parallelMapper->finish();
+                        mapTime = parallelMapper->mapMicros();
+                        parallelMapper.reset();
+                    }
                     pm.finished();
 
                     killCurrentOp.checkForInterrupt();
@@ -1290,6 +1600,8 @@ namespace mongo {
                     countsBuilder.appendNumber( "reduce" , state.numReduces() );
                     timingBuilder.appendNumber( "reduceTime" , inReduce / 1000 );
                     timingBuilder.append( "mode" , state.jsMode() ? "js" : "mixed" );
+                    if ( config.mapThreads > 1 )
+                        timingBuilder.append( "mapThreads" , config.mapThreads );
 
                     long long finalCount = state.postProcessCollection(op, pm);
                     state.appendResults( result );
@@ -34,11 +34,13 @@
 #include <string>
 #include <vector>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/scripting/engine.h"
+#include "mongo/util/queue.h"
 
 namespace mongo {
 
@@ -98,6 +100,9 @@ namespace mongo {
 
             virtual void init( State * state );
 
+            /** binds the function to a specific scope rather than the State's scope */
+            void init( Scope * scope );
+
             Scope * scope() const { return _scope; }
             ScriptingFunction func() const { return _func; }
 
@@ -115,6 +120,7 @@ namespace mongo {
             JSMapper( const BSONElement & code ) : _func( "_map" , code ) {}
             virtual void map( const BSONObj& o );
             virtual void init( State * state );
+            void init( Scope * scope , const BSONObj& params );
 
         private:
             JSFunction _func;
@@ -125,6 +131,7 @@ namespace mongo {
         public:
             JSReducer( const BSONElement& code ) : _func( "_reduce" , code ) {}
             virtual void init( State * state );
+            void init( Scope * scope );
 
             virtual BSONObj reduce( const BSONList& tuples );
             virtual BSONObj finalReduce( const BSONList& tuples , Finalizer * finalizer );
@@ -194,6 +201,13 @@ namespace mongo {
             BSONObj mapParams;
             BSONObj scopeSetup;
 
+            // owned copies of the map and reduce code, for per-thread instances
+            BSONObj mapCode;
+            BSONObj reduceCode;
+
+            // number of threads running the map function, 1 means map on the calling thread
+            int mapThreads;
+
             // output tables
             string incLong;
             string tempNamespace;
@@ -269,6 +283,12 @@ namespace mongo {
             void insertToInc( BSONObj& o );
             void _insertToInc( BSONObj& o );
 
+            /**
+             * folds tuples emitted outside of this State (e.g. by ParallelMapper workers)
+             * into the in memory map
+             */
+            void addToInMemory( const InMemory& im , long long numEmits );
+
             // ------ reduce stage -----------
 
             void prepTempCollection();
@@ -344,6 +364,65 @@ namespace mongo {
             ScriptingFunction _reduceAndFinalizeAndInsert;
         };
 
+        /**
+         * Runs the map phase on several threads.  The calling thread keeps scanning the
+         * collection and queues owned documents; each worker maps them in its own pooled Scope
+         * and emits into a private InMemory map, reduced in place when it grows past its share
+         * of maxInMemSize.  A map that stays too big after reducing is handed off, and the
+         * scanning thread folds it into the State with spill(), which can dump it to the inc
+         * collection.  finish() joins the workers and hands over what is left, ahead of
+         * reduceInMemory() and the on disk phases.  Only used in mixed mode; map functions
+         * can't access the database.
+         */
+        class ParallelMapper : boost::noncopyable {
+        public:
+            ParallelMapper( State* state , int numThreads );
+            ~ParallelMapper();
+
+            /** queues a document for mapping, rethrows if a worker has failed */
+            void map( const BSONObj& o );
+
+            /** true if a worker has handed off a map that spill() should fold into the State */
+            bool spillPending() const;
+
+            /**
+             * folds handed off worker maps into the State and lets it reduce or dump them
+             * must be called without holding a lock on the input namespace
+             */
+            void spill();
+
+            /** waits for the queue to drain and merges worker output into the State */
+            void finish();
+
+            /** total time spent in the map function across all workers */
+            long long mapMicros() const;
+
+        private:
+            class Worker;
+
+            /**
+             * @param discard drop documents still queued instead of mapping them, so a failed
+             *        or killed map/reduce doesn't wait for the backlog
+             */
+            void _stopWorkers( bool discard );
+            void _checkForError();
+            void _setError( const string& msg );
+            void _handOff( InMemory* im , long long numEmits );
+
+            State* _state;
+            OwnedPointerVector<Worker> _workers;
+            BlockingQueue<BSONObj> _queue;
+            const BSONObj _stopMarker;
+            bool _stopped;
+
+            mutable mongo::mutex _errorMutex;
+            string _error;
+
+            mutable mongo::mutex _spillMutex;
+            OwnedPointerVector<InMemory> _spills;    // handed off by workers, guarded by _spillMutex
+            long long _spilledEmits;                 // guarded by _spillMutex
+        };
+
         BSONObj fast_emit( const BSONObj& args, void* data );
         BSONObj _bailFromJS( const BSONObj& args, void* data );
 
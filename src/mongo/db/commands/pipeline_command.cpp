@@ -43,6 +43,7 @@
 #include "mongo/db/pipeline/pipeline_d.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/ops/query.h"
+#include "mongo/db/query/runner.h"
 #include "mongo/db/storage_options.h"
 
 namespace mongo {
@@ -73,6 +74,93 @@ namespace mongo {
         return true;
     }
 
+    /**
+     * Runner over the output of a Pipeline, cached in a ClientCursor for cursor-mode aggregates
+     * so that getMore goes through the Runner path and nothing is buffered beyond the batch.
+     *
+     * The runner is always pulled without a lock held, both here and in newGetMore.  The
+     * stages lock for themselves (DocumentSourceCursor takes the read lock per batch and
+     * yields it), so the runner has nothing to yield.  The pipeline is freed as soon as it hits
+     * EOF.
+     */
+    class PipelineRunner : public Runner {
+    public:
+        PipelineRunner(intrusive_ptr<Pipeline> pipeline, const string& ns)
+            : _pipeline(pipeline)
+            , _ns(ns)
+            , _killed(false)
+        {}
+
+        virtual void setYieldPolicy(YieldPolicy policy) {}
+
+        virtual RunnerState getNext(BSONObj* objOut, DiskLoc* dlOut) {
+            if (_killed)
+                return RUNNER_DEAD;
+
+            // results are computed, there is no DiskLoc to go with them
+            if (NULL != dlOut)
+                return RUNNER_ERROR;
+
+            if (_stash.isEmpty() && !fetch())
+                return _killed ? RUNNER_DEAD : RUNNER_EOF;
+
+            if (objOut)
+                *objOut = _stash;
+            _stash = BSONObj();
+            return RUNNER_ADVANCED;
+        }
+
+        virtual bool isEOF() {
+            return !_killed && _stash.isEmpty() && !fetch();
+        }
+
+        /**
+         * Returns a result that was taken but not used to the front of the stream, so it is the
+         * first one of the next batch.
+         */
+        void pushBack(const BSONObj& obj) {
+            verify(_stash.isEmpty());
+            _stash = obj;
+        }
+
+        // Stages don't hold DiskLocs across batches; DocumentSourceCursor registers its own
+        // runner for invalidations.
+        virtual void invalidate(const DiskLoc& dl) {}
+        virtual void kill() { _killed = true; }
+        virtual void saveState() {}
+        virtual bool restoreState() { return !_killed; }
+        virtual const string& ns() { return _ns; }
+
+        virtual Status getExplainPlan(TypeExplain** explain) const {
+            return Status(ErrorCodes::InternalError, "aggregation cursors are not explainable");
+        }
+
+    private:
+        /**
+         * Pulls the next result from the pipeline into _stash.  Returns false at EOF.
+         */
+        bool fetch() {
+            if (!_pipeline)
+                return false;
+
+            boost::optional<Document> next = _pipeline->output()->getNext();
+            if (!next) {
+                // give back the memory held by the stages now instead of when the cursor dies
+                _pipeline->output()->dispose();
+                _pipeline.reset();
+                return false;
+            }
+
+            _stash = next->toBson();
+            return true;
+        }
+
+        intrusive_ptr<Pipeline> _pipeline;
+        const string _ns;
+        bool _killed;
+        BSONObj _stash;
+    };
+
     static void handleCursorCommand(CursorId id, BSONObj& cmdObj, BSONObjBuilder& result) {
         BSONElement batchSizeElem = cmdObj.getFieldDotted("cursor.batchSize");
         const long long batchSize = batchSizeElem.isNumber()
@@ -87,8 +175,10 @@ namespace mongo {
                 cursor);
 
         // Make sure this cursor won't disappear on us
-        fassert(16959, !cursor->c()->shouldDestroyOnNSDeletion());
-        fassert(16960, !cursor->c()->requiresLock());
+        fassert(16959, cursor->isAggCursor());
+
+        PipelineRunner* runner = static_cast<PipelineRunner*>(cursor->getRunner());
+        fassert(17303, runner);
 
         try {
             const string cursorNs = cursor->ns(); // we need this after cursor may have been deleted
@@ -96,18 +186,28 @@ namespace mongo {
             // can't use result BSONObjBuilder directly since it won't handle exceptions correctly.
             BSONArrayBuilder resultsArray;
             const int byteLimit = MaxBytesToReturnToClientAtOnce;
-            for (int objCount = 0; objCount < batchSize && cursor->ok(); objCount++) {
-                BSONObj current = cursor->current();
-                if (resultsArray.len() + current.objsize() > byteLimit)
-                    break; // too big. current will be the first doc in the second batch
+            BSONObj current;
+            Runner::RunnerState state = Runner::RUNNER_ADVANCED;
+            for (int objCount = 0; objCount < batchSize; objCount++) {
+                state = runner->getNext(&current, NULL);
+                if (state != Runner::RUNNER_ADVANCED)
+                    break;
+
+                if (resultsArray.len() + current.objsize() > byteLimit) {
+                    // too big. current will be the first doc in the second batch
+                    runner->pushBack(current);
+                    break;
+                }
 
                 resultsArray.append(current);
-                cursor->advance();
             }
 
-            // The initial ok() on a cursor may be very expensive so we don't do it when batchSize
-            // is 0 since that indicates a desire for a fast return.
-            if (batchSize != 0 && !cursor->ok()) {
+            uassert(17291, "aggregation cursor was killed, was the collection dropped?",
+                    state != Runner::RUNNER_DEAD);
+
+            // The initial isEOF() on a runner may be very expensive so we don't do it when
+            // batchSize is 0 since that indicates a desire for a fast return.
+            if (batchSize != 0 && (state == Runner::RUNNER_EOF || runner->isEOF())) {
                 // There is no more data. Kill the cursor.
                 pin.release();
                 ClientCursor::erase(id);
@@ -135,73 +235,6 @@ namespace mongo {
         }
     }
 
-
-    class PipelineCursor : public Cursor {
-    public:
-        PipelineCursor(intrusive_ptr<Pipeline> pipeline)
-            : _pipeline(pipeline)
-            , _started(false)
-            , _done(false)
-        {}
-
-        // "core" cursor protocol
-        virtual bool ok() {
-            if (!_started) {
-                _started = true;
-                getNext();
-            }
-            return !_done;
-        }
-        virtual bool advance() {
-            if (!_started) {
-                _started = true;
-                // skip first result
-                getNext();
-            }
-
-            getNext();
-            return !_done;
-        }
-        virtual BSONObj current() {
-            verify(ok());
-            return _currentObj;
-        }
-
-        virtual bool requiresLock() { return false; }
-        virtual bool shouldDestroyOnNSDeletion() { return false; }
-
-        virtual Record* _current() { return NULL; }
-        virtual DiskLoc currLoc() { return DiskLoc(); }
-        virtual DiskLoc refLoc() { return DiskLoc(); }
-        virtual bool supportGetMore() { return true; }
-        virtual bool supportYields() { return false; } // has wrong semantics
-        virtual bool getsetdup(DiskLoc loc) { return false; } // we don't generate dups
-        virtual bool isMultiKey() const { return false; }
-        virtual bool modifiedKeys() const { return false; }
-        virtual string toString() { return "Aggregate_Cursor"; }
-
-        // These probably won't be needed once aggregation supports it's own explain.
-        virtual long long nscanned() { return 0; }
-        virtual void explainDetails( BSONObjBuilder& b ) { return; }
-    private:
-        const DocumentSource* iterator() const { return _pipeline->output(); }
-        DocumentSource* iterator() { return _pipeline->output(); }
-
-        void getNext() {
-            if (boost::optional<Document> result = iterator()->getNext()) {
-                _currentObj = result->toBson();
-            }
-            else {
-                _done = true;
-            }
-        }
-
-        intrusive_ptr<Pipeline> _pipeline;
-        bool _started;
-        bool _done;
-        BSONObj _currentObj;
-    };
-
     class PipelineCommand :
         public Command {
     public:
@@ -271,9 +304,9 @@ namespace mongo {
                 {
                     // Set up cursor
                     Client::ReadContext ctx(ns);
-                    shared_ptr<Cursor> cursor(new PipelineCursor(pPipeline));
-                    // cc will be owned by cursor manager
-                    ClientCursor* cc = new ClientCursor(0, cursor, ns, cmdObj.getOwned());
+                    PipelineRunner* runner = new PipelineRunner(pPipeline, ns);
+                    // cc will be owned by cursor manager, and owns the runner
+                    ClientCursor* cc = new ClientCursor(runner, 0, cmdObj.getOwned(), true);
                     id = cc->cursorid();
                 }
 
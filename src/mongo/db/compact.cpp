@@ -39,16 +39,20 @@
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/background.h"
+#include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/d_concurrency.h"
 #include "mongo/db/curop-inl.h"
 #include "mongo/db/extsort.h"
 #include "mongo/db/storage/index_details.h"
 #include "mongo/db/index_builder.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/storage/record_store.h"
 #include "mongo/db/structure/collection.h"
+#include "mongo/s/d_logic.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/touch_pages.h"
@@ -274,6 +278,9 @@ namespace mongo {
             pm.hit();
         }
 
+        // every record moved, so extent summaries are stale
+        collection->zoneMap()->reset();
+
         if( skipped ) {
             result.append("invalidObjects", skipped);
         }
@@ -296,6 +303,362 @@ namespace mongo {
         return true;
     }
 
+    /**
+     * Compacts a collection while other operations keep running. Records are moved a batch at a
+     * time from the last extent into free space earlier in the collection, taking the database
+     * write lock only for the length of a batch. Once the extent holds no records its free space
+     * is unlinked from the deleted lists, and the extent is unlinked from the collection and
+     * handed back to the database's free extent list.
+     *
+     * Space in the extent being emptied that the allocator hands out during a batch is kept off
+     * the deleted lists (the "quarantine") so moves don't land back in it. The quarantine never
+     * outlives a batch: it is put back on the lists before the batch commits and drops the lock,
+     * so the journal never holds free space that is on no list.
+     */
+    class OnlineCompactor {
+    public:
+        OnlineCompactor( const string& ns, int batchSize, long long maxBytesPerSec )
+            : _ns( ns ),
+              _batchSize( batchSize ),
+              _maxBytesPerSec( maxBytesPerSec ),
+              _recordsMoved( 0 ),
+              _bytesMoved( 0 ),
+              _extentsFreed( 0 ),
+              _batches( 0 ) {
+        }
+
+        /** @return a short reason for stopping */
+        string run() {
+            long long nRecords;
+            {
+                Lock::DBWrite lk( _ns );
+                Client::Context ctx( _ns );
+                NamespaceDetails* d = nsdetails( _ns );
+                massert( 17295, str::stream() << "namespace " << _ns << " does not exist", d );
+                nRecords = d->numRecords();
+            }
+
+            ProgressMeterHolder pm( cc().curop()->setMessage( "compact online",
+                                                              "Online Compaction Progress",
+                                                              nRecords ) );
+            Timer t;
+            Timer sinceLastBatch;
+            string stopReason;
+            while ( stopReason.empty() ) {
+                int moved = 0;
+                bool cursorsOpen = false;
+                {
+                    Lock::DBWrite lk( _ns );
+                    Client::Context ctx( _ns );
+                    try {
+                        stopReason = _runBatch( &moved, &cursorsOpen );
+                    }
+                    catch ( DBException& ) {
+                        _releaseQuarantine();
+                        throw;
+                    }
+                }
+
+                if ( cursorsOpen ) {
+                    killCurrentOp.checkForInterrupt( false );
+                    if ( sinceLastBatch.millis() > MaxCursorWaitMillis )
+                        stopReason = "cursors open on the collection";
+                    else
+                        sleepmillis( 10 );
+                    continue;
+                }
+                sinceLastBatch.reset();
+
+                pm.hit( moved );
+                _batches++;
+
+                killCurrentOp.checkForInterrupt( false );
+
+                if ( _maxBytesPerSec > 0 ) {
+                    // stay within the I/O budget
+                    long long due = _bytesMoved * 1000 * 1000 / _maxBytesPerSec;
+                    long long elapsed = t.micros();
+                    if ( due > elapsed )
+                        sleepmicros( due - elapsed );
+                }
+            }
+
+            pm.finished();
+            return stopReason;
+        }
+
+        void appendStats( BSONObjBuilder* result ) const {
+            result->appendNumber( "recordsMoved", _recordsMoved );
+            result->appendNumber( "bytesMoved", _bytesMoved );
+            result->append( "extentsFreed", _extentsFreed );
+            result->append( "batches", _batches );
+        }
+
+    private:
+        /** how long to wait for the cursors on the collection to go away before giving up */
+        static const int MaxCursorWaitMillis = 60 * 1000;
+
+        /**
+         * caller holds the db write lock. @return non empty if compaction should stop
+         * @param cursorsOpen set, with nothing moved, if the batch has to wait for cursors
+         */
+        string _runBatch( int* moved, bool* cursorsOpen ) {
+            Collection* collection = cc().database()->getCollection( _ns );
+            NamespaceDetails* d = nsdetails( _ns );
+            if ( !collection || !d )
+                return "collection dropped";
+            BackgroundOperation::assertNoBgOpInProgForNs( _ns );
+
+            // A yielded scan keeps its place in the collection or an index.  A record moved to
+            // a spot it has passed would be skipped, and one moved ahead of it would be returned
+            // twice, so records are only moved while no cursor or runner is open on the ns.
+            if ( ClientCursor::hasCursorsOrRunners( _ns ) ) {
+                *cursorsOpen = true;
+                return "";
+            }
+
+            if ( _extent.isNull() ) {
+                string reason = _startExtent( d );
+                if ( !reason.empty() )
+                    return reason;
+            }
+            else if ( !_inCollection( d, _extent ) ) {
+                _extent = DiskLoc();
+                return "collection changed";
+            }
+
+            string reason;
+            Extent* e = _extent.ext();
+            while ( *moved < _batchSize && !e->firstRecord.isNull() ) {
+                if ( !_moveRecord( collection, d, e->firstRecord ) ) {
+                    reason = "out of free space";
+                    break;
+                }
+                ++*moved;
+            }
+
+            if ( reason.empty() && e->firstRecord.isNull() )
+                reason = _finishExtent( collection, d );
+
+            _releaseQuarantine();
+            if ( !reason.empty() )
+                _extent = DiskLoc();
+
+            getDur().commitIfNeeded();
+            return reason;
+        }
+
+        /**
+         * picks the last extent, if what it holds fits in the free space in front of it
+         *
+         * Free space is worked out from the collection's stats and the records in the extent,
+         * rather than by walking the deleted lists.
+         */
+        string _startExtent( NamespaceDetails* d ) {
+            if ( d->lastExtent() == d->firstExtent() )
+                return "done";
+
+            long long storage = 0;
+            for ( DiskLoc L = d->firstExtent(); !L.isNull(); L = L.ext()->xnext )
+                storage += L.ext()->length - Extent::HeaderSize();
+            long long freeTotal = storage - d->dataSize() - d->numRecords() * Record::HeaderSize;
+
+            DiskLoc last = d->lastExtent();
+            Extent* e = last.ext();
+            long long used = 0;
+            ExtentManager& em = cc().database()->getExtentManager();
+            for ( DiskLoc L = e->firstRecord; !L.isNull(); L = em.getNextRecordInExtent( L ) )
+                used += L.rec()->lengthWithHeaders();
+            long long freeHere = e->length - Extent::HeaderSize() - used;
+
+            if ( used > freeTotal - freeHere )
+                return "not enough free space";
+
+            _extent = last;
+            return "";
+        }
+
+        /**
+         * Unlinks the free space of the current extent, which holds no records, from the
+         * deleted lists.  Only the buckets that records of the extent's size can be on are
+         * walked, and the walk stops once all of the extent's space has been found.
+         * @return false, with nothing unlinked beyond the quarantine, if some of it is missing
+         */
+        bool _unlinkFreeSpace( NamespaceDetails* d ) {
+            Extent* e = _extent.ext();
+            const long long expected = e->length - Extent::HeaderSize();
+
+            long long found = 0;
+            for ( size_t i = 0; i < _quarantine.size(); i++ )
+                found += _quarantine[i].drec()->lengthWithHeaders();
+
+            vector<DiskLoc> unlinked;
+            const int maxBucket = NamespaceDetails::bucket( e->length - Extent::HeaderSize() );
+            for ( int b = 0; b <= maxBucket && found < expected; b++ ) {
+                DiskLoc* prev = &d->deletedListEntry( b );
+                DiskLoc cur = *prev;
+                while ( !cur.isNull() && found < expected ) {
+                    DeletedRecord* r = cur.drec();
+                    DiskLoc next = r->nextDeleted();
+                    if ( DiskLoc( cur.a(), r->extentOfs() ) == _extent ) {
+                        *getDur().writing( prev ) = next;
+                        unlinked.push_back( cur );
+                        found += r->lengthWithHeaders();
+                    }
+                    else {
+                        prev = &r->nextDeleted();
+                    }
+                    cur = next;
+                }
+            }
+
+            if ( found != expected ) {
+                warning() << "compact online: found " << found << " of " << expected
+                          << " free bytes of extent " << _extent.toString() << " of " << _ns
+                          << " on the deleted lists" << endl;
+                _quarantine.insert( _quarantine.end(), unlinked.begin(), unlinked.end() );
+                return false;
+            }
+            return true;
+        }
+
+        /** puts quarantined space back on the deleted lists */
+        void _releaseQuarantine() {
+            NamespaceDetails* d = nsdetails( _ns );
+            if ( d && !_extent.isNull() && _inCollection( d, _extent ) ) {
+                for ( size_t i = 0; i < _quarantine.size(); i++ )
+                    d->addDeletedRec( _quarantine[i].drec(), _quarantine[i] );
+            }
+            _quarantine.clear();
+        }
+
+        /**
+         * Adds the keys of a moved record at its new location.  Unique indexes still hold the
+         * keys of the old copy, so duplicates are allowed; all or nothing, like indexRecord().
+         */
+        void _indexMovedRecord( Collection* collection, const BSONObj& obj, const DiskLoc& loc ) {
+            IndexCatalog* catalog = collection->getIndexCatalog();
+            InsertDeleteOptions options;
+            options.logIfError = false;
+            options.dupsAllowed = true;
+
+            int i = 0;
+            try {
+                for ( ; i < catalog->numIndexesTotal(); i++ ) {
+                    IndexAccessMethod* iam = catalog->getIndex( catalog->getDescriptor( i ) );
+                    int64_t inserted;
+                    Status s = iam->insert( obj, loc, options, &inserted );
+                    uassert( s.location(), s.reason(), s.isOK() );
+                }
+            }
+            catch ( DBException& ) {
+                for ( int j = 0; j <= i && j < catalog->numIndexesTotal(); j++ ) {
+                    IndexAccessMethod* iam = catalog->getIndex( catalog->getDescriptor( j ) );
+                    int64_t removed;
+                    iam->remove( obj, loc, options, &removed );
+                }
+                throw;
+            }
+        }
+
+        /** @return false if there is no room for the record outside the current extent */
+        bool _moveRecord( Collection* collection, NamespaceDetails* d, const DiskLoc& oldLoc ) {
+            Record* oldRec = oldLoc.rec();
+            BSONObj obj = BSONObj::make( oldRec ).getOwned();
+
+            const int lenWHdr = d->getRecordAllocationSize( obj.objsize() + Record::HeaderSize );
+            RecordStore* recordStore = collection->getRecordStore();
+            DiskLoc newLoc;
+            while ( 1 ) {
+                newLoc = recordStore->allocRecordFromFreeSpace( lenWHdr );
+                if ( newLoc.isNull() )
+                    return false;
+                if ( DiskLoc( newLoc.a(), newLoc.drec()->extentOfs() ) != _extent )
+                    break;
+                // space in the extent we are emptying, keep it out of use for this batch
+                _quarantine.push_back( newLoc );
+            }
+
+            Record* newRec = newLoc.rec();
+            newRec = reinterpret_cast<Record*>( getDur().writingPtr( newRec, lenWHdr ) );
+            memcpy( newRec->data(), obj.objdata(), obj.objsize() );
+            addRecordToRecListInExtent( newRec, newLoc );
+            d->incrementStats( newRec->netLength(), 1 );
+            collection->zoneMap()->noteWrite( newLoc, obj );
+
+            // index the new copy while the old one is still in place, so a failure leaves the
+            // record where it was
+            try {
+                _indexMovedRecord( collection, obj, newLoc );
+            }
+            catch ( DBException& ) {
+                collection->deleteDocument( newLoc, false, true );
+                throw;
+            }
+
+            // a migration that has yet to clone the record must clone the new copy
+            aboutToMoveForSharding( _ns, cc().database(), oldLoc, newLoc );
+
+            // invalidates cursors, unindexes and frees the old record
+            collection->deleteDocument( oldLoc, false, true );
+
+            _recordsMoved++;
+            _bytesMoved += obj.objsize();
+            return true;
+        }
+
+        /**
+         * the current extent holds no records: unlink it and free it
+         * @return non empty if compaction should stop
+         */
+        string _finishExtent( Collection* collection, NamespaceDetails* d ) {
+            if ( !_unlinkFreeSpace( d ) )
+                return "free space of extent not found";
+
+            Extent* e = _extent.ext();
+            if ( e->xprev.isNull() )
+                d->firstExtent().writing() = e->xnext;
+            else
+                e->xprev.ext()->xnext.writing() = e->xnext;
+            if ( e->xnext.isNull() )
+                d->lastExtent().writing() = e->xprev;
+            else
+                e->xnext.ext()->xprev.writing() = e->xprev;
+
+            getDur().writing( e )->markEmpty();
+            cc().database()->getExtentManager().freeExtents( _extent, _extent );
+            collection->zoneMap()->dropExtent( _extent );
+
+            log() << "compact online freed extent " << _extent.toString() << " of " << _ns
+                  << endl;
+            _extentsFreed++;
+            // its space went with it
+            _quarantine.clear();
+            _extent = DiskLoc();
+            return "";
+        }
+
+        bool _inCollection( NamespaceDetails* d, const DiskLoc& ext ) const {
+            for ( DiskLoc L = d->firstExtent(); !L.isNull(); L = L.ext()->xnext ) {
+                if ( L == ext )
+                    return true;
+            }
+            return false;
+        }
+
+        const string _ns;
+        const int _batchSize;
+        const long long _maxBytesPerSec;
+
+        DiskLoc _extent; // being emptied
+        vector<DiskLoc> _quarantine; // free space in _extent taken off the lists this batch
+
+        long long _recordsMoved;
+        long long _bytesMoved;
+        int _extentsFreed;
+        int _batches;
+    };
+
     bool isCurrentlyAReplSetPrimary();
 
     class CompactCmd : public Command {
@@ -318,7 +681,12 @@ namespace mongo {
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
                 "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
                 "  force - allows to run on a replica set primary\n"
-                "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n";
+                "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n"
+                "{ compact : <collection_name>, online : true, [batchSize:<num>], [maxBytesPerSec:<num>] }\n"
+                "  moves records out of the last extents a batch at a time, yielding the lock in between.\n"
+                "  does not block the server and may be run on a primary\n"
+                "  batchSize - records moved per lock acquisition (default 100)\n"
+                "  maxBytesPerSec - limits the rate documents are rewritten at (default unlimited)\n";
         }
         CompactCmd() : Command("compact") { }
 
@@ -339,7 +707,9 @@ namespace mongo {
                 return false;
             }
 
-            if( isCurrentlyAReplSetPrimary() && !cmdObj["force"].trueValue() ) { 
+            const bool online = cmdObj["online"].trueValue();
+
+            if( !online && isCurrentlyAReplSetPrimary() && !cmdObj["force"].trueValue() ) { 
                 errmsg = "will not run compact on an active replica set primary as this is a slow blocking operation. use force:true to force";
                 return false;
             }
@@ -371,6 +741,10 @@ namespace mongo {
                 }
             }
 
+            if ( online ) {
+                return runOnline( ns, cmdObj, errmsg, result );
+            }
+
 
             double pf = 1.0;
             int pb = 0;
@@ -438,6 +812,47 @@ namespace mongo {
 
             return ok;
         }
+
+    private:
+        bool runOnline( const string& ns, const BSONObj& cmdObj, string& errmsg,
+                        BSONObjBuilder& result ) {
+            if ( cmdObj.hasElement( "paddingFactor" ) || cmdObj.hasElement( "paddingBytes" ) ||
+                 cmdObj.hasElement( "preservePadding" ) ) {
+                errmsg = "online compact keeps the collection's padding; padding options are not supported";
+                return false;
+            }
+
+            int batchSize = 100;
+            if ( cmdObj.hasElement( "batchSize" ) ) {
+                batchSize = cmdObj["batchSize"].numberInt();
+                if ( batchSize < 1 || batchSize > 10000 ) {
+                    errmsg = "batchSize must be between 1 and 10000";
+                    return false;
+                }
+            }
+
+            long long maxBytesPerSec = 0;
+            if ( cmdObj.hasElement( "maxBytesPerSec" ) ) {
+                maxBytesPerSec = cmdObj["maxBytesPerSec"].numberLong();
+                if ( maxBytesPerSec < 0 ) {
+                    errmsg = "maxBytesPerSec can't be negative";
+                    return false;
+                }
+            }
+
+            log() << "compact " << ns << " online begin batchSize:" << batchSize
+                  << " maxBytesPerSec:" << maxBytesPerSec << endl;
+
+            OnlineCompactor compactor( ns, batchSize, maxBytesPerSec );
+            Timer t;
+            string stopReason = compactor.run();
+            compactor.appendStats( &result );
+            result.append( "stopReason", stopReason );
+            result.append( "millis", t.millis() );
+
+            log() << "compact " << ns << " online end: " << stopReason << endl;
+            return true;
+        }
     };
     static CompactCmd compactCmd;
 
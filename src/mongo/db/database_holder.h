@@ -41,9 +41,18 @@ namespace mongo {
     class DatabaseHolder {
         typedef map<string,Database*> DBs;
         typedef map<string,DBs> Paths;
+    public:
+        /** what a database looked like when it was closed */
+        struct ClosedInfo {
+            long long sizeOnDisk;
+            bool empty;
+        };
+    private:
+        typedef map<string,ClosedInfo> ClosedDBs;
         // todo: we want something faster than this if called a lot:
         mutable SimpleMutex _m;
         Paths _paths;
+        map<string,ClosedDBs> _closed; // path -> dbname -> info, for databases not in _paths
         int _size;
     public:
         DatabaseHolder() : _m("dbholder"),_size(0) { }
@@ -90,6 +99,37 @@ namespace mongo {
             _size -= (int)m.erase( _todb( ns ) );
         }
 
+        /**
+         * Remembers the size of a database being closed, so listDatabases can report it without
+         * opening the database or looking at its files.  A closed database can't change, so
+         * this holds until its files are deleted or replaced; see forgetClosed().
+         */
+        void noteClosed( const string& db , const string& path , const ClosedInfo& info ) {
+            SimpleMutex::scoped_lock lk(_m);
+            verify( Lock::isW() );
+            _closed[path][db] = info;
+        }
+
+        /** @return false if nothing is known about closed database 'db' */
+        bool getClosed( const string& db , const string& path , ClosedInfo* info ) const {
+            SimpleMutex::scoped_lock lk(_m);
+            map<string,ClosedDBs>::const_iterator x = _closed.find( path );
+            if ( x == _closed.end() )
+                return false;
+            ClosedDBs::const_iterator it = x->second.find( db );
+            if ( it == x->second.end() )
+                return false;
+            *info = it->second;
+            return true;
+        }
+
+        /** the files of closed database 'db' are being deleted or replaced */
+        void forgetClosed( const string& db , const string& path ) {
+            SimpleMutex::scoped_lock lk(_m);
+            verify( Lock::isW() );
+            _closed[path].erase( db );
+        }
+
         /** @param force - force close even if something underway - use at shutdown */
         bool closeAll( const string& path , BSONObjBuilder& result, bool force );
 
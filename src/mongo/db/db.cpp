@@ -65,9 +65,11 @@
 #include "mongo/db/repl/replication_server_status.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/restapi.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/startup_warnings.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/snapshots.h"
+#include "mongo/db/storage/working_set_snapshot.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/ttl.h"
 #include "mongo/platform/process_id.h"
@@ -77,12 +79,15 @@
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exception_filter_win32.h"
 #include "mongo/util/file_allocator.h"
+#include "mongo/util/mmap.h"
 #include "mongo/util/net/message_server.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/ntservice.h"
 #include "mongo/util/options_parser/startup_options.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
 #include "mongo/util/stacktrace.h"
 #include "mongo/util/startup_test.h"
@@ -354,86 +359,183 @@ namespace mongo {
         }
     }
 
+    namespace {
+
+        /** what a startup worker found when it opened and checked one database */
+        struct StartupDbCheck {
+            StartupDbCheck() : needsUpgrade(false), millis(0), errorCode(0) {}
+            string dbName;
+            bool needsUpgrade;  // for repairDatabasesAndCheckVersion to reopen and deal with
+            int millis;
+            string error;       // set if the check threw
+            int errorCode;
+        };
+
+        void warnOnPre24IndexPlugins( Database* db ) {
+            const string systemIndexes = db->name() + ".system.indexes";
+            auto_ptr<Runner> runner(InternalPlanner::collectionScan(systemIndexes));
+            BSONObj index;
+            Runner::RunnerState state;
+            while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&index, NULL))) {
+                const BSONObj key = index.getObjectField("key");
+                const string plugin = IndexNames::findPluginName(key);
+                if (IndexNames::existedBefore24(plugin))
+                    continue;
+
+                log() << "Index " << index << " claims to be of type '" << plugin << "', "
+                      << "which is either invalid or did not exist before v2.4. "
+                      << "See the upgrade section: "
+                      << "http://dochub.mongodb.org/core/upgrade-2.4"
+                      << startupWarningsLog;
+            }
+
+            if (Runner::RUNNER_EOF != state) {
+                warning() << "Internal error while reading collection " << systemIndexes;
+            }
+        }
+
+        /**
+         * Opens one database under its own db lock and runs the startup checks that don't need
+         * the whole server to themselves, then closes it again so no more databases are open
+         * at a time than there are workers.  Runs on a startup pool thread.
+         */
+        void checkDatabaseAtStartup( StartupDbCheck* check,
+                                     bool shouldClearNonLocalTmpCollections ) {
+            const string origThreadName = getThreadName();
+            Client::initThread("startupDbCheck");
+            Timer t;
+            try {
+                const string& dbName = check->dbName;
+                {
+                    Lock::DBWrite lk( dbName );
+                    Client::Context ctx( dbName );
+                    DataFileHeader *h = ctx.db()->getFile( 0 )->getHeader();
+
+                    if ( replSettings.usingReplSets() ) {
+                        // we only care about the _id index if we are in a replset
+                        checkForIdIndexes(ctx.db());
+                    }
+
+                    if (shouldClearNonLocalTmpCollections || dbName == "local")
+                        ctx.db()->clearTmpCollections();
+
+                    if (!h->isCurrentVersion() || mongodGlobalParams.repair) {
+                        check->needsUpgrade = true;
+                    }
+                    else if (h->versionMinor == PDFILE_VERSION_MINOR_22_AND_OLDER) {
+                        warnOnPre24IndexPlugins(ctx.db());
+                    }
+                }
+
+                // closing needs the global lock, but only briefly.  the upgrade pass opens the
+                // databases that need it again.
+                Lock::GlobalWrite lk;
+                Client::Context ctx( dbName );
+                Database::closeDatabase( dbName, storageGlobalParams.dbpath );
+            }
+            catch ( DBException& e ) {
+                check->error = e.toString();
+                check->errorCode = e.getCode();
+            }
+            catch ( std::exception& e ) {
+                check->error = e.what();
+            }
+            check->millis = t.millis();
+            Client::resetThread( origThreadName );
+        }
+
+    } // namespace
+
+    // number of threads used to open and check databases at startup
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(startupDatabaseOpenThreads, int, 8);
+
+    // number of threads deleting the ranges left behind by chunk migrations
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(rangeDeleterWorkers, int, 2);
+
     // ran at startup.
     static void repairDatabasesAndCheckVersion(bool shouldClearNonLocalTmpCollections) {
         //        LastError * le = lastError.get( true );
         LOG(1) << "enter repairDatabases (to check pdfile version #)" << endl;
 
-        Lock::GlobalWrite lk;
         vector< string > dbNames;
         getDatabaseNames( dbNames );
-        for ( vector< string >::iterator i = dbNames.begin(); i != dbNames.end(); ++i ) {
-            string dbName = *i;
-            LOG(1) << "\t" << dbName << endl;
 
-            Client::Context ctx( dbName );
-            DataFile *p = ctx.db()->getFile( 0 );
-            DataFileHeader *h = p->getHeader();
+        // opening a database maps its files and checking it reads its catalog; with many
+        // databases doing that one at a time dominates startup.  each database only needs its
+        // own lock for this, so fan them out and keep the global lock for the parts that
+        // really need it: upgrading, and closing each database once it has been checked.
+        vector<StartupDbCheck> checks( dbNames.size() );
+        Timer t;
+        {
+            ThreadPool pool( std::max( 1, std::min<int>( startupDatabaseOpenThreads,
+                                                         dbNames.size() ) ) );
+            for ( size_t i = 0; i < dbNames.size(); i++ ) {
+                checks[i].dbName = dbNames[i];
+                pool.schedule( checkDatabaseAtStartup, &checks[i],
+                               shouldClearNonLocalTmpCollections );
+            }
+            pool.join();
+        }
+
+        const StartupDbCheck* slowest = NULL;
+        for ( size_t i = 0; i < checks.size(); i++ ) {
+            if ( !slowest || checks[i].millis > slowest->millis )
+                slowest = &checks[i];
+        }
+        {
+            LogstreamBuilder l = log();
+            l << "opened and checked " << checks.size() << " databases in " << t.millis() << "ms";
+            if ( slowest )
+                l << ", slowest " << slowest->dbName << ' ' << slowest->millis << "ms";
+            l << endl;
+        }
 
-            if ( replSettings.usingReplSets() ) {
-                // we only care about the _id index if we are in a replset
-                checkForIdIndexes(ctx.db());
+        Lock::GlobalWrite lk;
+        for ( size_t i = 0; i < checks.size(); i++ ) {
+            const StartupDbCheck& check = checks[i];
+            const string& dbName = check.dbName;
+            LOG(1) << "\t" << dbName << endl;
+
+            if ( !check.error.empty() ) {
+                uasserted( check.errorCode ? check.errorCode : 17301,
+                           str::stream() << "error opening " << dbName << " at startup: "
+                                         << check.error );
             }
 
-            if (shouldClearNonLocalTmpCollections || dbName == "local")
-                ctx.db()->clearTmpCollections();
+            if ( !check.needsUpgrade )
+                continue;
 
-            if (!h->isCurrentVersion() || mongodGlobalParams.repair) {
+            Client::Context ctx( dbName );
+            DataFileHeader *h = ctx.db()->getFile( 0 )->getHeader();
 
-                if( h->version <= 0 ) {
-                    uasserted(14026,
-                      str::stream() << "db " << dbName << " appears corrupt pdfile version: " << h->version
-                                    << " info: " << h->versionMinor << ' ' << h->fileLength);
-                }
+            if( h->version <= 0 ) {
+                uasserted(14026,
+                  str::stream() << "db " << dbName << " appears corrupt pdfile version: " << h->version
+                                << " info: " << h->versionMinor << ' ' << h->fileLength);
+            }
 
-                if ( !h->isCurrentVersion() ) {
-                    log() << "****" << endl;
-                    log() << "****" << endl;
-                    log() << "need to upgrade database " << dbName << " "
-                          << "with pdfile version " << h->version << "." << h->versionMinor << ", "
-                          << "new version: "
-                          << PDFILE_VERSION << "." << PDFILE_VERSION_MINOR_22_AND_OLDER
-                          << endl;
-                }
+            if ( !h->isCurrentVersion() ) {
+                log() << "****" << endl;
+                log() << "****" << endl;
+                log() << "need to upgrade database " << dbName << " "
+                      << "with pdfile version " << h->version << "." << h->versionMinor << ", "
+                      << "new version: "
+                      << PDFILE_VERSION << "." << PDFILE_VERSION_MINOR_22_AND_OLDER
+                      << endl;
+            }
 
-                if (mongodGlobalParams.upgrade) {
-                    // QUESTION: Repair even if file format is higher version than code?
-                    string errmsg;
-                    verify( doDBUpgrade( dbName , errmsg , h ) );
-                }
-                else {
-                    log() << "\t Not upgrading, exiting" << endl;
-                    log() << "\t run --upgrade to upgrade dbs, then start again" << endl;
-                    log() << "****" << endl;
-                    dbexit( EXIT_NEED_UPGRADE );
-                    mongodGlobalParams.upgrade = 1;
-                    return;
-                }
+            if (mongodGlobalParams.upgrade) {
+                // QUESTION: Repair even if file format is higher version than code?
+                string errmsg;
+                verify( doDBUpgrade( dbName , errmsg , h ) );
             }
             else {
-                if (h->versionMinor == PDFILE_VERSION_MINOR_22_AND_OLDER) {
-                    const string systemIndexes = cc().database()->name() + ".system.indexes";
-                    auto_ptr<Runner> runner(InternalPlanner::collectionScan(systemIndexes));
-                    BSONObj index;
-                    Runner::RunnerState state;
-                    while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&index, NULL))) {
-                        const BSONObj key = index.getObjectField("key");
-                        const string plugin = IndexNames::findPluginName(key);
-                        if (IndexNames::existedBefore24(plugin))
-                            continue;
-
-                        log() << "Index " << index << " claims to be of type '" << plugin << "', "
-                              << "which is either invalid or did not exist before v2.4. "
-                              << "See the upgrade section: "
-                              << "http://dochub.mongodb.org/core/upgrade-2.4"
-                              << startupWarningsLog;
-                    }
-
-                    if (Runner::RUNNER_EOF != state) {
-                        warning() << "Internal error while reading collection " << systemIndexes;
-                    }
-                }
-                Database::closeDatabase(dbName.c_str(), storageGlobalParams.dbpath);
+                log() << "\t Not upgrading, exiting" << endl;
+                log() << "\t run --upgrade to upgrade dbs, then start again" << endl;
+                log() << "****" << endl;
+                dbexit( EXIT_NEED_UPGRADE );
+                mongodGlobalParams.upgrade = 1;
+                return;
             }
         }
 
@@ -570,6 +672,24 @@ namespace mongo {
 
             }
         } memJournalServerStatusMetric;
+
+        class HugePagesServerStatusSection : public ServerStatusSection {
+        public:
+            HugePagesServerStatusSection() : ServerStatusSection( "hugePages" ) {}
+            virtual bool includeByDefault() const { return g_mmapHugePages; }
+
+            BSONObj generateSection( const BSONElement& configElement ) const {
+                BSONObjBuilder b;
+                b.append( "enabled", g_mmapHugePages );
+                b.appendNumber( "viewsAdvised",
+                                static_cast<long long>( g_mmapHugePageViews.get() ) );
+                b.appendNumber( "adviceFailures",
+                                static_cast<long long>( g_mmapHugePageFailures.get() ) );
+                ProcessInfo p;
+                p.getHugePageInfo( b );
+                return b.obj();
+            }
+        } hugePagesServerStatusSection;
     }
 
 
@@ -684,7 +804,10 @@ namespace mongo {
 
         MONGO_ASSERT_ON_EXCEPTION_WITH_MSG( clearTmpFiles(), "clear tmp files" );
 
+        // where startup time goes, logged once we're ready to listen
+        Timer startupTimer;
         dur::startup();
+        const int journalMillis = startupTimer.millis();
 
         if (storageGlobalParams.durOptions & StorageGlobalParams::DurRecoverOnly)
             return;
@@ -713,17 +836,22 @@ namespace mongo {
         const bool shouldClearNonLocalTmpCollections = !(missingRepl
                                                          || replSettings.usingReplSets()
                                                          || replSettings.slave == SimpleSlave);
+        startupTimer.reset();
         repairDatabasesAndCheckVersion(shouldClearNonLocalTmpCollections);
+        const int databasesMillis = startupTimer.millis();
 
         if (mongodGlobalParams.upgrade)
             return;
 
+        startupTimer.reset();
         uassertStatusOK(getGlobalAuthorizationManager()->initialize());
+        const int authMillis = startupTimer.millis();
 
         /* this is for security on certain platforms (nonce generation) */
         srand((unsigned) (curTimeMicros() ^ startupSrandTimer.micros()));
 
         snapshotThread.go();
+        startWorkingSetSnapshots();
         d.clientCursorMonitor.go();
         PeriodicTask::startRunningPeriodicTasks();
         if (missingRepl) {
@@ -743,11 +871,15 @@ namespace mongo {
             Client::WriteContext c("admin", storageGlobalParams.dbpath);
         }
 
-        getDeleter()->startWorkers();
+        getDeleter()->startWorkers(rangeDeleterWorkers);
 
         // Starts a background thread that rebuilds all incomplete indices. 
         indexRebuilder.go(); 
 
+        log() << "startup took " << journalMillis << "ms journal recovery, "
+              << databasesMillis << "ms opening and checking databases, "
+              << authMillis << "ms auth initialization" << endl;
+
         listen(listenPort);
 
         // listen() will return when exit code closes its socket.
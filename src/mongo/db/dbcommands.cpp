@@ -35,6 +35,7 @@
 
 #include "mongo/pch.h"
 
+#include <boost/filesystem/operations.hpp>
 #include <time.h>
 
 #include "mongo/base/init.h"
@@ -68,6 +69,7 @@
 #include "mongo/db/query_optimizer.h"
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/storage/compression_estimate.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/s/d_logic.h"
 #include "mongo/s/d_writeback.h"
@@ -693,14 +695,38 @@ namespace mongo {
                 BSONObjBuilder b;
                 b.append( "name", *i );
 
-                boost::intmax_t size = dbSize( i->c_str() );
-                b.append( "sizeOnDisk", (double) size );
-                totalSize += size;
-                
+                // don't open databases just to list them: with thousands of databases that
+                // means mapping thousands of files.  an open database knows its file sizes, and
+                // the holder remembers them for databases closed since startup; otherwise look
+                // at the files.  a database is empty exactly when it has no .ns file (see
+                // Database::isEmpty), so check for one under the db lock, as a drop may have
+                // removed it since getDatabaseNames() ran.
+                boost::intmax_t size;
+                bool empty;
                 {
-                    Client::ReadContext rc( *i + ".system.namespaces" );
-                    b.appendBool( "empty", rc.ctx().db()->isEmpty() );
+                    Lock::DBRead lk( *i );
+                    Database* db = dbHolder().get( *i, storageGlobalParams.dbpath );
+                    DatabaseHolder::ClosedInfo closed;
+                    if ( db ) {
+                        size = db->namespaceIndex().fileLength() + db->fileSize();
+                        empty = db->isEmpty();
+                    }
+                    else if ( dbHolder().getClosed( *i, storageGlobalParams.dbpath, &closed ) ) {
+                        size = closed.sizeOnDisk;
+                        empty = closed.empty;
+                    }
+                    else {
+                        size = dbSize( i->c_str() );
+                        boost::filesystem::path nsPath( storageGlobalParams.dbpath );
+                        if ( storageGlobalParams.directoryperdb )
+                            nsPath /= *i;
+                        nsPath /= ( *i + ".ns" );
+                        empty = !boost::filesystem::exists( nsPath );
+                    }
                 }
+                b.append( "sizeOnDisk", (double) size );
+                totalSize += size;
+                b.appendBool( "empty", empty );
                 
                 dbInfos.push_back( b.obj() );
 
@@ -1086,6 +1112,8 @@ namespace mongo {
         virtual LockType locktype() const { return READ; }
         virtual void help( stringstream &help ) const {
             help << "{ collStats:\"blog.posts\" , scale : 1 } scale divides sizes e.g. for KB use 1024\n"
+                    "    freeList : true reports deleted record space by bucket and its fragmentation\n"
+                    "    compressionSample : <n> estimates snappy block compression over the first n records\n"
                     "    avgObjSize - in bytes";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -1153,6 +1181,23 @@ namespace mongo {
             if ( verbose )
                 result.appendArray( "extents" , extents.arr() );
 
+            collection->getRecordStore()->appendAllocationStats( &result );
+            if ( jsobj["freeList"].trueValue() )
+                collection->getRecordStore()->appendFreeListStats( &result, scale );
+
+            BSONElement sample = jsobj["compressionSample"];
+            if ( sample.trueValue() ) {
+                // sampled under the read lock without yielding, so keep it small
+                long long maxRecords = sample.isNumber() ? sample.numberLong() : 1000;
+                uassert( 17293, str::stream() << "compressionSample must be between 1 and "
+                                              << CompressionEstimate::MaxSampleRecords,
+                         maxRecords > 0 && maxRecords <= CompressionEstimate::MaxSampleRecords );
+                CompressionEstimate::sample( collection,
+                                             maxRecords,
+                                             CompressionEstimate::DefaultBlockSize )
+                    .appendTo( &result, scale );
+            }
+
             return true;
         }
     } cmdCollectionStats;
@@ -1167,6 +1212,7 @@ namespace mongo {
             help << 
                 "Sets collection options.\n"
                 "Example: { collMod: 'foo', usePowerOf2Sizes:true }\n"
+                "Example: { collMod: 'foo', zoneMapFields: ['ts'] }\n"
                 "Example: { collMod: 'foo', index: {keyPattern: {a: 1}, expireAfterSeconds: 600} }";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -1259,6 +1305,24 @@ namespace mongo {
                         result.appendAs( newExpireSecs , "expireAfterSeconds_new" );
                     }
                 }
+                else if ( str::equals( "zoneMapFields", e.fieldName() ) ) {
+                    Status status = ZoneMap::validateFields( e );
+                    if ( status.isOK() && nsd->isCapped() ) {
+                        status = Status( ErrorCodes::BadValue,
+                                         "zoneMapFields is not supported on capped collections" );
+                    }
+                    if ( status.isOK() ) {
+                        Collection* collection = ctx.db()->getCollection( ns );
+                        result.append( "zoneMapFields_old", collection->zoneMap()->fields() );
+                        status = collection->zoneMap()->setFields( e );
+                    }
+                    if ( !status.isOK() ) {
+                        errmsg = status.reason();
+                        ok = false;
+                        continue;
+                    }
+                    result.appendAs( e, "zoneMapFields_new" );
+                }
                 else {
                     errmsg = str::stream() << "unknown option to collMod: " << e.fieldName();
                     ok = false;
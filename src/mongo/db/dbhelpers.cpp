@@ -39,6 +39,7 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/db.h"
 #include "mongo/db/json.h"
+#include "mongo/db/kill_current_op.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/ops/update.h"
 #include "mongo/db/ops/update_lifecycle_impl.h"
@@ -52,6 +53,8 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/extent_manager.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/s/d_logic.h"
@@ -60,6 +63,9 @@ namespace mongo {
 
     const BSONObj reverseNaturalObj = BSON( "$natural" << -1 );
 
+    // Number of documents removeRange deletes per write lock acquisition.
+    MONGO_EXPORT_SERVER_PARAMETER(removeRangeBatchSize, int, 128);
+
     void Helpers::ensureIndex(const char *ns, BSONObj keyPattern, bool unique, const char *name) {
         Database* db = cc().database();
         verify(db);
@@ -302,7 +308,8 @@ namespace mongo {
                                     bool secondaryThrottle,
                                     RemoveSaver* callback,
                                     bool fromMigrate,
-                                    bool onlyRemoveOrphanedDocs )
+                                    bool onlyRemoveOrphanedDocs,
+                                    RemoveRangePacer* pacer )
     {
         Timer rangeRemoveTimer;
         const string& ns = range.ns;
@@ -341,86 +348,144 @@ namespace mongo {
         
         long long millisWaitingForReplication = 0;
 
+        const int batchSize = std::max( 1, static_cast<int>( removeRangeBatchSize ) );
+
         while ( 1 ) {
-            // Scoping for write lock.
-            {
-                Client::WriteContext ctx(ns);
-                Collection* collection = ctx.ctx().db()->getCollection( ns );
-                if ( !collection ) break;
-
-                IndexDescriptor* desc =
-                    collection->getIndexCatalog()->findIndexByKeyPattern( indexKeyPattern.toBSON() );
-
-                auto_ptr<Runner> runner(InternalPlanner::indexScan(desc, min, max,
-                                                                   maxInclusive,
-                                                                   InternalPlanner::FORWARD,
-                                                                   InternalPlanner::IXSCAN_FETCH));
-
-                runner->setYieldPolicy(Runner::YIELD_AUTO);
-
-                DiskLoc rloc;
-                BSONObj obj;
-                Runner::RunnerState state;
-                // This may yield so we cannot touch nsd after this.
-                state = runner->getNext(&obj, &rloc);
-                runner.reset();
-                if (Runner::RUNNER_EOF == state) { break; }
-
-                if ( onlyRemoveOrphanedDocs ) {
-                    // Do a final check in the write lock to make absolutely sure that our
-                    // collection hasn't been modified in a way that invalidates our migration
-                    // cleanup.
-
-                    // We should never be able to turn off the sharding state once enabled, but
-                    // in the future we might want to.
-                    verify(shardingState.enabled());
+            long long numDeletedInBatch = 0;
+            bool done = false;
 
-                    // In write lock, so will be the most up-to-date version
-                    CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
-
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        KeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractSingleKey( obj );
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
+            // Scoping for write lock.
+            PageFaultRetryableSection pgrs;
+            while ( 1 ) {
+                try {
+                    done = false;
+
+                    Client::WriteContext ctx(ns);
+                    Collection* collection = ctx.ctx().db()->getCollection( ns );
+                    if ( !collection ) {
+                        done = true;
+                        break;
                     }
-                    else {
-                        docIsOrphan = false;
+
+                    IndexDescriptor* desc = collection->getIndexCatalog()->findIndexByKeyPattern(
+                            indexKeyPattern.toBSON() );
+
+                    // Collect the next batch in index order, then delete it once the scan is done
+                    // so that the deletes can't invalidate the runner. The lock is held for the
+                    // whole batch, so there is no yielding in between; a page fault instead
+                    // releases it, touches the page and rescans, which only finds what is left.
+                    // The index may be multikey, so a document can turn up more than once.
+                    vector<DiskLoc> batch;
+                    set<DiskLoc> inBatch;
+                    {
+                        auto_ptr<Runner> runner(InternalPlanner::indexScan(desc, min, max,
+                                                                           maxInclusive,
+                                                                           InternalPlanner::FORWARD));
+                        DiskLoc rloc;
+                        while ( static_cast<int>( batch.size() ) < batchSize ) {
+                            Runner::RunnerState state = runner->getNext(NULL, &rloc);
+                            if ( Runner::RUNNER_ADVANCED != state ) {
+                                done = true;
+                                break;
+                            }
+                            if ( inBatch.insert( rloc ).second )
+                                batch.push_back( rloc );
+                        }
                     }
 
-                    if ( !docIsOrphan ) {
-                        warning() << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
+                    // In write lock, so will be the most up-to-date version
+                    CollectionMetadataPtr metadataNow;
+                    if ( onlyRemoveOrphanedDocs ) {
+                        // We should never be able to turn off the sharding state once enabled, but
+                        // in the future we might want to.
+                        verify(shardingState.enabled());
+                        metadataNow = shardingState.getCollectionMetadata( ns );
                     }
-                }
 
-                if ( callback )
-                    callback->goingToDelete( obj );
+                    for ( vector<DiskLoc>::const_iterator it = batch.begin();
+                          it != batch.end(); ++it ) {
+                        BSONObj obj = collection->docFor( *it );
+
+                        if ( onlyRemoveOrphanedDocs ) {
+                            // Do a final check in the write lock to make absolutely sure that our
+                            // collection hasn't been modified in a way that invalidates our
+                            // migration cleanup.
+                            bool docIsOrphan;
+                            if ( metadataNow ) {
+                                KeyPattern kp( metadataNow->getKeyPattern() );
+                                BSONObj key = kp.extractSingleKey( obj );
+                                docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                    && !metadataNow->keyIsPending( key );
+                            }
+                            else {
+                                docIsOrphan = false;
+                            }
+
+                            if ( !docIsOrphan ) {
+                                warning() << "aborting migration cleanup for chunk " << min << " to " << max
+                                          << ( metadataNow ? (string) " at document " + obj.toString() : "" )
+                                          << ", collection " << ns << " has changed " << endl;
+                                done = true;
+                                break;
+                            }
+                        }
+
+                        // Deleting unlinks the record from its neighbours in the extent, so
+                        // fault those in too while a page fault still just retries the batch.
+                        // Once the document is saved and logged nothing may throw a
+                        // PageFaultException, or the retry would save and log it a second time.
+                        const ExtentManager& em = ctx.ctx().db()->getExtentManager();
+                        DiskLoc prev = em.getPrevRecordInExtent( *it );
+                        if ( !prev.isNull() )
+                            em.recordFor( prev )->nextOfs();
+                        DiskLoc next = em.getNextRecordInExtent( *it );
+                        if ( !next.isNull() )
+                            em.recordFor( next )->prevOfs();
+
+                        NoPageFaultsAllowed npfa;
+
+                        if ( callback )
+                            callback->goingToDelete( obj );
+
+                        logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
+                        collection->deleteDocument( *it );
+                        numDeletedInBatch++;
+                    }
 
-                logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
-                c.database()->getCollection( ns )->deleteDocument( rloc );
-                numDeleted++;
+                    break;
+                }
+                catch ( PageFaultException& e ) {
+                    e.touch();
+                }
             }
 
-            Timer secondaryThrottleTime;
+            numDeleted += numDeletedInBatch;
+
+            if ( numDeletedInBatch > 0 || !done ) {
+                Timer secondaryThrottleTime;
 
-            if ( secondaryThrottle && numDeleted > 0 ) {
-                if ( ! waitForReplication( c.getLastOp(), 2, 60 /* seconds to wait */ ) ) {
-                    warning() << "replication to secondaries for removeRange at least 60 seconds behind" << endl;
+                if ( secondaryThrottle && numDeletedInBatch > 0 ) {
+                    if ( ! waitForReplication( c.getLastOp(), 2, 60 /* seconds to wait */ ) ) {
+                        warning() << "replication to secondaries for removeRange at least 60 seconds behind" << endl;
+                    }
+                    millisWaitingForReplication += secondaryThrottleTime.millis();
                 }
-                millisWaitingForReplication += secondaryThrottleTime.millis();
-            }
-            
-            if ( ! Lock::isLocked() ) {
-                int micros = ( 2 * Client::recommendedYieldMicros() ) - secondaryThrottleTime.micros();
-                if ( micros > 0 ) {
-                    LOG(1) << "Helpers::removeRangeUnlocked going to sleep for " << micros << " micros" << endl;
-                    sleepmicros( micros );
+
+                if ( pacer )
+                    pacer->batchRemoved( numDeletedInBatch );
+
+                if ( ! Lock::isLocked() ) {
+                    int micros = ( 2 * Client::recommendedYieldMicros() ) - secondaryThrottleTime.micros();
+                    if ( micros > 0 ) {
+                        LOG(1) << "Helpers::removeRangeUnlocked going to sleep for " << micros << " micros" << endl;
+                        sleepmicros( micros );
+                    }
                 }
             }
+
+            if ( done ) break;
+
+            killCurrentOp.checkForInterrupt();
         }
         
         if ( secondaryThrottle )
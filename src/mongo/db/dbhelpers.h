@@ -52,6 +52,7 @@ namespace mongo {
     struct Helpers {
 
         class RemoveSaver;
+        class RemoveRangePacer;
 
         /* ensure the specified index exists.
 
@@ -142,6 +143,11 @@ namespace mongo {
          * keyPattern={a:1,b:1} since it can be extended to {a:100,b:minKey}, but
          * min={b:100} is not compatible).
          *
+         * Documents are removed in index order, in batches of at most removeRangeBatchSize
+         * documents per write lock acquisition. The lock is released between batches and on a
+         * page fault, and the pacer (if any) is told about every batch once the lock has been
+         * released.
+         *
          * Caller must hold a write lock on 'ns'
          *
          * Returns -1 when no usable index exists
@@ -154,7 +160,8 @@ namespace mongo {
                                       bool secondaryThrottle = false,
                                       RemoveSaver* callback = NULL,
                                       bool fromMigrate = false,
-                                      bool onlyRemoveOrphanedDocs = false );
+                                      bool onlyRemoveOrphanedDocs = false,
+                                      RemoveRangePacer* pacer = NULL );
 
 
         // TODO: This will supersede Chunk::MaxObjectsPerChunk
@@ -205,6 +212,17 @@ namespace mongo {
             ofstream* _out;
         };
 
+        /**
+         * Lets the caller of removeRange throttle it. batchRemoved is called after each batch,
+         * outside of the write lock taken for that batch, and may block to slow the removal
+         * down.
+         */
+        class RemoveRangePacer {
+        public:
+            virtual ~RemoveRangePacer() {}
+            virtual void batchRemoved( long long numDeleted ) = 0;
+        };
+
     };
 
 } // namespace mongo
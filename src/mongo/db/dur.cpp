@@ -46,7 +46,8 @@
          remapping. with many files (e.g., 1000), remapping could be time consuming (several ms), so we don't want
          to be too frequent.
        there could be a slow down immediately after remapping as fresh copy-on-writes for commonly written pages will
-         be required.  so doing these remaps fractionally is helpful. 
+         be required.  so doing these remaps fractionally is helpful.  we remap only the slices of the views
+         that were written, dirtiest first, with at most journalRemapMaxMBPerPass per pass.
 
    mutexes:
 
@@ -79,6 +80,7 @@
 #include "mongo/db/dur_journal.h"
 #include "mongo/db/dur_recover.h"
 #include "mongo/db/dur_stats.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/server.h"
 #include "mongo/util/concurrency/race.h"
@@ -151,6 +153,7 @@ namespace mongo {
             b << 
                        "commits" << _commits <<
                        "journaledMB" << _journaledBytes / 1000000.0 <<
+                       "journaledMBSaved" << _journaledBytesSaved / 1000000.0 <<
                        "writeToDataFilesMB" << _writeToDataFilesBytes / 1000000.0 <<
                        "compression" << _journaledBytes / (_uncompressedBytes+1.0) <<
                        "commitsInWriteLock" << _commitsInWriteLock <<
@@ -161,7 +164,8 @@ namespace mongo {
                              "writeToJournal" << (unsigned) (_writeToJournalMicros/1000) <<
                              "writeToDataFiles" << (unsigned) (_writeToDataFilesMicros/1000) <<
                              "remapPrivateView" << (unsigned) (_remapPrivateViewMicros/1000)
-                           );
+                           ) <<
+                       "remapPrivateViewMB" << _remapPrivateViewBytes / 1000000.0;
             if (storageGlobalParams.journalCommitInterval != 0)
                 b << "journalCommitIntervalMs" << storageGlobalParams.journalCommitInterval;
             return b.obj();
@@ -460,11 +464,36 @@ namespace mongo {
 
         extern size_t privateMapBytes;
 
+        /** upper bound on how much of the private views one REMAPPRIVATEVIEW pass remaps.  passes run
+            in the write lock, so this bounds the stall writers see; whatever is left over is remapped
+            over the next commits.  0 means no cap.
+        */
+        MONGO_EXPORT_SERVER_PARAMETER(journalRemapMaxMBPerPass, int, 64);
+
+        /** we want every written slice of the private views remapped within about this long */
+        static const unsigned long long RemapIntervalMicros = 2000000;
+
+        /** a dirty slice of a private view, as seen by one REMAPPRIVATEVIEW pass */
+        struct RemapSlice {
+            DurableMappedFile *mmf;
+            unsigned slice;
+            unsigned long long bytes;
+            bool overdue; // dirty for longer than RemapIntervalMicros
+        };
+
+        /** order for remapping: overdue slices first, so none is put off forever, then the dirtiest */
+        struct RemapOrder {
+            bool operator()(const RemapSlice& a, const RemapSlice& b) const {
+                if( a.overdue != b.overdue )
+                    return a.overdue;
+                return a.bytes > b.bytes;
+            }
+        };
+
         static void _REMAPPRIVATEVIEW() {
             // todo: Consider using ProcessInfo herein and watching for getResidentSize to drop.  that could be a way 
             //       to assure very good behavior here.
 
-            static unsigned startAt;
             static unsigned long long lastRemap;
 
             LOG(4) << "journal REMAPPRIVATEVIEW" << endl;
@@ -472,13 +501,14 @@ namespace mongo {
             verify( Lock::isW() );
             verify( !commitJob.hasWritten() );
 
-            // we want to remap all private views about every 2 seconds.  there could be ~1000 views so
-            // we do a little each pass; beyond the remap time, more significantly, there will be copy on write
-            // faults after remapping, so doing a little bit at a time will avoid big load spikes on
-            // remapping.
+            // we want to remap all written private views about every 2 seconds.  we do a little each
+            // pass, in slices, rather than whole files; beyond the remap time, more significantly,
+            // there will be copy on write faults after remapping, so doing a little bit at a time
+            // will avoid big load spikes on remapping.
             unsigned long long now = curTimeMicros64();
-            double fraction = (now-lastRemap)/2000000.0;
-            if (storageGlobalParams.durOptions & StorageGlobalParams::DurAlwaysRemap)
+            double fraction = (now-lastRemap)/(double)RemapIntervalMicros;
+            const bool alwaysRemap = storageGlobalParams.durOptions & StorageGlobalParams::DurAlwaysRemap;
+            if (alwaysRemap)
                 fraction = 1;
             lastRemap = now;
 
@@ -495,50 +525,61 @@ namespace mongo {
             LockMongoFilesShared lk;
 #endif
             set<MongoFile*>& files = MongoFile::getAllFiles();
-            unsigned sz = files.size();
-            if( sz == 0 )
+
+            // only the slices of the private views that have been written need remapping
+            vector<RemapSlice> slices;
+            for( set<MongoFile*>::iterator i = files.begin(); i != files.end(); i++ ) {
+                if( !(*i)->isDurableMappedFile() )
+                    continue;
+                DurableMappedFile *mmf = (DurableMappedFile*) *i;
+                DurableMappedFile::DirtySlices& dirty = mmf->dirtySlices();
+                for( DurableMappedFile::DirtySlices::iterator j = dirty.begin(); j != dirty.end(); j++ ) {
+                    if( j->second.since == 0 )
+                        j->second.since = now;
+                    RemapSlice s = { mmf, j->first, j->second.bytes,
+                                     now - j->second.since >= RemapIntervalMicros };
+                    slices.push_back(s);
+                }
+            }
+            if( slices.empty() )
                 return;
 
+            bool memoryPressure = false;
             {
                 // be careful not to use too much memory if the write rate is 
                 // extremely high
                 double f = privateMapBytes / ((double)UncommittedBytesLimit);
                 if( f > fraction ) { 
                     fraction = f;
+                    memoryPressure = true;
                 }
                 privateMapBytes = 0;
             }
+            if( fraction > 1 )
+                fraction = 1;
 
-            unsigned ntodo = (unsigned) (sz * fraction);
-            if( ntodo < 1 ) ntodo = 1;
-            if( ntodo > sz ) ntodo = sz;
+            unsigned long long budget =
+                (unsigned long long) (slices.size() * DurableMappedFile::RemapSliceBytes * fraction);
+            // the cap keeps routine passes short.  when the private views are using too much
+            // memory, remapping has to catch up, so it doesn't apply then.
+            const unsigned long long cap = journalRemapMaxMBPerPass * 1024ULL * 1024;
+            if( !alwaysRemap && !memoryPressure && journalRemapMaxMBPerPass > 0 && budget > cap )
+                budget = cap;
 
-            const set<MongoFile*>::iterator b = files.begin();
-            const set<MongoFile*>::iterator e = files.end();
-            set<MongoFile*>::iterator i = b;
-            // skip to our starting position
-            for( unsigned x = 0; x < startAt; x++ ) {
-                i++;
-                if( i == e ) i = b;
-            }
-            unsigned startedAt = startAt;
-            startAt = (startAt + ntodo) % sz; // mark where to start next time
+            std::sort(slices.begin(), slices.end(), RemapOrder());
 
             Timer t;
-            for( unsigned x = 0; x < ntodo; x++ ) {
-                dassert( i != e );
-                if( (*i)->isDurableMappedFile() ) {
-                    DurableMappedFile *mmf = (DurableMappedFile*) *i;
-                    verify(mmf);
-                    if( mmf->willNeedRemap() ) {
-                        mmf->willNeedRemap() = false;
-                        mmf->remapThePrivateView();
-                    }
-                    i++;
-                    if( i == e ) i = b;
-                }
-            }
-            LOG(2) << "journal REMAPPRIVATEVIEW done startedAt: " << startedAt << " n:" << ntodo << ' ' << t.millis() << "ms" << endl;
+            unsigned long long done = 0;
+            unsigned n = 0;
+            // always make some progress
+            for( ; n < slices.size() && (n == 0 || done < budget); n++ ) {
+                DurableMappedFile *mmf = slices[n].mmf;
+                if( mmf->dirtySlices().count(slices[n].slice) ) // windows remaps whole views
+                    done += mmf->remapThePrivateViewSlice(slices[n].slice);
+            }
+            stats.curr->_remapPrivateViewBytes += done;
+            LOG(2) << "journal REMAPPRIVATEVIEW done slices: " << n << '/' << slices.size()
+                   << ' ' << done / (1024 * 1024) << "MB " << t.millis() << "ms" << endl;
         }
 
         /** We need to remap the private views periodically. otherwise they would become very large.
@@ -47,6 +47,9 @@ namespace mongo {
         // a smaller limit is likely better on 32 bit
         const unsigned UncommittedBytesLimit = (sizeof(void*)==4) ? 50 * 1024 * 1024 : 100 * 1024 * 1024;
 
+        /** server parameter: most MB of private views one remap pass covers. 0 means no cap */
+        extern int journalRemapMaxMBPerPass;
+
         /** Call during startup so durability module can initialize
             Throws if fatal error
             Does nothing if storageGlobalParams.dur is false
@@ -155,12 +155,43 @@ namespace mongo {
             dassert(contains(other));
         }
 
+        static bool startsBefore(const WriteIntent& a, const WriteIntent& b) {
+            return a.start() < b.start();
+        }
+
+        void IntentsAndDurOps::coalesce() {
+            if( _intents.size() < 2 )
+                return;
+            std::sort(_intents.begin(), _intents.end(), startsBefore);
+
+            vector<WriteIntent>::iterator last = _intents.begin();
+            for( vector<WriteIntent>::iterator i = last + 1; i != _intents.end(); ++i ) {
+                if( i->start() <= last->end() ) {
+                    // overlaps or abuts
+                    last->absorb(*i);
+                }
+                else {
+                    *++last = *i;
+                }
+            }
+            _intents.erase(last + 1, _intents.end());
+        }
+
+        unsigned long long IntentsAndDurOps::intentBytes() const {
+            unsigned long long n = 0;
+            for( vector<WriteIntent>::const_iterator i = _intents.begin(); i != _intents.end(); ++i )
+                n += i->length();
+            return n;
+        }
+
         void IntentsAndDurOps::clear() {
             assertLockedForCommitting();
             commitJob.groupCommitMutex.dassertLocked();
             _alreadyNoted.clear();
             _intents.clear();
             _durOps.clear();
+            _declaredBytes = 0;
+            _coalesceAt = CoalesceMin;
 #if defined(DEBUG_WRITE_INTENT)
             cout << "_debug clear\n";
             _debug.clear();
@@ -212,11 +243,22 @@ namespace mongo {
             _nSinceCommitIfNeededCall = 0;
         }
 
+        const vector<WriteIntent>& CommitJob::getIntentsCoalesced() {
+            groupCommitMutex.dassertLocked();
+            _intentsAndDurOps.coalesce();
+            unsigned long long journaled = _intentsAndDurOps.intentBytes();
+            if( _intentsAndDurOps._declaredBytes > journaled )
+                stats.curr->_journaledBytesSaved += _intentsAndDurOps._declaredBytes - journaled;
+            return _intentsAndDurOps._intents;
+        }
+
         void CommitJob::note(void* p, int len) {
             groupCommitMutex.dassertLocked();
 
             dassert( _hasWritten );
 
+            _intentsAndDurOps._declaredBytes += len;
+
             // from the point of view of the dur module, it would be fine (i think) to only
             // be read locked here.  but must be at least read locked to avoid race with
             // remapprivateview
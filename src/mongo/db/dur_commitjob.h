@@ -100,20 +100,42 @@ namespace mongo {
         /** our record of pending/uncommitted write intents */
         class IntentsAndDurOps : boost::noncopyable {
         public:
+            IntentsAndDurOps() : _declaredBytes(0), _coalesceAt(CoalesceMin) { }
+
             vector<WriteIntent> _intents;
             Already<127> _alreadyNoted;
             vector< shared_ptr<DurOp> > _durOps; // all the ops other than basic writes
+            unsigned long long _declaredBytes;   // sum of all declared lengths, including repeats
 
             /** reset the IntentsAndDurOps structure (empties all the above) */
             void clear();
 
             void insertWriteIntent(void* p, int len) {
                 _intents.push_back(WriteIntent(p,len));
+                if( _intents.size() >= _coalesceAt ) {
+                    // hot spots (btree buckets, NamespaceDetails counters) get declared over and over
+                    // within a commit; fold them together rather than let the vector grow.
+                    coalesce();
+                    _coalesceAt = _intents.size() * 2;
+                    if( _coalesceAt < CoalesceMin )
+                        _coalesceAt = CoalesceMin;
+                }
                 wassert( _intents.size() < 2000000 );
             }
+
+            /** sort _intents by start address and merge overlapping and adjacent ranges, leaving
+                the minimal set of disjoint ranges that covers everything declared.
+            */
+            void coalesce();
+
+            /** @return sum of the lengths of _intents */
+            unsigned long long intentBytes() const;
             #if defined(DEBUG_WRITE_INTENT)
             map<void*,int> _debug;
             #endif
+        private:
+            static const size_t CoalesceMin = 64 * 1024;
+            size_t _coalesceAt;
         };
 
         /** so we don't have to lock the groupCommitMutex too often */
@@ -182,14 +204,10 @@ namespace mongo {
             /** we check how much written and if it is getting to be a lot, we commit sooner. */
             size_t bytes() const { return _bytes; }
 
-            /** used in prepbasicwrites. sorted so that overlapping and duplicate items 
-             * can be merged.  we sort here so the caller receives something they must 
-             * keep const from their pov. */
-            const vector<WriteIntent>& getIntentsSorted() {
-                groupCommitMutex.dassertLocked();
-                sort(_intentsAndDurOps._intents.begin(), _intentsAndDurOps._intents.end());
-                return _intentsAndDurOps._intents;
-            }
+            /** used in prepbasicwrites.  sorted by address with overlapping, duplicate and
+             *  adjacent items merged, so each byte is journaled once.  we coalesce here so the
+             *  caller receives something they must keep const from their pov. */
+            const vector<WriteIntent>& getIntentsCoalesced();
 
             bool _hasWritten;
 
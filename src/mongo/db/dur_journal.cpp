@@ -48,6 +48,7 @@
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/race.h"
+#include "mongo/util/crc32c.h"
 #include "mongo/util/file.h"
 #include "mongo/util/logfile.h"
 #include "mongo/util/mmap.h"
@@ -127,12 +128,13 @@ namespace mongo {
 
         JSectFooter::JSectFooter(const void* begin, int len) { // needs buffer to compute hash
             sentinel = JEntry::OpCode_Footer;
+            hashType = HashCrc32c;
             reserved = 0;
             magic[0] = magic[1] = magic[2] = magic[3] = '\n';
 
-            Checksum c;
-            c.gen(begin, (unsigned) len);
-            memcpy(hash, c.bytes, sizeof(hash));
+            memset(hash, 0, sizeof(hash));
+            uint32_t crc = crc32c(0, begin, (size_t) len);
+            memcpy(hash, &crc, sizeof(crc));
         }
 
         bool JSectFooter::checkHash(const void* begin, int len) const {
@@ -140,12 +142,28 @@ namespace mongo {
                 log() << "journal footer not valid" << endl;
                 return false;
             }
-            Checksum c;
-            c.gen(begin, len);
-            DEV log() << "checkHash len:" << len << " hash:" << toHex(hash, 16) << " current:" << toHex(c.bytes, 16) << endl;
-            if( memcmp(hash, c.bytes, sizeof(hash)) == 0 ) 
+            unsigned char current[16];
+            switch( hashType ) {
+            case HashSimple: {
+                Checksum c;
+                c.gen(begin, len);
+                memcpy(current, c.bytes, sizeof(current));
+                break;
+            }
+            case HashCrc32c: {
+                memset(current, 0, sizeof(current));
+                uint32_t crc = crc32c(0, begin, (size_t) len);
+                memcpy(current, &crc, sizeof(crc));
+                break;
+            }
+            default:
+                log() << "journal footer has unknown checksum type " << hashType << endl;
+                return false;
+            }
+            DEV log() << "checkHash len:" << len << " type:" << hashType << " hash:" << toHex(hash, 16) << " current:" << toHex(current, 16) << endl;
+            if( memcmp(hash, current, sizeof(hash)) == 0 ) 
                 return true;
-            log() << "journal checkHash mismatch, got: " << toHex(c.bytes, 16) << " expected: " << toHex(hash,16) << endl;
+            log() << "journal checkHash mismatch, got: " << toHex(current, 16) << " expected: " << toHex(hash,16) << endl;
             return false;
         }
 
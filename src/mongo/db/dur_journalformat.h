@@ -49,9 +49,12 @@ namespace mongo {
             // x4142 is asci--readable if you look at the file with head/less -- thus the starting values were near
             // that.  simply incrementing the version # is safe on a fwd basis.
 #if defined(_NOCOMPRESS)
-            enum { CurrentVersion = 0x4148 };
+            // 0x414b: as 0x414a, for the uncompressed format.  0x4148 files use HashSimple.
+            enum { CurrentVersion = 0x414b, PrevVersion = 0x4148 };
 #else
-            enum { CurrentVersion = 0x4149 };
+            // 0x414a: section footers say which checksum they carry (JSectFooter::hashType).
+            // 0x4149 files are still readable, all of their sections use HashSimple.
+            enum { CurrentVersion = 0x414a, PrevVersion = 0x4149 };
 #endif
             unsigned short _version;
 
@@ -67,7 +70,7 @@ namespace mongo {
             char reserved3[8026]; // 8KB total for the file header
             char txt2[2];         // "\n\n" at the end
 
-            bool versionOk() const { return _version == CurrentVersion; }
+            bool versionOk() const { return _version == CurrentVersion || _version == PrevVersion; }
             bool valid() const { return magic[0] == 'j' && txt2[1] == '\n' && fileId; }
         };
 
@@ -141,13 +144,20 @@ namespace mongo {
             }
         };
 
-        /** group commit section footer. md5 is a key field. */
+        /** group commit section footer. hash is a key field. */
         struct JSectFooter {
             JSectFooter();
             JSectFooter(const void* begin, int len); // needs buffer to compute hash
+
+            enum HashTypes {
+                HashSimple = 0,     // mongo::Checksum, 16 bytes.  all that journal versions 0x4148 and 0x4149 wrote
+                HashCrc32c = 1      // crc32c in the first 4 bytes of hash, rest zero
+            };
+
             unsigned sentinel;
             unsigned char hash[16];
-            unsigned long long reserved;
+            unsigned hashType;
+            unsigned reserved;
             char magic[4]; // "\n\n\n\n"
 
             /** used by recovery to see if buffer is valid
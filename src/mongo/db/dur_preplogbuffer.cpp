@@ -112,6 +112,7 @@ namespace mongo {
             i->ofsInJournalBuffer = bb.len();
 #endif
             bb.appendBuf(i->start(), e.len);
+            mmf->noteDirty(ofs, e.len);
 
             if (unlikely(e.len != (unsigned)i->length())) {
                 log() << "journal info splitting prepBasicWrite at boundary" << endl;
@@ -128,9 +129,9 @@ namespace mongo {
 
         void assertNothingSpooled();
 
-        /** basic write ops / write intents.  note there is no particular order to these : if we have
-            two writes to the same location during the group commit interval, it is likely
-            (although not assured) that it is journaled here once.
+        /** basic write ops / write intents.  the intents arrive coalesced: if we have two writes to
+            the same, overlapping or adjacent locations during the group commit interval, the bytes
+            are journaled here once.
         */
         static void prepBasicWrites(AlignedBuilder& bb) {
             scoped_lock lk(privateViews._mutex());
@@ -140,23 +141,12 @@ namespace mongo {
             RelativePath lastDbPath;
 
             assertNothingSpooled();
-            const vector<WriteIntent>& _intents = commitJob.getIntentsSorted();
+            const vector<WriteIntent>& _intents = commitJob.getIntentsCoalesced();
             verify( !_intents.empty() );
 
-            WriteIntent last;
             for( vector<WriteIntent>::const_iterator i = _intents.begin(); i != _intents.end(); i++ ) { 
-                if( i->start() < last.end() ) { 
-                    // overlaps
-                    last.absorb(*i);
-                }
-                else { 
-                    // discontinuous
-                    if( i != _intents.begin() )
-                        prepBasicWrite_inlock(bb, &last, lastDbPath);
-                    last = *i;
-                }
+                prepBasicWrite_inlock(bb, &*i, lastDbPath);
             }
-            prepBasicWrite_inlock(bb, &last, lastDbPath);
         }
 
         static void resetLogBuffer(/*out*/JSectHeader& h, AlignedBuilder& bb) {
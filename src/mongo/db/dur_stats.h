@@ -48,6 +48,7 @@ namespace mongo {
                 unsigned _commits;
                 unsigned _earlyCommits; // count of early commits from commitIfNeeded() or from getDur().commitNow()
                 unsigned long long _journaledBytes;
+                unsigned long long _journaledBytesSaved; // declared write intent bytes not journaled thanks to coalescing
                 unsigned long long _uncompressedBytes;
                 unsigned long long _writeToDataFilesBytes;
 
@@ -55,6 +56,7 @@ namespace mongo {
                 unsigned long long _writeToJournalMicros;
                 unsigned long long _writeToDataFilesMicros;
                 unsigned long long _remapPrivateViewMicros;
+                unsigned long long _remapPrivateViewBytes; // private view bytes remapped, usually a fraction of the views per pass
 
                 // undesirable to be in write lock for the group commit (it can be done in a read lock), so good if we
                 // have visibility when this happens.  can happen for a couple reasons
@@ -32,6 +32,7 @@
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/working_set.h"
+#include "mongo/db/storage/extent.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/db/structure/collection_iterator.h"
 
@@ -43,7 +44,13 @@ namespace mongo {
     CollectionScan::CollectionScan(const CollectionScanParams& params,
                                    WorkingSet* workingSet,
                                    const MatchExpression* filter)
-        : _workingSet(workingSet), _filter(filter), _params(params), _nsDropped(false) { }
+        : _workingSet(workingSet),
+          _filter(filter),
+          _params(params),
+          _nsDropped(false),
+          _zoneMap(NULL),
+          _building(false),
+          _buildId(0) { }
 
     PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
         ++_commonStats.works;
@@ -60,6 +67,11 @@ namespace mongo {
                                                   _params.tailable,
                                                   _params.direction ) );
 
+            if ( !collection->details()->isCapped() && collection->zoneMap()->enabled() ) {
+                _zoneMap = collection->zoneMap();
+                _specificStats.zoneMapped = true;
+            }
+
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
@@ -69,6 +81,7 @@ namespace mongo {
         // Should we try getNext() on the underlying _iter if we're EOF?  Yes, if we're tailable.
         if (isEOF()) {
             if (!_params.tailable) {
+                leaveExtent();
                 return PlanStage::IS_EOF;
             }
             else {
@@ -84,6 +97,12 @@ namespace mongo {
             nextLoc = _iter->getNext();
         }
 
+        if (NULL != _zoneMap && enterExtent(nextLoc)) {
+            ++_specificStats.extentsSkipped;
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
         WorkingSetID id = _workingSet->allocate();
         WorkingSetMember* member = _workingSet->get(id);
         member->loc = nextLoc;
@@ -92,6 +111,10 @@ namespace mongo {
 
         ++_specificStats.docsTested;
 
+        if (_building) {
+            _summary.add(member->obj, _zoneMapFields);
+        }
+
         if (Filter::passes(member, _filter)) {
             *out = id;
             ++_commonStats.advanced;
@@ -104,6 +127,39 @@ namespace mongo {
         }
     }
 
+    bool CollectionScan::enterExtent(const DiskLoc& loc) {
+        DiskLoc extentLoc(loc.a(), loc.rec()->extentOfs());
+        if (extentLoc == _currExtent) {
+            return false;
+        }
+
+        leaveExtent();
+        _currExtent = extentLoc;
+
+        if (NULL != _filter && _zoneMap->canSkip(extentLoc, _filter)) {
+            _iter->skipExtent(loc);
+            return true;
+        }
+
+        // We can only summarize the extent if we read all of it.
+        Extent* e = extentLoc.ext();
+        DiskLoc first = CollectionScanParams::FORWARD == _params.direction ? e->firstRecord
+                                                                           : e->lastRecord;
+        if (loc == first && _zoneMap->startBuild(extentLoc, &_buildId)) {
+            _building = true;
+            _zoneMapFields = _zoneMap->fields();
+            _summary = ZoneMap::Summary(_zoneMapFields.size());
+        }
+        return false;
+    }
+
+    void CollectionScan::leaveExtent() {
+        if (_building) {
+            _zoneMap->finishBuild(_currExtent, _buildId, _summary);
+            _building = false;
+        }
+    }
+
     bool CollectionScan::isEOF() {
         if (_nsDropped) { return true; }
         if (NULL == _iter) { return false; }
@@ -130,6 +186,8 @@ namespace mongo {
             if (!_iter->recoverFromYield()) {
                 warning() << "collection dropped during yield of collscan or state deleted";
                 _nsDropped = true;
+                _zoneMap = NULL;
+                _building = false;
             }
         }
     }
@@ -33,6 +33,7 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/structure/collection_iterator.h"
+#include "mongo/db/structure/zone_map.h"
 
 namespace mongo {
 
@@ -59,6 +60,15 @@ namespace mongo {
         virtual PlanStageStats* getStats();
 
     private:
+        /**
+         * Called on the first record we see in each extent.  Returns true if the zone map shows
+         * the extent can't hold a match, in which case the iterator has moved past it.
+         */
+        bool enterExtent(const DiskLoc& firstLoc);
+
+        // Completes the summary of the extent we just left, if we read all of it.
+        void leaveExtent();
+
         // WorkingSet is not owned by us.
         WorkingSet* _workingSet;
 
@@ -72,6 +82,19 @@ namespace mongo {
         // True if nsdetails(_ns) == NULL on our first call to work.
         bool _nsDropped;
 
+        // Only set if the collection has zone maps.  Owned by the collection.
+        ZoneMap* _zoneMap;
+
+        // The extent of the last record we returned, when using zone maps.
+        DiskLoc _currExtent;
+
+        // When we started reading _currExtent at its first record and it had no summary yet, we
+        // build one as we go.
+        bool _building;
+        unsigned long long _buildId;
+        std::vector<std::string> _zoneMapFields;
+        ZoneMap::Summary _summary;
+
         // Stats
         CommonStats _commonStats;
         CollectionScanStats _specificStats;
@@ -109,10 +109,14 @@ namespace mongo {
     };
 
     struct CollectionScanStats : public SpecificStats {
-        CollectionScanStats() : docsTested(0) { }
+        CollectionScanStats() : docsTested(0), zoneMapped(false), extentsSkipped(0) { }
 
         // How many documents did we check against our filter?
         uint64_t docsTested;
+
+        // Did the collection have zone maps, and how many extents did they let us skip?
+        bool zoneMapped;
+        uint64_t extentsSkipped;
     };
 
     struct AndHashStats : public SpecificStats {
@@ -182,6 +182,24 @@ namespace mongo {
             }
         }
 
+        virtual int nKeys(DiskLoc bucket) const {
+            verify(!bucket.isNull());
+            const BtreeBucket<Version> *b = bucket.btree<Version>();
+            int n = b->getN();
+            if (n == b->INVALID_N_SENTINEL) {
+                throw UserException(deletedBucketCode, "nKeys bucket deleted");
+            }
+            return n;
+        }
+
+        virtual DiskLoc childForPos(DiskLoc bucket, int keyOffset) const {
+            const BtreeBucket<Version> *b = bucket.btree<Version>();
+            if (keyOffset == b->getN()) {
+                return b->getNextChild();
+            }
+            return b->keyNode(keyOffset).prevChildBucket;
+        }
+
         virtual string dupKeyError(DiskLoc bucket, const IndexDetails &idx,
                                    const BSONObj& keyObj) const {
             typename Version::KeyOwned key(keyObj);
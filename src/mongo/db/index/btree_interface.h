@@ -134,6 +134,22 @@ namespace mongo {
          */
         virtual void keyAndRecordAt(DiskLoc bucket, int keyOffset, BSONObj* keyOut,
                                     DiskLoc* recordOut) const = 0;
+
+        /**
+         * These methods expose the shape of the tree, for code that estimates from the btree
+         * structure instead of walking every key.
+         */
+
+        /**
+         * Number of key slots in the bucket, including unused ones.
+         */
+        virtual int nKeys(DiskLoc bucket) const = 0;
+
+        /**
+         * The child to the left of the key at keyOffset, or the rightmost child if keyOffset
+         * is nKeys(bucket). Null in leaf buckets.
+         */
+        virtual DiskLoc childForPos(DiskLoc bucket, int keyOffset) const = 0;
     };
 
 }  // namespace mongo
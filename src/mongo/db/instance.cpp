@@ -71,6 +71,7 @@
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/storage/working_set_snapshot.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/d_logic.h"
@@ -579,6 +580,11 @@ namespace mongo {
         prefix += '.';
         ClientCursor::invalidate(prefix.c_str());
 
+        DatabaseHolder::ClosedInfo info;
+        info.sizeOnDisk = database->namespaceIndex().fileLength() + database->fileSize();
+        info.empty = database->isEmpty();
+        dbHolderW().noteClosed( db, path, info );
+
         dbHolderW().erase( db, path );
         ctx->_clear();
         delete database; // closes files
@@ -1130,6 +1136,8 @@ namespace {
             MemoryMappedFile::flushAll(true);
         }
 
+        saveWorkingSetSnapshotAtShutdown();
+
         log() << "shutdown: closing all files..." << endl;
         stringstream ss3;
         MemoryMappedFile::closeAllFiles( ss3 );
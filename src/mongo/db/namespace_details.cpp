@@ -199,13 +199,13 @@ namespace mongo {
         @param lenToAlloc is WITH header
         @return null diskloc if no room - allocate a new extent then
     */
-    DiskLoc NamespaceDetails::alloc(const StringData& ns, int lenToAlloc) {
+    DiskLoc NamespaceDetails::alloc(const StringData& ns, int lenToAlloc, int* probes) {
         {
             // align very slightly.
             lenToAlloc = (lenToAlloc + 3) & 0xfffffffc;
         }
 
-        DiskLoc loc = _alloc(ns, lenToAlloc);
+        DiskLoc loc = _alloc(ns, lenToAlloc, probes);
         if ( loc.isNull() )
             return loc;
 
@@ -260,9 +260,10 @@ namespace mongo {
 
     /* for non-capped collections.
        @param peekOnly just look up where and don't reserve
+       @param probes if not NULL, set to the number of deleted records examined
        returned item is out of the deleted list upon return
     */
-    DiskLoc NamespaceDetails::__stdAlloc(int len, bool peekOnly) {
+    DiskLoc NamespaceDetails::__stdAlloc(int len, bool peekOnly, int* probes) {
         DiskLoc *prev;
         DiskLoc *bestprev = 0;
         DiskLoc bestmatch;
@@ -272,6 +273,7 @@ namespace mongo {
         prev = &_deletedList[b];
         int extra = 5; // look for a better fit, a little.
         int chain = 0;
+        int nProbes = 0;
         while ( 1 ) {
             { // defensive check
                 int fileNumber = cur.a();
@@ -293,6 +295,8 @@ namespace mongo {
                 b++;
                 if ( b > MaxBucket ) {
                     // out of space. alloc a new extent.
+                    if ( probes )
+                        *probes = nProbes;
                     return DiskLoc();
                 }
                 cur = _deletedList[b];
@@ -300,6 +304,7 @@ namespace mongo {
                 continue;
             }
             DeletedRecord *r = cur.drec();
+            nProbes++;
             if ( r->lengthWithHeaders() >= len &&
                  r->lengthWithHeaders() < bestmatchlen ) {
                 bestmatchlen = r->lengthWithHeaders();
@@ -337,6 +342,8 @@ namespace mongo {
             verify(bmr->extentOfs() < bestmatch.getOfs());
         }
 
+        if ( probes )
+            *probes = nProbes;
         return bestmatch;
     }
 
@@ -395,9 +402,9 @@ namespace mongo {
     }
 
     /* alloc with capped table handling. */
-    DiskLoc NamespaceDetails::_alloc(const StringData& ns, int len) {
+    DiskLoc NamespaceDetails::_alloc(const StringData& ns, int len, int* probes) {
         if ( ! isCapped() )
-            return __stdAlloc(len, false);
+            return __stdAlloc(len, false, probes);
 
         return cappedAlloc(ns,len);
     }
@@ -444,9 +444,10 @@ namespace mongo {
 
         /** allocate space for a new record from deleted lists.
             @param lenToAlloc is WITH header
+            @param probes if not NULL, set to the number of deleted records examined
             @return null diskloc if no room - allocate a new extent then
         */
-        DiskLoc alloc(const StringData& ns, int lenToAlloc);
+        DiskLoc alloc(const StringData& ns, int lenToAlloc, int* probes = NULL);
 
         /* add a given record to the deleted chains for this NS */
         void addDeletedRec(DeletedRecord *d, DiskLoc dloc);
@@ -472,9 +473,9 @@ namespace mongo {
          */
         void swapIndex( int a, int b );
 
-        DiskLoc _alloc(const StringData& ns, int len);
+        DiskLoc _alloc(const StringData& ns, int len, int* probes);
         void maybeComplain( const StringData& ns, int len ) const;
-        DiskLoc __stdAlloc(int len, bool willBeAt);
+        DiskLoc __stdAlloc(int len, bool willBeAt, int* probes = NULL);
         void compact(); // combine adjacent deleted records
 
         friend class NamespaceIndex;
@@ -568,6 +568,7 @@ namespace mongo {
                             where->size);
                         std::memcpy(targetPtr, sourcePtr, where->size);
                     }
+                    collection->zoneMap()->noteWrite(loc, oldObj);
                     objectWasChanged = true;
                     opDebug->fastmod = true;
                 }
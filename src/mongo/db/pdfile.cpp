@@ -172,6 +172,7 @@ namespace mongo {
                              const string& path = storageGlobalParams.dbpath);
 
     void _deleteDataFiles(const char *database) {
+        dbHolderW().forgetClosed(database, storageGlobalParams.dbpath);
         if (storageGlobalParams.directoryperdb) {
             FileAllocator::get()->waitUntilFinished();
             MONGO_ASSERT_ON_EXCEPTION_WITH_MSG(
@@ -231,6 +232,12 @@ namespace mongo {
         }
 
 
+        BSONElement zoneMapFields = options["zoneMapFields"];
+        if ( !zoneMapFields.eoo() ) {
+            uassertStatusOK( ZoneMap::validateFields( zoneMapFields ) );
+            uassert( 17296, "zoneMapFields is not supported on capped collections", !newCapped );
+        }
+
         collection = db->createCollection( ns,
                                            options["capped"].trueValue(),
                                            &options,
@@ -764,8 +771,10 @@ namespace mongo {
         d->incrementStats( r->netLength(), 1 );
 
         // we don't bother resetting query optimizer stats for the god tables - also god is true when adding a btree bucket
-        if ( !god )
+        if ( !god ) {
+            collection->zoneMap()->noteWrite( loc, BSONObj( r->data() ) );
             collection->infoCache()->notifyOfWriteOp();
+        }
 
         /* add this record to our indexes */
         if ( d->getTotalIndexCount() > 0 ) {
@@ -930,6 +939,7 @@ namespace mongo {
 
     // move temp files to standard data dir
     void _replaceWithRecovered( const char *database, const char *reservedPathString ) {
+        dbHolderW().forgetClosed(database, storageGlobalParams.dbpath);
         Path newPath(storageGlobalParams.dbpath);
         if (storageGlobalParams.directoryperdb)
             newPath /= database;
@@ -333,7 +333,7 @@ namespace mongo {
     void Document::hash_combine(size_t &seed) const {
         for (DocumentStorageIterator it = storage().iterator(); !it.atEnd(); it.advance()) {
             StringData name = it->nameSD();
-            boost::hash_range(seed, name.rawData(), name.rawData() + name.size());
+            MurmurHash3_x86_32(name.rawData(), name.size(), seed, &seed);
             it->val.hash_combine(seed);
         }
     }
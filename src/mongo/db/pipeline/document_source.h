@@ -633,6 +633,11 @@ namespace mongo {
          */
         vector<DBClientCursor*> getCursors();
 
+        /** Returns the connection of an exhausted cursor obtained from getCursors() to the pool
+         *  without waiting for the other cursors.  The cursor must not be used afterwards.
+         */
+        void releaseCursor(DBClientCursor* cursor);
+
     private:
 
         struct CursorAndConnection {
@@ -863,7 +868,8 @@ namespace mongo {
         // not.
         class IteratorFromCursor;
         class IteratorFromBsonArray;
-        void populateFromCursors(const vector<DBClientCursor*>& cursors);
+        void populateFromCursors(DocumentSourceMergeCursors* merger,
+                                 const vector<DBClientCursor*>& cursors);
         void populateFromBsonArrays(const vector<BSONArray>& arrays);
 
         /* these two parallel each other */
@@ -124,7 +124,7 @@ namespace mongo {
             bool ok = (*it)->cursor.initLazyFinish(retry); // blocks here for first batch
 
             uassert(17028,
-                    "error reading response from " + _cursors.back()->connection->toString(),
+                    "error reading response from " + (*it)->connection->toString(),
                     ok);
             verify(!retry);
         }
@@ -132,6 +132,17 @@ namespace mongo {
         _currentCursor = _cursors.begin();
     }
 
+    void DocumentSourceMergeCursors::releaseCursor(DBClientCursor* cursor) {
+        for (Cursors::iterator it = _cursors.begin(); it != _cursors.end(); ++it) {
+            if (&(*it)->cursor == cursor) {
+                (*it)->connection.done();
+                _cursors.erase(it);
+                _currentCursor = _cursors.begin();
+                return;
+            }
+        }
+    }
+
     boost::optional<Document> DocumentSourceMergeCursors::getNext() {
         if (_unstarted)
             start();
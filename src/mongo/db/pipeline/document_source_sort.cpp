@@ -52,7 +52,12 @@ namespace mongo {
         if (!_output || !_output->more())
             return boost::none;
 
-        return _output->next().second;
+        Document out = _output->next().second;
+        if (!_output->more()) {
+            // release the sorted data as soon as the last document is handed out
+            dispose();
+        }
+        return out;
     }
 
     void DocumentSourceSort::serializeToArray(vector<Value>& array, bool explain) const {
@@ -206,7 +211,7 @@ namespace mongo {
             typedef DocumentSourceMergeCursors DSCursors;
             typedef DocumentSourceCommandShards DSCommands;
             if (DSCursors* castedSource = dynamic_cast<DSCursors*>(pSource)) {
-                populateFromCursors(castedSource->getCursors());
+                populateFromCursors(castedSource, castedSource->getCursors());
             } else if (DSCommands* castedSource = dynamic_cast<DSCommands*>(pSource)) {
                 populateFromBsonArrays(castedSource->getArrays());
             } else {
@@ -224,25 +229,53 @@ namespace mongo {
 
     class DocumentSourceSort::IteratorFromCursor : public MySorter::Iterator {
     public:
-        IteratorFromCursor(DocumentSourceSort* sorter, DBClientCursor* cursor)
+        IteratorFromCursor(DocumentSourceSort* sorter,
+                           DocumentSourceMergeCursors* merger,
+                           DBClientCursor* cursor)
             : _sorter(sorter)
+            , _merger(merger)
             , _cursor(cursor)
         {}
 
-        bool more() { return _cursor->more(); }
+        bool more() {
+            if (!_cursor)
+                return false;
+
+            if (_cursor->more())
+                return true;
+
+            // this shard is done, don't hold on to its connection for the rest of the merge
+            _merger->releaseCursor(_cursor);
+            _cursor = NULL;
+            return false;
+        }
         Data next() {
-            Document doc(_cursor->next());
+            BSONObj next = _cursor->next();
+            uassert(17292, str::stream() << "Received error in response from "
+                                         << _cursor->originalHost() << ": " << next,
+                    !next.hasField("$err"));
+
+            Document doc(next);
             return make_pair(_sorter->extractKey(doc), doc);
         }
     private:
         DocumentSourceSort* _sorter;
+        DocumentSourceMergeCursors* _merger;
         DBClientCursor* _cursor;
     };
 
-    void DocumentSourceSort::populateFromCursors(const vector<DBClientCursor*>& cursors) {
+    void DocumentSourceSort::populateFromCursors(DocumentSourceMergeCursors* merger,
+                                                 const vector<DBClientCursor*>& cursors) {
+        // No shard can contribute more than limit documents to the merge, so don't have them
+        // send any more than that per batch.
+        const long long limit = limitSrc ? limitSrc->getLimit() : 0;
+        const bool smallLimit = limit > 0 && limit < numeric_limits<int>::max();
+
         vector<boost::shared_ptr<MySorter::Iterator> > iterators;
         for (size_t i = 0; i < cursors.size(); i++) {
-            iterators.push_back(boost::make_shared<IteratorFromCursor>(this, cursors[i]));
+            if (smallLimit)
+                cursors[i]->setBatchSize(static_cast<int>(limit));
+            iterators.push_back(boost::make_shared<IteratorFromCursor>(this, merger, cursors[i]));
         }
 
         _output.reset(MySorter::Iterator::merge(iterators, makeSortOptions(), Comparator(*this)));
@@ -95,6 +95,12 @@ namespace mongo {
         }
         else {
             putRefCountable(RCString::create(s));
+
+            // Long strings are always longer than stringCache. Keeping their first bytes
+            // inline lets compare() and operator== reject most unequal strings without
+            // chasing the pointer. BinData and RegEx reuse that space so they are excluded.
+            if (type == String || type == Symbol || type == Code)
+                memcpy(stringCache, s.rawData(), sizeof(stringCache));
         }
     }
 
@@ -610,6 +616,14 @@ namespace mongo {
         case Code:
         case Symbol:
         case String:
+            if (!rL._storage.shortStr && !rR._storage.shortStr) {
+                // Both have an inline prefix (see ValueStorage::putString())
+                const int prefixCmp = memcmp(rL._storage.stringCache,
+                                             rR._storage.stringCache,
+                                             sizeof(rL._storage.stringCache));
+                if (prefixCmp)
+                    return prefixCmp > 0 ? 1 : -1;
+            }
             return rL.getStringData().compare(rR.getStringData());
 
         case Object:
@@ -752,10 +766,12 @@ namespace mongo {
             break;
         }
 
-        case DBRef:
-            boost::hash_combine(seed, _storage.getDBRef()->ns);
+        case DBRef: {
+            const string& ns = _storage.getDBRef()->ns;
+            MurmurHash3_x86_32(ns.c_str(), ns.size(), seed, &seed);
             _storage.getDBRef()->oid.hash_combine(seed);
             break;
+        }
 
 
         case BinData: {
@@ -774,7 +790,7 @@ namespace mongo {
         case CodeWScope: {
             // SERVER-7804
             const char * code = _storage.getCodeWScope()->code.c_str();
-            boost::hash_range(seed, code, (code + strlen(code)));
+            MurmurHash3_x86_32(code, strlen(code), seed, &seed);
             // Not going to bother hashing scope. Too many edge cases. Will fall back to
             // Value::compare when code is same, so this is ok.
             break;
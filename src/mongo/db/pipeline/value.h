@@ -206,6 +206,10 @@ namespace mongo {
                 // Simple case
                 return true;
             }
+            if (v1._storage.stringsKnownUnequal(v2._storage)) {
+                // Common for $group and $addToSet keys that land in the same bucket
+                return false;
+            }
             return (Value::compare(v1, v2) == 0);
         }
         
@@ -206,6 +206,21 @@ namespace mongo {
                   && i64[1] == other.i64[1]);
         }
 
+        /** True if both are String, Symbol or Code values of the same type which can be shown
+         *  to differ without looking at their heap buffers. Short strings are stored zero-padded
+         *  so they are equal exactly when identical; long strings differ if their cached
+         *  prefixes do. Callers must have already checked identical().
+         */
+        bool stringsKnownUnequal(const ValueStorage& other) const {
+            if (type != other.type || !(type == String || type == Symbol || type == Code))
+                return false;
+            if (shortStr != other.shortStr)
+                return true; // short and long strings can never have the same length
+            if (shortStr)
+                return true;
+            return memcmp(stringCache, other.stringCache, sizeof(stringCache)) != 0;
+        }
+
         void verifyRefCountingIfShould() const;
 
         // This data is public because this should only be used by Value which would be a friend
@@ -237,7 +252,7 @@ namespace mongo {
                         union {
                             unsigned char binSubType;
                             char pad[6];
-                            char stringCache[6]; // TODO copy first few bytes of strings in here
+                            char stringCache[6]; // first bytes of long String, Symbol and Code
                         };
                         union { // 8 bytes long and 8-byte aligned
                             // There should be no pointers to non-const data
@@ -147,6 +147,9 @@ namespace mongo {
             res->setNScanned(csStats->docsTested);
             res->setNScannedObjects(csStats->docsTested);
             res->setIndexOnly(false);
+            if (csStats->zoneMapped) {
+                res->setNExtentsSkipped(csStats->extentsSkipped);
+            }
         }
         else if (leaf->stageType == STAGE_GEO_NEAR_2DSPHERE) {
             // TODO: This is kind of a lie for STAGE_GEO_NEAR_2DSPHERE.
@@ -324,7 +324,7 @@ namespace mongo {
         bb.skip(sizeof(QueryResult));
 
         // This is a read lock.  TODO: There is a cursor flag for not needing this.  Do we care?
-        Client::ReadContext ctx(ns);
+        scoped_ptr<Client::ReadContext> ctx(new Client::ReadContext(ns));
 
         QLOG() << "running getMore in new system, cursorid " << cursorid << endl;
 
@@ -382,6 +382,13 @@ namespace mongo {
             Runner* runner = cc->getRunner();
             const int queryOptions = cc->queryOptions();
 
+            // Aggregation cursors survive drops of their namespace and their stages take their
+            // own locks, yielding as they go.  Holding ours while pulling would keep blocking
+            // stages on their whole input under one read lock, and a $out needs a write lock.
+            if (cc->isAggCursor()) {
+                ctx.reset(); // unlocks
+            }
+
             // Get results out of the runner.
             runner->restoreState();
 
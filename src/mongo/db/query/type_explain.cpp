@@ -35,6 +35,7 @@ namespace mongo {
     const BSONField<bool> TypeExplain::indexOnly("indexOnly");
     const BSONField<long long> TypeExplain::nYields("nYields");
     const BSONField<long long> TypeExplain::nChunkSkips("nChunkSkips");
+    const BSONField<long long> TypeExplain::nExtentsSkipped("nExtentsSkipped");
     const BSONField<long long> TypeExplain::millis("millis");
     const BSONField<BSONObj> TypeExplain::indexBounds("indexBounds");
     const BSONField<std::vector<TypeExplain*> > TypeExplain::allPlans("allPlans");
@@ -127,6 +128,8 @@ namespace mongo {
 
         if (_isNChunkSkipsSet) builder.appendNumber(nChunkSkips(), _nChunkSkips);
 
+        if (_isNExtentsSkippedSet) builder.appendNumber(nExtentsSkipped(), _nExtentsSkipped);
+
         if (_isMillisSet) builder.appendNumber(millis(), _millis);
 
         if (_isIndexBoundsSet) builder.append(indexBounds(), _indexBounds);
@@ -209,6 +212,10 @@ namespace mongo {
         if (fieldState == FieldParser::FIELD_INVALID) return false;
         _isNChunkSkipsSet = fieldState == FieldParser::FIELD_SET;
 
+        fieldState = FieldParser::extract(source, nExtentsSkipped, &_nExtentsSkipped, errMsg);
+        if (fieldState == FieldParser::FIELD_INVALID) return false;
+        _isNExtentsSkippedSet = fieldState == FieldParser::FIELD_SET;
+
         fieldState = FieldParser::extract(source, millis, &_millis, errMsg);
         if (fieldState == FieldParser::FIELD_INVALID) return false;
         _isMillisSet = fieldState == FieldParser::FIELD_SET;
@@ -270,6 +277,9 @@ namespace mongo {
         _nChunkSkips = 0;
         _isNChunkSkipsSet = false;
 
+        _nExtentsSkipped = 0;
+        _isNExtentsSkippedSet = false;
+
         _millis = 0;
         _isMillisSet = false;
 
@@ -332,6 +342,9 @@ namespace mongo {
         other->_nChunkSkips = _nChunkSkips;
         other->_isNChunkSkipsSet = _isNChunkSkipsSet;
 
+        other->_nExtentsSkipped = _nExtentsSkipped;
+        other->_isNExtentsSkippedSet = _isNExtentsSkippedSet;
+
         other->_millis = _millis;
         other->_isMillisSet = _isMillisSet;
 
@@ -611,6 +624,24 @@ namespace mongo {
         return _nChunkSkips;
     }
 
+    void TypeExplain::setNExtentsSkipped(long long nExtentsSkipped) {
+        _nExtentsSkipped = nExtentsSkipped;
+        _isNExtentsSkippedSet = true;
+    }
+
+    void TypeExplain::unsetNExtentsSkipped() {
+         _isNExtentsSkippedSet = false;
+     }
+
+    bool TypeExplain::isNExtentsSkippedSet() const {
+         return _isNExtentsSkippedSet;
+    }
+
+    long long TypeExplain::getNExtentsSkipped() const {
+        dassert(_isNExtentsSkippedSet);
+        return _nExtentsSkipped;
+    }
+
     void TypeExplain::setMillis(long long millis) {
         _millis = millis;
         _isMillisSet = true;
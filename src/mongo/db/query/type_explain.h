@@ -47,6 +47,7 @@ namespace mongo {
         static const BSONField<bool> indexOnly;
         static const BSONField<long long> nYields;
         static const BSONField<long long> nChunkSkips;
+        static const BSONField<long long> nExtentsSkipped;
         static const BSONField<long long> millis;
         static const BSONField<BSONObj> indexBounds;
         static const BSONField<std::vector<TypeExplain*> > allPlans;
@@ -140,6 +141,11 @@ namespace mongo {
         bool isNChunkSkipsSet() const;
         long long getNChunkSkips() const;
 
+        void setNExtentsSkipped(long long nExtentsSkipped);
+        void unsetNExtentsSkipped();
+        bool isNExtentsSkippedSet() const;
+        long long getNExtentsSkipped() const;
+
         void setMillis(long long millis);
         void unsetMillis();
         bool isMillisSet() const;
@@ -218,6 +224,10 @@ namespace mongo {
         long long _nChunkSkips;
         bool _isNChunkSkipsSet;
 
+        // (O)  number of extents a collection scan skipped using their zone maps
+        long long _nExtentsSkipped;
+        bool _isNExtentsSkippedSet;
+
         // (O)  elapsed time this plan took running, in milliseconds
         long long _millis;
         bool _isMillisSet;
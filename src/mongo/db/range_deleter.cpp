@@ -171,9 +171,14 @@ namespace mongo {
         }
     }
 
-    void RangeDeleter::startWorkers() {
-        if (!_worker) {
-            _worker.reset(new boost::thread(boost::bind(&RangeDeleter::doWork, this)));
+    void RangeDeleter::startWorkers(int numWorkers) {
+        if (!_workers.empty()) {
+            return;
+        }
+
+        for (int i = 0; i < std::max(1, numWorkers); i++) {
+            _workers.mutableVector().push_back(
+                    new boost::thread(boost::bind(&RangeDeleter::doWork, this)));
         }
     }
 
@@ -183,8 +188,8 @@ namespace mongo {
             _stopRequested = true;
         }
 
-        if (_worker) {
-            _worker->join();
+        for (size_t i = 0; i < _workers.size(); i++) {
+            _workers.vector()[i]->join();
         }
 
         scoped_lock sl(_queueMutex);
@@ -315,13 +320,16 @@ namespace mongo {
             sleepmillis(checkIntervalMillis);
         }
 
+        long long numDeleted = 0;
         bool result = _env->deleteRange(ns, min, max, shardKeyPattern,
-                                        secondaryThrottle, errMsg);
+                                        secondaryThrottle, &numDeleted, errMsg);
 
         {
             scoped_lock sl(_queueMutex);
             _deleteSet.erase(&deleteRange);
 
+            _stats->addDeletedDocs_inlock(numDeleted);
+
             _stats->decInProgressDeletes_inlock();
             _stats->decTotalDeletes_inlock();
 
@@ -404,7 +412,8 @@ namespace mongo {
 
             {
                 scoped_lock sl(_queueMutex);
-                while (_taskQueue.empty()) {
+                TaskList::iterator next = nextRunnableTask_inlock();
+                while (next == _taskQueue.end()) {
                     _taskQueueNotEmptyCV.timed_wait(
                         sl.boost(), duration::milliseconds(NotEmptyTimeoutMillis));
 
@@ -413,36 +422,12 @@ namespace mongo {
                         return;
                     }
 
-                    if (_taskQueue.empty()) {
+                    next = nextRunnableTask_inlock();
+                    if (next == _taskQueue.end()) {
                         // Try to check if some deletes are ready and move them to the
                         // ready queue.
-
-                        TaskList::iterator iter = _notReadyQueue.begin();
-                        while (iter != _notReadyQueue.end()) {
-                            RangeDeleteEntry* entry = *iter;
-
-                            set<CursorId> cursorsNow;
-                            _env->getCursorIds(entry->ns, &cursorsNow);
-
-                            set<CursorId> cursorsLeft;
-                            std::set_intersection(entry->cursorsToWait.begin(),
-                                                  entry->cursorsToWait.end(),
-                                                  cursorsNow.begin(),
-                                                  cursorsNow.end(),
-                                                  std::inserter(cursorsLeft,
-                                                                cursorsLeft.end()));
-
-                            entry->cursorsToWait.swap(cursorsLeft);
-
-                            if (entry->cursorsToWait.empty()) {
-                                _taskQueue.push_back(*iter);
-                                _taskQueueNotEmptyCV.notify_one();
-                                iter = _notReadyQueue.erase(iter);
-                            }
-                            else {
-                                ++iter;
-                            }
-                        }
+                        checkNotReady_inlock();
+                        next = nextRunnableTask_inlock();
                     }
                 }
 
@@ -451,18 +436,21 @@ namespace mongo {
                     return;
                 }
 
-                nextTask = _taskQueue.front();
-                _taskQueue.pop_front();
+                nextTask = *next;
+                _taskQueue.erase(next);
+                _nsInProgress.insert(nextTask->ns);
 
                 _stats->decPendingDeletes_inlock();
                 _stats->incInProgressDeletes_inlock();
             }
 
+            long long numDeleted = 0;
             if (!_env->deleteRange(nextTask->ns,
                                    nextTask->min,
                                    nextTask->max,
                                    nextTask->shardKeyPattern,
                                    nextTask->secondaryThrottle,
+                                   &numDeleted,
                                    &errMsg)) {
                 warning() << "Error encountered while trying to delete range: "
                           << errMsg << endl;
@@ -473,9 +461,16 @@ namespace mongo {
 
                 NSMinMax setEntry(nextTask->ns, nextTask->min, nextTask->max);
                 deletePtrElement(&_deleteSet, &setEntry);
+                _nsInProgress.erase(nextTask->ns);
+                _stats->addDeletedDocs_inlock(numDeleted);
                 _stats->decInProgressDeletes_inlock();
                 _stats->decTotalDeletes_inlock();
 
+                // Another worker may be waiting for a task on the namespace we just released.
+                if (!_taskQueue.empty()) {
+                    _taskQueueNotEmptyCV.notify_all();
+                }
+
                 if (nextTask->notifyDone) {
                     nextTask->notifyDone->notifyOne();
                 }
@@ -486,6 +481,46 @@ namespace mongo {
         }
     }
 
+    RangeDeleter::TaskList::iterator RangeDeleter::nextRunnableTask_inlock() {
+        TaskList::iterator iter = _taskQueue.begin();
+        for (; iter != _taskQueue.end(); ++iter) {
+            if (_nsInProgress.count((*iter)->ns) == 0) {
+                break;
+            }
+        }
+
+        return iter;
+    }
+
+    void RangeDeleter::checkNotReady_inlock() {
+        TaskList::iterator iter = _notReadyQueue.begin();
+        while (iter != _notReadyQueue.end()) {
+            RangeDeleteEntry* entry = *iter;
+
+            set<CursorId> cursorsNow;
+            _env->getCursorIds(entry->ns, &cursorsNow);
+
+            set<CursorId> cursorsLeft;
+            std::set_intersection(entry->cursorsToWait.begin(),
+                                  entry->cursorsToWait.end(),
+                                  cursorsNow.begin(),
+                                  cursorsNow.end(),
+                                  std::inserter(cursorsLeft,
+                                                cursorsLeft.end()));
+
+            entry->cursorsToWait.swap(cursorsLeft);
+
+            if (entry->cursorsToWait.empty()) {
+                _taskQueue.push_back(*iter);
+                _taskQueueNotEmptyCV.notify_one();
+                iter = _notReadyQueue.erase(iter);
+            }
+            else {
+                ++iter;
+            }
+        }
+    }
+
     bool RangeDeleter::isBlacklisted_inlock(const StringData& ns,
                                             const BSONObj& min,
                                             const BSONObj& max,
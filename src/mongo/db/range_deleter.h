@@ -34,6 +34,7 @@
 #include <string>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/cc_by_loc.h" // for typedef CursorId
 #include "mongo/db/jsobj.h"
@@ -53,15 +54,18 @@ namespace mongo {
      *
      * Threading assumptions:
      *
-     *   This class has (currently) one worker thread attacking the queue, one
-     *   job at a time. If we want an immediate deletion, that job is going to
-     *   be performed on the thread that is requesting it.
+     *   This class has a pool of worker threads attacking the queue, each one
+     *   working on one job at a time. Workers never work on the same namespace at
+     *   the same time: a task is skipped while another worker is deleting from its
+     *   namespace, so concurrency comes from deleting ranges of different collections.
+     *   If we want an immediate deletion, that job is going to be performed on the
+     *   thread that is requesting it.
      *
      *   All calls regarding deletion are synchronized.
      *
      * Life cycle:
      *   RangeDeleter* deleter = new RangeDeleter(new ...);
-     *   deleter->startWorkers();
+     *   deleter->startWorkers(numWorkers);
      *   ...
      *   killCurrentOp.killAll(); // stop all deletes
      *   deleter->stopWorkers();
@@ -89,15 +93,15 @@ namespace mongo {
         //
 
         /**
-         * Starts the background thread to work on this queue. Does nothing if the worker
-         * thread is already active.
+         * Starts numWorkers background threads to work on this queue. Does nothing if the
+         * workers are already active.
          *
          * This call is _not_ thread safe and must be issued before any other call.
          */
-        void startWorkers();
+        void startWorkers(int numWorkers = 1);
 
         /**
-         * Stops the background thread working on this queue. This will block if there are
+         * Stops the background threads working on this queue. This will block if there are
          * tasks that are being deleted, but will leave the pending tasks in the queue.
          *
          * Steps:
@@ -200,9 +204,21 @@ namespace mongo {
 
         typedef std::set<NSMinMax*, NSMinMaxCmp> NSMinMaxSet; // owned here
 
-        /** Body of the worker thread */
+        /** Body of the worker threads */
         void doWork();
 
+        /**
+         * Returns the first task in _taskQueue whose namespace no other worker is deleting
+         * from, or _taskQueue.end(). Assumes _queueMutex is held.
+         */
+        TaskList::iterator nextRunnableTask_inlock();
+
+        /**
+         * Moves the tasks in _notReadyQueue whose cursors have all been closed to _taskQueue.
+         * Assumes _queueMutex is held.
+         */
+        void checkNotReady_inlock();
+
         /** Returns true if range is blacklisted. Assumes _queueMutex is held */
         bool isBlacklisted_inlock(const StringData& ns,
                                   const BSONObj& min,
@@ -220,8 +236,8 @@ namespace mongo {
 
         scoped_ptr<RangeDeleterEnv> _env;
 
-        // Initially not active. Must be started explicitly.
-        scoped_ptr<boost::thread> _worker;
+        // Initially empty. Must be started explicitly.
+        OwnedPointerVector<boost::thread> _workers;
 
         // Protects _stopRequested.
         mutable mutex _stopMutex;
@@ -237,9 +253,14 @@ namespace mongo {
         // Protects all the data structure below this.
         mutable mutex _queueMutex;
 
-        // _taskQueue has a task ready to work on.
+        // _taskQueue has a task ready to work on, or a worker finished a task and a task
+        // skipped because of it can now be run.
         boost::condition _taskQueueNotEmptyCV;
 
+        // Namespaces the workers are currently deleting from. Does not include deletes
+        // done with deleteNow.
+        std::set<std::string> _nsInProgress;
+
         // Queue for storing the list of ranges that have cursors pending on it.
         //
         // Note: pointer life cycle is not handled here.
@@ -277,7 +298,8 @@ namespace mongo {
         /**
          * Deletes the documents from the given range. This method should be
          * responsible for making sure that the proper contexts are setup
-         * to be able to perform deletions.
+         * to be able to perform deletions. The number of documents removed is
+         * stored in numDeleted, also when the delete fails part of the way.
          *
          * Must be a synchronous call. Docs should be deleted after call ends.
          * Must not throw Exceptions.
@@ -287,6 +309,7 @@ namespace mongo {
                                  const BSONObj& exclusiveUpper,
                                  const BSONObj& shardKeyPattern,
                                  bool secondaryThrottle,
+                                 long long* numDeleted,
                                  std::string* errMsg) = 0;
 
         /**
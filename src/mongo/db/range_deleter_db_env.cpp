@@ -34,10 +34,71 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/d_logic.h"
 
 namespace mongo {
 
+    // Upper bound on the documents removed per second by all range deletes together.
+    // 0 means no limit.
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxDocsPerSec, int, 0);
+
+namespace {
+
+    // At most this much unused budget carries over, so that an idle deleter can't
+    // build up a long burst.
+    const long long MaxBankedMicros = 1000 * 1000;
+
+    SimpleMutex deleteBudgetMutex("rangeDeleterBudget");
+
+    // Time at which the documents removed so far are paid for. Protected by
+    // deleteBudgetMutex.
+    unsigned long long deleteBudgetPaidUntil = 0;
+
+    /**
+     * Counts the documents removed by one deleteRange call and charges them against the
+     * process wide rangeDeleterMaxDocsPerSec budget, sleeping when it is used up.
+     */
+    class DeleteRateLimiter : public Helpers::RemoveRangePacer {
+    public:
+        DeleteRateLimiter(): _numDeleted(0) {
+        }
+
+        virtual void batchRemoved(long long numDeleted) {
+            _numDeleted += numDeleted;
+
+            const int maxDocsPerSec = rangeDeleterMaxDocsPerSec;
+            if (maxDocsPerSec <= 0 || numDeleted <= 0) {
+                return;
+            }
+
+            const unsigned long long now = curTimeMicros64();
+            long long sleepMicros;
+            {
+                SimpleMutex::scoped_lock sl(deleteBudgetMutex);
+                if (deleteBudgetPaidUntil + MaxBankedMicros < now) {
+                    deleteBudgetPaidUntil = now - MaxBankedMicros;
+                }
+
+                deleteBudgetPaidUntil += numDeleted * 1000 * 1000 / maxDocsPerSec;
+                sleepMicros = static_cast<long long>(deleteBudgetPaidUntil - now);
+            }
+
+            if (sleepMicros > 0) {
+                sleepmicros(sleepMicros);
+            }
+        }
+
+        long long numDeleted() const {
+            return _numDeleted;
+        }
+
+    private:
+        long long _numDeleted;
+    };
+
+} // namespace
+
     /**
      * Outline of the delete process:
      * 1. Initialize the client for this thread if there is no client. This is for the worker
@@ -45,7 +106,7 @@ namespace mongo {
      * 2. Grant this thread authorization to perform deletes.
      * 3. Temporarily enable mode to bypass shard version checks. TODO: Replace this hack.
      * 4. Setup callback to save deletes to moveChunk directory (only if moveParanoia is true).
-     * 5. Delete range.
+     * 5. Delete range, in batches paced by rangeDeleterMaxDocsPerSec.
      * 6. Wait until the majority of the secondaries catch up.
      */
     bool RangeDeleterDBEnv::deleteRange(const StringData& ns,
@@ -53,8 +114,10 @@ namespace mongo {
                                         const BSONObj& exclusiveUpper,
                                         const BSONObj& keyPattern,
                                         bool secondaryThrottle,
+                                        long long* numDeleted,
                                         std::string* errMsg) {
         const bool initiallyHaveClient = haveClient();
+        *numDeleted = 0;
 
         if (!initiallyHaveClient) {
             Client::initThread("RangeDeleter");
@@ -65,6 +128,7 @@ namespace mongo {
         ShardForceVersionOkModeBlock forceVersion;
         {
             Helpers::RemoveSaver removeSaver("moveChunk", ns.toString(), "post-cleanup");
+            DeleteRateLimiter rateLimiter;
 
             // log the opId so the user can use it to cancel the delete using killOp.
             unsigned int opId = cc().curop()->opNum();
@@ -75,7 +139,7 @@ namespace mongo {
                   << endl;
 
             try {
-                long long numDeleted =
+                long long numRemoved =
                         Helpers::removeRange(KeyRange(ns.toString(),
                                                       inclusiveLower,
                                                       exclusiveUpper,
@@ -84,9 +148,11 @@ namespace mongo {
                                              replSet? secondaryThrottle : false,
                                              serverGlobalParams.moveParanoia ? &removeSaver : NULL,
                                              true, /*fromMigrate*/
-                                             true); /*onlyRemoveOrphans*/
+                                             true, /*onlyRemoveOrphans*/
+                                             &rateLimiter);
+                *numDeleted = rateLimiter.numDeleted();
 
-                if (numDeleted < 0) {
+                if (numRemoved < 0) {
                     warning() << "collection or index dropped "
                               << "before data could be cleaned" << endl;
 
@@ -97,13 +163,14 @@ namespace mongo {
                     return false;
                 }
 
-                log() << "rangeDeleter deleted " << numDeleted
+                log() << "rangeDeleter deleted " << numRemoved
                       << " documents for " << ns
                       << " from " << inclusiveLower
                       << " -> " << exclusiveUpper
                       << endl;
             }
             catch (const DBException& ex) {
+                *numDeleted = rateLimiter.numDeleted();
                 *errMsg = str::stream() << "Error encountered while deleting range: "
                                         << "ns" << ns
                                         << " from " << inclusiveLower
@@ -47,6 +47,7 @@ namespace mongo {
 
     RangeDeleterMockEnv::RangeDeleterMockEnv():
         _deleteListMutex("delList"),
+        _docsPerDelete(0),
         _cursorMapMutex("cursorMap"),
         _pauseDeleteMutex("pauseDelete"),
         _pauseDelete(false),
@@ -65,6 +66,11 @@ namespace mongo {
         _cursorMap[ns.toString()].erase(id);
     }
 
+    void RangeDeleterMockEnv::setDocsPerDelete(long long numDocs) {
+        scoped_lock sl(_deleteListMutex);
+        _docsPerDelete = numDocs;
+    }
+
     void RangeDeleterMockEnv::pauseDeletes() {
         scoped_lock sl(_pauseDeleteMutex);
         _pauseDelete = true;
@@ -105,6 +111,7 @@ namespace mongo {
                                           const BSONObj& max,
                                           const BSONObj& shardKeyPattern,
                                           bool secondaryThrottle,
+                                          long long* numDeleted,
                                           string* errMsg) {
 
         {
@@ -133,6 +140,7 @@ namespace mongo {
             entry.shardKeyPattern = shardKeyPattern.getOwned();
 
             _deleteList.push_back(entry);
+            *numDeleted = _docsPerDelete;
         }
 
         return true;
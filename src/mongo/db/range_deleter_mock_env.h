@@ -74,6 +74,11 @@ namespace mongo {
          */
         void removeCursorId(const StringData& ns, CursorId id);
 
+        /**
+         * Sets the number of documents every subsequent deleteRange reports as removed.
+         */
+        void setDocsPerDelete(long long numDocs);
+
         //
         // Environment synchronization methods.
         //
@@ -129,6 +134,7 @@ namespace mongo {
                          const BSONObj& max,
                          const BSONObj& shardKeyPattern,
                          bool secondaryThrottle,
+                         long long* numDeleted,
                          string* errMsg);
 
         /**
@@ -144,6 +150,7 @@ namespace mongo {
 
         mutable mutex _deleteListMutex;
         std::vector<DeletedRange> _deleteList;
+        long long _docsPerDelete;
 
         mutex _cursorMapMutex;
         std::map<std::string, std::set<CursorId> > _cursorMap;
@@ -29,7 +29,9 @@
 #include "mongo/db/range_deleter_service.h"
 
 #include "mongo/base/init.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/range_deleter_db_env.h"
+#include "mongo/db/range_deleter_stats.h"
 
 namespace {
 
@@ -46,4 +48,14 @@ namespace mongo {
     RangeDeleter* getDeleter() {
         return _deleter;
     }
+
+    class RangeDeleterServerStatus : public ServerStatusSection {
+    public:
+        RangeDeleterServerStatus() : ServerStatusSection("rangeDeleter") {}
+        virtual bool includeByDefault() const { return false; }
+
+        BSONObj generateSection(const BSONElement& configElement) const {
+            return getDeleter()->getStats()->toBSON();
+        }
+    } rangeDeleterServerStatus;
 }
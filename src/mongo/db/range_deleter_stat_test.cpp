@@ -201,6 +201,36 @@ namespace {
         deleter.stopWorkers();
     }
 
+    TEST(QueuedDeletes, DocsDeleted) {
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+
+        const string ns("test.user");
+        env->setDocsPerDelete(25);
+        deleter.startWorkers();
+
+        Notification notifyDone1;
+        ASSERT_TRUE(deleter.queueDelete(ns, BSON("x" << 0), BSON("x" << 10), BSON("x" << 1),
+                                        true, &notifyDone1, NULL /* errMsg not needed */));
+
+        Notification notifyDone2;
+        ASSERT_TRUE(deleter.queueDelete(ns, BSON("x" << 10), BSON("x" << 20), BSON("x" << 1),
+                                        true, &notifyDone2, NULL /* errMsg not needed */));
+
+        notifyDone1.waitToBeNotified();
+        notifyDone2.waitToBeNotified();
+
+        const BSONObj stats(deleter.getStats()->toBSON());
+
+        long long docsDeleted = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::DocsDeletedField,
+                                         &docsDeleted, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(50, docsDeleted);
+        ASSERT_TRUE(stats.hasField(RangeDeleterStats::DocsDeletedPerSecField.name()));
+
+        deleter.stopWorkers();
+    }
+
     TEST(ImmediateDeletes, NotReady) {
         RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
         RangeDeleter deleter(env);
@@ -32,6 +32,8 @@ namespace mongo {
     const BSONField<int> RangeDeleterStats::TotalDeletesField("totalDeletes");
     const BSONField<int> RangeDeleterStats::PendingDeletesField("pendingDeletes");
     const BSONField<int> RangeDeleterStats::InProgressDeletesField("inProgressDeletes");
+    const BSONField<long long> RangeDeleterStats::DocsDeletedField("docsDeleted");
+    const BSONField<double> RangeDeleterStats::DocsDeletedPerSecField("docsDeletedPerSec");
 
     BSONObj RangeDeleterStats::toBSON() const {
         scoped_lock sl(*_lockPtr);
@@ -40,6 +42,14 @@ namespace mongo {
         builder << TotalDeletesField(_totalDeletes);
         builder << PendingDeletesField(_pendingDeletes);
         builder << InProgressDeletesField(_inProgressDeletes);
+        builder << DocsDeletedField(_docsDeleted);
+
+        unsigned long long busyMillis = _busyMillis;
+        if (_inProgressDeletes > 0) {
+            busyMillis += curTimeMillis64() - _busySince;
+        }
+        builder << DocsDeletedPerSecField(busyMillis == 0 ? 0.0 :
+                                          _docsDeleted * 1000.0 / busyMillis);
 
         return builder.obj();
     }
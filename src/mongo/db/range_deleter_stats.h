@@ -32,6 +32,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/cstdint.h"
 #include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
     /**
@@ -52,6 +53,13 @@ namespace mongo {
         // Total number of deletes that are currently in progress.
         static const BSONField<int> InProgressDeletesField;
 
+        // Total number of documents removed by finished deletes.
+        static const BSONField<long long> DocsDeletedField;
+
+        // Documents removed per second of time during which at least one delete was in
+        // progress. Only counts finished deletes.
+        static const BSONField<double> DocsDeletedPerSecField;
+
         /**
          * Creates a stat object given the mutex from the RangeDeleter object
          * that this instance is keeping track of.
@@ -60,7 +68,10 @@ namespace mongo {
             _lockPtr(lockPtr),
             _totalDeletes(0),
             _pendingDeletes(0),
-            _inProgressDeletes(0) {
+            _inProgressDeletes(0),
+            _docsDeleted(0),
+            _busyMillis(0),
+            _busySince(0) {
         }
 
         /**
@@ -93,11 +104,19 @@ namespace mongo {
         }
 
         void incInProgressDeletes_inlock() {
-            _inProgressDeletes++;
+            if (_inProgressDeletes++ == 0) {
+                _busySince = curTimeMillis64();
+            }
         }
 
         void decInProgressDeletes_inlock() {
-            _inProgressDeletes--;
+            if (--_inProgressDeletes == 0) {
+                _busyMillis += curTimeMillis64() - _busySince;
+            }
+        }
+
+        void addDeletedDocs_inlock(long long numDeleted) {
+            _docsDeleted += numDeleted;
         }
 
         bool hasInProgress_inlock() {
@@ -111,5 +130,12 @@ namespace mongo {
         int _totalDeletes;
         int _pendingDeletes;
         int _inProgressDeletes;
+
+        long long _docsDeleted;
+
+        // Time spent with at least one delete in progress, not counting the current stretch
+        // which started at _busySince.
+        unsigned long long _busyMillis;
+        unsigned long long _busySince;
     };
 }
@@ -35,6 +35,7 @@
 #include "mongo/db/range_deleter_mock_env.h"
 #include "mongo/db/range_deleter_stats.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
 
 namespace {
 
@@ -339,6 +340,90 @@ namespace {
         deleter.stopWorkers();
     }
 
+    // Workers should delete from different namespaces at the same time.
+    TEST(MultipleWorkers, ConcurrentAcrossNamespaces) {
+        const string ns1("test.user");
+        const string ns2("test.events");
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+        deleter.startWorkers(2);
+
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        ASSERT_TRUE(deleter.queueDelete(ns1, BSON("x" << 0), BSON("x" << 10), BSON("x" << 1),
+                                        true, &notifyDone1, NULL /* errMsg not needed */));
+
+        Notification notifyDone2;
+        ASSERT_TRUE(deleter.queueDelete(ns2, BSON("x" << 0), BSON("x" << 10), BSON("x" << 1),
+                                        true, &notifyDone2, NULL /* errMsg not needed */));
+
+        // Both deletes have to be paused inside the environment at the same time.
+        env->waitForNthPausedDelete(2u);
+
+        const BSONObj stats(deleter.getStats()->toBSON());
+        int inProgressCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::InProgressDeletesField,
+                                         &inProgressCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(2, inProgressCount);
+
+        env->resumeOneDelete();
+        env->resumeOneDelete();
+
+        notifyDone1.waitToBeNotified();
+        notifyDone2.waitToBeNotified();
+
+        deleter.stopWorkers();
+    }
+
+    // Workers should not delete from the same namespace at the same time.
+    TEST(MultipleWorkers, SerializedWithinNamespace) {
+        const string ns("test.user");
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+        deleter.startWorkers(2);
+
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        ASSERT_TRUE(deleter.queueDelete(ns, BSON("x" << 0), BSON("x" << 10), BSON("x" << 1),
+                                        true, &notifyDone1, NULL /* errMsg not needed */));
+
+        env->waitForNthPausedDelete(1u);
+
+        Notification notifyDone2;
+        ASSERT_TRUE(deleter.queueDelete(ns, BSON("x" << 10), BSON("x" << 20), BSON("x" << 1),
+                                        true, &notifyDone2, NULL /* errMsg not needed */));
+
+        // Give the idle worker a chance to (wrongly) pick up the second delete.
+        mongo::sleepmillis(500);
+
+        const BSONObj stats(deleter.getStats()->toBSON());
+        int inProgressCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::InProgressDeletesField,
+                                         &inProgressCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(1, inProgressCount);
+
+        int pendingCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::PendingDeletesField,
+                                         &pendingCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(1, pendingCount);
+
+        env->resumeOneDelete();
+        notifyDone1.waitToBeNotified();
+
+        env->waitForNthPausedDelete(2u);
+        env->resumeOneDelete();
+        notifyDone2.waitToBeNotified();
+
+        DeletedRange deleted(env->getLastDelete());
+        ASSERT_TRUE(deleted.min.equal(BSON("x" << 10)));
+
+        deleter.stopWorkers();
+    }
+
     // Should not be able to delete ranges that overlaps with a black listed range.
     TEST(BlackList, CantDeleteBlackListed) {
         RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
@@ -56,6 +56,7 @@
 #include "mongo/db/storage_options.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/crc32c.h"
 #include "mongo/util/goodies.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -207,10 +208,18 @@ namespace mongo {
                 const bool compressed = rawSize < 0;
                 const int32_t blockSize = std::abs(rawSize);
 
+                uint32_t checksum;
+                read(&checksum, sizeof(checksum));
+                massert(17298, "file too short?", !_done);
+
                 _buffer.reset(new char[blockSize]);
                 read(_buffer.get(), blockSize);
                 massert(16816, "file too short?", !_done);
 
+                massert(17299, str::stream() << "checksum mismatch in sort file \""
+                                             << _fileName << '"',
+                        crc32c(0, _buffer.get(), blockSize) == checksum);
+
                 if (!compressed) {
                     _reader.reset(new BufReader(_buffer.get(), blockSize));
                     return;
@@ -816,14 +825,19 @@ namespace mongo {
         snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
         verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
+        // each block is: int32 size (negative if compressed), uint32 crc32c of the data, data
         try {
             if (compressed.size() < size_t(_buffer.len()/10*9)) {
                 const int32_t size = -int32_t(compressed.size()); // negative means compressed
+                const uint32_t checksum = crc32c(0, compressed.data(), compressed.size());
                 _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
                 _file.write(compressed.data(), compressed.size());
             } else {
                 const int32_t size = _buffer.len();
+                const uint32_t checksum = crc32c(0, _buffer.buf(), _buffer.len());
                 _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+                _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
                 _file.write(_buffer.buf(), _buffer.len());
             }
         } catch (const std::exception&) {
@@ -0,0 +1,133 @@
+// compression_estimate.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/db/storage/compression_estimate.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "mongo/db/structure/collection.h"
+#include "mongo/db/structure/collection_iterator.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    namespace {
+
+        void finishBlock( BufBuilder& buf, std::vector<std::string>* blocks ) {
+            blocks->push_back( std::string() );
+            compress( buf.buf(), buf.len(), &blocks->back() );
+            buf.reset();
+        }
+
+        /** @return the number of documents in a decompressed block */
+        long long walkBlock( const std::string& data ) {
+            long long n = 0;
+            size_t pos = 0;
+            while ( pos < data.size() ) {
+                massert( 17294, "corrupt compressed block", data.size() - pos >= 4 );
+                int size;
+                memcpy( &size, data.data() + pos, 4 );
+                massert( 17304, "corrupt compressed block",
+                         size >= 5 && size_t( size ) <= data.size() - pos );
+
+                BSONObj obj( data.data() + pos );
+                pos += obj.objsize();
+                n++;
+            }
+            return n;
+        }
+
+    }
+
+    const int CompressionEstimate::DefaultBlockSize;
+    const long long CompressionEstimate::MaxSampleRecords;
+    const long long CompressionEstimate::MaxSampleBytes;
+
+    void CompressionEstimate::appendTo( BSONObjBuilder* out, int scale ) const {
+        BSONObjBuilder b( out->subobjStart( "compression" ) );
+        b.append( "blockSize", blockSize );
+        b.appendNumber( "sampledRecords", records );
+        b.appendNumber( "blocks", blocks );
+        b.appendNumber( "uncompressedSize", uncompressedBytes / scale );
+        b.appendNumber( "compressedSize", compressedBytes / scale );
+        b.append( "ratio", compressedBytes ? double( uncompressedBytes ) / compressedBytes : 0.0 );
+        b.appendNumber( "decompressMicros", decompressMicros );
+        b.append( "decompressMBps",
+                  decompressMicros ? double( uncompressedBytes ) / decompressMicros : 0.0 );
+        b.done();
+    }
+
+    CompressionEstimate CompressionEstimate::sample( Collection* collection,
+                                                     long long maxRecords,
+                                                     int blockSize ) {
+        CompressionEstimate stats;
+        stats.blockSize = blockSize;
+
+        std::vector<std::string> blocks;
+        BufBuilder buf( blockSize );
+
+        boost::scoped_ptr<CollectionIterator> it(
+            collection->getIterator( DiskLoc(), false, CollectionScanParams::FORWARD ) );
+        while ( stats.records < maxRecords
+                && stats.uncompressedBytes < MaxSampleBytes
+                && !it->isEOF() ) {
+            BSONObj obj = collection->docFor( it->getNext() );
+            // a document larger than the block size gets a block to itself
+            if ( buf.len() > 0 && buf.len() + obj.objsize() > blockSize )
+                finishBlock( buf, &blocks );
+            buf.appendBuf( obj.objdata(), obj.objsize() );
+            stats.records++;
+            stats.uncompressedBytes += obj.objsize();
+        }
+        if ( buf.len() > 0 )
+            finishBlock( buf, &blocks );
+
+        stats.blocks = blocks.size();
+
+        std::string data;
+        long long seen = 0;
+        Timer t;
+        for ( size_t i = 0; i < blocks.size(); i++ ) {
+            stats.compressedBytes += blocks[i].size();
+            data.clear();
+            verify( uncompress( blocks[i].data(), blocks[i].size(), &data ) );
+            seen += walkBlock( data );
+        }
+        stats.decompressMicros = t.micros();
+        verify( seen == stats.records );
+
+        return stats;
+    }
+
+}
@@ -0,0 +1,77 @@
+// compression_estimate.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    class Collection;
+
+    /**
+     * Estimate of what snappy block compression would save for a collection, reported by
+     * collStats { compressionSample: <n> }.  Records are not stored compressed; this only packs
+     * a sample of them into blocks in memory to measure the ratio and the decompression cost.
+     */
+    class CompressionEstimate {
+    public:
+        static const int DefaultBlockSize = 32 * 1024;
+
+        // The sample is taken under the read lock without yielding, so it is kept small
+        static const long long MaxSampleRecords = 10 * 1000;
+        static const long long MaxSampleBytes = 16 * 1024 * 1024;
+
+        CompressionEstimate()
+            : blockSize( 0 ), records( 0 ), blocks( 0 ), uncompressedBytes( 0 ),
+              compressedBytes( 0 ), decompressMicros( 0 ) {}
+
+        /**
+         * Packs up to maxRecords documents of 'collection', in natural order, back to back into
+         * blocks of blockSize bytes, compresses each block as a unit and times decompressing
+         * and walking them again.  Sampling stops early after MaxSampleBytes.  Caller must hold
+         * at least a read lock.
+         */
+        static CompressionEstimate sample( Collection* collection,
+                                           long long maxRecords,
+                                           int blockSize );
+
+        /** appends the 'compression' section of collStats; sizes are divided by scale */
+        void appendTo( BSONObjBuilder* out, int scale ) const;
+
+        int blockSize;
+        long long records;
+        long long blocks;
+        long long uncompressedBytes;
+        long long compressedBytes;
+        long long decompressMicros;
+    };
+
+}
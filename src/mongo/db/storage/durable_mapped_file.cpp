@@ -59,6 +59,47 @@ namespace mongo {
         fassert( 16112, _view_private == old );
     }
 
+    void DurableMappedFile::noteDirty(size_t ofs, unsigned len) {
+        if( len == 0 )
+            return;
+        const size_t end = ofs + len;
+        for( size_t s = ofs / RemapSliceBytes; s * RemapSliceBytes < end; s++ ) {
+            size_t from = max<size_t>(ofs, s * RemapSliceBytes);
+            size_t to = min<size_t>(end, (s + 1) * RemapSliceBytes);
+            _dirtySlices[(unsigned) s].bytes += to - from;
+        }
+    }
+
+    unsigned long long DurableMappedFile::remapThePrivateViewSlice(unsigned slice) {
+        verify(storageGlobalParams.dur);
+
+#if defined(_WIN32)
+        // views are unmapped and mapped again a chunk at a time on windows, there is no partial remap
+        remapThePrivateView();
+        _dirtySlices.clear();
+        _willNeedRemap = false;
+        return length();
+#else
+        const unsigned long long len = length();
+        const unsigned long long ofs = (unsigned long long) slice * RemapSliceBytes;
+        unsigned long long n = 0;
+        if( ofs < len ) {
+            n = len - ofs;
+            if( n > RemapSliceBytes )
+                n = RemapSliceBytes;
+            void *old = _view_private;
+            _view_private = remapPrivateView(_view_private, ofs, n);
+            fassert( 17297, _view_private == old );
+        }
+
+        // writes from here on mark the slice dirty again
+        _dirtySlices.erase(slice);
+        if( _dirtySlices.empty() )
+            _willNeedRemap = false;
+        return n;
+#endif
+    }
+
     /** register view. threadsafe */
     void PointerToDurableMappedFile::add(void *view, DurableMappedFile *f) {
         verify(view);
@@ -97,6 +97,33 @@ namespace mongo {
 
         void remapThePrivateView();
 
+        /** a RemapSliceBytes piece of the private view written since it was last remapped */
+        struct DirtySlice {
+            DirtySlice() : bytes(0), since(0) { }
+            unsigned long long bytes; // journaled into the slice since it was last remapped
+            unsigned long long since; // when REMAPPRIVATEVIEW first saw it dirty, 0 if it hasn't yet
+        };
+        typedef std::map<unsigned, DirtySlice> DirtySlices; // by slice number
+
+        /** note len bytes journaled at ofs in the view.  called in PREPLOGBUFFER */
+        void noteDirty(size_t ofs, unsigned len);
+
+        /** the slices of the private view that need remapping.  REMAPPRIVATEVIEW remaps the
+            dirtiest first.
+        */
+        DirtySlices& dirtySlices() { return _dirtySlices; }
+
+        /** remap one dirty slice of the private view (the last slice of the file may be shorter).
+            on windows the whole view is remapped.
+            @return bytes remapped
+        */
+        unsigned long long remapThePrivateViewSlice(unsigned slice);
+
+        /** granularity of partial remaps.  a multiple of the huge page size so slices don't split
+            a huge page.
+        */
+        static const unsigned long long RemapSliceBytes = 2 * 1024 * 1024;
+
         virtual bool isDurableMappedFile() { return true; }
 
     private:
@@ -104,6 +131,7 @@ namespace mongo {
         void *_view_write;
         void *_view_private;
         bool _willNeedRemap;
+        DirtySlices _dirtySlices;
         RelativePath _p;   // e.g. "somepath/dbname"
         int _fileSuffixNo;  // e.g. 3.  -1="ns"
 
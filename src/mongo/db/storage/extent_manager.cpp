@@ -31,6 +31,7 @@
 #include "mongo/pch.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <fstream>
 
 #include "mongo/db/client.h"
 #include "mongo/db/d_concurrency.h"
@@ -51,7 +52,8 @@ namespace mongo {
         : _dbname( dbname.toString() ),
           _path( path.toString() ),
           _freeListDetails( freeListDetails ),
-          _directoryPerDB( directoryPerDB ) {
+          _directoryPerDB( directoryPerDB ),
+          _openMutex( "ExtentManager::_openMutex" ) {
     }
 
     ExtentManager::~ExtentManager() {
@@ -60,9 +62,10 @@ namespace mongo {
 
     void ExtentManager::reset() {
         for ( size_t i = 0; i < _files.size(); i++ ) {
-            delete _files[i];
+            delete _fileAt( i );
         }
         _files.clear();
+        _fileLengths.clear();
     }
 
     boost::filesystem::path ExtentManager::fileName( int n ) const {
@@ -79,6 +82,8 @@ namespace mongo {
     Status ExtentManager::init() {
         verify( _files.size() == 0 );
 
+        // we only look at the files here.  mapping them all up front makes opening a database
+        // with many files (or a server with many databases) slow, so that waits for first use.
         for ( int n = 0; n < DiskLoc::MaxFiles; n++ ) {
             boost::filesystem::path fullName = fileName( n );
             if ( !boost::filesystem::exists( fullName ) )
@@ -86,31 +91,53 @@ namespace mongo {
 
             string fullNameString = fullName.string();
 
-            auto_ptr<DataFile> df( new DataFile(n) );
-
-            Status s = df->openExisting( fullNameString.c_str() );
-            if ( !s.isOK() ) {
-                return s;
+            int version = 0;
+            {
+                std::ifstream f( fullNameString.c_str(), std::ios::in | std::ios::binary );
+                if ( !f.read( reinterpret_cast<char*>( &version ), sizeof( version ) ) ) {
+                    return Status( ErrorCodes::InternalError,
+                                   str::stream() << "couldn't read header of " << fullNameString );
+                }
             }
-
-            if ( df->getHeader()->uninitialized() ) {
-                // pre-alloc only, so we're done
+            if ( version == 0 ) {
+                // pre-alloc only (DataFileHeader::uninitialized()), so we're done
                 break;
             }
 
-            _files.push_back( df.release() );
+            _files.push_back( AtomicWord<uintptr_t>() );
+            _fileLengths.push_back( boost::filesystem::file_size( fullName ) );
         }
 
         return Status::OK();
     }
 
+    DataFile* ExtentManager::_openExisting( int n ) const {
+        SimpleMutex::scoped_lock lk( _openMutex );
+        if ( DataFile* f = _fileAt( n ) )
+            return f; // someone else got here first
+
+        string fullNameString = fileName( n ).string();
+        auto_ptr<DataFile> df( new DataFile(n) );
+        Status s = df->openExisting( fullNameString.c_str() );
+        if ( !s.isOK() ) {
+            msgasserted( 17300, str::stream() << "couldn't open " << fullNameString << ": "
+                                              << s.toString() );
+        }
+        // publish only once fully opened; readers may not hold _openMutex
+        _setFile( n, df.get() );
+        return df.release();
+    }
+
     const DataFile* ExtentManager::_getOpenFile( int n ) const {
         verify(this);
         DEV Lock::assertAtLeastReadLocked( _dbname );
         if ( n < 0 || n >= static_cast<int>(_files.size()) )
             log() << "uh oh: " << n;
         verify( n >= 0 && n < static_cast<int>(_files.size()) );
-        return _files[n];
+        const DataFile* f = _fileAt( n );
+        if ( f )
+            return f;
+        return _openExisting( n );
     }
 
 
@@ -138,9 +165,12 @@ namespace mongo {
                     log() << "       context ns: " << cc().ns() << endl;
                     verify(false);
                 }
-                _files.push_back(0);
+                _files.push_back( AtomicWord<uintptr_t>() );
+                _fileLengths.push_back(0);
             }
-            p = _files[n];
+            p = _fileAt( n );
+            if ( p == 0 && _fileLengths[n] )
+                p = _openExisting( n );
         }
         if ( p == 0 ) {
             DEV Lock::assertWriteLocked( _dbname );
@@ -148,8 +178,8 @@ namespace mongo {
             string fullNameString = fullName.string();
             p = new DataFile(n);
             int minSize = 0;
-            if ( n != 0 && _files[ n - 1 ] )
-                minSize = _files[ n - 1 ]->getHeader()->fileLength;
+            if ( n != 0 && n - 1 < static_cast<int>(_files.size()) && _fileLengths[ n - 1 ] )
+                minSize = getFile( n - 1 )->getHeader()->fileLength;
             if ( sizeNeeded + DataFileHeader::HeaderSize > minSize )
                 minSize = sizeNeeded + DataFileHeader::HeaderSize;
             try {
@@ -159,10 +189,13 @@ namespace mongo {
                 delete p;
                 throw;
             }
-            if ( preallocateOnly )
+            if ( preallocateOnly ) {
                 delete p;
-            else
-                _files[n] = p;
+            }
+            else {
+                _setFile( n, p );
+                _fileLengths[n] = p->length();
+            }
         }
         return preallocateOnly ? 0 : p;
     }
@@ -183,16 +216,21 @@ namespace mongo {
 
     long long ExtentManager::fileSize() const {
         long long size=0;
-        for ( int n = 0; boost::filesystem::exists( fileName(n) ); n++)
+        int n = 0;
+        for ( ; n < static_cast<int>(_fileLengths.size()) && _fileLengths[n]; n++ )
+            size += _fileLengths[n];
+        // data files don't change size once created, but there may be a preallocated one beyond
+        for ( ; boost::filesystem::exists( fileName(n) ); n++)
             size += boost::filesystem::file_size( fileName(n) );
         return size;
     }
 
     void ExtentManager::flushFiles( bool sync ) {
         DEV Lock::assertAtLeastReadLocked( _dbname );
-        for( vector<DataFile*>::iterator i = _files.begin(); i != _files.end(); i++ ) {
-            DataFile *f = *i;
-            f->flush(sync);
+        for ( size_t i = 0; i < _files.size(); i++ ) {
+            DataFile *f = _fileAt( i );
+            if ( f )
+                f->flush(sync);
         }
     }
 
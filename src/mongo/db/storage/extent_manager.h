@@ -38,6 +38,8 @@
 #include "mongo/base/status.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/diskloc.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
@@ -84,11 +86,16 @@ namespace mongo {
         void init( NamespaceDetails* freeListDetails );
 
         /**
-         * opens all current files
+         * finds all current files.  they are not mapped until first used.
          */
         Status init();
 
         size_t numFiles() const;
+
+        /**
+         * total size of the data files, including a preallocated next file.  only files past the
+         * ones we know about are stat'ed.
+         */
         long long fileSize() const;
 
         DataFile* getFile( int n, int sizeNeeded = 0, bool preallocateOnly = false );
@@ -168,6 +175,17 @@ namespace mongo {
 
         const DataFile* _getOpenFile( int n ) const;
 
+        /** maps existing file n, which init() found, on first use.  ok in a read lock. */
+        DataFile* _openExisting( int n ) const;
+
+        /** entry n of _files; acquire load, as _openExisting() may be storing it concurrently */
+        DataFile* _fileAt( int n ) const {
+            return reinterpret_cast<DataFile*>( _files[n].load() );
+        }
+        void _setFile( int n, DataFile* f ) const {
+            _files[n].store( reinterpret_cast<uintptr_t>( f ) );
+        }
+
         DiskLoc _createExtentInFile( int fileNo, DataFile* f,
                                      int size, int maxFileNoForQuota );
 
@@ -180,10 +198,18 @@ namespace mongo {
         NamespaceDetails* _freeListDetails;
         bool _directoryPerDB;
 
-        // must be in the dbLock when touching this (and write locked when writing to of course)
+        // must be in the dbLock when touching this (and write locked when growing it of course)
         // however during Database object construction we aren't, which is ok as it isn't yet visible
         //   to others and we are in the dbholder lock then.
-        std::vector<DataFile*> _files;
+        // an entry is NULL until the file is mapped; files found by init() are mapped on first
+        //   use, under _openMutex as that may happen in a read lock.  so entries are atomic and
+        //   only accessed through _fileAt() and _setFile().
+        mutable std::vector< AtomicWord<uintptr_t> > _files;
+
+        // length of each file in _files, 0 if not known to exist on disk yet
+        std::vector<long long> _fileLengths;
+
+        mutable SimpleMutex _openMutex;
 
     };
 
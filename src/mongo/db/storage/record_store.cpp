@@ -30,6 +30,8 @@
 
 #include "mongo/db/storage/record_store.h"
 
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_details.h"
 #include "mongo/db/storage/extent.h"
 
 #include "mongo/db/pdfile.h" // XXX-ERH
@@ -37,7 +39,11 @@
 namespace mongo {
 
     RecordStore::RecordStore( const StringData& ns )
-        : _ns( ns.toString() ) {
+        : _ns( ns.toString() ),
+          _nAllocs( 0 ),
+          _nProbes( 0 ),
+          _maxProbes( 0 ),
+          _nNewExtents( 0 ) {
         _extentManager = NULL;
         _details = NULL;
     }
@@ -50,8 +56,21 @@ namespace mongo {
         _isSystemIndexes = isSystemIndexes;
     }
 
+    DiskLoc RecordStore::_alloc( int lengthWithHeaders ) {
+        int probes = 0;
+        DiskLoc loc = _details->alloc( _ns, lengthWithHeaders, &probes );
+        _nAllocs++;
+        _nProbes += probes;
+        _maxProbes = std::max( _maxProbes, probes );
+        return loc;
+    }
+
+    DiskLoc RecordStore::allocRecordFromFreeSpace( int lengthWithHeaders ) {
+        return _alloc( lengthWithHeaders );
+    }
+
     StatusWith<DiskLoc> RecordStore::allocRecord( int lengthWithHeaders, int quotaMax ) {
-        DiskLoc loc = _details->alloc( _ns, lengthWithHeaders );
+        DiskLoc loc = _alloc( lengthWithHeaders );
         if ( !loc.isNull() )
             return StatusWith<DiskLoc>( loc );
 
@@ -65,8 +84,9 @@ namespace mongo {
                                              Extent::followupSize( lengthWithHeaders,
                                                                    _details->lastExtentSize()),
                                              quotaMax );
+        _nNewExtents++;
 
-        loc = _details->alloc( _ns, lengthWithHeaders );
+        loc = _alloc( lengthWithHeaders );
         if ( !loc.isNull() ) {
             // got on first try
             return StatusWith<DiskLoc>( loc );
@@ -83,8 +103,9 @@ namespace mongo {
                                                  Extent::followupSize( lengthWithHeaders,
                                                                        _details->lastExtentSize()),
                                                  quotaMax );
+            _nNewExtents++;
 
-            loc = _details->alloc( _ns, lengthWithHeaders);
+            loc = _alloc( lengthWithHeaders );
             if ( ! loc.isNull() )
                 return StatusWith<DiskLoc>( loc );
         }
@@ -150,4 +171,55 @@ namespace mongo {
 
     }
 
+    void RecordStore::appendAllocationStats( BSONObjBuilder* b ) const {
+        BSONObjBuilder sub( b->subobjStart( "allocation" ) );
+        sub.appendNumber( "allocs", _nAllocs );
+        sub.appendNumber( "probes", _nProbes );
+        sub.append( "avgProbes", _nAllocs ? double( _nProbes ) / _nAllocs : 0.0 );
+        sub.append( "maxProbes", _maxProbes );
+        sub.appendNumber( "newExtents", _nNewExtents );
+        sub.done();
+    }
+
+    void RecordStore::appendFreeListStats( BSONObjBuilder* b, int scale ) const {
+        if ( _details->isCapped() ) {
+            // capped collections reuse the deleted lists for their own bookkeeping
+            return;
+        }
+
+        BSONObjBuilder sub( b->subobjStart( "freeList" ) );
+        BSONArrayBuilder buckets( sub.subarrayStart( "buckets" ) );
+
+        long long totalCount = 0;
+        long long totalBytes = 0;
+        int largest = 0;
+        for ( int i = 0; i < Buckets; i++ ) {
+            long long count = 0;
+            long long bytes = 0;
+            for ( DiskLoc dl = _details->deletedListEntry( i ); !dl.isNull();
+                  dl = dl.drec()->nextDeleted() ) {
+                int len = dl.drec()->lengthWithHeaders();
+                count++;
+                bytes += len;
+                largest = std::max( largest, len );
+            }
+            if ( count ) {
+                buckets.append( BSON( "maxSize" << bucketSizes[i]
+                                      << "count" << count
+                                      << "size" << bytes / scale ) );
+            }
+            totalCount += count;
+            totalBytes += bytes;
+        }
+        buckets.done();
+
+        sub.appendNumber( "count", totalCount );
+        sub.appendNumber( "size", totalBytes / scale );
+        sub.append( "largest", largest / scale );
+        // share of free space that could not serve a single allocation of the largest free size
+        sub.append( "fragmentation",
+                    totalBytes ? 1.0 - double( largest ) / totalBytes : 0.0 );
+        sub.done();
+    }
+
 }
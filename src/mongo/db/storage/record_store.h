@@ -34,6 +34,7 @@
 
 namespace mongo {
 
+    class BSONObjBuilder;
     class ExtentManager;
     class NamespaceDetails;
     class Record;
@@ -50,11 +51,34 @@ namespace mongo {
 
         StatusWith<DiskLoc> allocRecord( int lengthWithHeaders, int quotaMax );
 
+        /**
+         * Like allocRecord(), but only from the collection's existing free space; never adds an
+         * extent.  @return null if there is no deleted record large enough
+         */
+        DiskLoc allocRecordFromFreeSpace( int lengthWithHeaders );
+
+        /** allocation counters since the collection was opened */
+        void appendAllocationStats( BSONObjBuilder* b ) const;
+
+        /**
+         * Reports free space per deleted list bucket and how fragmented it is. This walks every
+         * deleted record so it is only done on request.
+         */
+        void appendFreeListStats( BSONObjBuilder* b, int scale ) const;
+
     private:
+        DiskLoc _alloc( int lengthWithHeaders );
+
         std::string _ns;
         NamespaceDetails* _details;
         ExtentManager* _extentManager;
         bool _isSystemIndexes;
+
+        // protected by the database write lock
+        long long _nAllocs;
+        long long _nProbes;
+        int _maxProbes;
+        long long _nNewExtents;
     };
 
 }
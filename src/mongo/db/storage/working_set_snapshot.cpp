@@ -0,0 +1,497 @@
+// working_set_snapshot.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/storage/working_set_snapshot.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/data_file.h"
+#include "mongo/db/storage/durable_mapped_file.h"
+#include "mongo/db/storage/extent.h"
+#include "mongo/db/storage_options.h"
+#include "mongo/util/background.h"
+#include "mongo/util/bufreader.h"
+#include "mongo/util/file.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    // 0 disables snapshots and replay
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER( workingSetSnapshotIntervalSecs, int, 0 );
+    MONGO_EXPORT_SERVER_PARAMETER( workingSetReplayMBPerSec, int, 100 );
+
+    namespace {
+
+        const unsigned SnapshotMagic = 0x53575357; // "WSWS"
+        const unsigned SnapshotVersion = 1;
+        const char SnapshotFileName[] = "mongod.workingset";
+
+        // mincore() and touch this many pages at a time
+        const size_t PagesPerStep = 256;
+
+        /**
+         * File format, all integers in host byte order:
+         *   unsigned magic, unsigned version, unsigned pageSize, unsigned nFiles
+         *   nFiles times:
+         *     filename (NUL terminated), unsigned long long length, bitmap of
+         *     ceil(length / pageSize) bits, bit i set when page i was resident
+         */
+        struct FileResidency {
+            string filename;
+            unsigned long long length;
+            vector<unsigned char> bitmap;
+
+            bool test( size_t page ) const { return bitmap[page / 8] & ( 1 << ( page % 8 ) ); }
+            void clear( size_t page ) { bitmap[page / 8] &= ~( 1 << ( page % 8 ) ); }
+        };
+
+        string snapshotPath() {
+            return ( boost::filesystem::path( storageGlobalParams.dbpath ) / SnapshotFileName )
+                .string();
+        }
+
+        size_t numPages( unsigned long long length, size_t pageSize ) {
+            return static_cast<size_t>( ( length + pageSize - 1 ) / pageSize );
+        }
+
+        /** MongoFile::forEach functor listing the mapped data files */
+        class MappedFileLister {
+        public:
+            MappedFileLister( vector<FileResidency>* out ) : _out( out ) {}
+
+            void operator()( MongoFile* mf ) {
+                if ( !mf->isDurableMappedFile() )
+                    return;
+                DurableMappedFile* mmf = (DurableMappedFile*) mf;
+                if ( !mmf->getView() )
+                    return; // not fully opened yet
+
+                FileResidency f;
+                f.filename = mmf->filename();
+                f.length = mmf->length();
+                _out->push_back( f );
+            }
+
+        private:
+            vector<FileResidency>* _out;
+        };
+
+        /**
+         * Fills in the residency bitmap of f. The files mutex is only held for PagesPerStep
+         * pages at a time.
+         * @return false if the file was closed or changed, or mincore() failed
+         */
+        bool collectResidency( FileResidency* f, long long* resident ) {
+            const size_t pageSize = ProcessInfo::getPageSize();
+            const size_t pages = numPages( f->length, pageSize );
+            f->bitmap.assign( ( pages + 7 ) / 8, 0 );
+
+            vector<char> in;
+            for ( size_t i = 0; i < pages; i += PagesPerStep ) {
+                const size_t n = std::min( PagesPerStep, pages - i );
+                {
+                    MongoFileFinder finder;
+                    MongoFile* mf = finder.findByPath( f->filename );
+                    if ( !mf || !mf->isDurableMappedFile() )
+                        return false;
+                    DurableMappedFile* mmf = (DurableMappedFile*) mf;
+                    const char* view = static_cast<const char*>( mmf->getView() );
+                    if ( !view || mmf->length() != f->length )
+                        return false;
+                    if ( !ProcessInfo::pagesInMemory( view + i * pageSize, n, &in ) )
+                        return false;
+                }
+                for ( size_t j = 0; j < n; j++ ) {
+                    if ( in[j] ) {
+                        f->bitmap[( i + j ) / 8] |= 1 << ( ( i + j ) % 8 );
+                        ++*resident;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /** @return false if there is no usable snapshot */
+        bool loadSnapshot( vector<FileResidency>* files ) {
+            const string path = snapshotPath();
+            if ( !boost::filesystem::exists( path ) )
+                return false;
+
+            std::ifstream in( path.c_str(), std::ios::in | std::ios::binary );
+            string data( ( std::istreambuf_iterator<char>( in ) ),
+                         std::istreambuf_iterator<char>() );
+            if ( !in.good() && !in.eof() ) {
+                warning() << "couldn't read working set snapshot " << path << endl;
+                return false;
+            }
+
+            try {
+                BufReader r( data.data(), data.size() );
+                if ( r.read<unsigned>() != SnapshotMagic ||
+                     r.read<unsigned>() != SnapshotVersion ||
+                     r.read<unsigned>() != ProcessInfo::getPageSize() ) {
+                    warning() << "ignoring incompatible working set snapshot " << path << endl;
+                    return false;
+                }
+                const unsigned nFiles = r.read<unsigned>();
+                for ( unsigned i = 0; i < nFiles; i++ ) {
+                    FileResidency f;
+                    r.readStr( f.filename );
+                    f.length = r.read<unsigned long long>();
+                    const size_t bytes = ( numPages( f.length, ProcessInfo::getPageSize() ) + 7 ) / 8;
+                    const unsigned char* p = static_cast<const unsigned char*>( r.skip( bytes ) );
+                    f.bitmap.assign( p, p + bytes );
+                    files->push_back( f );
+                }
+            }
+            catch ( BufReader::eof& ) {
+                warning() << "ignoring truncated working set snapshot " << path << endl;
+                files->clear();
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * Index extents of a data file, as [offset, offset + length) ranges, found by reading the
+         * extent headers laid out after the file header. Stops early on anything that doesn't
+         * look like an extent.
+         */
+        void findIndexExtents( File& file, unsigned long long length,
+                               vector<pair<unsigned long long, unsigned long long> >* out ) {
+            vector<char> header( Extent::HeaderSize() );
+            unsigned long long ofs = DataFileHeader::HeaderSize;
+            while ( ofs + Extent::HeaderSize() <= length ) {
+                file.read( ofs, &header.front(), header.size() );
+                if ( file.bad() )
+                    break;
+                const Extent* e = reinterpret_cast<const Extent*>( &header.front() );
+                if ( e->magic != Extent::extentSignature || e->length <= 0 ||
+                     ofs + e->length > length )
+                    break;
+
+                char ns[Namespace::MaxNsLen];
+                memcpy( ns, &e->nsDiagnostic, sizeof( ns ) );
+                if ( memchr( ns, '$', sizeof( ns ) ) )
+                    out->push_back( make_pair( ofs, ofs + e->length ) );
+
+                ofs += e->length;
+            }
+        }
+
+        bool isNamespaceFile( const string& filename ) {
+            return str::endsWith( filename, ".ns" );
+        }
+
+    }
+
+    class WorkingSetSnapshotter : public BackgroundJob, public ServerStatusSection {
+    public:
+        WorkingSetSnapshotter()
+            : ServerStatusSection( "workingSetSnapshot" ),
+              _saveMutex( "WorkingSetSnapshotter::save" ),
+              _m( "WorkingSetSnapshotter" ),
+              _snapshots( 0 ),
+              _lastResidentPages( 0 ),
+              _lastMillis( 0 ),
+              _replayState( "none" ),
+              _replayPagesTotal( 0 ),
+              _replayPagesTouched( 0 ),
+              _replayPriorityPages( 0 ),
+              _replayMillis( 0 ) {
+        }
+
+        virtual string name() const { return "WorkingSetSnapshotter"; }
+
+        virtual bool includeByDefault() const { return workingSetSnapshotIntervalSecs > 0; }
+
+        virtual BSONObj generateSection( const BSONElement& configElement ) const {
+            scoped_lock lk( _m );
+            BSONObjBuilder b;
+            b.append( "intervalSecs", workingSetSnapshotIntervalSecs );
+            b.append( "snapshots", _snapshots );
+            b.appendDate( "lastSnapshot", _lastSnapshot );
+            b.appendNumber( "lastResidentPages", _lastResidentPages );
+            b.append( "lastSnapshotMillis", _lastMillis );
+            BSONObjBuilder r( b.subobjStart( "replay" ) );
+            r.append( "state", _replayState );
+            r.appendNumber( "pages", _replayPagesTotal );
+            r.appendNumber( "pagesTouched", _replayPagesTouched );
+            r.appendNumber( "priorityPages", _replayPriorityPages );
+            r.append( "millis", _replayMillis );
+            r.done();
+            return b.obj();
+        }
+
+        virtual void run() {
+            Client::initThread( name().c_str() );
+
+            replay();
+
+            while ( !inShutdown() ) {
+                for ( int i = 0; i < workingSetSnapshotIntervalSecs && !inShutdown(); i++ )
+                    sleepsecs( 1 );
+                if ( inShutdown() )
+                    break;
+                save();
+            }
+
+            cc().shutdown();
+        }
+
+        /** writes the current residency of all data files to the snapshot file */
+        void save() {
+            if ( !ProcessInfo::blockCheckSupported() )
+                return;
+
+            // the periodic and shutdown snapshots share the tmp file
+            scoped_lock saveLock( _saveMutex );
+            Timer t;
+            // list the files first: mincore() runs outside of the files mutex
+            vector<FileResidency> listed;
+            MongoFile::forEach( MappedFileLister( &listed ) );
+
+            vector<FileResidency> files;
+            long long resident = 0;
+            for ( size_t i = 0; i < listed.size(); i++ ) {
+                if ( collectResidency( &listed[i], &resident ) )
+                    files.push_back( listed[i] );
+            }
+
+            BufBuilder b;
+            b.appendNum( SnapshotMagic );
+            b.appendNum( SnapshotVersion );
+            b.appendNum( static_cast<unsigned>( ProcessInfo::getPageSize() ) );
+            b.appendNum( static_cast<unsigned>( files.size() ) );
+            for ( size_t i = 0; i < files.size(); i++ ) {
+                b.appendStr( files[i].filename );
+                b.appendNum( files[i].length );
+                if ( !files[i].bitmap.empty() )
+                    b.appendBuf( &files[i].bitmap.front(), files[i].bitmap.size() );
+            }
+
+            // write aside and rename so a crash never leaves a partial snapshot behind
+            const string path = snapshotPath();
+            const string tmp = path + ".tmp";
+            {
+                std::ofstream out( tmp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+                out.write( b.buf(), b.len() );
+                out.close();
+                if ( !out.good() ) {
+                    warning() << "couldn't write working set snapshot " << tmp << endl;
+                    return;
+                }
+            }
+            try {
+                boost::filesystem::rename( tmp, path );
+            }
+            catch ( boost::filesystem::filesystem_error& e ) {
+                warning() << "couldn't rename working set snapshot: " << e.what() << endl;
+                return;
+            }
+
+            scoped_lock lk( _m );
+            _snapshots++;
+            _lastSnapshot = jsTime();
+            _lastResidentPages = resident;
+            _lastMillis = t.millis();
+            LOG(1) << "working set snapshot of " << resident << " pages in " << files.size()
+                   << " files took " << _lastMillis << "ms" << endl;
+        }
+
+    private:
+        void replay() {
+            vector<FileResidency> files;
+            if ( !ProcessInfo::blockCheckSupported() || !loadSnapshot( &files ) )
+                return;
+
+            long long total = 0;
+            for ( size_t i = 0; i < files.size(); i++ ) {
+                const size_t pages = numPages( files[i].length, ProcessInfo::getPageSize() );
+                for ( size_t p = 0; p < pages; p++ )
+                    total += files[i].test( p );
+            }
+            {
+                scoped_lock lk( _m );
+                _replayState = "running";
+                _replayPagesTotal = total;
+            }
+            log() << "replaying working set snapshot of " << total << " pages" << endl;
+
+            // The databases aren't open yet, and may be mapped lazily once they are, so the
+            // pages are read through our own descriptors into the page cache.
+            Timer t;
+            // NULL where the file is gone or changed since the snapshot
+            OwnedPointerVector<File> opened;
+            for ( size_t i = 0; i < files.size(); i++ ) {
+                auto_ptr<File> file( new File() );
+                opened.mutableVector().push_back( openUnchanged( files[i], file.get() )
+                                                  ? file.release() : NULL );
+            }
+
+            try {
+                // namespace files and index extents first, then everything else
+                for ( size_t i = 0; i < files.size() && !inShutdown(); i++ ) {
+                    File* file = opened.vector()[i];
+                    if ( !file )
+                        continue;
+                    if ( isNamespaceFile( files[i].filename ) ) {
+                        replayRange( file, &files[i], 0, files[i].length, true, t );
+                        continue;
+                    }
+
+                    vector<pair<unsigned long long, unsigned long long> > indexExtents;
+                    findIndexExtents( *file, files[i].length, &indexExtents );
+                    for ( size_t j = 0; j < indexExtents.size() && !inShutdown(); j++ ) {
+                        replayRange( file, &files[i], indexExtents[j].first,
+                                     indexExtents[j].second, true, t );
+                    }
+                }
+                for ( size_t i = 0; i < files.size() && !inShutdown(); i++ ) {
+                    File* file = opened.vector()[i];
+                    if ( file )
+                        replayRange( file, &files[i], 0, files[i].length, false, t );
+                }
+            }
+            catch ( DBException& e ) {
+                // e.g. a file was truncated under us
+                warning() << "working set replay stopped: " << e.what() << endl;
+            }
+
+            scoped_lock lk( _m );
+            _replayState = inShutdown() ? "interrupted" : "done";
+            _replayMillis = t.millis();
+            log() << "working set replay " << _replayState << ", touched " << _replayPagesTouched
+                  << " pages in " << _replayMillis << "ms" << endl;
+        }
+
+        /** @return false if the snapshotted file is gone or changed in size */
+        static bool openUnchanged( const FileResidency& f, File* file ) {
+            if ( !boost::filesystem::exists( f.filename ) )
+                return false;
+            file->open( f.filename.c_str(), true );
+            return file->is_open() && !file->bad() &&
+                static_cast<unsigned long long>( file->len() ) == f.length;
+        }
+
+        /**
+         * Reads the snapshotted pages of f within [begin, end), a run of adjacent pages at a
+         * time, clearing their bits so the final pass skips them.
+         */
+        void replayRange( File* file, FileResidency* f, unsigned long long begin,
+                          unsigned long long end, bool priority, const Timer& t ) {
+            const size_t pageSize = ProcessInfo::getPageSize();
+            const size_t last = numPages( end, pageSize );
+            vector<char> buf( PagesPerStep * pageSize );
+            for ( size_t page = begin / pageSize; page < last && !inShutdown(); ) {
+                const size_t stepEnd = std::min( last, page + PagesPerStep );
+                long long touched = 0;
+                while ( page < stepEnd ) {
+                    if ( !f->test( page ) ) {
+                        page++;
+                        continue;
+                    }
+                    size_t runEnd = page;
+                    while ( runEnd < stepEnd && f->test( runEnd ) ) {
+                        f->clear( runEnd );
+                        runEnd++;
+                    }
+                    const unsigned long long ofs = static_cast<unsigned long long>( page ) *
+                                                   pageSize;
+                    const unsigned len = static_cast<unsigned>(
+                        std::min<unsigned long long>( ( runEnd - page ) * pageSize,
+                                                      f->length - ofs ) );
+                    file->read( ofs, &buf.front(), len );
+                    if ( file->bad() )
+                        return;
+                    touched += runEnd - page;
+                    page = runEnd;
+                }
+
+                long long done;
+                {
+                    scoped_lock lk( _m );
+                    _replayPagesTouched += touched;
+                    if ( priority )
+                        _replayPriorityPages += touched;
+                    done = _replayPagesTouched;
+                }
+
+                const int mbPerSec = workingSetReplayMBPerSec;
+                if ( mbPerSec > 0 ) {
+                    // stay within the read budget
+                    long long due = done * pageSize / mbPerSec;
+                    long long elapsed = t.micros();
+                    if ( due > elapsed )
+                        sleepmicros( due - elapsed );
+                }
+            }
+        }
+
+        mongo::mutex _saveMutex;
+
+        // guards the stats below
+        mutable mongo::mutex _m;
+        int _snapshots;
+        Date_t _lastSnapshot;
+        long long _lastResidentPages;
+        int _lastMillis;
+
+        string _replayState;
+        long long _replayPagesTotal;
+        long long _replayPagesTouched;
+        long long _replayPriorityPages;
+        int _replayMillis;
+    };
+
+    static WorkingSetSnapshotter workingSetSnapshotter;
+
+    void startWorkingSetSnapshots() {
+        if ( workingSetSnapshotIntervalSecs <= 0 )
+            return;
+        workingSetSnapshotter.go();
+    }
+
+    void saveWorkingSetSnapshotAtShutdown() {
+        if ( workingSetSnapshotIntervalSecs <= 0 )
+            return;
+        log() << "shutdown: saving working set snapshot..." << endl;
+        workingSetSnapshotter.save();
+    }
+
+}
@@ -0,0 +1,53 @@
+// working_set_snapshot.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+namespace mongo {
+
+    /**
+     * Working set snapshots let a restarted mongod fault its hot pages back in before clients
+     * need them.
+     *
+     * When the workingSetSnapshotIntervalSecs server parameter is set, mongod periodically (and
+     * at clean shutdown) records which pages of each data file are resident, using mincore(),
+     * in a bitmap file in the dbpath. On the next startup a background thread reads those pages
+     * back into the page cache through its own file descriptors, since the databases aren't
+     * mapped yet, namespace files and index extents first, throttled by
+     * workingSetReplayMBPerSec. Progress is reported in serverStatus as "workingSetSnapshot".
+     */
+
+    /** replays the previous snapshot, if any, then starts taking new ones. no-op if disabled */
+    void startWorkingSetSnapshots();
+
+    /** takes a final snapshot. call at clean shutdown while the data files are still open */
+    void saveWorkingSetSnapshotAtShutdown();
+
+}
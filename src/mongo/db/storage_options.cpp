@@ -30,6 +30,7 @@
 
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/util/mmap.h"
 
 namespace mongo {
 
@@ -59,4 +60,10 @@ namespace mongo {
                                                      true,
                                                      true);
 
+    ExportedServerParameter<bool> MmapHugePagesSetting(ServerParameterSet::getGlobal(),
+                                                       "mmapHugePages",
+                                                       &g_mmapHugePages,
+                                                       true,
+                                                       false);
+
 } // namespace mongo
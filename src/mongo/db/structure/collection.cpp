@@ -52,6 +52,7 @@ namespace mongo {
         : _ns( fullNS ),
           _recordStore( _ns.ns() ),
           _infoCache( this ),
+          _zoneMap( this ),
           _indexCatalog( this, details ) {
         _details = details;
         _database = database;
@@ -145,6 +146,8 @@ namespace mongo {
 
         _details->incrementStats( r->netLength(), 1 );
 
+        _zoneMap.noteWrite( loc.getValue(), docToInsert );
+
         // TOOD: old god not done
         _infoCache.notifyOfWriteOp();
 
@@ -293,6 +296,7 @@ namespace mongo {
         //  update in place
         int sz = objNew.objsize();
         memcpy(getDur().writingPtr(oldRecord->data(), sz), objNew.objdata(), sz);
+        _zoneMap.noteWrite( oldLocation, objNew );
         return StatusWith<DiskLoc>( oldLocation );
     }
 
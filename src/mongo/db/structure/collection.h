@@ -39,6 +39,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/structure/collection_info_cache.h"
+#include "mongo/db/structure/zone_map.h"
 #include "mongo/platform/cstdint.h"
 
 namespace mongo {
@@ -74,6 +75,8 @@ namespace mongo {
         CollectionInfoCache* infoCache() { return &_infoCache; }
         const CollectionInfoCache* infoCache() const { return &_infoCache; }
 
+        ZoneMap* zoneMap() { return &_zoneMap; }
+
         const NamespaceString& ns() const { return _ns; }
 
         const IndexCatalog* getIndexCatalog() const { return &_indexCatalog; }
@@ -81,6 +84,9 @@ namespace mongo {
 
         bool requiresIdIndex() const;
 
+        const RecordStore* getRecordStore() const { return &_recordStore; }
+        RecordStore* getRecordStore() { return &_recordStore; }
+
         BSONObj docFor( const DiskLoc& loc );
 
         // ---- things that should move to a CollectionAccessMethod like thing
@@ -150,6 +156,7 @@ namespace mongo {
         Database* _database;
         RecordStore _recordStore;
         CollectionInfoCache _infoCache;
+        ZoneMap _zoneMap;
         IndexCatalog _indexCatalog;
 
         friend class Database;
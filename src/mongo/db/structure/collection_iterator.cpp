@@ -29,6 +29,7 @@
 #include "mongo/db/structure/collection_iterator.h"
 
 #include "mongo/db/namespace_details.h"
+#include "mongo/db/pdfile.h"
 #include "mongo/db/storage/extent.h"
 #include "mongo/db/storage/extent_manager.h"
 #include "mongo/db/structure/collection.h"
@@ -114,6 +115,25 @@ namespace mongo {
         }
     }
 
+    void FlatIterator::skipExtent(const DiskLoc& dl) {
+        const ExtentManager* em = _collection->getExtentManager();
+        Extent* e = em->getExtent(DiskLoc(dl.a(), dl.rec()->extentOfs()));
+
+        // Same as the constructor: land on the first record of the next non-empty extent.
+        if (CollectionScanParams::FORWARD == _direction) {
+            do {
+                e = em->getNextExtent(e);
+            } while (e && e->firstRecord.isNull());
+            _curr = e ? e->firstRecord : DiskLoc();
+        }
+        else {
+            do {
+                e = em->getPrevExtent(e);
+            } while (e && e->lastRecord.isNull());
+            _curr = e ? e->lastRecord : DiskLoc();
+        }
+    }
+
     void FlatIterator::prepareToYield() {
     }
 
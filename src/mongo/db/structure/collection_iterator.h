@@ -60,6 +60,10 @@ namespace mongo {
 
         // Returns true if collection still exists, false otherwise.
         virtual bool recoverFromYield() = 0;
+
+        // Moves past the rest of the extent holding 'dl', the DiskLoc most recently returned by
+        // getNext().  Iterators that don't walk extents in order ignore this.
+        virtual void skipExtent(const DiskLoc& dl) { }
     };
 
     /**
@@ -81,6 +85,8 @@ namespace mongo {
         virtual void prepareToYield();
         virtual bool recoverFromYield();
 
+        virtual void skipExtent(const DiskLoc& dl);
+
     private:
         // The result returned on the next call to getNext().
         DiskLoc _curr;
@@ -0,0 +1,312 @@
+// zone_map.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/structure/zone_map.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/d_concurrency.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/namespace_details.h"
+#include "mongo/db/ops/update.h"
+#include "mongo/db/pdfile.h"
+#include "mongo/db/structure/collection.h"
+
+namespace mongo {
+
+    ZoneMap::Summary::Summary( size_t nFields ) : _ranges( nFields ) {
+    }
+
+    void ZoneMap::Summary::Range::add( const BSONElement& e ) {
+        if ( e.type() == Array ) {
+            hasArray = true;
+            return;
+        }
+
+        static const BSONObj nullObj = BSON( "" << BSONNULL );
+        BSONElement value = e.eoo() ? nullObj.firstElement() : e;
+
+        if ( empty ) {
+            min = max = value.wrap( "" );
+            empty = false;
+            return;
+        }
+        if ( value.woCompare( min.firstElement(), false ) < 0 )
+            min = value.wrap( "" );
+        else if ( value.woCompare( max.firstElement(), false ) > 0 )
+            max = value.wrap( "" );
+    }
+
+    void ZoneMap::Summary::add( const BSONObj& obj, const vector<string>& fields ) {
+        verify( fields.size() == _ranges.size() );
+        for ( size_t i = 0; i < fields.size(); i++ ) {
+            // eoo if missing, the array if the path reaches one
+            const char* path = fields[i].c_str();
+            _ranges[i].add( obj.getFieldDottedOrArray( path ) );
+        }
+    }
+
+    void ZoneMap::Summary::merge( const Summary& other ) {
+        verify( other._ranges.size() == _ranges.size() );
+        for ( size_t i = 0; i < _ranges.size(); i++ ) {
+            const Range& r = other._ranges[i];
+            if ( r.hasArray )
+                _ranges[i].hasArray = true;
+            if ( !r.empty ) {
+                _ranges[i].add( r.min.firstElement() );
+                _ranges[i].add( r.max.firstElement() );
+            }
+        }
+    }
+
+    bool ZoneMap::Summary::mayMatch( const MatchExpression* expr,
+                                     const vector<string>& fields ) const {
+        switch ( expr->matchType() ) {
+        case MatchExpression::AND:
+            for ( size_t i = 0; i < expr->numChildren(); i++ ) {
+                if ( !mayMatch( expr->getChild( i ), fields ) )
+                    return false;
+            }
+            return true;
+        case MatchExpression::OR:
+            for ( size_t i = 0; i < expr->numChildren(); i++ ) {
+                if ( mayMatch( expr->getChild( i ), fields ) )
+                    return true;
+            }
+            return expr->numChildren() == 0;
+        case MatchExpression::LT:
+        case MatchExpression::LTE:
+        case MatchExpression::EQ:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+            for ( size_t i = 0; i < fields.size(); i++ ) {
+                if ( expr->path() == fields[i] )
+                    return _comparisonMayMatch( expr, _ranges[i] );
+            }
+            return true;
+        default:
+            return true;
+        }
+    }
+
+    bool ZoneMap::Summary::_comparisonMayMatch( const MatchExpression* expr,
+                                                const Range& r ) const {
+        if ( r.hasArray )
+            return true;
+        if ( r.empty )
+            return false;
+
+        const BSONElement& rhs = static_cast<const ComparisonMatchExpression*>( expr )->getData();
+        switch ( rhs.type() ) {
+        case MinKey:
+        case MaxKey:
+        case jstNULL:
+        case Undefined:
+        case Array:
+            // these match across types, see ComparisonMatchExpression::matchesSingleElement
+            return true;
+        default:
+            break;
+        }
+
+        // comparisons only match values of the same canonical type, and every value in the
+        // range has a canonical type between that of min and that of max
+        const BSONElement lo = r.min.firstElement();
+        const BSONElement hi = r.max.firstElement();
+        const int type = rhs.canonicalType();
+        if ( type < lo.canonicalType() || type > hi.canonicalType() )
+            return false;
+
+        // an end of the range of another type doesn't bound the values of rhs's type
+        const int loCmp = lo.canonicalType() == type ? compareElementValues( lo, rhs ) : -1;
+        const int hiCmp = hi.canonicalType() == type ? compareElementValues( hi, rhs ) : 1;
+
+        switch ( expr->matchType() ) {
+        case MatchExpression::LT:
+            return loCmp < 0;
+        case MatchExpression::LTE:
+            return loCmp <= 0;
+        case MatchExpression::EQ:
+            return loCmp <= 0 && hiCmp >= 0;
+        case MatchExpression::GT:
+            return hiCmp > 0;
+        case MatchExpression::GTE:
+            return hiCmp >= 0;
+        default:
+            return true;
+        }
+    }
+
+    // -----------------
+
+    ZoneMap::ZoneMap( Collection* collection )
+        : _collection( collection ),
+          _mutex( "ZoneMap" ),
+          _fieldsLoaded( false ),
+          _nextBuildId( 0 ) {
+    }
+
+    Status ZoneMap::validateFields( const BSONElement& e ) {
+        if ( e.type() != Array )
+            return Status( ErrorCodes::BadValue, "zoneMapFields must be an array" );
+
+        BSONForEach( field, e.Obj() ) {
+            if ( field.type() != String || field.valuestrsize() <= 1 )
+                return Status( ErrorCodes::BadValue,
+                               "zoneMapFields must only hold non-empty field names" );
+            if ( field.valuestr()[0] == '$' )
+                return Status( ErrorCodes::BadValue,
+                               str::stream() << "bad zoneMapFields entry: " << field.valuestr() );
+        }
+        return Status::OK();
+    }
+
+    void ZoneMap::_loadFields_inlock() {
+        if ( _fieldsLoaded )
+            return;
+        _fieldsLoaded = true;
+        _fields.clear();
+
+        const NamespaceString& ns = _collection->ns();
+        if ( ns.isSystem() || ns.isSpecial() || ns.ns().find( '$' ) != string::npos )
+            return;
+        if ( _collection->details()->isCapped() )
+            return;
+
+        BSONObj entry;
+        if ( !Helpers::findOne( ns.db().toString() + ".system.namespaces",
+                                BSON( "name" << ns.ns() ),
+                                entry ) )
+            return;
+
+        BSONElement e = entry.getObjectField( "options" )["zoneMapFields"];
+        if ( !validateFields( e ).isOK() )
+            return;
+
+        BSONForEach( field, e.Obj() ) {
+            _fields.push_back( field.String() );
+        }
+    }
+
+    vector<string> ZoneMap::fields() {
+        scoped_lock lk( _mutex );
+        _loadFields_inlock();
+        return _fields;
+    }
+
+    bool ZoneMap::enabled() {
+        scoped_lock lk( _mutex );
+        _loadFields_inlock();
+        return !_fields.empty();
+    }
+
+    Status ZoneMap::setFields( const BSONElement& e ) {
+        const string ns = _collection->ns().ns();
+        Lock::assertWriteLocked( ns );
+
+        // same as NamespaceDetails::syncUserFlags
+        const string systemNamespaces = _collection->ns().db().toString() + ".system.namespaces";
+        DiskLoc oldLocation = Helpers::findOne( systemNamespaces, BSON( "name" << ns ), false );
+        if ( oldLocation.isNull() )
+            return Status( ErrorCodes::NamespaceNotFound, "no catalog entry for " + ns );
+
+        Collection* catalog = cc().database()->getCollection( systemNamespaces );
+        BSONObj oldEntry = catalog->docFor( oldLocation );
+        BSONObj newEntry = applyUpdateOperators( oldEntry,
+                                                 BSON( "$set" << BSON( "options.zoneMapFields"
+                                                                       << e.Obj() ) ) );
+        StatusWith<DiskLoc> loc = catalog->updateDocument( oldLocation, newEntry, false, NULL );
+        reset();
+        return loc.getStatus();
+    }
+
+    void ZoneMap::reset() {
+        scoped_lock lk( _mutex );
+        _fieldsLoaded = false;
+        _fields.clear();
+        _extents.clear();
+    }
+
+    void ZoneMap::noteWrite( const DiskLoc& loc, const BSONObj& obj ) {
+        scoped_lock lk( _mutex );
+        _loadFields_inlock();
+        if ( _fields.empty() || _extents.empty() )
+            return;
+
+        DiskLoc extentLoc( loc.a(), loc.rec()->extentOfs() );
+        std::map<DiskLoc, Entry>::iterator i = _extents.find( extentLoc );
+        if ( i == _extents.end() )
+            return;
+        i->second.summary.add( obj, _fields );
+    }
+
+    void ZoneMap::dropExtent( const DiskLoc& extentLoc ) {
+        scoped_lock lk( _mutex );
+        _extents.erase( extentLoc );
+    }
+
+    bool ZoneMap::canSkip( const DiskLoc& extentLoc, const MatchExpression* filter ) {
+        scoped_lock lk( _mutex );
+        std::map<DiskLoc, Entry>::const_iterator i = _extents.find( extentLoc );
+        if ( i == _extents.end() || !i->second.complete )
+            return false;
+        return !i->second.summary.mayMatch( filter, _fields );
+    }
+
+    bool ZoneMap::startBuild( const DiskLoc& extentLoc, unsigned long long* buildId ) {
+        scoped_lock lk( _mutex );
+        _loadFields_inlock();
+        if ( _fields.empty() )
+            return false;
+
+        Entry& entry = _extents[extentLoc];
+        if ( entry.complete )
+            return false;
+
+        // restart from scratch; a build already in progress can no longer complete
+        entry.summary = Summary( _fields.size() );
+        entry.buildId = *buildId = ++_nextBuildId;
+        return true;
+    }
+
+    void ZoneMap::finishBuild( const DiskLoc& extentLoc, unsigned long long buildId,
+                               const Summary& scanned ) {
+        scoped_lock lk( _mutex );
+        std::map<DiskLoc, Entry>::iterator i = _extents.find( extentLoc );
+        if ( i == _extents.end() || i->second.buildId != buildId )
+            return;
+        i->second.summary.merge( scanned );
+        i->second.complete = true;
+    }
+
+}
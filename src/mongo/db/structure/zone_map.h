@@ -0,0 +1,150 @@
+// zone_map.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/db/diskloc.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    class Collection;
+    class MatchExpression;
+
+    /**
+     * Per extent min/max summaries of the fields declared in the collection's zoneMapFields
+     * option, letting collection scans skip extents that can't hold a match for their filter.
+     *
+     * Summaries only live in memory. An extent gets one the first time a collection scan reads
+     * it from end to end; from then on every insert and update into the extent widens it.
+     * Deletes never shrink a summary, so it is always a superset of what the extent holds.
+     * Capped and system collections never have zone maps.
+     *
+     * life cycle is managed from inside Collection
+     */
+    class ZoneMap {
+    public:
+        /** min and max of each declared field over a set of documents */
+        class Summary {
+        public:
+            explicit Summary( size_t nFields = 0 );
+
+            void add( const BSONObj& obj, const std::vector<std::string>& fields );
+            void merge( const Summary& other );
+
+            /** @return false if no document matching 'expr' can be among those added */
+            bool mayMatch( const MatchExpression* expr,
+                           const std::vector<std::string>& fields ) const;
+
+        private:
+            struct Range {
+                Range() : empty( true ), hasArray( false ) {}
+                void add( const BSONElement& e );
+                // bounds are single element objects, missing fields count as null
+                BSONObj min;
+                BSONObj max;
+                bool empty;
+                // arrays match element-wise, so they make the range unusable
+                bool hasArray;
+            };
+
+            bool _comparisonMayMatch( const MatchExpression* expr, const Range& r ) const;
+
+            std::vector<Range> _ranges;
+        };
+
+        ZoneMap( Collection* collection );
+
+        /** validates a zoneMapFields option: an array of field names, possibly dotted */
+        static Status validateFields( const BSONElement& e );
+
+        /** @return the declared fields, read from the collection's catalog entry on first use */
+        std::vector<std::string> fields();
+
+        bool enabled();
+
+        /**
+         * Replaces the declared fields in the collection's catalog entry, for collMod.
+         * Caller holds the db write lock and has validated 'e'.
+         */
+        Status setFields( const BSONElement& e );
+
+        /** drops all summaries and rereads the declared fields */
+        void reset();
+
+        /** widens the summary of loc's extent, if it has one, to include obj */
+        void noteWrite( const DiskLoc& loc, const BSONObj& obj );
+
+        /** forgets the summary of an extent that left the collection */
+        void dropExtent( const DiskLoc& extentLoc );
+
+        /** @return true if the extent's summary shows no document in it can match 'filter' */
+        bool canSkip( const DiskLoc& extentLoc, const MatchExpression* filter );
+
+        /**
+         * Starts building the summary of an extent that is about to be read from end to end.
+         * Writes into the extent are collected from now on.
+         * @return false if the extent already has a summary
+         */
+        bool startBuild( const DiskLoc& extentLoc, unsigned long long* buildId );
+
+        /**
+         * Completes a summary started with startBuild(), given what the scan read. Ignored if
+         * another build of the extent started in the meantime or the zone map was reset.
+         */
+        void finishBuild( const DiskLoc& extentLoc, unsigned long long buildId,
+                          const Summary& scanned );
+
+    private:
+        struct Entry {
+            Entry() : complete( false ), buildId( 0 ) {}
+            Summary summary;
+            bool complete;
+            unsigned long long buildId;
+        };
+
+        void _loadFields_inlock();
+
+        Collection* _collection; // not owned
+
+        mutex _mutex;
+        bool _fieldsLoaded;
+        std::vector<std::string> _fields;
+        std::map<DiskLoc, Entry> _extents;
+        unsigned long long _nextBuildId;
+    };
+
+}
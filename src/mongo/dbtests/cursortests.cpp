@@ -697,6 +697,53 @@ namespace CursorTests {
             }
         };
 
+        /**
+         * invalidate() of a collection leaves the cursors on other collections in the db alone,
+         * and cursors are counted per namespace.
+         */
+        class InvalidateOtherNamespace : public Base {
+        public:
+            ~InvalidateOtherNamespace() {
+                client.dropCollection( otherNs() );
+            }
+            void run() {
+                client.insert( ns(), BSON( "a" << 1 ) );
+                client.insert( otherNs(), BSON( "a" << 1 ) );
+
+                Client::WriteContext ctx( ns() );
+                ClientCursorHolder clientCursor( new ClientCursor( 0,
+                                                                   theDataFileMgr.findAll( ns() ),
+                                                                   ns() ) );
+                ClientCursorHolder otherClientCursor(
+                        new ClientCursor( 0, theDataFileMgr.findAll( otherNs() ), otherNs() ) );
+                CursorId otherId = otherClientCursor->cursorid();
+
+                BSONObjBuilder before;
+                ClientCursor::appendNamespaceStats( before );
+                BSONObj beforeStats = before.obj();
+                ASSERT_EQUALS( 1, beforeStats[ ns() ].Obj()[ "open" ].numberInt() );
+                ASSERT_EQUALS( 1, beforeStats[ otherNs() ].Obj()[ "open" ].numberInt() );
+
+                ClientCursor::invalidate( ns() );
+
+                set<CursorId> ids;
+                ClientCursor::find( ns(), ids );
+                ASSERT( ids.empty() );
+
+                set<CursorId> otherIds;
+                ClientCursor::find( otherNs(), otherIds );
+                ASSERT_EQUALS( 1U, otherIds.count( otherId ) );
+
+                BSONObjBuilder after;
+                ClientCursor::appendNamespaceStats( after );
+                BSONObj afterStats = after.obj();
+                ASSERT( afterStats[ ns() ].eoo() );
+                ASSERT_EQUALS( 1, afterStats[ otherNs() ].Obj()[ "open" ].numberInt() );
+            }
+        private:
+            static const char * const otherNs() { return "unittests.cursortests.clientcursor2"; }
+        };
+
         namespace Pin {
 
             class Base {
@@ -794,6 +841,7 @@ namespace CursorTests {
             add<ClientCursor::AboutToDelete>();
             add<ClientCursor::AboutToDeleteDuplicate>();
             add<ClientCursor::AboutToDeleteDuplicateNextClause>();
+            add<ClientCursor::InvalidateOtherNamespace>();
             add<ClientCursor::Pin::PinCursor>();
             add<ClientCursor::Pin::PinTwice>();
             add<ClientCursor::Pin::CursorDeleted>();
@@ -1226,6 +1226,13 @@ namespace DocumentTests {
                 assertComparison( -1, "b-", "ba" );
                 // With a null character.
                 assertComparison( 1, string( "a\0", 2 ), "a" );
+                // Long strings, which keep their first bytes inline.
+                assertComparison( 0, "abcdefghijklmnop", "abcdefghijklmnop" );
+                assertComparison( -1, "abcdefghijklmnop", "abcdefghijklmnoq" );
+                assertComparison( -1, "abcdeAghijklmnop", "abcdefghijklmnop" );
+                assertComparison( -1, "abcdefghijkl", "abcdefghijklm" );
+                assertComparison( 1, string( "abcdefghijklm\0", 14 ), "abcdefghijklm" );
+                assertComparison( 1, string( "abcde\0\0ghijklm", 14 ), string( "abcde\0", 6 ) );
 
                 // Object.
                 assertComparison( 0, fromjson( "{'':{}}" ), fromjson( "{'':{}}" ) );
@@ -1275,6 +1282,7 @@ namespace DocumentTests {
                 assertComparison(0,  Value(1), Value(1.0));
                 assertComparison(-1, Value(1), Value("string"));
                 assertComparison(0,  Value("string"), Value(BSONSymbol("string")));
+                assertComparison(0,  Value("a longer string"), Value(BSONSymbol("a longer string")));
                 assertComparison(-1, Value("string"), Value(mongo::Document()));
                 assertComparison(-1, Value(mongo::Document()), Value(vector<Value>()));
                 assertComparison(-1, Value(vector<Value>()), Value(BSONBinData("", 0, MD5Type)));
@@ -1331,6 +1339,10 @@ namespace DocumentTests {
                     // (not true in general but we should error if it fails in any of these cases)
                     ASSERT_NOT_EQUALS( hash( a ), hash( b ) );
                 }
+
+                // operator== has its own fast paths
+                ASSERT_EQUALS( expectedResult == 0, a == b );
+                ASSERT_EQUALS( expectedResult == 0, b == a );
                 
                 // same as BSON
                 ASSERT_EQUALS(expectedResult, sign(toBson(a).firstElement().woCompare(
@@ -20,6 +20,7 @@
 
 #include <boost/filesystem/operations.hpp>
 
+#include "mongo/db/dur_commitjob.h"
 #include "mongo/db/storage/durable_mapped_file.h"
 #include "mongo/util/timer.h"
 #include "mongo/dbtests/dbtests.h"
@@ -106,11 +107,38 @@ namespace MMapTests {
         }
     };
 
+    /** write intents are folded into the minimal set of disjoint ranges before journaling */
+    class CoalesceWriteIntents {
+    public:
+        void run() {
+            char buf[1000];
+            dur::IntentsAndDurOps w;
+            w.insertWriteIntent(buf + 100, 10);
+            w.insertWriteIntent(buf + 100, 10);  // duplicate
+            w.insertWriteIntent(buf + 105, 20);  // overlaps
+            w.insertWriteIntent(buf + 125, 5);   // adjacent
+            w.insertWriteIntent(buf + 0, 8);
+            w.insertWriteIntent(buf + 500, 4);
+            w.insertWriteIntent(buf + 490, 100); // contains the previous one
+            w.coalesce();
+
+            ASSERT_EQUALS( 3U, w._intents.size() );
+            ASSERT( w._intents[0].start() == buf );
+            ASSERT_EQUALS( 8U, w._intents[0].length() );
+            ASSERT( w._intents[1].start() == buf + 100 );
+            ASSERT_EQUALS( 30U, w._intents[1].length() );
+            ASSERT( w._intents[2].start() == buf + 490 );
+            ASSERT_EQUALS( 100U, w._intents[2].length() );
+            ASSERT_EQUALS( 138ULL, w.intentBytes() );
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "mmap" ) {}
         void setupTests() {
             add< LeakTest >();
+            add< CoalesceWriteIntents >();
         }
     } myall;
 
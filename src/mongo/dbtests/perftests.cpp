@@ -29,21 +29,34 @@
 #include <fstream>
 
 #include "mongo/db/db.h"
+#include "mongo/db/dur.h"
 #include "mongo/db/dur_stats.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/json.h"
 #include "mongo/db/key.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/storage/compression_estimate.h"
 #include "mongo/db/taskqueue.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/s/d_logic.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/qlock.h"
+#include "mongo/util/crc32c.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/touch_pages.h"
 #include "mongo/util/version.h"
 
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
 #if (__cplusplus >= 201103L)
 #include <mutex>
 #endif
@@ -473,6 +486,28 @@ namespace PerfTests {
         }
     };
 
+    /** hashing and equality of compound keys the way $group and $addToSet use them */
+    class ValueGroupKeys : public NonDurTest {
+    public:
+        int n;
+        vector<Value> keys;
+        string name() { return "ValueGroupKeys"; }
+        ValueGroupKeys() {
+            n = 0;
+            for( int i = 0; i < 200; i++ ) {
+                keys.push_back(Value(DOC("region" << string(str::stream() << "r" << i % 8)
+                                      << "sku" << string(str::stream() << "sku-identifier-" << i % 50)
+                                      << "qty" << i % 3)));
+            }
+        }
+        void timed() {
+            ValueSet groups;
+            for( size_t i = 0; i < keys.size(); i++ )
+                groups.insert(keys[i]);
+            n += groups.size();
+        }
+    };
+
     class KeyTest : public B {
     public:
         KeyV1Owned a,b,c;
@@ -626,6 +661,59 @@ namespace PerfTests {
 #endif
         }
     };
+
+    /** shardVersionOk() on a connection whose version is already known to be current, which is
+        what every versioned op on a shard goes through.  _DEBUG builds also report how many
+        mutexes each check locks; only the MutexDebugger counts them.
+    */
+    class ShardVersionCheck : public B {
+        unsigned long long _ops;
+        unsigned long long _mutexes;
+
+        static unsigned long long mutexesLocked() {
+#if defined(_DEBUG)
+            return mutexDebugger.acquisitionsThisThread();
+#else
+            return 0;
+#endif
+        }
+    public:
+        ShardVersionCheck() : _ops(0), _mutexes(0) { }
+        string name() { return "shardVersionOk"; }
+        virtual int howLongMillis() { return 2000; }
+        virtual bool showDurStats() { return false; }
+        void prep() {
+            shardingState.enable( "localhost:30000" );
+            ShardedConnectionInfo::get( true );
+
+            // the first check has to go to ShardingState, don't count it
+            string errmsg;
+            ChunkVersion received, wanted;
+            verify( shardVersionOk( ns(), errmsg, received, wanted ) );
+        }
+        void timed() {
+            unsigned long long before = mutexesLocked();
+
+            string errmsg;
+            ChunkVersion received, wanted;
+            if( shardVersionOk( ns(), errmsg, received, wanted ) )
+                dontOptimizeOutHopefully++;
+
+            _mutexes += mutexesLocked() - before;
+            _ops++;
+        }
+        void post() {
+            cout << "stats " << setw(42) << left << "shardVersionOk mutexes/op" << ' '
+                 << right << setw(9);
+#if defined(_DEBUG)
+            cout << (double) _mutexes / _ops << endl;
+#else
+            cout << "n/a" << endl;
+#endif
+            ShardedConnectionInfo::reset();
+            shardingState.resetShardingState();
+        }
+    };
     class rlock : public B {
     public:
         string name() { return "rlock"; }
@@ -946,11 +1034,82 @@ namespace PerfTests {
         }
     };
 
+    /** full scan of log-like documents, stored raw or in snappy compressed 32KB blocks */
+    class BlockScan : public B {
+    public:
+        vector<string> blocks;
+        BufBuilder raw;
+        long long n;
+        BlockScan() : n(0) { }
+        virtual unsigned batchSize() { return 1; }
+        virtual bool showDurStats() { return false; }
+        virtual int howLongMillis() { return 2000; }
+        void prep() {
+            BufBuilder block;
+            for( int i = 0; i < 50000; i++ ) {
+                BSONObj o = BSON( "_id" << i << "ts" << Date_t(1380000000000LL + i * 17)
+                                  << "level" << (i % 7 ? "info" : "warning")
+                                  << "component" << "replication"
+                                  << "msg" << string(str::stream() << "applied batch of "
+                                                    << i % 100 << " operations from syncsource") );
+                raw.appendBuf(o.objdata(), o.objsize());
+                if( block.len() + o.objsize() > CompressionEstimate::DefaultBlockSize ) {
+                    blocks.push_back(string());
+                    compress(block.buf(), block.len(), &blocks.back());
+                    block.reset();
+                }
+                block.appendBuf(o.objdata(), o.objsize());
+            }
+            blocks.push_back(string());
+            compress(block.buf(), block.len(), &blocks.back());
+
+            static unsigned once;
+            if( once++ == 0 ) {
+                size_t compressed = 0;
+                for( size_t i = 0; i < blocks.size(); i++ )
+                    compressed += blocks[i].size();
+                cout << "BlockScan footprint raw: " << raw.len() << " compressed: " << compressed
+                     << " (" << blocks.size() << " blocks)" << endl;
+            }
+        }
+    };
+
+    class BlockScanRaw : public BlockScan {
+    public:
+        string name() { return "BlockScanRaw"; }
+        void timed() {
+            for( int pos = 0; pos < raw.len(); ) {
+                BSONObj o(raw.buf() + pos);
+                if( o["level"].valuestrsize() > 5 )
+                    n++;
+                pos += o.objsize();
+            }
+        }
+    };
+
+    class BlockScanCompressed : public BlockScan {
+    public:
+        string name() { return "BlockScanCompressed"; }
+        void timed() {
+            string data;
+            for( size_t i = 0; i < blocks.size(); i++ ) {
+                data.clear();
+                verify( uncompress(blocks[i].data(), blocks[i].size(), &data) );
+                for( size_t pos = 0; pos < data.size(); ) {
+                    BSONObj o(data.data() + pos);
+                    if( o["level"].valuestrsize() > 5 )
+                        n++;
+                    pos += o.objsize();
+                }
+            }
+        }
+    };
+
     // test speed of checksum method
     class ChecksumTest : public B {
     public:
         const unsigned sz;
-        ChecksumTest() : sz(1024*1024*100+3) { }
+        ChecksumTest() : sz(1024*1024*100+3), p(0) { }
         string name() { return "checksum"; }
         virtual int howLongMillis() { return 2000; }
         virtual bool showDurStats() { return false; }
@@ -982,6 +1141,14 @@ namespace PerfTests {
                 ASSERT( c == last );
             }
         }
+
+        // what journal section footers and sort spill files use now
+        virtual string name2() {
+            return crc32cHardwareEnabled() ? "checksum-crc32c" : "checksum-crc32c-software";
+        }
+        void timed2(DBClientBase&) {
+            dontOptimizeOutHopefully += crc32c(0, p, sz);
+        }
         void post() {
             {
                 mongo::Checksum c;
@@ -996,9 +1163,91 @@ namespace PerfTests {
                 c.gen(p, sz);
                 ASSERT( c != last );
             }
-            free(p);
+        }
+        ~ChecksumTest() {
+            free(p); // not in post(), timed2() runs after it
+        }
+    };
+
+#if defined(__linux__)
+    /**
+     * Random page reads from a mapped data file, with the file evicted from the page cache
+     * (cold) or fully faulted in with touch_pages (warm), as after a restart with and without a
+     * working set snapshot replay.
+     */
+    class WorkingSetRead : public B {
+    public:
+        WorkingSetRead() : fd(-1), view(0), len(64 * 1024 * 1024) { }
+        virtual int howLongMillis() { return 2000; }
+        virtual bool showDurStats() { return false; }
+        virtual unsigned batchSize() { return 1; }
+
+        void prep() {
+            path = storageGlobalParams.dbpath + "/perftest_workingset";
+            {
+                std::ofstream f(path.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+                vector<char> chunk(1024 * 1024);
+                for( size_t i = 0; i < len / chunk.size(); i++ ) {
+                    chunk[0] = i;
+                    f.write(&chunk[0], chunk.size());
+                }
+                ASSERT( f.good() );
+            }
+            fd = open(path.c_str(), O_RDONLY);
+            ASSERT( fd >= 0 );
+            fsync(fd);
+            map();
+        }
+
+        void post() {
+            munmap(view, len);
+            close(fd);
+            boost::filesystem::remove(path);
+        }
+
+    protected:
+        void map() {
+            view = static_cast<char*>(mmap(0, len, PROT_READ, MAP_SHARED, fd, 0));
+            ASSERT( view != MAP_FAILED );
+        }
+
+        /** what one operation measures: reads a page at each of 256 random offsets */
+        void readPages() {
+            const size_t pageSize = ProcessInfo::getPageSize();
+            for( int i = 0; i < 256; i++ )
+                dontOptimizeOutHopefully += view[(rand() % (len / pageSize)) * pageSize];
+        }
+
+        string path;
+        int fd;
+        char *view;
+        const size_t len;
+    };
+
+    class WorkingSetCold : public WorkingSetRead {
+    public:
+        string name() { return "WorkingSetCold"; }
+        void timed() {
+            // drop the file from the page cache so every read faults from disk
+            munmap(view, len);
+            posix_fadvise(fd, 0, len, POSIX_FADV_DONTNEED);
+            map();
+            readPages();
+        }
+    };
+
+    class WorkingSetWarm : public WorkingSetRead {
+    public:
+        string name() { return "WorkingSetWarm"; }
+        void prep() {
+            WorkingSetRead::prep();
+            touch_pages(view, len);
+        }
+        void timed() {
+            readPages();
         }
     };
+#endif
 
     class InsertDup : public B {
         const BSONObj o;
@@ -1124,6 +1373,55 @@ namespace PerfTests {
         }
     };
 
+    /**
+     * Steady in place updates spread over a collection of a few hundred MB, timing each one.
+     * Every commit dirties pages across the data files, so REMAPPRIVATEVIEW has plenty to do;
+     * when it remaps everything in one go, the updates queued behind the write lock show it in
+     * the tail.  CapMB is journalRemapMaxMBPerPass for the run (0 is uncapped).
+     */
+    template <int CapMB>
+    class RemapWriteLatency : public B {
+    public:
+        RemapWriteLatency() : _n(0) { }
+        virtual int howLongMillis() { return profiling ? 30000 : 10000; }
+        virtual unsigned batchSize() { return 1; }
+        string name() { return str::stream() << "remap-write-latency-cap" << CapMB << "MB"; }
+        void prep() {
+            _oldCap = dur::journalRemapMaxMBPerPass;
+            dur::journalRemapMaxMBPerPass = CapMB;
+            const string pad(400, 'x');
+            _n = sizeof(void*) == 4 ? 100000 : 500000;
+            DEV _n = 20000;
+            for( int i = 0; i < _n; i++ )
+                client().insert(ns(), BSON("_id" << i << "y" << 0 << "pad" << pad));
+            client().getLastError();
+            _micros.clear();
+        }
+        void timed() {
+            static BSONObj I = BSON( "$inc" << BSON( "y" << 1 ) );
+            mongo::Timer t;
+            client().update(ns(), QUERY("_id" << (int) (rand() % _n)), I);
+            _micros.push_back(t.micros());
+        }
+        void post() {
+            dur::journalRemapMaxMBPerPass = _oldCap;
+            if( _micros.empty() )
+                return;
+            std::sort(_micros.begin(), _micros.end());
+            const size_t n = _micros.size();
+            cout << "stats " << setw(42) << left << name() + "-micros" << right
+                 << " p50:" << _micros[n / 2]
+                 << " p99:" << _micros[n * 99 / 100]
+                 << " p99.9:" << _micros[n * 999 / 1000]
+                 << " max:" << _micros[n - 1]
+                 << " remapMs:" << dur::stats.curr->_remapPrivateViewMicros / 1000 << endl;
+        }
+    private:
+        int _n;
+        int _oldCap;
+        vector<unsigned long long> _micros;
+    };
+
     template <typename T>
     class MoreIndexes : public T {
     public:
@@ -1354,6 +1652,12 @@ namespace PerfTests {
                 add< Dummy >();
                 add< ChecksumTest >();
                 add< Compress >();
+                add< BlockScanRaw >();
+                add< BlockScanCompressed >();
+#if defined(__linux__)
+                add< WorkingSetCold >();
+                add< WorkingSetWarm >();
+#endif
                 add< TLS >();
 #if defined(_WIN32)
                 add< TLS2 >();
@@ -1399,6 +1703,7 @@ namespace PerfTests {
                 add< stdtimed_mutexspeed >();
 #endif
                 add< spinlockspeed >();
+                add< ShardVersionCheck >();
 #ifdef RUNCOMPARESWAP
                 add< casspeed >();
 #endif
@@ -1410,6 +1715,7 @@ namespace PerfTests {
                 add< BSONIter >();
                 add< BSONGetFields1 >();
                 add< BSONGetFields2 >();
+                add< ValueGroupKeys >();
                 //add< TaskQueueTest >();
                 add< InsertDup >();
                 add< Insert1 >();
@@ -1418,6 +1724,8 @@ namespace PerfTests {
                 add< Update1 >();
                 add< MoreIndexes<Update1> >();
                 add< InsertBig >();
+                add< RemapWriteLatency<0> >();
+                add< RemapWriteLatency<16> >();
                 add< FailPointTest<false, false> >();
                 add< FailPointTest<true, false> >();
                 add< FailPointTest<true, true> >();
@@ -23,7 +23,11 @@
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/s/chunk_diff.h"
 #include "mongo/s/chunk_version.h"
+#include "mongo/s/d_logic.h"
+#include "mongo/s/routing_table_cache.h"
 #include "mongo/s/type_chunk.h"
+#include "mongo/s/type_collection.h"
+#include "mongo/unittest/temp_dir.h"
 
 namespace ShardingTests {
 
@@ -268,6 +272,204 @@ namespace ShardingTests {
 
     };
 
+    //
+    // Tests that keys are routed to the chunk that contains them, including keys on chunk
+    // boundaries and at the global min and max.
+    //
+    class ChunkManagerRoutingTest : public ChunkManagerCreateFullTest {
+    public:
+
+        void run(){
+
+            string keyName = "_id";
+            createChunks( keyName );
+
+            ChunkManagerPtr manager( new ChunkManager( collName(), ShardKeyPattern( BSON( "_id" << 1 ) ), false ) );
+            ((ChunkManager*) manager.get())->loadExistingRanges( shard().getConnString() );
+
+            const ChunkMap& chunkMap = manager->getChunkMap();
+            for ( ChunkMap::const_iterator it = chunkMap.begin(); it != chunkMap.end(); ++it ) {
+                ChunkPtr chunk = it->second;
+                ASSERT( manager->findIntersectingChunk( chunk->getMin() ) == chunk );
+            }
+
+            for ( int i = -10; i < numSplitPoints * 10 + 10; i++ ) {
+                BSONObj key = BSON( keyName << i );
+                ChunkPtr chunk = manager->findIntersectingChunk( key );
+                ASSERT( chunk->containsPoint( key ) );
+                ASSERT( chunkMap.upper_bound( key )->second == chunk );
+            }
+
+            BSONObjBuilder minKey;
+            minKey.appendMinKey( keyName );
+            ASSERT( manager->findIntersectingChunk( minKey.obj() ) == chunkMap.begin()->second );
+        }
+
+    };
+
+    //
+    // Base for tests of chunk managers seeded from the on-disk routing table cache.  Enables the
+    // cache in a temporary directory for the duration of the test.
+    //
+    class ChunkManagerDiskCacheTest : public ChunkManagerCreateFullTest {
+    public:
+
+        ChunkManagerDiskCacheTest() : _cacheDir( "sharding_routing_table_cache" ) {
+            ASSERT_OK( routingTableCache.setDirectory( _cacheDir.path() ) );
+        }
+
+        virtual ~ChunkManagerDiskCacheTest() {
+            routingTableCache.setDirectory( "" );
+        }
+
+        // A manager for the collection as mongos would build it from config.collections
+        ChunkManagerPtr loadManager( const OID& epoch ) {
+            BSONObjBuilder collDoc;
+            collDoc.append( CollectionType::ns(), collName() );
+            collDoc.append( CollectionType::keyPattern(), BSON( "_id" << 1 ) );
+            collDoc.append( CollectionType::unique(), false );
+            ChunkVersion( 0, epoch ).addToBSON( collDoc, CollectionType::DEPRECATED_lastmod() );
+
+            ChunkManagerPtr manager( new ChunkManager( collDoc.obj() ) );
+            ((ChunkManager*) manager.get())->loadExistingRanges( shard().getConnString() );
+            return manager;
+        }
+
+        // Caches the current config chunks, all marked jumbo so we can tell where they came from
+        void cacheChunksAsJumbo( const OID& epoch, const ChunkVersion& maxVersion ) {
+            vector<BSONObj> chunkDocs;
+            ChunkVersion lastVersion = lastChunkVersion();
+
+            auto_ptr<DBClientCursor> cursor =
+                client().query(ChunkType::ConfigNS, QUERY(ChunkType::ns(collName())));
+
+            while( cursor->more() ){
+                BSONObj chunk = cursor->next();
+
+                BSONObjBuilder b;
+                BSONObjIterator it( chunk );
+                while( it.more() ){
+                    BSONElement e = it.next();
+                    string fieldName = e.fieldName();
+                    if( fieldName == ChunkType::jumbo() ||
+                        fieldName == ChunkType::DEPRECATED_lastmod() ||
+                        fieldName == ChunkType::DEPRECATED_epoch() ) continue;
+                    b.append( e );
+                }
+
+                // Optionally replace the version of the last chunk
+                ChunkVersion version = ChunkVersion::fromBSON(chunk,
+                                                              ChunkType::DEPRECATED_lastmod());
+                if( maxVersion.isSet() && version.isEquivalentTo( lastVersion ) ){
+                    version = maxVersion;
+                }
+                version.addToBSON( b, ChunkType::DEPRECATED_lastmod() );
+                b.append( ChunkType::jumbo(), true );
+
+                chunkDocs.push_back( b.obj() );
+            }
+
+            ASSERT_OK( routingTableCache.save( collName(), epoch, chunkDocs ) );
+        }
+
+        BSONObj lastChunk() {
+            return client().findOne(ChunkType::ConfigNS,
+                                    Query(BSON(ChunkType::ns(collName())))
+                                        .sort(ChunkType::DEPRECATED_lastmod(), -1)).getOwned();
+        }
+
+        ChunkVersion lastChunkVersion() {
+            return ChunkVersion::fromBSON(lastChunk(), ChunkType::DEPRECATED_lastmod());
+        }
+
+        int countJumbo( const ChunkManager& manager ) {
+            int numJumbo = 0;
+            const ChunkMap& chunkMap = manager.getChunkMap();
+            for ( ChunkMap::const_iterator it = chunkMap.begin(); it != chunkMap.end(); ++it ) {
+                if ( it->second->isJumbo() ) numJumbo++;
+            }
+            return numJumbo;
+        }
+
+    private:
+        mongo::unittest::TempDir _cacheDir;
+    };
+
+    //
+    // Tests that a manager built from scratch starts from a stale disk cache and only takes the
+    // chunks which changed since from the config data.
+    //
+    class ChunkManagerStaleDiskCacheTest : public ChunkManagerDiskCacheTest {
+    public:
+
+        void run(){
+
+            createChunks( "_id" );
+            int numChunks = static_cast<int>(client().count(ChunkType::ConfigNS,
+                                                            BSON(ChunkType::ns(collName()))));
+
+            BSONObj last = lastChunk();
+            OID epoch = lastChunkVersion().epoch();
+
+            cacheChunksAsJumbo( epoch, ChunkVersion( 0, OID() ) );
+
+            // Move the collection past the cache by bumping the last chunk
+            BSONObjBuilder b;
+            ChunkVersion laterVersion = ChunkVersion( 2, 0, epoch );
+            laterVersion.addToBSON(b, ChunkType::DEPRECATED_lastmod());
+            client().update(ChunkType::ConfigNS,
+                            BSON(ChunkType::name(last[ChunkType::name()].String())),
+                            BSON("$set" << b.obj()));
+
+            ChunkManagerPtr manager = loadManager( epoch );
+
+            ASSERT( manager->getVersion().isEquivalentTo( laterVersion ) );
+            ASSERT_EQUALS( numChunks, static_cast<int>( manager->getChunkMap().size() ) );
+
+            // Only the bumped chunk was read from the config data
+            ASSERT_EQUALS( numChunks - 1, countJumbo( *manager ) );
+            ASSERT( !manager->findIntersectingChunk(
+                            last[ChunkType::min()].Obj() )->isJumbo() );
+        }
+
+    };
+
+    //
+    // Tests that a disk cache which doesn't line up with the config data is dropped and all
+    // chunks are reloaded.
+    //
+    class ChunkManagerInconsistentDiskCacheTest : public ChunkManagerDiskCacheTest {
+    public:
+
+        void run(){
+
+            createChunks( "_id" );
+            int numChunks = static_cast<int>(client().count(ChunkType::ConfigNS,
+                                                            BSON(ChunkType::ns(collName()))));
+
+            ChunkVersion version = lastChunkVersion();
+            OID epoch = version.epoch();
+
+            // The cache claims a version the config servers never had
+            cacheChunksAsJumbo( epoch, ChunkVersion( 5, 0, epoch ) );
+
+            ChunkManagerPtr manager = loadManager( epoch );
+
+            ASSERT( manager->getVersion().isEquivalentTo( version ) );
+            ASSERT_EQUALS( numChunks, static_cast<int>( manager->getChunkMap().size() ) );
+            ASSERT_EQUALS( 0, countJumbo( *manager ) );
+
+            // The cache entry was replaced by the reloaded chunks
+            vector<BSONObj> cachedChunks;
+            ASSERT( routingTableCache.load( collName(), epoch, &cachedChunks ) );
+            ASSERT_EQUALS( numChunks, static_cast<int>( cachedChunks.size() ) );
+            for( vector<BSONObj>::iterator it = cachedChunks.begin(); it != cachedChunks.end(); ++it ){
+                ASSERT( !(*it)[ChunkType::jumbo()].trueValue() );
+            }
+        }
+
+    };
+
     class ChunkDiffUnitTest {
     public:
 
@@ -630,6 +832,46 @@ namespace ShardingTests {
         ChunkDiffUnitTestInverse() : ChunkDiffUnitTest( true ) {}
     };
 
+    /**
+     * Once a connection's version has been found compatible, shardVersionOk() shouldn't look at
+     * it again until either side changes.
+     */
+    class ShardVersionOkFastPath {
+    public:
+        void run() {
+            const string ns = "unittest.shardversion";
+
+            shardingState.enable( "localhost:30000" );
+            ShardedConnectionInfo* info = ShardedConnectionInfo::get( true );
+
+            string errmsg;
+            ChunkVersion received, wanted;
+
+            unsigned long long generation = shardingState.getMetadataGeneration();
+            ASSERT( !info->isVersionVerified( ns, generation ) );
+            ASSERT( shardVersionOk( ns, errmsg, received, wanted ) );
+            ASSERT( info->isVersionVerified( ns, generation ) );
+
+            // A new version from mongos must be checked again
+            info->setVersion( ns, ChunkVersion( 1, 0, OID::gen() ) );
+            ASSERT( !info->isVersionVerified( ns, generation ) );
+            ASSERT( !shardVersionOk( ns, errmsg, received, wanted ) );
+            ASSERT( !info->isVersionVerified( ns, generation ) );
+
+            info->setVersion( ns, ChunkVersion( 0, OID() ) );
+            ASSERT( shardVersionOk( ns, errmsg, received, wanted ) );
+            ASSERT( info->isVersionVerified( ns, generation ) );
+
+            // So must any change to the shard's metadata
+            shardingState.resetMetadata( ns );
+            ASSERT( shardingState.getMetadataGeneration() != generation );
+            ASSERT( !info->isVersionVerified( ns, shardingState.getMetadataGeneration() ) );
+
+            ShardedConnectionInfo::reset();
+            shardingState.resetShardingState();
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "sharding" ) {
@@ -640,8 +882,12 @@ namespace ShardingTests {
             add< ChunkManagerCreateBasicTest >();
             add< ChunkManagerCreateFullTest >();
             add< ChunkManagerLoadBasicTest >();
+            add< ChunkManagerRoutingTest >();
+            add< ChunkManagerStaleDiskCacheTest >();
+            add< ChunkManagerInconsistentDiskCacheTest >();
             add< ChunkDiffUnitTestNormal >();
             add< ChunkDiffUnitTestInverse >();
+            add< ShardVersionOkFastPath >();
         }
     } myall;
 
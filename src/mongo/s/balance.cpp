@@ -39,6 +39,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/server.h"
 #include "mongo/s/shard.h"
+#include "mongo/s/type_changelog.h"
 #include "mongo/s/type_chunk.h"
 #include "mongo/s/type_collection.h"
 #include "mongo/s/type_mongos.h"
@@ -178,6 +179,79 @@ namespace mongo {
         return true;
     }
     
+    void Balancer::_sampleShardLoad( const Shard& shard, ShardInfo* info ) {
+        BSONObj totals;
+        try {
+            BSONObj top = shard.runCommand( "admin", BSON( "top" << 1 ) );
+            totals = top["totals"].Obj().getOwned();
+        }
+        catch ( const DBException& e ) {
+            warning() << "couldn't get op counts from " << shard.getName() << causedBy( e )
+                      << endl;
+            return;
+        }
+
+        ShardLoad& load = _shardLoad[ shard.getName() ];
+        const Date_t now = jsTime();
+        const double secs = ( now.millis - load.sampledAt.millis ) / 1000.0;
+        const bool haveLast = load.sampledAt.millis != 0 && secs > 0;
+
+        map<string,long long> counts;
+        BSONForEach( e, totals ) {
+            if ( ! e.isABSONObj() )
+                continue; // "note"
+
+            BSONObj usage = e.Obj();
+            counts[ e.fieldName() ] = usage.getFieldDotted( "queries.count" ).numberLong() +
+                                      usage.getFieldDotted( "getmore.count" ).numberLong() +
+                                      usage.getFieldDotted( "insert.count" ).numberLong() +
+                                      usage.getFieldDotted( "update.count" ).numberLong() +
+                                      usage.getFieldDotted( "remove.count" ).numberLong();
+        }
+
+        for ( map<string,long long>::const_iterator i = counts.begin(); i != counts.end(); ++i ) {
+            map<string,long long>::const_iterator before = load.opCounts.find( i->first );
+            if ( ! haveLast || before == load.opCounts.end() || i->second < before->second )
+                continue; // first sample, or the shard restarted
+
+            // smooth over rounds so one burst doesn't move chunks around
+            double rate = ( i->second - before->second ) / secs;
+            double& smoothed = load.opsPerSec[ i->first ];
+            smoothed = smoothed == 0 ? rate : ( smoothed + rate ) / 2;
+            info->setOpsPerSec( i->first, smoothed );
+        }
+
+        load.opCounts.swap( counts );
+        load.sampledAt = now;
+    }
+
+    void Balancer::_getRecentSplitPoints( DBClientBase& conn,
+                                          map< string,vector<BSONObj> >* splitPoints ) {
+        const Date_t since( jsTime() - LoadBalancingPolicy::SplitHistorySecs * 1000ULL );
+        auto_ptr<DBClientCursor> cursor = conn.query( ChangelogType::ConfigNS,
+                BSON( ChangelogType::what() << BSON( "$in" << BSON_ARRAY( "split" <<
+                                                                          "multi-split" ) ) <<
+                      ChangelogType::time() << BSON( "$gt" << since ) ) );
+        while ( cursor->more() ) {
+            BSONObj entry = cursor->nextSafe();
+            BSONObj details = entry[ChangelogType::details()].Obj();
+
+            // a split logs the two new chunks; a multi-split logs each new chunk separately
+            BSONObj point;
+            if ( entry[ChangelogType::what()].String() == "split" ) {
+                point = details["left"].Obj()[ChunkType::max()].Obj();
+            }
+            else if ( details["number"].numberInt() > 1 ) {
+                point = details["chunk"].Obj()[ChunkType::min()].Obj();
+            }
+            else {
+                continue;
+            }
+
+            (*splitPoints)[ entry[ChangelogType::ns()].String() ].push_back( point.getOwned() );
+        }
+    }
+
     /**
      * Occasionally prints a log message with shard versions if the versions are not the same
      * in the cluster.
@@ -258,10 +332,16 @@ namespace mongo {
                                                   s.tags(),
                                                   status.mongoVersion()
                                                   );
+            if ( _loadPolicy.getSettings().enabled )
+                _sampleShardLoad( s, &shardInfo[ s.getName() ] );
         }
 
         OCCASIONALLY warnOnMultiVersion( shardInfo );
 
+        map< string,vector<BSONObj> > splitPoints;
+        if ( _loadPolicy.getSettings().enabled )
+            _getRecentSplitPoints( conn, &splitPoints );
+
         //
         // 3. For each collection, check if the balancing policy recommends moving anything around.
         //
@@ -369,6 +449,8 @@ namespace mongo {
             }
 
             CandidateChunk* p = _policy->balance( ns, status, _balancedLastTime );
+            if ( ! p )
+                p = _loadPolicy.balance( ns, status, splitPoints[ns], jsTime() );
             if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
         }
     }
@@ -492,6 +574,10 @@ namespace mongo {
                         secondaryThrottle = balancerConfig[SettingsType::secondaryThrottle()].trueValue();
                     }
 
+                    _loadPolicy.setSettings( LoadBalancingSettings::fromBSON(
+                            balancerConfig["loadBalancing"].isABSONObj() ?
+                                    balancerConfig["loadBalancing"].Obj() : BSONObj() ) );
+
                     LOG(1) << "waitForDelete: " << waitForDelete << endl;
                     LOG(1) << "secondaryThrottle: " << secondaryThrottle << endl;
 
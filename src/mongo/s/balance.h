@@ -38,6 +38,8 @@
 
 namespace mongo {
 
+    class Shard;
+
     /**
      * The balancer is a background task that tries to keep the number of chunks across all servers of the cluster even. Although
      * every mongos will have one balancer running, only one of them will be active at the any given point in time. The balancer
@@ -73,6 +75,33 @@ namespace mongo {
 
         // decide which chunks to move; owned here.
         scoped_ptr<BalancerPolicy> _policy;
+
+        // moves hot chunks once chunk counts are balanced, if the balancer settings ask for it
+        LoadBalancingPolicy _loadPolicy;
+
+        // op counts from a shard's top command, and the rates worked out from them
+        struct ShardLoad {
+            Date_t sampledAt;
+            map<string,long long> opCounts; // by collection
+            map<string,double> opsPerSec;   // by collection, smoothed over rounds
+        };
+
+        // by shard name
+        map<string,ShardLoad> _shardLoad;
+
+        /**
+         * Samples the shard's per collection op counters and sets its op rates on 'info'.
+         * Failures are logged and leave 'info' without rates.
+         */
+        void _sampleShardLoad( const Shard& shard, ShardInfo* info );
+
+        /**
+         * Reads the keys collections were split at lately from the config changelog, for
+         * LoadBalancingPolicy to tell hot chunks from cold ones.
+         * @param splitPoints filled in by collection
+         */
+        void _getRecentSplitPoints( DBClientBase& conn,
+                                    map< string,vector<BSONObj> >* splitPoints );
         
         /**
          * Checks that the balancer can connect to all servers it needs to do its job.
@@ -415,6 +415,126 @@ namespace mongo {
     }
 
 
+    LoadBalancingSettings::LoadBalancingSettings()
+        : enabled( false ),
+          hotRatio( 2.0 ),
+          minOpsPerSec( 100 ),
+          cooldownSecs( 600 ) {
+    }
+
+    LoadBalancingSettings LoadBalancingSettings::fromBSON( const BSONObj& obj ) {
+        LoadBalancingSettings s;
+        s.enabled = obj["enabled"].trueValue();
+        if ( obj["hotRatio"].isNumber() )
+            s.hotRatio = obj["hotRatio"].numberDouble();
+        if ( obj["minOpsPerSec"].isNumber() )
+            s.minOpsPerSec = obj["minOpsPerSec"].numberDouble();
+        if ( obj["cooldownSecs"].isNumber() )
+            s.cooldownSecs = obj["cooldownSecs"].numberInt();
+        return s;
+    }
+
+    MigrateInfo* LoadBalancingPolicy::balance( const string& ns,
+                                               const DistributionStatus& distribution,
+                                               const vector<BSONObj>& splitPoints,
+                                               Date_t now ) {
+        if ( ! _settings.enabled )
+            return NULL;
+
+        map<string,Date_t>::const_iterator last = _lastMove.find( ns );
+        if ( last != _lastMove.end() &&
+             now.millis < last->second.millis + _settings.cooldownSecs * 1000ULL ) {
+            LOG(1) << "not moving load for " << ns << ", last moved at " << last->second << endl;
+            return NULL;
+        }
+
+        // hottest shard we can move a chunk off, and coolest one that can take it
+        string hot;
+        string cool;
+        double hotOps = -1;
+        double coolOps = numeric_limits<double>::max();
+
+        const set<string>& shards = distribution.shards();
+        for ( set<string>::const_iterator i = shards.begin(); i != shards.end(); ++i ) {
+            const ShardInfo& info = distribution.shardInfo( *i );
+            double ops = info.getOpsPerSec( ns );
+
+            if ( ! info.hasOpsQueued() && distribution.numberOfChunksInShard( *i ) > 0 &&
+                 ops > hotOps ) {
+                hot = *i;
+                hotOps = ops;
+            }
+
+            if ( ! info.isSizeMaxed() && ! info.isDraining() && ! info.hasOpsQueued() &&
+                 ops < coolOps ) {
+                cool = *i;
+                coolOps = ops;
+            }
+        }
+
+        if ( hot.empty() || cool.empty() || hot == cool )
+            return NULL;
+
+        LOG(1) << "collection : " << ns << endl;
+        LOG(1) << "hottest    : " << hot << " ops/sec " << hotOps << endl;
+        LOG(1) << "coolest    : " << cool << " ops/sec " << coolOps << endl;
+
+        if ( hotOps < _settings.minOpsPerSec || hotOps < coolOps * _settings.hotRatio )
+            return NULL;
+
+        // the chunk split most often, preferring the higher one on ties
+        const ShardInfo& coolInfo = distribution.shardInfo( cool );
+        const vector<BSONObj>& chunks = distribution.getChunks( hot );
+        const BSONObj* hotChunk = NULL;
+        int hotChunkSplits = 0;
+        int totalSplits = 0;
+        for ( unsigned i = 0; i < chunks.size(); i++ ) {
+            BSONObj min = chunks[i][ChunkType::min()].Obj();
+            BSONObj max = chunks[i][ChunkType::max()].Obj();
+            int splits = 0;
+            for ( unsigned j = 0; j < splitPoints.size(); j++ ) {
+                if ( min.woCompare( splitPoints[j] ) <= 0 && splitPoints[j].woCompare( max ) < 0 )
+                    splits++;
+            }
+            totalSplits += splits;
+
+            if ( chunks[i][ChunkType::jumbo()].trueValue() )
+                continue;
+
+            if ( ! coolInfo.hasTag( distribution.getTagForChunk( chunks[i] ) ) )
+                continue;
+
+            if ( splits == 0 || splits < hotChunkSplits )
+                continue;
+
+            hotChunk = &chunks[i];
+            hotChunkSplits = splits;
+        }
+
+        if ( ! hotChunk ) {
+            LOG(1) << "no recently split chunk of " << ns << " on " << hot
+                   << " can move to " << cool << endl;
+            return NULL;
+        }
+
+        // moving load L leaves the shards |(hotOps - L) - (coolOps + L)| apart, which is only
+        // less than they are now if L < hotOps - coolOps
+        const double chunkOps = hotOps * hotChunkSplits / totalSplits;
+        if ( chunkOps >= hotOps - coolOps ) {
+            LOG(1) << "not moving " << *hotChunk << " with about " << chunkOps << " ops/sec, "
+                   << cool << " would end up busier than " << hot << " is now" << endl;
+            return NULL;
+        }
+
+        log() << " ns: " << ns << " going to move hot chunk " << *hotChunk
+              << " (about " << chunkOps << " ops/sec)"
+              << " from: " << hot << " (" << hotOps << " ops/sec)"
+              << " to: " << cool << " (" << coolOps << " ops/sec)" << endl;
+
+        _lastMove[ns] = now;
+        return new MigrateInfo( ns, cool, hot, hotChunk->getOwned() );
+    }
+
     ShardInfo::ShardInfo( long long maxSize, long long currSize,
                           bool draining, bool opsQueued,
                           const set<string>& tags, 
@@ -446,6 +566,15 @@ namespace mongo {
         return _currSize >= _maxSize;
     }
 
+    double ShardInfo::getOpsPerSec( const string& ns ) const {
+        map<string,double>::const_iterator i = _opsPerSec.find( ns );
+        return i == _opsPerSec.end() ? 0 : i->second;
+    }
+
+    void ShardInfo::setOpsPerSec( const string& ns, double opsPerSec ) {
+        _opsPerSec[ns] = opsPerSec;
+    }
+
     bool ShardInfo::hasTag( const string& tag ) const {
         if ( tag.size() == 0 )
             return true;
@@ -101,6 +101,14 @@ namespace mongo {
 
         string getMongoVersion() const { return _mongoVersion; }
 
+        /**
+         * @return reads and writes per second the shard recently saw on 'ns', from its op
+         *         counters, or 0 if not known
+         */
+        double getOpsPerSec( const string& ns ) const;
+
+        void setOpsPerSec( const string& ns, double opsPerSec );
+
         string toString() const;
         
     private:
@@ -110,6 +118,7 @@ namespace mongo {
         bool _hasOpsQueued;
         set<string> _tags;
         string _mongoVersion;
+        map<string,double> _opsPerSec;
     };
     
     struct MigrateInfo {
@@ -213,6 +222,71 @@ namespace mongo {
         static bool _isJumbo( const BSONObj& chunk );
     };
 
+    /**
+     * Settings for LoadBalancingPolicy, from the "loadBalancing" field of the balancer settings
+     * document, e.g. { _id : "balancer", loadBalancing : { enabled : true, hotRatio : 3 } }
+     */
+    struct LoadBalancingSettings {
+        LoadBalancingSettings();
+
+        static LoadBalancingSettings fromBSON( const BSONObj& obj );
+
+        bool enabled;
+
+        // the hottest shard has to see this many times the operations of the coolest...
+        double hotRatio;
+
+        // ...and at least this many a second, so quiet collections are left alone
+        double minOpsPerSec;
+
+        // once load has been moved for a collection, how long before it may be moved again
+        int cooldownSecs;
+    };
+
+    /**
+     * Balances operations rather than chunk counts: when a collection is much busier on one shard
+     * than on another, its hot chunk moves to the cooler shard.  Only consulted once the chunk
+     * counts are balanced, so it never fights BalancerPolicy.
+     *
+     * Shards only report op counts per collection, so chunks are told apart by where autosplit
+     * has split the collection lately: it splits where writes land, so a chunk's share of the
+     * donor's recent split points is taken as its share of the donor's load.  Migrations don't
+     * split anything, so moving chunks doesn't disturb this.  Reads don't split either, so a
+     * read-only hotspot is never moved.
+     *
+     * A chunk only moves if, by that estimate, the two shards end up strictly closer in load than
+     * they were; a lone hot chunk just moves the hotspot, so it stays put.  On top of that rates
+     * are smoothed by the caller, the hot shard has to be hotRatio times busier than the cool
+     * one, and after a move the collection is left alone for cooldownSecs.
+     */
+    class LoadBalancingPolicy {
+    public:
+        // how far back the caller should look for split points
+        static const int SplitHistorySecs = 600;
+
+        LoadBalancingPolicy() {}
+
+        void setSettings( const LoadBalancingSettings& settings ) { _settings = settings; }
+        const LoadBalancingSettings& getSettings() const { return _settings; }
+
+        /**
+         * @param splitPoints keys ns was split at in the last SplitHistorySecs
+         * @param now time of this balancing round, for the cooldown
+         * @return NULL or the move taking ns's hot chunk off its hottest shard.  caller owns the
+         *         MigrateInfo instance
+         */
+        MigrateInfo* balance( const string& ns,
+                              const DistributionStatus& distribution,
+                              const vector<BSONObj>& splitPoints,
+                              Date_t now );
+
+    private:
+        LoadBalancingSettings _settings;
+
+        // when load was last moved, by collection
+        map<string,Date_t> _lastMove;
+    };
+
 
 
 }  // namespace mongo
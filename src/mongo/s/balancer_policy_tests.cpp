@@ -507,5 +507,282 @@ namespace mongo {
                 }
             }
         }
+
+        /**
+         * Replays a synthetic load trace against the balancer the way Balancer does it: one round a
+         * minute, chunk counts first and then load.  Each round every chunk gets the operations
+         * the trace gives it and shards report the sum over the chunks they own.  A chunk is split
+         * (its lastmod bumped and a split point inside it recorded) every OpsPerSplit operations,
+         * as autosplit would do, and a migration bumps the moved chunk and one left on the donor,
+         * as the moveChunk commit does.  Chunks keep their bounds, so the trace stays put.
+         */
+        class LoadSimulator {
+        public:
+            // operations per second on chunk 'chunk' in round 'round'
+            typedef double (*LoadTrace)( int round, int chunk, int numChunks );
+
+            static const int OpsPerSplit = 60000;
+
+            LoadSimulator( int numShards, int numChunks, const LoadBalancingSettings& settings )
+                : _numShards( numShards ), _epoch( OID::gen() ), _majorVersion( 1 ),
+                  _loadMoves( 0 ), _countMoves( 0 ) {
+                _loadPolicy.setSettings( settings );
+                for ( int i = 0; i < numChunks; i++ ) {
+                    SimChunk c;
+                    c.shard = shardName( i * numShards / numChunks );
+                    c.version = ChunkVersion( 1, i, _epoch );
+                    c.unsplitOps = 0;
+                    _chunks.push_back( c );
+                }
+            }
+
+            static string shardName( int i ) {
+                return str::stream() << "shard" << i;
+            }
+
+            void setDraining( const string& shard ) { _draining.insert( shard ); }
+
+            void run( int rounds, LoadTrace trace ) {
+                for ( int round = 0; round < rounds; round++ ) {
+                    ShardToChunksMap chunkMap;
+                    ShardInfoMap shardInfo;
+                    map<string,double> shardOps;
+
+                    for ( int i = 0; i < _numShards; i++ )
+                        chunkMap[shardName( i )];
+
+                    for ( unsigned i = 0; i < _chunks.size(); i++ ) {
+                        double ops = trace( round, i, _chunks.size() );
+                        shardOps[_chunks[i].shard] += ops;
+
+                        // autosplit
+                        _chunks[i].unsplitOps += ops * 60;
+                        while ( _chunks[i].unsplitOps >= OpsPerSplit ) {
+                            _chunks[i].unsplitOps -= OpsPerSplit;
+                            _chunks[i].version = newestVersion();
+                            _chunks[i].version.incMinor();
+                            _splits.push_back( make_pair( round, BSON( "x" << i + 0.5 ) ) );
+                        }
+
+                        chunkMap[_chunks[i].shard].push_back( chunkDoc( i ) );
+                    }
+
+                    for ( ShardToChunksMap::const_iterator i = chunkMap.begin();
+                          i != chunkMap.end();
+                          ++i ) {
+                        ShardInfo info( 0, i->second.size(), _draining.count( i->first ) > 0,
+                                        false );
+                        info.setOpsPerSec( "ns", shardOps[i->first] );
+                        shardInfo[i->first] = info;
+                    }
+
+                    vector<BSONObj> splitPoints;
+                    const int historyRounds = LoadBalancingPolicy::SplitHistorySecs / 60;
+                    for ( unsigned i = 0; i < _splits.size(); i++ ) {
+                        if ( _splits[i].first > round - historyRounds )
+                            splitPoints.push_back( _splits[i].second );
+                    }
+
+                    DistributionStatus status( shardInfo, chunkMap );
+                    Date_t now( round * 60 * 1000ULL );
+                    auto_ptr<MigrateInfo> m( BalancerPolicy::balance( "ns", status, 0 ) );
+                    if ( m.get() ) {
+                        _countMoves++;
+                    }
+                    else {
+                        m.reset( _loadPolicy.balance( "ns", status, splitPoints, now ) );
+                        if ( m.get() ) {
+                            _loadMoves++;
+                            _loadMovesTo.push_back( m->to );
+                            _lastLoadMoved = m->chunk.min;
+                        }
+                    }
+
+                    if ( m.get() )
+                        migrate( chunkIndex( m->chunk.min ), m->from, m->to );
+                }
+            }
+
+            int loadMoves() const { return _loadMoves; }
+            int countMoves() const { return _countMoves; }
+            const vector<string>& loadMovesTo() const { return _loadMovesTo; }
+            BSONObj lastLoadMoved() const { return _lastLoadMoved; }
+
+            BSONObj chunkMin( int i ) const {
+                if ( i == 0 )
+                    return BSON( "x" << BSON( "$minKey" << 1 ) );
+                return BSON( "x" << i );
+            }
+
+            string shardOf( int i ) const { return _chunks[i].shard; }
+
+        private:
+            struct SimChunk {
+                string shard;
+                ChunkVersion version;
+                double unsplitOps; // since autosplit last split it
+            };
+
+            void migrate( int moved, const string& from, const string& to ) {
+                SimChunk& c = _chunks[moved];
+                ASSERT_EQUALS( from, c.shard );
+                c.shard = to;
+
+                // the commit gives the moved chunk a new major version, and the donor's highest
+                // chunk, if it has any left, that version with minor 1
+                _majorVersion++;
+                c.version = ChunkVersion( _majorVersion, 0, _epoch );
+                int donorChunk = -1;
+                for ( unsigned i = 0; i < _chunks.size(); i++ ) {
+                    if ( _chunks[i].shard == from &&
+                         ( donorChunk < 0 || _chunks[donorChunk].version < _chunks[i].version ) )
+                        donorChunk = i;
+                }
+                if ( donorChunk >= 0 )
+                    _chunks[donorChunk].version = ChunkVersion( _majorVersion, 1, _epoch );
+            }
+
+            BSONObj chunkDoc( int i ) const {
+                BSONObjBuilder b;
+                b.append( ChunkType::min(), chunkMin( i ) );
+                if ( i == static_cast<int>( _chunks.size() ) - 1 )
+                    b.append( ChunkType::max(), BSON( "x" << BSON( "$maxKey" << 1 ) ) );
+                else
+                    b.append( ChunkType::max(), BSON( "x" << i + 1 ) );
+                _chunks[i].version.addToBSON( b, ChunkType::DEPRECATED_lastmod() );
+                return b.obj();
+            }
+
+            int chunkIndex( const BSONObj& min ) const {
+                for ( unsigned i = 0; i < _chunks.size(); i++ ) {
+                    if ( chunkMin( i ) == min )
+                        return i;
+                }
+                verify( 0 );
+                return -1;
+            }
+
+            ChunkVersion newestVersion() const {
+                ChunkVersion newest = _chunks[0].version;
+                for ( unsigned i = 1; i < _chunks.size(); i++ )
+                    newest = std::max( newest, _chunks[i].version );
+                return newest;
+            }
+
+            int _numShards;
+            OID _epoch;
+            int _majorVersion;
+            vector<SimChunk> _chunks;
+            set<string> _draining;
+            LoadBalancingPolicy _loadPolicy;
+
+            // round split in, and the split point
+            vector< pair<int,BSONObj> > _splits;
+
+            int _loadMoves;
+            int _countMoves;
+            vector<string> _loadMovesTo;
+            BSONObj _lastLoadMoved;
+        };
+
+        // inserts on a time-keyed collection: all the writes go to the top chunk
+        double insertsAtTop( int round, int chunk, int numChunks ) {
+            return chunk == numChunks - 1 ? 1000 : 10;
+        }
+
+        // writes spread over the top two chunks
+        double insertsAtTopTwo( int round, int chunk, int numChunks ) {
+            return chunk >= numChunks - 2 ? 500 : 10;
+        }
+
+        double uniformLoad( int round, int chunk, int numChunks ) {
+            return 100;
+        }
+
+        double quietInsertsAtTop( int round, int chunk, int numChunks ) {
+            return chunk == numChunks - 1 ? 50 : 0;
+        }
+
+        LoadBalancingSettings enabledLoadBalancing() {
+            LoadBalancingSettings settings;
+            settings.enabled = true;
+            settings.hotRatio = 2;
+            settings.minOpsPerSec = 100;
+            settings.cooldownSecs = 600;
+            return settings;
+        }
+
+        TEST( LoadBalancingPolicyTests, SettingsFromBSON ) {
+            LoadBalancingSettings defaults = LoadBalancingSettings::fromBSON( BSONObj() );
+            ASSERT( ! defaults.enabled );
+
+            LoadBalancingSettings s = LoadBalancingSettings::fromBSON(
+                    BSON( "enabled" << true << "hotRatio" << 3 << "cooldownSecs" << 60 ) );
+            ASSERT( s.enabled );
+            ASSERT_EQUALS( 3.0, s.hotRatio );
+            ASSERT_EQUALS( defaults.minOpsPerSec, s.minOpsPerSec );
+            ASSERT_EQUALS( 60, s.cooldownSecs );
+        }
+
+        TEST( LoadBalancingPolicyTests, OffByDefault ) {
+            LoadSimulator sim( 3, 9, LoadBalancingSettings() );
+            sim.run( 60, insertsAtTopTwo );
+            ASSERT_EQUALS( 0, sim.loadMoves() );
+            ASSERT_EQUALS( 0, sim.countMoves() );
+        }
+
+        TEST( LoadBalancingPolicyTests, HotChunkMovesToCoolestShard ) {
+            // the first split points show up in the second round
+            LoadSimulator sim( 3, 9, enabledLoadBalancing() );
+            sim.run( 2, insertsAtTopTwo );
+            ASSERT_EQUALS( 1, sim.loadMoves() );
+            ASSERT_EQUALS( sim.chunkMin( 8 ), sim.lastLoadMoved() );
+            ASSERT_NOT_EQUALS( LoadSimulator::shardName( 2 ), sim.shardOf( 8 ) );
+            ASSERT_EQUALS( LoadSimulator::shardName( 2 ), sim.shardOf( 7 ) );
+        }
+
+        TEST( LoadBalancingPolicyTests, LoneHotChunkStaysPut ) {
+            // moving the only hot chunk would just move the hotspot
+            LoadSimulator sim( 3, 9, enabledLoadBalancing() );
+            sim.run( 60, insertsAtTop );
+            ASSERT_EQUALS( 0, sim.loadMoves() );
+        }
+
+        TEST( LoadBalancingPolicyTests, CooldownPreventsThrashing ) {
+            // an hour of rounds, a minute apart, with a ten minute cooldown
+            LoadSimulator sim( 3, 9, enabledLoadBalancing() );
+            sim.run( 60, insertsAtTopTwo );
+            ASSERT_EQUALS( 1, sim.loadMoves() );
+        }
+
+        TEST( LoadBalancingPolicyTests, NoThrashingWithoutCooldown ) {
+            // once the hot chunks are apart, moving either would only make things worse
+            LoadBalancingSettings settings = enabledLoadBalancing();
+            settings.cooldownSecs = 0;
+            LoadSimulator sim( 3, 9, settings );
+            sim.run( 60, insertsAtTopTwo );
+            ASSERT_EQUALS( 1, sim.loadMoves() );
+        }
+
+        TEST( LoadBalancingPolicyTests, EvenLoadStaysPut ) {
+            LoadSimulator sim( 3, 9, enabledLoadBalancing() );
+            sim.run( 60, uniformLoad );
+            ASSERT_EQUALS( 0, sim.loadMoves() );
+        }
+
+        TEST( LoadBalancingPolicyTests, QuietCollectionStaysPut ) {
+            LoadSimulator sim( 3, 9, enabledLoadBalancing() );
+            sim.run( 60, quietInsertsAtTop );
+            ASSERT_EQUALS( 0, sim.loadMoves() );
+        }
+
+        TEST( LoadBalancingPolicyTests, NoMovesToDrainingShard ) {
+            LoadSimulator sim( 3, 9, enabledLoadBalancing() );
+            sim.setDraining( LoadSimulator::shardName( 0 ) );
+            sim.run( 60, insertsAtTopTwo );
+            const vector<string>& to = sim.loadMovesTo();
+            for ( unsigned i = 0; i < to.size(); i++ )
+                ASSERT_NOT_EQUALS( LoadSimulator::shardName( 0 ), to[i] );
+        }
     }
 }
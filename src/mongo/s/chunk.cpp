@@ -32,10 +32,13 @@
 
 #include "mongo/s/chunk.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/queryutil.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/chunk_diff.h"
 #include "mongo/s/chunk_version.h"
@@ -43,7 +46,9 @@
 #include "mongo/s/config.h"
 #include "mongo/s/cursors.h"
 #include "mongo/s/grid.h"
+#include "mongo/s/routing_table_cache.h"
 #include "mongo/s/strategy.h"
+#include "mongo/s/type_chunk.h"
 #include "mongo/s/type_collection.h"
 #include "mongo/s/type_settings.h"
 #include "mongo/util/concurrency/ticketholder.h"
@@ -603,11 +608,41 @@ namespace mongo {
 
     AtomicUInt ChunkManager::NextSequenceNumber = 1;
 
+    // Number and time of chunk metadata loads, from scratch or incremental
+    static TimerStats chunkManagerLoadStats;
+    static ServerStatusMetricField<TimerStats> displayChunkManagerLoads(
+                                                    "sharding.chunkManager.loads",
+                                                    &chunkManagerLoadStats );
+    // Chunk documents read from the config servers by those loads
+    static Counter64 chunksFetchedStats;
+    static ServerStatusMetricField<Counter64> displayChunksFetched(
+                                                    "sharding.chunkManager.chunksFetched",
+                                                    &chunksFetchedStats );
+    // On-disk routing table cache usage, see --routingTableCacheDir
+    static Counter64 diskCacheHitStats;
+    static ServerStatusMetricField<Counter64> displayDiskCacheHits(
+                                                    "sharding.chunkManager.diskCache.hits",
+                                                    &diskCacheHitStats );
+    static Counter64 diskCacheMissStats;
+    static ServerStatusMetricField<Counter64> displayDiskCacheMisses(
+                                                    "sharding.chunkManager.diskCache.misses",
+                                                    &diskCacheMissStats );
+    static Counter64 diskCacheChunksStats;
+    static ServerStatusMetricField<Counter64> displayDiskCacheChunks(
+                                                    "sharding.chunkManager.diskCache.chunksLoaded",
+                                                    &diskCacheChunksStats );
+    static Counter64 diskCacheSaveStats;
+    static ServerStatusMetricField<Counter64> displayDiskCacheSaves(
+                                                    "sharding.chunkManager.diskCache.saves",
+                                                    &diskCacheSaveStats );
+
     ChunkManager::ChunkManager( const string& ns, const ShardKeyPattern& pattern , bool unique ) :
         _ns( ns ),
         _key( pattern ),
         _unique( unique ),
         _chunkRanges(),
+        _routingTable(),
+        _routingChunks(),
         _mutex("ChunkManager"),
         _sequenceNumber(++NextSequenceNumber)
     {
@@ -627,6 +662,8 @@ namespace mongo {
                                                         BSONObj()),
         _unique(collDoc[CollectionType::unique()].trueValue()),
         _chunkRanges(),
+        _routingTable(),
+        _routingChunks(),
         _mutex("ChunkManager"),
         // The shard versioning mechanism hinges on keeping track of the number of times we reloaded ChunkManager's.
         // Increasing this number here will prompt checkShardVersion() to refresh the connection-level versions to
@@ -649,6 +686,8 @@ namespace mongo {
         _key( oldManager->getShardKey() ),
         _unique( oldManager->isUnique() ),
         _chunkRanges(),
+        _routingTable(),
+        _routingChunks(),
         _mutex("ChunkManager"),
         _sequenceNumber(++NextSequenceNumber)
     {
@@ -672,12 +711,14 @@ namespace mongo {
 
             if( success ){
                 {
-                    int ms = t.millis();
+                    int ms = chunkManagerLoadStats.record( t );
                     log() << "ChunkManager: time to load chunks for " << _ns << ": " << ms << "ms"
                           << " sequenceNumber: " << _sequenceNumber
                           << " version: " << _version.toString()
                           << " based on: " <<
-                           ( _oldManager.get() ? _oldManager->getVersion().toString() : "(empty)" )
+                           ( _oldManager.get() ? _oldManager->getVersion().toString() :
+                             _diskCacheVersion.isSet() ? _diskCacheVersion.toString() + " (disk cache)" :
+                                                         "(empty)" )
                           << endl;
                 }
 
@@ -691,6 +732,24 @@ namespace mongo {
                     const_cast<ShardVersionMap&>(_shardVersions).swap(shardVersions);
                     const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(_chunkMap);
 
+                    ChunkRoutingTable& table = const_cast<ChunkRoutingTable&>(_routingTable);
+                    vector<ChunkPtr>& routed = const_cast<vector<ChunkPtr>&>(_routingChunks);
+                    routed.reserve(_chunkMap.size());
+                    for (ChunkMap::const_iterator i = _chunkMap.begin(); i != _chunkMap.end(); ++i) {
+                        table.append(i->first);
+                        routed.push_back(i->second);
+                    }
+
+                    // Only rewrite the disk cache if we actually moved past what we started
+                    // from, and not more than once per save interval
+                    ChunkVersion baseVersion = _oldManager ? _oldManager->getVersion() :
+                                                             _diskCacheVersion;
+                    if ( routingTableCache.isEnabled() && _version.isSet() &&
+                         !baseVersion.isEquivalentTo( _version ) &&
+                         routingTableCache.shouldSave( _ns, jsTime() ) ) {
+                        _saveToDiskCache();
+                    }
+
                     // Once we load data, clear reference to old manager
                     _oldManager.reset();
 
@@ -705,6 +764,16 @@ namespace mongo {
             warning() << "ChunkManager loaded an invalid config for " << _ns
                       << ", trying again" << endl;
 
+            // The disk cache may be what's bad, so don't seed the next try from it
+            if ( _diskCacheVersion.isSet() ) {
+                warning() << "dropping disk cache of chunks for " << _ns << " at version "
+                          << _diskCacheVersion << endl;
+
+                routingTableCache.remove( _ns );
+                _version = ChunkVersion( 0, _version.epoch() );
+                _diskCacheVersion = ChunkVersion( 0, OID() );
+            }
+
             sleepmillis(10 * (3-tries));
         }
 
@@ -760,6 +829,7 @@ namespace mongo {
 
         // Reset the max version, but not the epoch, when we aren't loading from the oldManager
         _version = ChunkVersion( 0, _version.epoch() );
+        _diskCacheVersion = ChunkVersion( 0, OID() );
         set<ChunkVersion> minorVersions;
 
         // If we have a previous version of the ChunkManager to work from, use that info to reduce
@@ -797,6 +867,10 @@ namespace mongo {
                    << " using old chunk manager w/ version " << _version.toString()
                    << " and " << oldChunkMap.size() << " chunks" << endl;
         }
+        else if( routingTableCache.isEnabled() && _version.epoch().isSet() ){
+            // Otherwise start from the chunks we saved to disk for this epoch, if any
+            _seedFromDiskCache( chunkMap, shardVersions );
+        }
 
         // Attach a diff tracker for the versioned chunk data
         CMConfigDiffTracker differ( this );
@@ -804,7 +878,26 @@ namespace mongo {
 
         // Diff tracker should *always* find at least one chunk if collection exists
         int diffsApplied = differ.calculateConfigDiff( config, minorVersions );
+
+        if( diffsApplied <= 0 && _diskCacheVersion.isSet() ){
+
+            // The cached max version chunk is gone, so the cache can't be trusted to line up
+            // with the config data.  Throw it away and load everything.
+            warning() << "disk cache of chunks for " << _ns << " at version " << _diskCacheVersion
+                      << " does not match config data, reloading all chunks" << endl;
+
+            routingTableCache.remove( _ns );
+
+            chunkMap.clear();
+            shardVersions.clear();
+            _version = ChunkVersion( 0, _diskCacheVersion.epoch() );
+            _diskCacheVersion = ChunkVersion( 0, OID() );
+
+            diffsApplied = differ.calculateConfigDiff( config, minorVersions );
+        }
+
         if( diffsApplied > 0 ){
+            chunksFetchedStats.increment( diffsApplied );
 
             LOG(2) << "loaded " << diffsApplied << " chunks into new chunk manager for " << _ns
                    << " with version " << _version << endl;
@@ -856,6 +949,91 @@ namespace mongo {
 
     }
 
+    void ChunkManager::_seedFromDiskCache( ChunkMap& chunkMap, ShardVersionMap& shardVersions ) {
+
+        vector<BSONObj> cachedChunks;
+        if ( !routingTableCache.load( _ns, _version.epoch(), &cachedChunks ) ) {
+            diskCacheMissStats.increment();
+            return;
+        }
+
+        ChunkVersion maxVersion( 0, _version.epoch() );
+
+        try {
+            for ( vector<BSONObj>::const_iterator it = cachedChunks.begin();
+                  it != cachedChunks.end(); ++it ) {
+
+                ChunkPtr c( new Chunk( this, *it ) );
+                if ( !c->getLastmod().hasCompatibleEpoch( maxVersion.epoch() ) ) {
+                    warning() << "ignoring disk cache of chunks for " << _ns
+                              << ", found chunk " << c->toString() << " with a different epoch"
+                              << endl;
+                    chunkMap.clear();
+                    shardVersions.clear();
+                    diskCacheMissStats.increment();
+                    return;
+                }
+
+                chunkMap.insert( make_pair( c->getMax(), c ) );
+
+                ChunkVersion& shardVersion = shardVersions[c->getShard()];
+                if ( !shardVersion.isSet() || shardVersion < c->getLastmod() ) {
+                    shardVersion = c->getLastmod();
+                }
+                if ( maxVersion < c->getLastmod() ) {
+                    maxVersion = c->getLastmod();
+                }
+            }
+        }
+        catch ( const DBException& e ) {
+            // e.g. a shard which has since been removed
+            warning() << "ignoring disk cache of chunks for " << _ns << causedBy( e ) << endl;
+            chunkMap.clear();
+            shardVersions.clear();
+            diskCacheMissStats.increment();
+            return;
+        }
+
+        _version = maxVersion;
+        _diskCacheVersion = maxVersion;
+
+        diskCacheHitStats.increment();
+        diskCacheChunksStats.increment( cachedChunks.size() );
+
+        LOG(1) << "loading chunk manager for collection " << _ns
+               << " using disk cache w/ version " << _version.toString()
+               << " and " << chunkMap.size() << " chunks" << endl;
+    }
+
+    void ChunkManager::_saveToDiskCache() const {
+
+        vector<BSONObj> chunkDocs;
+        chunkDocs.reserve( _chunkMap.size() );
+
+        for ( ChunkMap::const_iterator it = _chunkMap.begin(); it != _chunkMap.end(); ++it ) {
+            const Chunk& c = *it->second;
+
+            BSONObjBuilder b;
+            b.append( ChunkType::ns(), _ns );
+            b.append( ChunkType::min(), c.getMin() );
+            b.append( ChunkType::max(), c.getMax() );
+            b.append( ChunkType::shard(), c.getShard().getName() );
+            c.getLastmod().addToBSON( b, ChunkType::DEPRECATED_lastmod() );
+            if ( c.isJumbo() ) b.append( ChunkType::jumbo(), true );
+
+            chunkDocs.push_back( b.obj() );
+        }
+
+        Status status = routingTableCache.save( _ns, _version.epoch(), chunkDocs );
+        if ( !status.isOK() ) {
+            warning() << "could not save disk cache of chunks for " << _ns
+                      << causedBy( status.reason() ) << endl;
+            return;
+        }
+
+        diskCacheSaveStats.increment();
+    }
+
     ChunkManagerPtr ChunkManager::reload(bool force) const {
         return grid.getDBConfig(getns())->getChunkManager(getns(), force);
     }
@@ -1065,10 +1243,10 @@ namespace mongo {
             BSONObj foo;
             ChunkPtr c;
             {
-                ChunkMap::const_iterator it = _chunkMap.upper_bound( point );
-                if (it != _chunkMap.end()) {
-                    foo = it->first;
-                    c = it->second;
+                size_t i = _routingTable.upperBound( point );
+                if ( i < _routingChunks.size() ) {
+                    c = _routingChunks[i];
+                    foo = c->getMax();
                 }
             }
 
@@ -1278,6 +1456,8 @@ namespace mongo {
         conn.done();
         LOG(1) << "ChunkManager::drop : " << _ns << "\t removed chunk data" << endl;
 
+        routingTableCache.remove( _ns );
+
         for ( set<Shard>::iterator i=seen.begin(); i!=seen.end(); i++ ) {
             ScopedDbConnection conn(i->getConnString());
             BSONObj res;
@@ -1361,7 +1541,7 @@ namespace mongo {
             }
 
             // Make sure we match the original chunks
-            const ChunkMap chunks = _ranges.begin()->second->getManager()->_chunkMap;
+            const ChunkMap& chunks = _ranges.begin()->second->getManager()->_chunkMap;
             for ( ChunkMap::const_iterator i=chunks.begin(); i!=chunks.end(); ++i ) {
                 const ChunkPtr chunk = i->second;
 
@@ -1434,6 +1614,8 @@ namespace mongo {
     ChunkManager::ChunkManager() :
     _unique(),
     _chunkRanges(),
+    _routingTable(),
+    _routingChunks(),
     _mutex( "ChunkManager" ),
     _sequenceNumber()
     {}
@@ -33,6 +33,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/bson/util/atomic_int.h"
 #include "mongo/client/distlock.h"
+#include "mongo/s/chunk_routing_table.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/shard.h"
 #include "mongo/s/shardkey.h"
@@ -424,7 +425,7 @@ namespace mongo {
         /** @param shards set to the shards covered by the interval [min, max], see SERVER-4791 */
         void getShardsForRange( set<Shard>& shards, const BSONObj& min, const BSONObj& max ) const;
 
-        ChunkMap getChunkMap() const { return _chunkMap; }
+        const ChunkMap& getChunkMap() const { return _chunkMap; }
 
         /**
          * Returns true if, for this shard, the chunks are identical in both chunk managers
@@ -466,6 +467,11 @@ namespace mongo {
                                     ShardVersionMap& shardVersions, ChunkManagerPtr oldManager);
         static bool _isValid(const ChunkMap& chunks);
 
+        // seeds an empty load with the chunks of the current epoch saved on disk, if any
+        void _seedFromDiskCache( ChunkMap& chunks, ShardVersionMap& shardVersions );
+        // replaces the disk cache entry for this namespace with our chunks
+        void _saveToDiskCache() const;
+
         // end helpers
 
         // All members should be const for thread-safety
@@ -476,6 +482,10 @@ namespace mongo {
         const ChunkMap _chunkMap;
         const ChunkRangeManager _chunkRanges;
 
+        // the max keys of _chunkMap for findIntersectingChunk(), and its chunks in the same order
+        const ChunkRoutingTable _routingTable;
+        const vector<ChunkPtr> _routingChunks;
+
         const set<Shard> _shards;
 
         const ShardVersionMap _shardVersions; // max version per shard
@@ -487,6 +497,9 @@ namespace mongo {
         // cleared after loading chunks
         ChunkManagerPtr _oldManager;
 
+        // max version of the chunks seeded from the disk cache, unset if we didn't use it
+        ChunkVersion _diskCacheVersion;
+
         mutable mutex _mutex; // only used with _nsLock
 
         const unsigned long long _sequenceNumber;
@@ -0,0 +1,214 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/s/chunk_routing_table.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace mongo {
+
+    namespace {
+
+        const unsigned long long SignBit = 1ULL << 63;
+
+        // doubles of smaller magnitude compare against longs as woCompare does (see
+        // compareElementValues): the conversion to double is exact on both sides, or the long
+        // is out of their range either way
+        const double TwoTo53 = 9007199254740992.0;
+
+        /** appends to a vector<char> or string with the BufBuilder calls the encoder uses */
+        template <class Container>
+        class ContainerSink {
+        public:
+            explicit ContainerSink( Container* c ) : _c( c ) { }
+            void appendUChar( unsigned char c ) { _c->push_back( static_cast<char>( c ) ); }
+            void appendBuf( const void* src, size_t len ) {
+                const char* p = static_cast<const char*>( src );
+                _c->insert( _c->end(), p, p + len );
+            }
+        private:
+            Container* _c;
+        };
+
+        template <class Sink>
+        void appendBigEndian( Sink* out, unsigned long long v ) {
+            unsigned char b[8];
+            for ( int i = 7; i >= 0; i-- ) {
+                b[i] = static_cast<unsigned char>( v & 0xff );
+                v >>= 8;
+            }
+            out->appendBuf( b, sizeof( b ) );
+        }
+
+        /**
+         * Numbers are the integral part as a 64 bit integer and the fraction as the bits of a
+         * non negative double, both big endian and the first with its sign bit flipped.
+         */
+        template <class Sink>
+        void appendNumber( Sink* out, long long whole, double fraction ) {
+            appendBigEndian( out, static_cast<unsigned long long>( whole ) ^ SignBit );
+            unsigned long long bits;
+            memcpy( &bits, &fraction, sizeof( bits ) );
+            appendBigEndian( out, bits );
+        }
+
+        template <class Sink>
+        bool encodeElement( const BSONElement& e, Sink* out ) {
+            // elements of different types order by canonical type, whatever their values
+            out->appendUChar( static_cast<unsigned char>( e.canonicalType() + 1 ) );
+
+            switch ( e.type() ) {
+            case MinKey:
+            case MaxKey:
+            case Undefined:
+            case jstNULL:
+                return true;
+            case NumberInt:
+            case NumberLong:
+                appendNumber( out, e.numberLong(), 0.0 );
+                return true;
+            case NumberDouble: {
+                const double d = e._numberDouble();
+                if ( !( d > -TwoTo53 && d < TwoTo53 ) ) // NaN too
+                    return false;
+                const double whole = std::floor( d );
+                appendNumber( out, static_cast<long long>( whole ), d - whole );
+                return true;
+            }
+            case String:
+            case Symbol: {
+                // zero bytes are escaped so the terminator sorts below any continuation
+                const char* s = e.valuestr();
+                const int n = e.valuestrsize() - 1;
+                for ( int i = 0; i < n; i++ ) {
+                    out->appendUChar( static_cast<unsigned char>( s[i] ) );
+                    if ( s[i] == 0 )
+                        out->appendUChar( 0xff );
+                }
+                out->appendUChar( 0 );
+                out->appendUChar( 0 );
+                return true;
+            }
+            case jstOID:
+                out->appendBuf( e.value(), 12 );
+                return true;
+            case Bool: {
+                const unsigned char b = static_cast<unsigned char>( *e.value() );
+                if ( b > 1 )
+                    return false;
+                out->appendUChar( b );
+                return true;
+            }
+            case Date:
+                appendBigEndian( out, static_cast<unsigned long long>( e.date().millis ) ^ SignBit );
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        template <class Sink>
+        bool encodeKeyTo( const BSONObj& key, Sink* out ) {
+            // a key that is a prefix of another encodes to a prefix of it, and sorts first
+            BSONObjIterator i( key );
+            while ( i.more() ) {
+                if ( !encodeElement( i.next(), out ) )
+                    return false;
+            }
+            return true;
+        }
+
+        int compareEncoded( const char* l, size_t llen, const char* r, size_t rlen ) {
+            int res = memcmp( l, r, std::min( llen, rlen ) );
+            if ( res )
+                return res;
+            if ( llen == rlen )
+                return 0;
+            return llen < rlen ? -1 : 1;
+        }
+
+        // orders keys like the ChunkMap's BSONObjCmp, skipping the field names
+        struct ShardKeyLess {
+            bool operator()( const BSONObj& l, const BSONObj& r ) const {
+                return l.woCompare( r, BSONObj(), false ) < 0;
+            }
+        };
+
+    } // namespace
+
+    bool ChunkRoutingTable::encodeKey( const BSONObj& key, std::string* out ) {
+        ContainerSink<std::string> sink( out );
+        return encodeKeyTo( key, &sink );
+    }
+
+    void ChunkRoutingTable::append( const BSONObj& max ) {
+        DEV verify( _maxes.empty() || ShardKeyLess()( _maxes.back(), max ) );
+        _maxes.push_back( max );
+
+        if ( !_encoded )
+            return;
+
+        ContainerSink< std::vector<char> > sink( &_keyData );
+        if ( !encodeKeyTo( max, &sink ) ) {
+            _encoded = false;
+            std::vector<char>().swap( _keyData );
+            std::vector<size_t>().swap( _keyEnds );
+            return;
+        }
+        _keyEnds.push_back( _keyData.size() );
+    }
+
+    size_t ChunkRoutingTable::upperBound( const BSONObj& key ) const {
+        if ( _encoded ) {
+            StackBufBuilder b;
+            if ( encodeKeyTo( key, &b ) )
+                return _encodedUpperBound( b.buf(), b.len() );
+        }
+        return std::upper_bound( _maxes.begin(), _maxes.end(), key, ShardKeyLess() )
+            - _maxes.begin();
+    }
+
+    size_t ChunkRoutingTable::_encodedUpperBound( const char* key, size_t len ) const {
+        const char* data = _keyData.empty() ? NULL : &_keyData[0];
+        size_t lo = 0;
+        size_t hi = _keyEnds.size();
+        while ( lo < hi ) {
+            const size_t mid = lo + ( hi - lo ) / 2;
+            const size_t begin = mid == 0 ? 0 : _keyEnds[mid - 1];
+            if ( compareEncoded( data + begin, _keyEnds[mid] - begin, key, len ) > 0 )
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        return lo;
+    }
+
+}
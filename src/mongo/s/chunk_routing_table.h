@@ -0,0 +1,89 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * Finds which of a collection's chunks a shard key falls in: given the chunks' max keys in
+     * ascending order, upperBound() returns the position of the first one greater than a key.
+     *
+     * Keys are stored pre-encoded into a form where memcmp() order is the order woCompare()
+     * gives shard keys (field names aside, all keys of a collection have the same ones), packed
+     * one after the other in a single buffer.  A lookup is then a binary search of byte string
+     * compares over contiguous memory, instead of a BSON comparison per step down the nodes of
+     * a map.
+     *
+     * The encoding covers the types shard keys are made of in practice: MinKey, MaxKey,
+     * undefined, null, numbers (doubles only when integral arithmetic on them is exact, below
+     * 2^53), strings, ObjectIds, booleans and dates.  If a chunk bound holds anything else the
+     * table compares BSON instead; a key to look up that can't be encoded is compared as BSON
+     * just for that lookup.
+     *
+     * A table is filled once and not changed after, so lookups need no locking.
+     */
+    class ChunkRoutingTable {
+    public:
+        ChunkRoutingTable() : _encoded( true ) { }
+
+        /** adds the next max key; keys must be added in ascending order */
+        void append( const BSONObj& max );
+
+        /** @return the position of the first max key greater than key, size() if none is */
+        size_t upperBound( const BSONObj& key ) const;
+
+        size_t size() const { return _maxes.size(); }
+
+        /** @return false if some max key couldn't be encoded, so lookups compare BSON */
+        bool encoded() const { return _encoded; }
+
+        /**
+         * Appends the memcmp()-ordered form of key to out.
+         * @return false, with out in an unspecified state, if key holds a type not encoded
+         */
+        static bool encodeKey( const BSONObj& key, std::string* out );
+
+    private:
+        size_t _encodedUpperBound( const char* key, size_t len ) const;
+
+        std::vector<BSONObj> _maxes;
+
+        // encoded max keys, key i is [_keyEnds[i-1], _keyEnds[i]) of _keyData
+        std::vector<char> _keyData;
+        std::vector<size_t> _keyEnds;
+        bool _encoded;
+    };
+
+}
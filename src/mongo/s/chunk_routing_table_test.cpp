@@ -0,0 +1,210 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+
+#include "mongo/s/chunk_routing_table.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::ChunkRoutingTable;
+    using mongo::Date_t;
+    using mongo::OID;
+    using std::string;
+    using std::vector;
+
+    int sign( int x ) {
+        return x < 0 ? -1 : ( x > 0 ? 1 : 0 );
+    }
+
+    int compareEncoded( const BSONObj& l, const BSONObj& r ) {
+        string le;
+        string re;
+        ASSERT( ChunkRoutingTable::encodeKey( l, &le ) );
+        ASSERT( ChunkRoutingTable::encodeKey( r, &re ) );
+        return sign( le.compare( re ) );
+    }
+
+    // one field values of every encoded type, including the corner cases of each
+    vector<BSONObj> sampleValues() {
+        vector<BSONObj> values;
+        values.push_back( BSON( "a" << mongo::MINKEY ) );
+        values.push_back( BSON( "a" << mongo::MAXKEY ) );
+        values.push_back( BSON( "a" << mongo::BSONNULL ) );
+        values.push_back( BSON( "a" << mongo::BSONUndefined ) );
+
+        values.push_back( BSON( "a" << 0 ) );
+        values.push_back( BSON( "a" << 1 ) );
+        values.push_back( BSON( "a" << -1 ) );
+        values.push_back( BSON( "a" << std::numeric_limits<int>::min() ) );
+        values.push_back( BSON( "a" << std::numeric_limits<int>::max() ) );
+        values.push_back( BSON( "a" << 1LL ) );
+        values.push_back( BSON( "a" << -5LL ) );
+        values.push_back( BSON( "a" << ( 1LL << 53 ) ) );
+        values.push_back( BSON( "a" << ( 1LL << 53 ) + 1 ) );
+        values.push_back( BSON( "a" << -( 1LL << 60 ) ) );
+        values.push_back( BSON( "a" << std::numeric_limits<long long>::min() ) );
+        values.push_back( BSON( "a" << std::numeric_limits<long long>::max() ) );
+        values.push_back( BSON( "a" << 0.0 ) );
+        values.push_back( BSON( "a" << -0.0 ) );
+        values.push_back( BSON( "a" << 0.5 ) );
+        values.push_back( BSON( "a" << -0.5 ) );
+        values.push_back( BSON( "a" << 1.0 ) );
+        values.push_back( BSON( "a" << 1.25 ) );
+        values.push_back( BSON( "a" << -1.25 ) );
+        values.push_back( BSON( "a" << 1e-300 ) );
+        values.push_back( BSON( "a" << -1e15 ) );
+        values.push_back( BSON( "a" << 9007199254740991.0 ) );
+
+        values.push_back( BSON( "a" << "" ) );
+        values.push_back( BSON( "a" << "a" ) );
+        values.push_back( BSON( "a" << "ab" ) );
+        values.push_back( BSON( "a" << "b" ) );
+        values.push_back( BSON( "a" << "\xff" ) );
+        values.push_back( BSON( "a" << string( "a\0", 2 ) ) );
+        values.push_back( BSON( "a" << string( "a\0b", 3 ) ) );
+        values.push_back( BSON( "a" << string( "\0", 1 ) ) );
+
+        values.push_back( BSON( "a" << OID( "000000000000000000000000" ) ) );
+        values.push_back( BSON( "a" << OID( "52a0b2c3d4e5f60718293a4b" ) ) );
+        values.push_back( BSON( "a" << OID( "ffffffffffffffffffffffff" ) ) );
+
+        values.push_back( BSON( "a" << false ) );
+        values.push_back( BSON( "a" << true ) );
+
+        values.push_back( BSON( "a" << Date_t( 0 ) ) );
+        values.push_back( BSON( "a" << Date_t( 1000 ) ) );
+        values.push_back( BSON( "a" << Date_t( static_cast<unsigned long long>( -1000LL ) ) ) );
+        return values;
+    }
+
+    TEST(ChunkRoutingTable, EncodedOrderMatchesWoCompare) {
+        const vector<BSONObj> values = sampleValues();
+        for ( size_t i = 0; i < values.size(); i++ ) {
+            for ( size_t j = 0; j < values.size(); j++ ) {
+                ASSERT_EQUALS( sign( values[i].woCompare( values[j], BSONObj(), false ) ),
+                               compareEncoded( values[i], values[j] ) );
+            }
+        }
+    }
+
+    TEST(ChunkRoutingTable, EncodedOrderMatchesWoCompareForCompoundKeys) {
+        const vector<BSONObj> values = sampleValues();
+        vector<BSONObj> keys;
+        for ( size_t i = 0; i < values.size(); i += 3 ) {
+            for ( size_t j = 0; j < values.size(); j += 4 ) {
+                BSONObjBuilder b;
+                b.appendAs( values[i].firstElement(), "a" );
+                b.appendAs( values[j].firstElement(), "b" );
+                keys.push_back( b.obj() );
+            }
+            // a prefix of the compound keys
+            keys.push_back( values[i] );
+        }
+
+        for ( size_t i = 0; i < keys.size(); i++ ) {
+            for ( size_t j = 0; j < keys.size(); j++ ) {
+                ASSERT_EQUALS( sign( keys[i].woCompare( keys[j], BSONObj(), false ) ),
+                               compareEncoded( keys[i], keys[j] ) );
+            }
+        }
+    }
+
+    TEST(ChunkRoutingTable, UnencodedTypes) {
+        string out;
+        ASSERT_FALSE( ChunkRoutingTable::encodeKey( BSON( "a" << 9007199254740992.0 ), &out ) );
+        ASSERT_FALSE( ChunkRoutingTable::encodeKey( BSON( "a" << 1e300 ), &out ) );
+        ASSERT_FALSE( ChunkRoutingTable::encodeKey(
+                          BSON( "a" << std::numeric_limits<double>::quiet_NaN() ), &out ) );
+        ASSERT_FALSE( ChunkRoutingTable::encodeKey( BSON( "a" << BSON( "b" << 1 ) ), &out ) );
+        ASSERT_FALSE( ChunkRoutingTable::encodeKey( BSON( "a" << 1 << "b" << BSON_ARRAY( 1 ) ),
+                                                    &out ) );
+    }
+
+    // the position of the first max greater than key, the slow way
+    size_t expectedUpperBound( const vector<BSONObj>& maxes, const BSONObj& key ) {
+        size_t i = 0;
+        while ( i < maxes.size() && maxes[i].woCompare( key, BSONObj(), false ) <= 0 )
+            i++;
+        return i;
+    }
+
+    TEST(ChunkRoutingTable, UpperBound) {
+        vector<BSONObj> maxes;
+        ChunkRoutingTable table;
+        for ( long long i = -100; i <= 100; i += 10 ) {
+            maxes.push_back( BSON( "a" << i ) );
+            table.append( maxes.back() );
+        }
+        maxes.push_back( BSON( "a" << mongo::MAXKEY ) );
+        table.append( maxes.back() );
+        ASSERT( table.encoded() );
+        ASSERT_EQUALS( maxes.size(), table.size() );
+
+        for ( int i = -120; i <= 120; i++ ) {
+            BSONObj key = BSON( "a" << i );
+            ASSERT_EQUALS( expectedUpperBound( maxes, key ), table.upperBound( key ) );
+            key = BSON( "a" << i + 0.5 );
+            ASSERT_EQUALS( expectedUpperBound( maxes, key ), table.upperBound( key ) );
+        }
+        ASSERT_EQUALS( 0U, table.upperBound( BSON( "a" << mongo::MINKEY ) ) );
+        ASSERT_EQUALS( maxes.size(), table.upperBound( BSON( "a" << mongo::MAXKEY ) ) );
+
+        // keys that can't be encoded are compared as BSON
+        BSONObj big = BSON( "a" << 1e300 );
+        ASSERT_EQUALS( expectedUpperBound( maxes, big ), table.upperBound( big ) );
+        BSONObj object = BSON( "a" << BSON( "b" << 1 ) );
+        ASSERT_EQUALS( expectedUpperBound( maxes, object ), table.upperBound( object ) );
+    }
+
+    TEST(ChunkRoutingTable, UnencodedMaxesCompareBSON) {
+        vector<BSONObj> maxes;
+        ChunkRoutingTable table;
+        maxes.push_back( BSON( "a" << 0 ) );
+        maxes.push_back( BSON( "a" << 1e300 ) );
+        maxes.push_back( BSON( "a" << "x" ) );
+        maxes.push_back( BSON( "a" << mongo::MAXKEY ) );
+        for ( size_t i = 0; i < maxes.size(); i++ )
+            table.append( maxes[i] );
+        ASSERT_FALSE( table.encoded() );
+
+        const BSONObj keys[] = { BSON( "a" << -1 ), BSON( "a" << 0 ), BSON( "a" << 5 ),
+                                 BSON( "a" << 1e300 ), BSON( "a" << "a" ),
+                                 BSON( "a" << "x" ), BSON( "a" << "z" ) };
+        for ( size_t i = 0; i < sizeof( keys ) / sizeof( keys[0] ); i++ ) {
+            ASSERT_EQUALS( expectedUpperBound( maxes, keys[i] ), table.upperBound( keys[i] ) );
+        }
+    }
+
+} // namespace
@@ -35,6 +35,8 @@
 
 #include "mongo/base/init.h"
 #include "mongo/base/status.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/chunk_manager_targeter.h"
 #include "mongo/s/config.h"
 #include "mongo/s/dbclient_multi_command.h"
@@ -49,6 +51,64 @@ namespace mongo {
     using std::vector;
     using std::string;
 
+    // Bounds how many child write batches mongos keeps outstanding to a single shard host
+    MONGO_EXPORT_SERVER_PARAMETER( maxWriteBatchesInFlightPerHost, int,
+                                   BatchWriteExec::DefaultMaxInFlightPerHost );
+
+    // Most writes mongos puts in one child batch of an unordered write, so the writes for a host
+    // can be pipelined; 0 sends them all in one child batch
+    MONGO_EXPORT_SERVER_PARAMETER( maxWritesPerChildBatch, int,
+                                   BatchWriteExec::DefaultMaxWritesPerChildBatch );
+
+    namespace {
+
+        /**
+         * Round-trip latency of the child write batches sent to each shard host.
+         */
+        class ShardWriteStatsSection : public ServerStatusSection {
+        public:
+            ShardWriteStatsSection() :
+                ServerStatusSection( "shardWrites" ), _mutex( "ShardWriteStatsSection" ) {
+            }
+
+            virtual bool includeByDefault() const { return false; }
+
+            void noteExecStats( const BatchWriteExecStats& execStats ) {
+                scoped_lock lk( _mutex );
+                for ( map<string, HostWriteStats>::const_iterator it = execStats.hostStats.begin();
+                    it != execStats.hostStats.end(); ++it ) {
+
+                    HostWriteStats& stats = _hostStats[it->first];
+                    stats.numBatches += it->second.numBatches;
+                    stats.totalMillis += it->second.totalMillis;
+                    stats.maxMillis = std::max( stats.maxMillis, it->second.maxMillis );
+                }
+            }
+
+            BSONObj generateSection( const BSONElement& configElement ) const {
+                scoped_lock lk( _mutex );
+                BSONObjBuilder b;
+                for ( map<string, HostWriteStats>::const_iterator it = _hostStats.begin();
+                    it != _hostStats.end(); ++it ) {
+
+                    const HostWriteStats& stats = it->second;
+                    BSONObjBuilder hostB( b.subobjStart( it->first ) );
+                    hostB.append( "batches", stats.numBatches );
+                    hostB.append( "totalMillis", stats.totalMillis );
+                    hostB.append( "maxMillis", stats.maxMillis );
+                    hostB.append( "avgMillis", stats.numBatches == 0 ? 0.0 :
+                        static_cast<double>( stats.totalMillis ) / stats.numBatches );
+                    hostB.done();
+                }
+                return b.obj();
+            }
+
+        private:
+            mutable mongo::mutex _mutex;
+            map<string, HostWriteStats> _hostStats;
+        } shardWriteStatsSection;
+    }
+
     /**
      * Splits the chunks touched based from the targeter stats if needed.
      */
@@ -134,8 +194,12 @@ namespace mongo {
         DBClientShardResolver resolver;
         DBClientMultiCommand dispatcher;
         BatchWriteExec exec( &targeter, &resolver, &dispatcher );
+        exec.setMaxInFlightPerHost( std::max( 1, maxWriteBatchesInFlightPerHost ) );
+        exec.setMaxWritesPerChildBatch( std::max( 0, maxWritesPerChildBatch ) );
         exec.executeBatch( request, response );
 
+        shardWriteStatsSection.noteExecStats( exec.getStats() );
+
         if ( autoSplit ) splitIfNeeded( request.getNS(), *targeter.getStats() );
     }
 
@@ -747,7 +747,7 @@ namespace mongo {
                     // Reload the new config info.  If we created more than one initial chunk, then
                     // we need to move them around to balance.
                     ChunkManagerPtr chunkManager = config->getChunkManager( ns , true );
-                    ChunkMap chunkMap = chunkManager->getChunkMap();
+                    const ChunkMap& chunkMap = chunkManager->getChunkMap();
                     // 2. Move and commit each "big chunk" to a different shard.
                     int i = 0;
                     for ( ChunkMap::const_iterator c = chunkMap.begin(); c != chunkMap.end(); ++c,++i ){
@@ -787,7 +787,10 @@ namespace mongo {
                              str::equals( e.fieldName() , "ok" ) || 
                              str::equals( e.fieldName() , "avgObjSize" ) ||
                              str::equals( e.fieldName() , "lastExtentSize" ) ||
-                             str::equals( e.fieldName() , "paddingFactor" ) ) {
+                             str::equals( e.fieldName() , "paddingFactor" ) ||
+                             str::equals( e.fieldName() , "allocation" ) ||
+                             str::equals( e.fieldName() , "freeList" ) ||
+                             str::equals( e.fieldName() , "compression" ) ) {
                             continue;
                         }
                         else if ( str::equals( e.fieldName() , "count" ) ||
@@ -1376,6 +1379,7 @@ namespace mongo {
                             fn == "sort" ||
                             fn == "scope" ||
                             fn == "verbose" ||
+                            fn == "mapThreads" ||
                             fn == "$queryOptions" ||
                             fn == LiteParsedQuery::cmdOptionMaxTimeMS) {
                         b.append( e );
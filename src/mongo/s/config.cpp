@@ -167,6 +167,7 @@ namespace mongo {
 
         scoped_lock lk( _lock );
         _shardingEnabled = true;
+        grid.noteRoutingChange();
         if( save ) _save();
     }
 
@@ -210,6 +211,7 @@ namespace mongo {
             cm->createFirstChunks( configServer.getPrimary().getConnString(),
                                    getPrimary(), initPoints, initShards );
             ci.shard( cm );
+            grid.noteRoutingChange();
 
             _save();
 
@@ -271,6 +273,7 @@ namespace mongo {
         }
 
         ci.unshard();
+        grid.noteRoutingChange();
         _save( false, true );
         return true;
     }
@@ -456,6 +459,7 @@ namespace mongo {
 
         if ( shouldReset ){
             ci.resetCM( temp.release() );
+            grid.noteRoutingChange();
         }
         
         uassert( 15883 , str::stream() << "not sharded after chunk manager reset : " << ns , ci.isSharded() );
@@ -506,6 +510,7 @@ namespace mongo {
         }
 
         unserialize( dbObj );
+        grid.noteRoutingChange();
 
         BSONObjBuilder b;
         b.appendRegex(CollectionType::ns(),
@@ -523,6 +528,7 @@ namespace mongo {
 
             if( collObj[CollectionType::dropped()].trueValue() ){
                 _collections.erase( collName );
+                grid.noteRoutingChange();
                 numCollsErased++;
             }
             else if( !collObj[CollectionType::primary()].eoo() ){
@@ -531,10 +537,12 @@ namespace mongo {
 
                 // Erased in case it was previously sharded, dropped, then init'd as unsharded
                 _collections.erase( collName );
+                grid.noteRoutingChange();
                 numCollsErased++;
             }
             else{
                 _collections[ collName ] = CollectionInfo( collObj );
+                grid.noteRoutingChange();
                 if( _collections[ collName ].isSharded() ) numCollsSharded++;
             }
         }
@@ -173,31 +173,42 @@ namespace mongo {
         return sr->nextInt64();
     }
 
-    CursorCache::CursorCache()
-        :_mutex( "CursorCache" ),
-         _random( getCCRandomSeed() ),
-         _shardedTotal(0) {
+    CursorCache::Stripe::Stripe()
+        : mutex( "CursorCacheStripe" ),
+          random( getCCRandomSeed() ),
+          shardedTotal(0) {
+    }
+
+    CursorCache::CursorCache() {
     }
 
     CursorCache::~CursorCache() {
         // TODO: delete old cursors?
+        size_t numSharded = 0;
+        size_t numRefs = 0;
+        for ( int i = 0; i < NumStripes; i++ ) {
+            numSharded += _stripes[i].cursors.size();
+            numRefs += _stripes[i].refs.size();
+            verify(_stripes[i].refs.size() == _stripes[i].refsNS.size());
+        }
+
         bool print = logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1));
-        if ( _cursors.size() || _refs.size() )
+        if ( numSharded || numRefs )
             print = true;
-        verify(_refs.size() == _refsNS.size());
         
         if ( print ) 
             log() << " CursorCache at shutdown - "
-                  << " sharded: " << _cursors.size()
-                  << " passthrough: " << _refs.size()
+                  << " sharded: " << numSharded
+                  << " passthrough: " << numRefs
                   << endl;
     }
 
     ShardedClientCursorPtr CursorCache::get( long long id ) const {
         LOG(_myLogLevel) << "CursorCache::get id: " << id << endl;
-        scoped_lock lk( _mutex );
-        MapSharded::const_iterator i = _cursors.find( id );
-        if ( i == _cursors.end() ) {
+        const Stripe& stripe = stripeFor( id );
+        scoped_lock lk( stripe.mutex );
+        MapSharded::const_iterator i = stripe.cursors.find( id );
+        if ( i == stripe.cursors.end() ) {
             OCCASIONALLY log() << "Sharded CursorCache missing cursor id: " << id << endl;
             return ShardedClientCursorPtr();
         }
@@ -207,9 +218,10 @@ namespace mongo {
 
     int CursorCache::getMaxTimeMS( long long id ) const {
         verify( id );
-        scoped_lock lk( _mutex );
-        MapShardedInt::const_iterator i = _cursorsMaxTimeMS.find( id );
-        return ( i != _cursorsMaxTimeMS.end() ) ? i->second : 0;
+        const Stripe& stripe = stripeFor( id );
+        scoped_lock lk( stripe.mutex );
+        MapShardedInt::const_iterator i = stripe.cursorsMaxTimeMS.find( id );
+        return ( i != stripe.cursorsMaxTimeMS.end() ) ? i->second : 0;
     }
 
     void CursorCache::store( ShardedClientCursorPtr cursor, int maxTimeMS ) {
@@ -221,10 +233,11 @@ namespace mongo {
         verify( maxTimeMS == kMaxTimeCursorTimeLimitExpired
                 || maxTimeMS == kMaxTimeCursorNoTimeLimit
                 || maxTimeMS > 0 );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS[cursor->getId()] = maxTimeMS;
-        _cursors[cursor->getId()] = cursor;
-        _shardedTotal++;
+        Stripe& stripe = stripeFor( cursor->getId() );
+        scoped_lock lk( stripe.mutex );
+        stripe.cursorsMaxTimeMS[cursor->getId()] = maxTimeMS;
+        stripe.cursors[cursor->getId()] = cursor;
+        stripe.shardedTotal++;
     }
 
     void CursorCache::updateMaxTimeMS( long long id, int maxTimeMS ) {
@@ -232,77 +245,93 @@ namespace mongo {
         verify( maxTimeMS == kMaxTimeCursorTimeLimitExpired
                 || maxTimeMS == kMaxTimeCursorNoTimeLimit
                 || maxTimeMS > 0 );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS[id] = maxTimeMS;
+        Stripe& stripe = stripeFor( id );
+        scoped_lock lk( stripe.mutex );
+        stripe.cursorsMaxTimeMS[id] = maxTimeMS;
     }
 
     void CursorCache::remove( long long id ) {
         verify( id );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS.erase( id );
-        _cursors.erase( id );
+        Stripe& stripe = stripeFor( id );
+        scoped_lock lk( stripe.mutex );
+        stripe.cursorsMaxTimeMS.erase( id );
+        stripe.cursors.erase( id );
     }
     
     void CursorCache::removeRef( long long id ) {
         verify( id );
-        scoped_lock lk( _mutex );
-        _refs.erase( id );
-        _refsNS.erase( id );
+        Stripe& stripe = stripeFor( id );
+        scoped_lock lk( stripe.mutex );
+        stripe.refs.erase( id );
+        stripe.refsNS.erase( id );
     }
 
     void CursorCache::storeRef(const std::string& server, long long id, const std::string& ns) {
         LOG(_myLogLevel) << "CursorCache::storeRef server: " << server << " id: " << id << endl;
         verify( id );
-        scoped_lock lk( _mutex );
-        _refs[id] = server;
-        _refsNS[id] = ns;
+        Stripe& stripe = stripeFor( id );
+        scoped_lock lk( stripe.mutex );
+        stripe.refs[id] = server;
+        stripe.refsNS[id] = ns;
     }
 
     string CursorCache::getRef( long long id ) const {
         verify( id );
-        scoped_lock lk( _mutex );
-        MapNormal::const_iterator i = _refs.find( id );
+        const Stripe& stripe = stripeFor( id );
+        scoped_lock lk( stripe.mutex );
+        MapNormal::const_iterator i = stripe.refs.find( id );
 
-        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == _refs.end() ? " NONE " : i->second ) << endl;
+        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == stripe.refs.end() ? " NONE " : i->second ) << endl;
 
-        if ( i == _refs.end() )
+        if ( i == stripe.refs.end() )
             return "";
         return i->second;
     }
 
     std::string CursorCache::getRefNS(long long id) const {
         verify(id);
-        scoped_lock lk(_mutex);
-        MapNormal::const_iterator i = _refsNS.find(id);
+        const Stripe& stripe = stripeFor( id );
+        scoped_lock lk(stripe.mutex);
+        MapNormal::const_iterator i = stripe.refsNS.find(id);
 
         LOG(_myLogLevel) << "CursorCache::getRefNs id: " << id
-                << " out: " << ( i == _refsNS.end() ? " NONE " : i->second ) << std::endl;
+                << " out: " << ( i == stripe.refsNS.end() ? " NONE " : i->second ) << std::endl;
 
-        if ( i == _refsNS.end() )
+        if ( i == stripe.refsNS.end() )
             return "";
         return i->second;
     }
 
 
     long long CursorCache::genId() {
+        // The low bits of the id pick the stripe, so new cursors are spread evenly over them
+        const int stripeNum = _nextStripe.fetchAndAdd( 1 ) & ( NumStripes - 1 );
+        Stripe& stripe = _stripes[stripeNum];
+
         while ( true ) {
-            scoped_lock lk( _mutex );
+            scoped_lock lk( stripe.mutex );
 
             long long x = Listener::getElapsedTimeMillis() << 32;
-            x |= _random.nextInt32();
+            x |= stripe.random.nextInt32();
+
+            if ( x < 0 )
+                x *= -1;
+
+            x = ( x & ~static_cast<long long>( NumStripes - 1 ) ) | stripeNum;
 
             if ( x == 0 )
                 continue;
 
-            if ( x < 0 )
-                x *= -1;
+            dassert( stripeIndex( x ) == stripeNum );
 
-            MapSharded::iterator i = _cursors.find( x );
-            if ( i != _cursors.end() )
+            // Passthrough ids come from the shards, but land in the stripe of their id too, so
+            // checking this stripe is enough to avoid colliding with them
+            MapSharded::iterator i = stripe.cursors.find( x );
+            if ( i != stripe.cursors.end() )
                 continue;
 
-            MapNormal::iterator j = _refs.find( x );
-            if ( j != _refs.end() )
+            MapNormal::iterator j = stripe.refs.find( x );
+            if ( j != stripe.refs.end() )
                 continue;
 
             return x;
@@ -336,10 +365,11 @@ namespace mongo {
 
             string server;
             {
-                scoped_lock lk( _mutex );
+                Stripe& stripe = stripeFor( id );
+                scoped_lock lk( stripe.mutex );
 
-                MapSharded::iterator i = _cursors.find( id );
-                if ( i != _cursors.end() ) {
+                MapSharded::iterator i = stripe.cursors.find( id );
+                if ( i != stripe.cursors.end() ) {
                     const bool isAuthorized = authSession->isAuthorizedForActionsOnNamespace(
                             NamespaceString(i->second->getNS()), ActionType::killCursors);
                     audit::logKillCursorsAuthzCheck(
@@ -348,19 +378,19 @@ namespace mongo {
                             id,
                             isAuthorized ? ErrorCodes::OK : ErrorCodes::Unauthorized);
                     if (isAuthorized) {
-                        _cursorsMaxTimeMS.erase( i->second->getId() );
-                        _cursors.erase( i );
+                        stripe.cursorsMaxTimeMS.erase( i->second->getId() );
+                        stripe.cursors.erase( i );
                     }
                     continue;
                 }
 
-                MapNormal::iterator refsIt = _refs.find(id);
-                MapNormal::iterator refsNSIt = _refsNS.find(id);
-                if (refsIt == _refs.end()) {
+                MapNormal::iterator refsIt = stripe.refs.find(id);
+                MapNormal::iterator refsNSIt = stripe.refsNS.find(id);
+                if (refsIt == stripe.refs.end()) {
                     warning() << "can't find cursor: " << id << endl;
                     continue;
                 }
-                verify(refsNSIt != _refsNS.end());
+                verify(refsNSIt != stripe.refsNS.end());
                 const bool isAuthorized = authSession->isAuthorizedForActionsOnNamespace(
                         NamespaceString(refsNSIt->second), ActionType::killCursors);
                 audit::logKillCursorsAuthzCheck(
@@ -372,8 +402,8 @@ namespace mongo {
                     continue;
                 }
                 server = refsIt->second;
-                _refs.erase(refsIt);
-                _refsNS.erase(refsNSIt);
+                stripe.refs.erase(refsIt);
+                stripe.refsNS.erase(refsNSIt);
             }
 
             LOG(_myLogLevel) << "CursorCache::found gotKillCursors id: " << id << " server: " << server << endl;
@@ -386,28 +416,39 @@ namespace mongo {
     }
 
     void CursorCache::appendInfo( BSONObjBuilder& result ) const {
-        scoped_lock lk( _mutex );
-        result.append( "sharded" , (int)_cursors.size() );
-        result.appendNumber( "shardedEver" , _shardedTotal );
-        result.append( "refs" , (int)_refs.size() );
-        result.append( "totalOpen" , (int)(_cursors.size() + _refs.size() ) );
+        int numSharded = 0;
+        int numRefs = 0;
+        long long shardedTotal = 0;
+        for ( int i = 0; i < NumStripes; i++ ) {
+            scoped_lock lk( _stripes[i].mutex );
+            numSharded += _stripes[i].cursors.size();
+            numRefs += _stripes[i].refs.size();
+            shardedTotal += _stripes[i].shardedTotal;
+        }
+
+        result.append( "sharded" , numSharded );
+        result.appendNumber( "shardedEver" , shardedTotal );
+        result.append( "refs" , numRefs );
+        result.append( "totalOpen" , numSharded + numRefs );
     }
 
     void CursorCache::doTimeouts() {
-        long long now = Listener::getElapsedTimeMillis();
-        scoped_lock lk( _mutex );
-        for ( MapSharded::iterator i=_cursors.begin(); i!=_cursors.end(); ++i ) {
-            // Note: cursors with no timeout will always have an idleTime of 0
-            long long idleFor = i->second->idleTime( now );
-            if ( idleFor < TIMEOUT ) {
-                continue;
+        // Sweep one stripe at a time, so getMores on the other stripes aren't held up
+        for ( int s = 0; s < NumStripes; s++ ) {
+            Stripe& stripe = _stripes[s];
+            long long now = Listener::getElapsedTimeMillis();
+            scoped_lock lk( stripe.mutex );
+            for ( MapSharded::iterator i = stripe.cursors.begin(); i != stripe.cursors.end(); ) {
+                // Note: cursors with no timeout will always have an idleTime of 0
+                long long idleFor = i->second->idleTime( now );
+                if ( idleFor < TIMEOUT ) {
+                    ++i;
+                    continue;
+                }
+                log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
+                stripe.cursorsMaxTimeMS.erase( i->second->getId() );
+                stripe.cursors.erase( i++ );
             }
-            log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
-            _cursorsMaxTimeMS.erase( i->second->getId() );
-            _cursors.erase( i );
-            i = _cursors.begin(); // possible 2nd entry will get skipped, will get on next pass
-            if ( i == _cursors.end() )
-                break;
         }
     }
 
@@ -37,6 +37,7 @@
 #include "mongo/client/parallel.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/request.h"
 
@@ -101,11 +102,19 @@ namespace mongo {
 
     typedef boost::shared_ptr<ShardedClientCursor> ShardedClientCursorPtr;
 
+    /**
+     * Tracks the cursors mongos has open on behalf of clients.  The cache is partitioned into
+     * stripes by cursor id, each with its own lock, so that concurrent getMores on different
+     * cursors don't contend.  Ids from genId() are spread round-robin across the stripes.
+     */
     class CursorCache {
     public:
 
         static long long TIMEOUT;
 
+        // Number of independently locked partitions, must be a power of two
+        static const int NumStripes = 16;
+
         typedef map<long long,ShardedClientCursorPtr> MapSharded;
         typedef map<long long,int> MapShardedInt;
         typedef map<long long,string> MapNormal;
@@ -135,27 +144,47 @@ namespace mongo {
 
         void doTimeouts();
         void startTimeoutThread();
+
+        /** @return the stripe which holds the cursor with this id */
+        static int stripeIndex( long long id ) {
+            return static_cast<int>( static_cast<unsigned long long>( id ) & ( NumStripes - 1 ) );
+        }
+
     private:
-        mutable mongo::mutex _mutex;
 
-        PseudoRandom _random;
+        // One partition of the cache, holding every cursor whose id maps to it
+        struct Stripe {
+            Stripe();
 
-        // Maps sharded cursor ID to ShardedClientCursorPtr.
-        MapSharded _cursors;
+            mutable mongo::mutex mutex;
 
-        // Maps sharded cursor ID to remaining max time.  Value can be any of:
-        // - the constant "kMaxTimeCursorNoTimeLimit", or
-        // - the constant "kMaxTimeCursorTimeLimitExpired", or
-        // - a positive integer representing milliseconds of remaining time
-        MapShardedInt _cursorsMaxTimeMS;
+            PseudoRandom random;
 
-        // Maps passthrough cursor ID to shard name.
-        MapNormal _refs;
+            // Maps sharded cursor ID to ShardedClientCursorPtr.
+            MapSharded cursors;
 
-        // Maps passthrough cursor ID to namespace.
-        MapNormal _refsNS;
-        
-        long long _shardedTotal;
+            // Maps sharded cursor ID to remaining max time.  Value can be any of:
+            // - the constant "kMaxTimeCursorNoTimeLimit", or
+            // - the constant "kMaxTimeCursorTimeLimitExpired", or
+            // - a positive integer representing milliseconds of remaining time
+            MapShardedInt cursorsMaxTimeMS;
+
+            // Maps passthrough cursor ID to shard name.
+            MapNormal refs;
+
+            // Maps passthrough cursor ID to namespace.
+            MapNormal refsNS;
+
+            long long shardedTotal;
+        };
+
+        Stripe& stripeFor( long long id ) { return _stripes[stripeIndex( id )]; }
+        const Stripe& stripeFor( long long id ) const { return _stripes[stripeIndex( id )]; }
+
+        Stripe _stripes[NumStripes];
+
+        // Stripe for the next generated cursor id
+        AtomicUInt32 _nextStripe;
 
         static const int _myLogLevel;
     };
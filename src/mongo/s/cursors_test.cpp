@@ -0,0 +1,174 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/s/cursors.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::CursorCache;
+
+    TEST(CursorCacheTests, GenIdSpreadsOverStripes) {
+        CursorCache cache;
+
+        int perStripe[CursorCache::NumStripes] = { 0 };
+        for ( int i = 0; i < CursorCache::NumStripes * 4; i++ ) {
+            long long id = cache.genId();
+            ASSERT( id > 0 );
+            perStripe[CursorCache::stripeIndex( id )]++;
+        }
+
+        for ( int i = 0; i < CursorCache::NumStripes; i++ ) {
+            ASSERT_EQUALS( perStripe[i], 4 );
+        }
+    }
+
+    TEST(CursorCacheTests, RefsInEveryStripe) {
+        CursorCache cache;
+
+        for ( long long id = 1; id <= CursorCache::NumStripes * 2; id++ ) {
+            cache.storeRef( "shard0:27017", id, "foo.bar" );
+        }
+
+        for ( long long id = 1; id <= CursorCache::NumStripes * 2; id++ ) {
+            ASSERT_EQUALS( cache.getRef( id ), "shard0:27017" );
+            ASSERT_EQUALS( cache.getRefNS( id ), "foo.bar" );
+        }
+
+        BSONObjBuilder b;
+        cache.appendInfo( b );
+        BSONObj info = b.obj();
+        ASSERT_EQUALS( info["refs"].numberInt(), CursorCache::NumStripes * 2 );
+        ASSERT_EQUALS( info["totalOpen"].numberInt(), CursorCache::NumStripes * 2 );
+
+        for ( long long id = 1; id <= CursorCache::NumStripes * 2; id++ ) {
+            cache.removeRef( id );
+            ASSERT_EQUALS( cache.getRef( id ), "" );
+        }
+    }
+
+    //
+    // Many threads doing the lookups of a getMore against the cache while others store and remove
+    // refs of their own, spread over all the stripes.  Every lookup has to find what was stored.
+    //
+
+    class LookupTester {
+    public:
+        LookupTester( CursorCache* cache, long long firstId, int numIds, bool writer )
+            : _cache(cache), _firstId(firstId), _numIds(numIds), _writer(writer),
+              _errors(0), _t(NULL) {}
+
+        ~LookupTester() {
+            delete _t;
+        }
+
+        void start( int iterations ) {
+            _t = new boost::thread( boost::bind(&LookupTester::test, this, iterations) );
+        }
+
+        void join() {
+            if ( _t ) _t->join();
+        }
+
+        int errors() const { return _errors; }
+
+    private:
+        CursorCache* _cache;  // not owned here
+        long long    _firstId;
+        int          _numIds;
+        bool         _writer;
+        int          _errors;
+        boost::thread* _t;
+
+        void test( int iterations ) {
+            for ( int i = 0; i < iterations; i++ ) {
+                long long id = _firstId + ( i % _numIds );
+                if ( _writer ) {
+                    _cache->storeRef( "shard1:27017", id, "foo.baz" );
+                    if ( _cache->getRef( id ) != "shard1:27017" )
+                        _errors++;
+                    _cache->removeRef( id );
+                    if ( _cache->getRef( id ) != "" )
+                        _errors++;
+                }
+                else {
+                    if ( _cache->getRef( id ) != "shard0:27017" )
+                        _errors++;
+                    if ( _cache->getRefNS( id ) != "foo.bar" )
+                        _errors++;
+                }
+            }
+        }
+
+        LookupTester( LookupTester& );
+        LookupTester& operator=( LookupTester& );
+    };
+
+    TEST(CursorCacheTests, ConcurrentLookups) {
+        CursorCache cache;
+
+        const int numIds = 256;
+        for ( int i = 0; i < numIds; i++ ) {
+            cache.storeRef( "shard0:27017", 1 + i, "foo.bar" );
+        }
+
+        const int readers = 16;
+        const int writers = 4;
+        const int iterations = 20000;
+        LookupTester* testers[readers + writers];
+
+        for ( int i = 0; i < readers; i++ ) {
+            testers[i] = new LookupTester( &cache, 1, numIds, false );
+        }
+        for ( int i = 0; i < writers; i++ ) {
+            // each writer has ids of its own, after the ones the readers look up
+            testers[readers + i] = new LookupTester( &cache, 1 + numIds * ( i + 1 ), numIds,
+                                                     true );
+        }
+        for ( int i = 0; i < readers + writers; i++ ) {
+            testers[i]->start( iterations );
+        }
+
+        int errors = 0;
+        for ( int i = 0; i < readers + writers; i++ ) {
+            testers[i]->join();
+            errors += testers[i]->errors();
+            delete testers[i];
+        }
+        ASSERT_EQUALS( errors, 0 );
+
+        BSONObjBuilder b;
+        cache.appendInfo( b );
+        ASSERT_EQUALS( b.obj()["refs"].numberInt(), numIds );
+    }
+
+} // namespace
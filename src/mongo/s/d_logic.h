@@ -33,6 +33,7 @@
 #include "mongo/pch.h"
 
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/collection_metadata.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/util/concurrency/ticketholder.h"
@@ -74,6 +75,14 @@ namespace mongo {
         bool hasVersion( const string& ns , ChunkVersion& version );
         const ChunkVersion getVersion( const string& ns ) const;
 
+        /**
+         * Bumped on every change to the collection metadata held here.  Connections remember
+         * the generation at which their version of a namespace was last found compatible with
+         * ours, so the common case where nothing has changed costs one atomic load instead of
+         * a trip through _mutex (see shardVersionOk).
+         */
+        unsigned long long getMetadataGeneration() const { return _metadataGeneration.load(); }
+
         /**
          * If the metadata for 'ns' at this shard is at or above the requested version,
          * 'reqShardVersion', returns OK and fills in 'latestShardVersion' with the latest shard
@@ -270,6 +279,9 @@ namespace mongo {
         // Map from a namespace into the metadata we need for each collection on this shard
         typedef map<string,CollectionMetadataPtr> CollectionMetadataMap;
         CollectionMetadataMap _collMetadata;
+
+        // incremented under _mutex after every change to _collMetadata or _enabled
+        AtomicUInt64 _metadataGeneration;
     };
 
     extern ShardingState shardingState;
@@ -289,6 +301,13 @@ namespace mongo {
         const ChunkVersion getVersion( const string& ns ) const;
         void setVersion( const string& ns , const ChunkVersion& version );
 
+        /**
+         * @return true if our version of ns was found compatible with the shard's at metadata
+         * generation 'generation' and hasn't been set since
+         */
+        bool isVersionVerified( const string& ns , unsigned long long generation ) const;
+        void noteVersionVerified( const string& ns , unsigned long long generation );
+
         static ShardedConnectionInfo* get( bool create );
         static void reset();
         static void addHook();
@@ -305,7 +324,14 @@ namespace mongo {
         OID _id;
         bool _forceVersionOk; // if this is true, then chunk version #s aren't check, and all ops are allowed
 
-        typedef map<string,ChunkVersion> NSVersionMap;
+        struct NSVersion {
+            NSVersion() : verifiedGeneration( 0 ) {}
+            ChunkVersion version;
+            // ShardingState metadata generation the version was last checked at, 0 if never
+            unsigned long long verifiedGeneration;
+        };
+
+        typedef map<string,NSVersion> NSVersionMap;
         NSVersionMap _versions;
 
         static boost::thread_specific_ptr<ShardedConnectionInfo> _tl;
@@ -374,4 +400,14 @@ namespace mongo {
 
     void aboutToDeleteForSharding( const StringData& ns, const Database* db , const DiskLoc& dl );
 
+    /**
+     * Called before a record of 'ns' is copied from 'oldLoc' to 'newLoc' without changing its
+     * contents (online compaction).  If an active migration still has to clone 'oldLoc' it
+     * clones 'newLoc' instead, as deleting 'oldLoc' drops it from the clone list.
+     */
+    void aboutToMoveForSharding( const StringData& ns,
+                                 const Database* db,
+                                 const DiskLoc& oldLoc,
+                                 const DiskLoc& newLoc );
+
 }
@@ -67,6 +67,7 @@
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/rs_config.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/logger/ramlog.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
@@ -145,6 +146,12 @@ namespace mongo {
         }
 
 
+        /** adds a field to the changelog entry, e.g. how fast data was cloned */
+        template<typename T>
+        void append( const string& field , const T& value ) {
+            _b.append( field , value );
+        }
+
         void note( const string& s ) {
             string field = "note";
             if ( _nextNote > 0 ) {
@@ -559,6 +566,22 @@ namespace mongo {
             _cloneLocs.erase( dl );
         }
 
+        void aboutToMove( const Database* db , const DiskLoc& oldLoc , const DiskLoc& newLoc ) {
+            verify(db);
+            Lock::assertWriteLocked(db->name());
+
+            if ( ! _getActive() )
+                return;
+
+            if ( ! db->ownsNS( _ns ) )
+                return;
+
+            scoped_spinlock lk( _trackerLocks );
+
+            if ( _cloneLocs.count( oldLoc ) )
+                _cloneLocs.insert( newLoc );
+        }
+
         std::size_t cloneLocsRemaining() {
             scoped_spinlock lk( _trackerLocks );
             return _cloneLocs.size();
@@ -671,6 +694,13 @@ namespace mongo {
         migrateFromStatus.aboutToDelete( db, dl );
     }
 
+    void aboutToMoveForSharding( const StringData& ns,
+                                 const Database* db,
+                                 const DiskLoc& oldLoc,
+                                 const DiskLoc& newLoc ) {
+        migrateFromStatus.aboutToMove( db, oldLoc, newLoc );
+    }
+
     class TransferModsCommand : public ChunkCommandHelper {
     public:
         TransferModsCommand() : ChunkCommandHelper( "_transferMods" ) {}
@@ -1126,6 +1156,8 @@ namespace mongo {
 
                 killCurrentOp.checkForInterrupt();
             }
+            if ( res["counts"].isABSONObj() )
+                timing.append( "counts", res["counts"].Obj() );
             timing.done(4);
             MONGO_FP_PAUSE_WHILE(moveChunkHangAtStep4);
 
@@ -1508,6 +1540,94 @@ namespace mongo {
     MONGO_FP_DECLARE(migrateThreadHangAtStep4);
     MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+    // how many _migrateClone batches the recipient keeps queued ahead of the one it is inserting
+    MONGO_EXPORT_SERVER_PARAMETER(migrateCloneBatchesInFlight, int, 3);
+
+    /**
+     * Pulls _migrateClone batches from the donor on its own thread and connection, so the donor
+     * reads and ships the next batches while the recipient inserts the current one.
+     */
+    class CloneBatchFetcher : boost::noncopyable {
+    public:
+        CloneBatchFetcher( const string& from, int batchesInFlight )
+            : _from( from ),
+              // a bounded BlockingQueue holds one less than its max size
+              _batches( std::max( 1, batchesInFlight ) + 1 ),
+              _mutex( "CloneBatchFetcher" ),
+              _stop( false ),
+              _finished( false ) {
+            _thread.reset( new boost::thread( boost::bind( &CloneBatchFetcher::_run, this ) ) );
+        }
+
+        ~CloneBatchFetcher() {
+            {
+                scoped_lock lk( _mutex );
+                _stop = true;
+            }
+            // the fetcher may be blocked on a full queue; drain until it says it is done
+            while ( !_finished )
+                next();
+            _thread->join();
+        }
+
+        /**
+         * @return the next _migrateClone response, an empty object once the donor has nothing
+         *         left to send, or a response with ok:0 if fetching failed
+         */
+        BSONObj next() {
+            verify( !_finished );
+            BSONObj res = _batches.blockingPop();
+            if ( res.isEmpty() || !res["ok"].trueValue() )
+                _finished = true;
+            return res;
+        }
+
+    private:
+        bool _stopping() {
+            scoped_lock lk( _mutex );
+            return _stop;
+        }
+
+        void _run() {
+            Client::initThread( "migrateCloneFetcher" );
+            if ( getGlobalAuthorizationManager()->isAuthEnabled() ) {
+                cc().getAuthorizationSession()->grantInternalAuthorization();
+            }
+
+            BSONObj last;
+            try {
+                ScopedDbConnection conn( _from );
+                while ( !_stopping() ) {
+                    BSONObj res;
+                    // gets array of objects to copy, in disk order
+                    if ( !conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {
+                        last = res.isEmpty() ? BSON( "ok" << 0 ) : res.getOwned();
+                        break;
+                    }
+                    if ( res["objects"].Obj().isEmpty() )
+                        break;
+                    _batches.push( res.getOwned() );
+                }
+                conn.done();
+            }
+            catch ( std::exception& e ) {
+                last = BSON( "ok" << 0 << "errmsg" << e.what() );
+            }
+
+            _batches.push( last );
+            cc().shutdown();
+        }
+
+        const string _from;
+        BlockingQueue<BSONObj> _batches;
+
+        mongo::mutex _mutex; // for _stop
+        bool _stop;
+
+        bool _finished; // only touched by the consuming thread
+        boost::scoped_ptr<boost::thread> _thread;
+    };
+
     class MigrateStatus {
     public:
         
@@ -1522,6 +1642,8 @@ namespace mongo {
 
             numCloned = 0;
             clonedBytes = 0;
+            cloneMillis = 0;
+            deferredIndexes.clear();
             numCatchup = 0;
             numSteady = 0;
 
@@ -1610,32 +1732,33 @@ namespace mongo {
                     }
                 }
 
+                // building an index over documents already in place is much cheaper than
+                // updating it a document at a time, so if nothing is here yet only the _id index
+                // (to check cloned documents), the shard key index (to find the range) and unique
+                // indexes (so a violating document fails its insert rather than the whole build)
+                // are built before cloning.  the rest are built in the background afterwards.
+                bool deferIndexes;
+                {
+                    Client::ReadContext ctx( ns );
+                    Collection* collection = ctx.ctx().db()->getCollection( ns );
+                    deferIndexes = collection && collection->numRecords() == 0;
+                }
+
                 for ( unsigned i=0; i<all.size(); i++ ) {
                     BSONObj idx = all[i];
-                    Client::WriteContext ctx( ns );
-                    Database* db = ctx.ctx().db();
-                    Collection* collection = db->getCollection( ns );
-                    if ( !collection ) {
-                        errmsg = str::stream() << "collection dropped during migration: " << ns;
-                        warning() << errmsg;
-                        state = FAIL;
-                        return;
+                    BSONObj key = idx["key"].Obj();
+                    if ( deferIndexes &&
+                         !IndexDetails::isIdIndexPattern( key ) &&
+                         !shardKeyPattern.isPrefixOf( key ) &&
+                         !idx["unique"].trueValue() ) {
+                        deferredIndexes.push_back( idx );
+                        continue;
                     }
-
-                    Status status = collection->getIndexCatalog()->createIndex( idx, false );
-                    if ( !status.isOK() && status.code() != ErrorCodes::IndexAlreadyExists ) {
-                        errmsg = str::stream() << "failed to create index before migrating data. "
-                                               << " idx: " << idx
-                                               << " error: " << status.toString();
-                        errmsg = str::stream() << "collection dropped during migration: " << ns;
+                    if ( !createIndex( idx, errmsg ) ) {
                         warning() << errmsg;
                         state = FAIL;
                         return;
                     }
-
-                    // make sure to create index on secondaries as well
-                    logOp( "i", db->getSystemIndexesName().c_str(), idx,
-                           NULL, NULL, true /* fromMigrate */ );
                 }
 
                 timing.done(1);
@@ -1689,9 +1812,14 @@ namespace mongo {
                 // 3. initial bulk clone
                 state = CLONE;
 
+                Timer cloneTimer;
+                CloneBatchFetcher fetcher( from, migrateCloneBatchesInFlight );
                 while ( true ) {
-                    BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    BSONObj res = fetcher.next();
+                    if ( res.isEmpty() )
+                        break;
+
+                    if ( ! res["ok"].trueValue() ) {
                         state = FAIL;
                         errmsg = "_migrateClone failed: ";
                         errmsg += res.toString();
@@ -1700,55 +1828,29 @@ namespace mongo {
                         return;
                     }
 
-                    BSONObj arr = res["objects"].Obj();
-                    int thisTime = 0;
-
-                    BSONObjIterator i( arr );
-                    while( i.more() ) {
-                        BSONObj o = i.next().Obj();
-                        {
-                            PageFaultRetryableSection pgrs;
-                            while ( 1 ) {
-                                try {
-                                    Client::WriteContext cx( ns );
-
-                                    BSONObj localDoc;
-                                    if ( willOverrideLocalId( o, &localDoc ) ) {
-                                        string errMsg =
-                                            str::stream() << "cannot migrate chunk, local document "
-                                                          << localDoc
-                                                          << " has same _id as cloned "
-                                                          << "remote document " << o;
-
-                                        warning() << errMsg << endl;
-
-                                        // Exception will abort migration cleanly
-                                        uasserted( 16976, errMsg );
-                                    }
-
-                                    Helpers::upsert( ns, o, true );
-                                    break;
-                                }
-                                catch ( PageFaultException& e ) {
-                                    e.touch();
-                                }
-                            }
-                        }
-                        thisTime++;
-                        numCloned++;
-                        clonedBytes += o.objsize();
+                    vector<BSONObj> docs;
+                    BSONObjIterator i( res["objects"].Obj() );
+                    while( i.more() )
+                        docs.push_back( i.next().Obj() );
+                    insertClonedBatch( docs );
+                }
 
-                        if ( secondaryThrottle && thisTime > 0 ) {
-                            if ( ! waitForReplication( cc().getLastOp(), 2, 60 /* seconds to wait */ ) ) {
-                                warning() << "secondaryThrottle on, but doc insert timed out after 60 seconds, continuing" << endl;
-                            }
-                        }
+                for ( unsigned i = 0; i < deferredIndexes.size(); i++ ) {
+                    if ( !createIndex( deferredIndexes[i], errmsg, true ) ) {
+                        warning() << errmsg;
+                        state = FAIL;
+                        return;
                     }
-
-                    if ( thisTime == 0 )
-                        break;
                 }
 
+                cloneMillis = cloneTimer.millis();
+                timing.append( "clonedDocs", numCloned );
+                timing.append( "clonedBytes", clonedBytes );
+                timing.append( "cloneMillis", cloneMillis );
+                timing.append( "cloneMBPerSec",
+                               clonedBytes / ( 1024.0 * 1024 ) / ( std::max( cloneMillis, 1 ) / 1000.0 ) );
+                timing.append( "deferredIndexes", static_cast<int>( deferredIndexes.size() ) );
+
                 timing.done(3);
                 MONGO_FP_PAUSE_WHILE(migrateThreadHangAtStep3);
             }
@@ -1889,6 +1991,7 @@ namespace mongo {
                 BSONObjBuilder bb( b.subobjStart( "counts" ) );
                 bb.append( "cloned" , numCloned );
                 bb.append( "clonedBytes" , clonedBytes );
+                bb.append( "cloneMillis" , cloneMillis );
                 bb.append( "catchup" , numCatchup );
                 bb.append( "steady" , numSteady );
                 bb.done();
@@ -1973,6 +2076,116 @@ namespace mongo {
             return didAnything;
         }
 
+        /**
+         * Creates a donor index here and logs it so secondaries build it too.
+         * @param background build the index with a background build, which yields the write
+         *        lock as it goes, for an index built over data already cloned
+         */
+        bool createIndex( const BSONObj& idx, string& errmsg, bool background = false ) {
+            BSONObj spec = idx;
+            if ( background && !idx["background"].trueValue() ) {
+                BSONObjBuilder b;
+                BSONObjIterator i( idx );
+                while ( i.more() ) {
+                    BSONElement e = i.next();
+                    if ( !str::equals( e.fieldName(), "background" ) )
+                        b.append( e );
+                }
+                b.appendBool( "background", true );
+                spec = b.obj();
+            }
+
+            Client::WriteContext ctx( ns );
+            Database* db = ctx.ctx().db();
+            Collection* collection = db->getCollection( ns );
+            if ( !collection ) {
+                errmsg = str::stream() << "collection dropped during migration: " << ns;
+                return false;
+            }
+
+            Status status = collection->getIndexCatalog()->createIndex( spec, false );
+            if ( !status.isOK() && status.code() != ErrorCodes::IndexAlreadyExists ) {
+                errmsg = str::stream() << "failed to create index "
+                                       << ( background ? "after" : "before" )
+                                       << " migrating data. "
+                                       << " idx: " << spec
+                                       << " error: " << status.toString();
+                return false;
+            }
+
+            // make sure to create index on secondaries as well
+            logOp( "i", db->getSystemIndexesName().c_str(), spec,
+                   NULL, NULL, true /* fromMigrate */ );
+            return true;
+        }
+
+        /**
+         * Inserts one _migrateClone batch.  The write lock is taken once for a run of documents
+         * rather than per document, and let go now and then so we don't starve everyone else.
+         * Documents with no local copy are inserted directly; the rest go through an upsert.
+         */
+        void insertClonedBatch( const vector<BSONObj>& docs ) {
+            size_t next = 0;
+            while ( next < docs.size() ) {
+                ElapsedTracker tracker( 128, 10 ); // same as ClientCursor::_yieldSometimesTracker
+                PageFaultRetryableSection pgrs;
+                while ( 1 ) {
+                    try {
+                        Client::WriteContext cx( ns );
+                        Collection* collection = cx.ctx().db()->getCollection( ns );
+                        uassert( 17302, str::stream() << "collection dropped during migration: "
+                                                      << ns,
+                                 collection );
+
+                        for ( ; next < docs.size(); next++ ) {
+                            const BSONObj& o = docs[next];
+
+                            BSONObj localDoc;
+                            if ( willOverrideLocalId( o, &localDoc ) ) {
+                                string errMsg =
+                                    str::stream() << "cannot migrate chunk, local document "
+                                                  << localDoc
+                                                  << " has same _id as cloned "
+                                                  << "remote document " << o;
+
+                                warning() << errMsg << endl;
+
+                                // Exception will abort migration cleanly
+                                uasserted( 16976, errMsg );
+                            }
+
+                            if ( localDoc.isEmpty() ) {
+                                StatusWith<DiskLoc> loc = collection->insertDocument( o, true );
+                                uassertStatusOK( loc.getStatus() );
+                                logOp( "i", ns.c_str(), o, NULL, NULL, true /* fromMigrate */ );
+                            }
+                            else {
+                                Helpers::upsert( ns, o, true );
+                            }
+
+                            numCloned++;
+                            clonedBytes += o.objsize();
+
+                            if ( tracker.intervalHasElapsed() ) {
+                                next++;
+                                break;
+                            }
+                        }
+                        break;
+                    }
+                    catch ( PageFaultException& e ) {
+                        e.touch();
+                    }
+                }
+
+                if ( secondaryThrottle ) {
+                    if ( ! waitForReplication( cc().getLastOp(), 2, 60 /* seconds to wait */ ) ) {
+                        warning() << "secondaryThrottle on, but doc insert timed out after 60 seconds, continuing" << endl;
+                    }
+                }
+            }
+        }
+
         /**
          * Checks if an upsert of a remote document will override a local document with the same _id
          * but in a different range on this shard.
@@ -2089,6 +2302,10 @@ namespace mongo {
 
         long long numCloned;
         long long clonedBytes;
+        int cloneMillis;
+
+        // built once the initial clone is done
+        vector<BSONObj> deferredIndexes;
         long long numCatchup;
         long long numSteady;
         bool secondaryThrottle;
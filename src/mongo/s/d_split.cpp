@@ -30,10 +30,13 @@
 
 #include "mongo/pch.h"
 
+#include <cmath>
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/distlock.h"
@@ -44,10 +47,14 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/index/btree_interface.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/random.h"
 #include "mongo/s/chunk.h" // for static genID only
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
@@ -203,6 +210,387 @@ namespace mongo {
         }
     } cmdCheckShardingIndex;
 
+    // Whether splitVector tries to find split points from a sample of the index btree before
+    // falling back to walking every key in the range. The command's 'estimate' field wins.
+    MONGO_EXPORT_SERVER_PARAMETER(splitVectorSampling, bool, true);
+
+    // Ranges estimated to hold fewer keys than this are scanned exactly, unless the command
+    // asks for an estimate.
+    MONGO_EXPORT_SERVER_PARAMETER(splitVectorSamplingMinKeys, int, 250000);
+
+    /**
+     * Finds approximate split points from the shape of a btree index instead of walking every
+     * key in a range.
+     *
+     * Any two adjacent leaf buckets are separated by exactly one key of an internal bucket, so
+     * walking the internal buckets that intersect the range sees the range as an ordered
+     * sequence of leaves and separator keys, without reading the leaves themselves. The first
+     * and last leaf are counted exactly; every other leaf is assumed to hold the average number
+     * of keys of a random sample of leaves. Split points are picked among the separator keys.
+     *
+     * Caller must hold a read lock on the collection for the lifetime of this object.
+     */
+    class SplitPointEstimator {
+        MONGO_DISALLOW_COPYING(SplitPointEstimator);
+    public:
+        SplitPointEstimator(IndexDescriptor* idx, const BSONObj& min, const BSONObj& max)
+            : _bt(BtreeInterface::interfaces[idx->version()]),
+              _head(idx->getHead()),
+              _ordering(Ordering::make(idx->keyPattern())),
+              _min(min),
+              _max(max),
+              _leafDepth(0),
+              _unbalanced(false),
+              _picking(false),
+              _done(false),
+              _bucketsRead(0),
+              _numLeaves(0),
+              _numSeparators(0),
+              _random(static_cast<int64_t>(curTimeMicros64())),
+              _firstLeafKeys(0),
+              _lastLeafKeys(0),
+              _avgLeafKeys(0),
+              _leafFillDeviation(0),
+              _keyCount(0),
+              _maxSplitPoints(0),
+              _currCount(0),
+              _splitKeys(NULL),
+              _chunkKeys(NULL) {
+        }
+
+        /**
+         * Walks the internal buckets over the range and samples its leaves. Returns false, with
+         * the reason in 'whyNot', if the tree can't give a usable estimate for this range.
+         */
+        bool sample(string* whyNot) {
+            // Find the depth of the leaves along the path to 'min'.
+            DiskLoc bucket = _head;
+            while (true) {
+                _bucketsRead++;
+                const int n = _bt->nKeys(bucket);
+                int pos = 0;
+                while (pos < n && _bt->keyAt(bucket, pos).woCompare(_min, _ordering, false) < 0) {
+                    pos++;
+                }
+
+                const DiskLoc child = _bt->childForPos(bucket, pos);
+                if (child.isNull()) {
+                    break;
+                }
+
+                bucket = child;
+                _leafDepth++;
+            }
+
+            if (_leafDepth == 0) {
+                *whyNot = "index btree has a single level";
+                return false;
+            }
+
+            _walk(_head, 0);
+
+            if (_unbalanced) {
+                *whyNot = "index btree leaves are not all at the same depth";
+                return false;
+            }
+
+            if (_numLeaves < MinLeaves) {
+                *whyNot = "range spans too few btree buckets";
+                return false;
+            }
+
+            _firstLeafKeys = _countLeafKeys(_firstLeaf);
+            _lastLeafKeys = _countLeafKeys(_lastLeaf);
+
+            long long sum = 0;
+            long long sumSquares = 0;
+            int sampled = 0;
+            for (size_t i = 0; i < _sample.size(); i++) {
+                if (_sample[i] == _firstLeaf || _sample[i] == _lastLeaf) {
+                    continue;
+                }
+
+                const long long keys = _countLeafKeys(_sample[i]);
+                sum += keys;
+                sumSquares += keys * keys;
+                sampled++;
+            }
+
+            verify(sampled > 0);
+            _avgLeafKeys = static_cast<double>(sum) / sampled;
+            if (_avgLeafKeys < 1) {
+                *whyNot = "sampled btree buckets are empty";
+                return false;
+            }
+
+            const double variance = static_cast<double>(sumSquares) / sampled
+                                    - _avgLeafKeys * _avgLeafKeys;
+            _leafFillDeviation = sqrt(std::max(0.0, variance)) / _avgLeafKeys;
+            if (_leafFillDeviation > MaxLeafFillDeviation) {
+                *whyNot = "sampled btree buckets are filled too unevenly";
+                return false;
+            }
+
+            return true;
+        }
+
+        /** Estimated number of keys in the range. Only valid after sample() succeeded. */
+        long long estimatedKeys() const {
+            return _firstLeafKeys + _lastLeafKeys + _numSeparators
+                + static_cast<long long>((_numLeaves - 2) * _avgLeafKeys);
+        }
+
+        /** Average number of keys per leaf bucket. Only valid after sample() succeeded. */
+        double keysPerLeaf() const {
+            return _avgLeafKeys;
+        }
+
+        /**
+         * Mirrors the exact scan in splitVector: appends a separator key, in index key format,
+         * to 'splitKeys' whenever more than 'keyCount' keys are estimated to lie between it and
+         * the previous split point, stopping at 'maxSplitPoints' if that is non-zero. The
+         * estimated number of keys before each split point goes to 'chunkKeys'.
+         */
+        void pickSplitKeys(long long keyCount,
+                           long long maxSplitPoints,
+                           vector<BSONObj>* splitKeys,
+                           vector<long long>* chunkKeys) {
+            _picking = true;
+            _done = false;
+            _keyCount = keyCount;
+            _maxSplitPoints = maxSplitPoints;
+            _currCount = 0;
+            _splitKeys = splitKeys;
+            _chunkKeys = chunkKeys;
+
+            _walk(_head, 0);
+        }
+
+        void appendStats(BSONObjBuilder* b) const {
+            b->append("bucketsRead", _bucketsRead);
+            b->append("leafBuckets", _numLeaves);
+            b->append("sampledLeaves", static_cast<int>(_sample.size()));
+            b->append("keysPerLeaf", _avgLeafKeys);
+            b->append("leafFillDeviation", _leafFillDeviation);
+        }
+
+    private:
+        // Below this many leaves the exact scan is cheap enough.
+        static const long long MinLeaves = 8;
+        static const size_t SampleSize = 32;
+        static const double MaxLeafFillDeviation;
+
+        /**
+         * In-order walk of the internal buckets under 'bucket' restricted to [_min, _max).
+         * Children at _leafDepth are handed to _visitLeaf without being read.
+         */
+        void _walk(const DiskLoc& bucket, int depth) {
+            if (!_picking) {
+                _bucketsRead++;
+            }
+
+            const int n = _bt->nKeys(bucket);
+            for (int pos = 0; pos <= n && !_done; pos++) {
+                // The key past the last child is +infinity.
+                BSONObj key;
+                int cmpMin = 1;
+                if (pos < n) {
+                    key = _bt->keyAt(bucket, pos);
+                    cmpMin = key.woCompare(_min, _ordering, false);
+                }
+
+                // The child left of 'key' only holds keys up to 'key'.
+                if (cmpMin >= 0) {
+                    const DiskLoc child = _bt->childForPos(bucket, pos);
+                    if (child.isNull()) {
+                        _unbalanced = true;
+                    }
+                    else if (depth + 1 == _leafDepth) {
+                        _visitLeaf(child);
+                    }
+                    else {
+                        _walk(child, depth + 1);
+                    }
+                }
+
+                if (pos == n || key.woCompare(_max, _ordering, false) >= 0) {
+                    break;
+                }
+
+                if (cmpMin >= 0 && _bt->keyIsUsed(bucket, pos)) {
+                    _visitSeparator(key);
+                }
+            }
+        }
+
+        void _visitLeaf(const DiskLoc& leaf) {
+            if (_picking) {
+                if (leaf == _firstLeaf) {
+                    _currCount += _firstLeafKeys;
+                }
+                else if (leaf == _lastLeaf) {
+                    _currCount += _lastLeafKeys;
+                }
+                else {
+                    _currCount += static_cast<long long>(_avgLeafKeys);
+                }
+                return;
+            }
+
+            if (_numLeaves == 0) {
+                _firstLeaf = leaf;
+            }
+            _lastLeaf = leaf;
+            _numLeaves++;
+
+            // Reservoir sample, so that the leaves don't have to be remembered.
+            if (_sample.size() < SampleSize) {
+                _sample.push_back(leaf);
+            }
+            else {
+                const long long pick = (_random.nextInt64() & 0x7fffffffffffffffLL) % _numLeaves;
+                if (pick < static_cast<long long>(SampleSize)) {
+                    _sample[pick] = leaf;
+                }
+            }
+        }
+
+        void _visitSeparator(const BSONObj& key) {
+            if (!_picking) {
+                _numSeparators++;
+                return;
+            }
+
+            _currCount++;
+            if (_currCount > _keyCount) {
+                _splitKeys->push_back(key.getOwned());
+                _chunkKeys->push_back(_currCount);
+                _currCount = 0;
+
+                if (_maxSplitPoints &&
+                        static_cast<long long>(_splitKeys->size()) >= _maxSplitPoints) {
+                    _done = true;
+                }
+            }
+        }
+
+        /** Reads a leaf and counts its used keys in [_min, _max). */
+        long long _countLeafKeys(const DiskLoc& leaf) {
+            _bucketsRead++;
+
+            long long count = 0;
+            const int n = _bt->nKeys(leaf);
+            for (int pos = 0; pos < n; pos++) {
+                if (!_bt->keyIsUsed(leaf, pos)) {
+                    continue;
+                }
+
+                const BSONObj key = _bt->keyAt(leaf, pos);
+                if (key.woCompare(_min, _ordering, false) >= 0 &&
+                        key.woCompare(_max, _ordering, false) < 0) {
+                    count++;
+                }
+            }
+
+            return count;
+        }
+
+        BtreeInterface* const _bt;
+        const DiskLoc _head;
+        const Ordering _ordering;
+        const BSONObj _min;
+        const BSONObj _max;
+
+        // Depth of the leaf buckets, the head being at depth 0.
+        int _leafDepth;
+
+        // Set if a leaf was found above _leafDepth.
+        bool _unbalanced;
+
+        // False while sampling, true while picking split keys.
+        bool _picking;
+        bool _done;
+
+        int _bucketsRead;
+        long long _numLeaves;
+        long long _numSeparators;
+        DiskLoc _firstLeaf;
+        DiskLoc _lastLeaf;
+        vector<DiskLoc> _sample;
+        PseudoRandom _random;
+
+        long long _firstLeafKeys;
+        long long _lastLeafKeys;
+        double _avgLeafKeys;
+
+        // Standard deviation of the sampled leaf key counts, relative to their average.
+        double _leafFillDeviation;
+
+        // State for pickSplitKeys.
+        long long _keyCount;
+        long long _maxSplitPoints;
+        long long _currCount;
+        vector<BSONObj>* _splitKeys;
+        vector<long long>* _chunkKeys;
+    };
+
+    const double SplitPointEstimator::MaxLeafFillDeviation = 0.5;
+
+    /**
+     * Remembers how splitVector found the split points of recently examined chunks, so that the
+     * splitChunk which normally follows can put it in the changelog. Only the most recent
+     * entries are kept.
+     */
+    class SplitVectorHistory {
+    public:
+        SplitVectorHistory() : _mutex("splitVectorHistory") {}
+
+        void record(const string& ns, const BSONObj& min, const BSONObj& max,
+                    const BSONObj& stats) {
+            SimpleMutex::scoped_lock lk(_mutex);
+
+            Entry entry;
+            entry.ns = ns;
+            entry.min = min.getOwned();
+            entry.max = max.getOwned();
+            entry.stats = stats.getOwned();
+            _entries.push_back(entry);
+
+            if (_entries.size() > MaxEntries) {
+                _entries.pop_front();
+            }
+        }
+
+        /** Removes and returns the stats recorded for the chunk, or an empty object. */
+        BSONObj take(const string& ns, const BSONObj& min, const BSONObj& max) {
+            SimpleMutex::scoped_lock lk(_mutex);
+
+            for (deque<Entry>::reverse_iterator it = _entries.rbegin();
+                    it != _entries.rend(); ++it) {
+                if (it->ns == ns && it->min.woCompare(min) == 0 && it->max.woCompare(max) == 0) {
+                    BSONObj stats = it->stats;
+                    _entries.erase(--(it.base()));
+                    return stats;
+                }
+            }
+
+            return BSONObj();
+        }
+
+    private:
+        static const size_t MaxEntries = 100;
+
+        struct Entry {
+            string ns;
+            BSONObj min;
+            BSONObj max;
+            BSONObj stats;
+        };
+
+        SimpleMutex _mutex;
+        deque<Entry> _entries;
+    } splitVectorHistory;
+
     BSONObj prettyKey(const BSONObj& keyPattern, const BSONObj& key) {
         return key.replaceFieldNames(keyPattern).clientReadable();
     }
@@ -222,6 +610,8 @@ namespace mongo {
                  "  \n"
                  "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, force: true }\n"
                  "  'force' will produce one split point even if data is small; defaults to false\n"
+                 "  'estimate' picks split points from a sample of the index btree when possible; defaults to\n"
+                 "  the splitVectorSampling server parameter, and then only applies to large ranges\n"
                  "NOTE: This command may take a while to run";
         }
         virtual Status checkAuthForCommand(ClientBasic* client,
@@ -266,6 +656,18 @@ namespace mongo {
                 maxSplitPoints = maxSplitPointsElem.numberLong();
             }
 
+            bool useSampling = splitVectorSampling;
+            bool estimateRequested = false;
+            BSONElement estimateElem = jsobj[ "estimate" ];
+            if ( estimateElem.isBoolean() ) {
+                useSampling = estimateElem.boolean();
+                estimateRequested = useSampling;
+            }
+
+            // The chunk bounds as given, to match the splitChunk that may follow.
+            const BSONObj chunkMin = min.getOwned();
+            const BSONObj chunkMax = max.getOwned();
+
             long long maxChunkObjects = Chunk::MaxObjectPerChunk;
             BSONElement MaxChunkObjectsElem = jsobj[ "maxChunkObjects" ];
             if ( MaxChunkObjectsElem.isNumber() ) {
@@ -391,54 +793,125 @@ namespace mongo {
                 set<BSONObj> tooFrequentKeys;
                 splitKeys.push_back(prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields( keyPattern ) );
 
-                runner->setYieldPolicy(Runner::YIELD_AUTO);
-                while ( 1 ) {
-                    while (Runner::RUNNER_ADVANCED == state) {
-                        currCount++;
-                        
-                        if ( currCount > keyCount && !forceMedianSplit ) {
-                            currKey = prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields(keyPattern);
-                            // Do not use this split key if it is the same used in the previous split point.
-                            if ( currKey.woCompare( splitKeys.back() ) == 0 ) {
-                                tooFrequentKeys.insert( currKey.getOwned() );
-                            }
-                            else {
-                                splitKeys.push_back( currKey.getOwned() );
-                                currCount = 0;
-                                numChunks++;
-                                LOG(4) << "picked a split key: " << currKey << endl;
-                            }
+                // Number of keys in each chunk before a split point, for the split stats.
+                vector<long long> chunkKeys;
+
+                //
+                // 2.a Try to estimate the split points from the btree first. Anything that makes
+                //     the estimate doubtful sends us to the exact scan below.
+                //
+
+                bool sampled = false;
+                bool estimated = false;
+                string fallbackReason;
+                BSONObjBuilder samplingStats;
+                const string accessMethod =
+                    collection->getIndexCatalog()->getAccessMethodName( idx->keyPattern() );
+                if ( useSampling && ( accessMethod == "" || accessMethod == IndexNames::HASHED ) ) {
+                    sampled = true;
+                    SplitPointEstimator estimator( idx, min, max );
+                    if ( estimator.sample( &fallbackReason ) ) {
+                        const long long estimatedKeyCount =
+                            forceMedianSplit ? estimator.estimatedKeys() / 2 : keyCount;
+
+                        if ( !estimateRequested &&
+                                estimator.estimatedKeys() < splitVectorSamplingMinKeys ) {
+                            fallbackReason = "range is small enough to scan";
                         }
+                        else if ( estimatedKeyCount < 2 * estimator.keysPerLeaf() ) {
+                            fallbackReason = "chunks would span too few btree buckets";
+                        }
+                        else {
+                            vector<BSONObj> candidates;
+                            estimator.pickSplitKeys( estimatedKeyCount,
+                                                     forceMedianSplit ? 0 : maxSplitPoints,
+                                                     &candidates,
+                                                     &chunkKeys );
+
+                            vector<BSONObj> picked( 1, splitKeys.front() );
+                            for ( size_t i = 0; i < candidates.size(); i++ ) {
+                                BSONObj key = prettyKey( idx->keyPattern(), candidates[i] ).extractFields( keyPattern );
+                                // The exact scan knows how to step over a key that fills more
+                                // than a chunk, the estimate doesn't.
+                                if ( key.woCompare( picked.back() ) == 0 ) {
+                                    fallbackReason = "sampled split point falls on a very frequent key";
+                                    break;
+                                }
+                                picked.push_back( key.getOwned() );
+                            }
 
-                        // Stop if we have enough split points.
-                        if ( maxSplitPoints && ( numChunks >= maxSplitPoints ) ) {
-                            log() << "max number of requested split points reached (" << numChunks
-                                  << ") before the end of chunk " << ns << " " << min << " -->> " << max
-                                  << endl;
-                            break;
+                            if ( fallbackReason.empty() ) {
+                                estimated = true;
+                                splitKeys.swap( picked );
+                                keyCount = estimatedKeyCount;
+                                samplingStats.append( "estimatedKeys", estimator.estimatedKeys() );
+                            }
                         }
+                    }
+                    estimator.appendStats( &samplingStats );
 
-                        state = runner->getNext(&currKey, NULL);
+                    if ( ! estimated ) {
+                        chunkKeys.clear();
+                        LOG(1) << "splitVector using a full index scan for chunk " << ns << " "
+                               << min << " -->> " << max << ": " << fallbackReason << endl;
                     }
+                }
+
+                //
+                // 2.b Otherwise walk every key.
+                //
+
+                if ( ! estimated ) {
+                    runner->setYieldPolicy(Runner::YIELD_AUTO);
+                    while ( 1 ) {
+                        while (Runner::RUNNER_ADVANCED == state) {
+                            currCount++;
+                        
+                            if ( currCount > keyCount && !forceMedianSplit ) {
+                                currKey = prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields(keyPattern);
+                                // Do not use this split key if it is the same used in the previous split point.
+                                if ( currKey.woCompare( splitKeys.back() ) == 0 ) {
+                                    tooFrequentKeys.insert( currKey.getOwned() );
+                                }
+                                else {
+                                    splitKeys.push_back( currKey.getOwned() );
+                                    chunkKeys.push_back( currCount );
+                                    currCount = 0;
+                                    numChunks++;
+                                    LOG(4) << "picked a split key: " << currKey << endl;
+                                }
+                            }
+
+                            // Stop if we have enough split points.
+                            if ( maxSplitPoints && ( numChunks >= maxSplitPoints ) ) {
+                                log() << "max number of requested split points reached (" << numChunks
+                                      << ") before the end of chunk " << ns << " " << min << " -->> " << max
+                                      << endl;
+                                break;
+                            }
+
+                            state = runner->getNext(&currKey, NULL);
+                        }
                     
-                    if ( ! forceMedianSplit )
-                        break;
+                        if ( ! forceMedianSplit )
+                            break;
                     
-                    //
-                    // If we're forcing a split at the halfway point, then the first pass was just
-                    // to count the keys, and we still need a second pass.
-                    //
+                        //
+                        // If we're forcing a split at the halfway point, then the first pass was just
+                        // to count the keys, and we still need a second pass.
+                        //
 
-                    forceMedianSplit = false;
-                    keyCount = currCount / 2;
-                    currCount = 0;
-                    log() << "splitVector doing another cycle because of force, keyCount now: " << keyCount << endl;
+                        forceMedianSplit = false;
+                        keyCount = currCount / 2;
+                        currCount = 0;
+                        log() << "splitVector doing another cycle because of force, keyCount now: " << keyCount << endl;
 
-                    runner.reset(InternalPlanner::indexScan(idx, min, max,
-                                                            false, InternalPlanner::FORWARD));
+                        runner.reset(InternalPlanner::indexScan(idx, min, max,
+                                                                false, InternalPlanner::FORWARD));
 
-                    runner->setYieldPolicy(Runner::YIELD_AUTO);
-                    state = runner->getNext(&currKey, NULL);
+                        runner->setYieldPolicy(Runner::YIELD_AUTO);
+                        state = runner->getNext(&currKey, NULL);
+                    }
                 }
 
                 //
@@ -462,10 +935,39 @@ namespace mongo {
                               << endl;
                 }
                 
+                // Summarize how the split points were found and how even the resulting chunks
+                // are (estimated, if sampled). This also goes into the split changelog entry.
+                BSONObjBuilder statsBuilder;
+                statsBuilder.append( "method", estimated ? "sampled" : "scan" );
+                statsBuilder.append( "timeMillis", timer.millis() );
+                statsBuilder.append( "targetChunkKeys", keyCount );
+                if ( ! chunkKeys.empty() ) {
+                    long long minKeys = chunkKeys.front();
+                    long long maxKeys = chunkKeys.front();
+                    for ( size_t i = 1; i < chunkKeys.size(); i++ ) {
+                        minKeys = std::min( minKeys, chunkKeys[i] );
+                        maxKeys = std::max( maxKeys, chunkKeys[i] );
+                    }
+                    statsBuilder.append( "minChunkKeys", minKeys );
+                    statsBuilder.append( "maxChunkKeys", maxKeys );
+                }
+                if ( ! fallbackReason.empty() ) {
+                    statsBuilder.append( "fallbackReason", fallbackReason );
+                }
+                if ( sampled ) {
+                    statsBuilder.append( "sampling", samplingStats.obj() );
+                }
+                BSONObj stats = statsBuilder.obj();
+
+                if ( splitKeys.size() > 1 ) {
+                    splitVectorHistory.record( ns, chunkMin, chunkMax, stats );
+                }
+
                 // Warning: we are sending back an array of keys but are currently limited to
                 // 4MB work of 'result' size. This should be okay for now.
 
                 result.append( "timeMillis", timer.millis() );
+                result.append( "splitStats", stats );
             }
 
             result.append( "splitKeys" , splitKeys );
@@ -532,6 +1034,8 @@ namespace mongo {
         }
         bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
 
+            Timer splitTimer;
+
             //
             // 1. check whether parameters passed to splitChunk are sound
             //
@@ -722,6 +1226,12 @@ namespace mongo {
 
             BSONObjBuilder logDetail;
             origChunk.appendShortVersion( "before" , logDetail );
+
+            // How the split points were found, if they came from a splitVector on this shard.
+            BSONObj splitVectorStats = splitVectorHistory.take( ns , min , max );
+            if ( ! splitVectorStats.isEmpty() ) {
+                logDetail.append( "splitVector" , splitVectorStats );
+            }
             LOG(1) << "before split on " << origChunk << endl;
             vector<ChunkInfo> newChunks;
 
@@ -818,6 +1328,8 @@ namespace mongo {
             // 5. logChanges
             //
 
+            logDetail.append( "timeMillis" , splitTimer.millis() );
+
             // single splits are logged different than multisplits
             if ( newChunks.size() == 2 ) {
                 newChunks[0].appendShortVersion( "left" , logDetail );
@@ -68,7 +68,8 @@ namespace mongo {
 
     ShardingState::ShardingState()
         : _enabled(false) , _mutex( "ShardingState" ),
-          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ) {
+          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ),
+          _metadataGeneration( 1 ) {
     }
 
     void ShardingState::enable( const string& server ) {
@@ -122,6 +123,7 @@ namespace mongo {
         _configServer.clear();
         _shardName.clear();
         _collMetadata.clear();
+        _metadataGeneration.fetchAndAdd( 1 );
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
@@ -181,6 +183,7 @@ namespace mongo {
         // TODO: a bit dangerous to have two different zero-version states - no-metadata and
         // no-version
         _collMetadata[ns] = cloned;
+        _metadataGeneration.fetchAndAdd( 1 );
     }
 
     void ShardingState::undoDonateChunk( const string& ns, CollectionMetadataPtr prevMetadata ) {
@@ -190,6 +193,7 @@ namespace mongo {
         CollectionMetadataMap::iterator it = _collMetadata.find( ns );
         verify( it != _collMetadata.end() );
         it->second = prevMetadata;
+        _metadataGeneration.fetchAndAdd( 1 );
     }
 
     bool ShardingState::notePending( const string& ns,
@@ -231,6 +235,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _metadataGeneration.fetchAndAdd( 1 );
         return true;
     }
 
@@ -273,6 +278,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _metadataGeneration.fetchAndAdd( 1 );
         return true;
     }
 
@@ -297,6 +303,7 @@ namespace mongo {
         uassert( 16857, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _metadataGeneration.fetchAndAdd( 1 );
     }
 
     void ShardingState::mergeChunks( const string& ns,
@@ -319,6 +326,7 @@ namespace mongo {
         uassert( 17004, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _metadataGeneration.fetchAndAdd( 1 );
     }
 
     void ShardingState::resetMetadata( const string& ns ) {
@@ -328,6 +336,7 @@ namespace mongo {
                   << endl;
 
         _collMetadata.erase( ns );
+        _metadataGeneration.fetchAndAdd( 1 );
     }
 
     Status ShardingState::refreshMetadataIfNeeded( const string& ns,
@@ -599,6 +608,8 @@ namespace mongo {
                     _collMetadata.erase( it );
                 }
 
+                _metadataGeneration.fetchAndAdd( 1 );
+
                 *latestShardVersion = remoteShardVersion;
             }
         }
@@ -731,7 +742,7 @@ namespace mongo {
     const ChunkVersion ShardedConnectionInfo::getVersion( const string& ns ) const {
         NSVersionMap::const_iterator it = _versions.find( ns );
         if ( it != _versions.end() ) {
-            return it->second;
+            return it->second.version;
         }
         else {
             return ChunkVersion( 0, OID() );
@@ -739,7 +750,20 @@ namespace mongo {
     }
 
     void ShardedConnectionInfo::setVersion( const string& ns , const ChunkVersion& version ) {
-        _versions[ns] = version;
+        NSVersion& nsVersion = _versions[ns];
+        nsVersion.version = version;
+        nsVersion.verifiedGeneration = 0;
+    }
+
+    bool ShardedConnectionInfo::isVersionVerified( const string& ns,
+                                                   unsigned long long generation ) const {
+        NSVersionMap::const_iterator it = _versions.find( ns );
+        return it != _versions.end() && it->second.verifiedGeneration == generation;
+    }
+
+    void ShardedConnectionInfo::noteVersionVerified( const string& ns,
+                                                     unsigned long long generation ) {
+        _versions[ns].verifiedGeneration = generation;
     }
 
     void ShardedConnectionInfo::addHook() {
@@ -1225,12 +1249,21 @@ namespace mongo {
             return true;
         }
 
+        // Nothing has changed on either side since this connection's version was last found
+        // compatible - skip the lookup under the ShardingState mutex.  The generation must be
+        // read before the versions, so that a concurrent change is never recorded as verified.
+        const unsigned long long generation = shardingState.getMetadataGeneration();
+        if ( info->isVersionVerified( ns, generation ) ) return true;
+
         // TODO : all collections at some point, be sharded or not, will have a version
         //  (and a CollectionMetadata)
         received = info->getVersion( ns );
         wanted = shardingState.getVersion( ns );
 
-        if( received.isWriteCompatibleWith( wanted ) ) return true;
+        if( received.isWriteCompatibleWith( wanted ) ) {
+            info->noteVersionVerified( ns, generation );
+            return true;
+        }
 
         //
         // Figure out exactly why not compatible, send appropriate error message
@@ -28,12 +28,17 @@
 
 #include "mongo/s/dbclient_multi_command.h"
 
+#include <set>
+
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/shard.h"
 #include "mongo/s/write_ops/batch_downconvert.h"
 #include "mongo/s/write_ops/dbclient_safe_writer.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/net/socket_poll.h"
 
 namespace mongo {
 
@@ -44,6 +49,7 @@ namespace mongo {
         dbName( dbName.toString() ),
         cmdObj( cmdObj ),
         conn( NULL ),
+        sent( false ),
         status( Status::OK() ) {
     }
 
@@ -106,6 +112,29 @@ namespace mongo {
             dassert( response.isValid( NULL ) );
             *cmdResponse = response.toBSON();
         }
+
+        /**
+         * Returns the socket on which the response to a sent command will arrive, or -1 if
+         * recvAny doesn't need to wait on the network for it.
+         */
+        int responseFD( DBClientBase* conn, const BSONObj& cmdObj, const Status& status ) {
+
+            // Failed sends have nothing to recv
+            if ( !status.isOK() ) return -1;
+
+            // Legacy safe writes are only sent once we recv
+            if ( !hasBatchWriteFeature( conn ) && isBatchWriteCommand( cmdObj ) ) return -1;
+
+            DBClientConnection* connection = dynamic_cast<DBClientConnection*>( conn );
+            if ( NULL == connection ) return -1;
+
+            return connection->port().psock->rawFD();
+        }
+
+        // Socket timeout of the connection in millis, or 0 if it has none
+        int soTimeoutMillis( const DBClientBase* conn ) {
+            return static_cast<int>( conn->getSoTimeout() * 1000 );
+        }
     }
 
     // THROWS
@@ -145,6 +174,11 @@ namespace mongo {
             it != _pendingCommands.end(); ++it ) {
 
             PendingCommand* command = *it;
+
+            // Already out on the network from an earlier sendAll
+            if ( command->sent ) continue;
+            command->sent = true;
+
             dassert( NULL == command->conn );
 
             try {
@@ -185,13 +219,103 @@ namespace mongo {
     }
 
     int DBClientMultiCommand::numPending() const {
-        return static_cast<int>( _pendingCommands.size() );
+
+        int numSent = 0;
+        for ( deque<PendingCommand*>::const_iterator it = _pendingCommands.begin();
+            it != _pendingCommands.end(); ++it ) {
+            if ( ( *it )->sent ) ++numSent;
+        }
+
+        return numSent;
+    }
+
+    /**
+     * Only the oldest sent command to each endpoint may be recv'd, so that responses from one
+     * endpoint come back in the order they were sent.  Of those, returns the first command that
+     * failed to send or whose response has already arrived, so a slow host doesn't hold up the
+     * responses from faster ones.
+     */
+    DBClientMultiCommand::PendingQueue::iterator DBClientMultiCommand::nextReady() {
+
+        vector<PendingQueue::iterator> eligible;
+        vector<pollfd> pollInfos;
+        set<string> seenEndpoints;
+
+        // Wait no longer than the shortest socket timeout of the hosts we're waiting on
+        int timeoutMillis = -1;
+
+        for ( PendingQueue::iterator it = _pendingCommands.begin(); it != _pendingCommands.end();
+            ++it ) {
+
+            PendingCommand* command = *it;
+            if ( !command->sent ) continue;
+            if ( !seenEndpoints.insert( command->endpoint.toString() ).second ) continue;
+
+            int fd = responseFD( command->conn, command->cmdObj, command->status );
+
+            // Nothing to wait for on the network
+            if ( fd < 0 ) return it;
+
+            pollfd pollInfo;
+            pollInfo.fd = fd;
+            pollInfo.events = POLLIN;
+            pollInfo.revents = 0;
+
+            eligible.push_back( it );
+            pollInfos.push_back( pollInfo );
+
+            int connTimeoutMillis = soTimeoutMillis( command->conn );
+            if ( connTimeoutMillis > 0
+                 && ( timeoutMillis < 0 || connTimeoutMillis < timeoutMillis ) ) {
+                timeoutMillis = connTimeoutMillis;
+            }
+        }
+
+        dassert( !eligible.empty() );
+        if ( eligible.size() == 1 || !isPollSupported() ) return eligible.front();
+
+        // Wait for any of the hosts to respond - errors and hangups are returned as events too,
+        // and are then reported by the recv itself
+        int nEvents = socketPoll( &pollInfos[0], pollInfos.size(), timeoutMillis );
+
+        if ( nEvents > 0 ) {
+            for ( size_t i = 0; i < pollInfos.size(); ++i ) {
+                if ( pollInfos[i].revents != 0 ) return eligible[i];
+            }
+        }
+
+        if ( nEvents == 0 ) {
+
+            // Timed out - the hosts whose socket timeout has passed get an error instead of a
+            // response.  Their connections still have a response coming, so they can't go back
+            // to the pool.
+            PendingQueue::iterator timedOutIt = eligible.front();
+            for ( size_t i = eligible.size(); i-- > 0; ) {
+
+                PendingCommand* command = *eligible[i];
+                if ( soTimeoutMillis( command->conn ) != timeoutMillis ) continue;
+
+                command->status = Status( ErrorCodes::HostUnreachable,
+                                          str::stream() << "timed out after " << timeoutMillis
+                                                        << "ms waiting for a response from "
+                                                        << command->endpoint.toString() );
+                delete command->conn;
+                command->conn = NULL;
+                timedOutIt = eligible[i];
+            }
+
+            return timedOutIt;
+        }
+
+        // Poll failed, fall back to waiting on the oldest command
+        return eligible.front();
     }
 
     Status DBClientMultiCommand::recvAny( ConnectionString* endpoint, BSONSerializable* response ) {
 
-        scoped_ptr<PendingCommand> command( _pendingCommands.front() );
-        _pendingCommands.pop_front();
+        PendingQueue::iterator readyIt = nextReady();
+        scoped_ptr<PendingCommand> command( *readyIt );
+        _pendingCommands.erase( readyIt );
 
         *endpoint = command->endpoint;
         if ( !command->status.isOK() ) return command->status;
@@ -39,6 +39,9 @@ namespace mongo {
      * A DBClientMultiCommand uses the client driver (DBClientConnections) to send and recv
      * commands to different hosts in parallel.
      *
+     * Each command is sent on its own pooled connection, so several commands may be outstanding
+     * to the same host at once.  recvAny returns whichever host responds first.
+     *
      * See MultiCommandDispatch for more details.
      */
     class DBClientMultiCommand : public MultiCommandDispatch {
@@ -73,11 +76,18 @@ namespace mongo {
             // Where to send it
             DBClientBase* conn;
 
+            // Whether sendAll has dispatched it yet
+            bool sent;
+
             // If anything goes wrong
             Status status;
         };
 
         typedef std::deque<PendingCommand*> PendingQueue;
+
+        // Picks the sent command to recv next
+        PendingQueue::iterator nextReady();
+
         PendingQueue _pendingCommands;
     };
 
@@ -69,6 +69,7 @@ namespace mongo {
         if( ! dbConfig ){
 
             dbConfig.reset(new DBConfig( database ));
+            noteRoutingChange();
 
             // Protect initial load from connectivity errors
             bool loaded = false;
@@ -167,7 +168,7 @@ namespace mongo {
         uassert( 10186 ,  "removeDB expects db name" , database.find( '.' ) == string::npos );
         scoped_lock l( _lock );
         _databases.erase( database );
-
+        noteRoutingChange();
     }
 
     void Grid::removeDBIfExists( const DBConfig& database ) {
@@ -178,6 +179,7 @@ namespace mongo {
         if( it != _databases.end() && it->second.get() == &database ){
 
             _databases.erase( it );
+            noteRoutingChange();
             log() << "erased database " << database.getName() << " from local registry" << endl;
         }
         else{
@@ -595,6 +597,7 @@ namespace mongo {
     void Grid::flushConfig() {
         scoped_lock lk( _lock );
         _databases.clear();
+        noteRoutingChange();
     }
 
     BSONObj Grid::getConfigSetting( const std::string& name ) const {
@@ -33,6 +33,7 @@
 #include <boost/date_time/posix_time/posix_time.hpp>
 
 #include "mongo/util/time_support.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 
 #include "config.h"  // DBConfigPtr
@@ -45,7 +46,7 @@ namespace mongo {
      */
     class Grid {
     public:
-        Grid() : _lock( "Grid" ) , _allowLocalShard( true ) { }
+        Grid() : _lock( "Grid" ) , _allowLocalShard( true ) , _routingGeneration( 1 ) { }
 
         /**
          * gets the config the db.
@@ -124,6 +125,15 @@ namespace mongo {
         
         void flushConfig();
 
+        /**
+         * The routing generation is bumped after every change to the cached databases,
+         * sharded collections and chunk managers.  A reader which loads it before looking at
+         * that metadata can later tell, with one atomic load, whether anything it derived
+         * from the metadata might be out of date.
+         */
+        unsigned long long getRoutingGeneration() const { return _routingGeneration.load(); }
+        void noteRoutingChange() { _routingGeneration.fetchAndAdd( 1 ); }
+
         // exposed methods below are for testing only
 
         /**
@@ -137,6 +147,7 @@ namespace mongo {
         mongo::mutex              _lock;            // protects _databases; TODO: change to r/w lock ??
         map<string, DBConfigPtr > _databases;       // maps ns to DBConfig's
         bool                      _allowLocalShard; // can 'localhost' be used in shard addresses?
+        AtomicUInt64              _routingGeneration; // see getRoutingGeneration()
 
         /**
          * @param name is the chose name for the shard. Parameter is mandatory.
@@ -24,6 +24,7 @@
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_options_helpers.h"
 #include "mongo/s/chunk.h"
+#include "mongo/s/routing_table_cache.h"
 #include "mongo/s/version_mongos.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/options_parser/startup_options.h"
@@ -77,6 +78,9 @@ namespace mongo {
         sharding_options.addOptionChaining("chunkSize", "chunkSize", moe::Int,
                 "maximum amount of data per chunk (in MB)");
 
+        sharding_options.addOptionChaining("routingTableCacheDir", "routingTableCacheDir",
+                moe::String, "directory to cache chunk metadata in, for faster startup");
+
         sharding_options.addOptionChaining("ipv6", "ipv6", moe::Switch,
                 "enable IPv6 support (disabled by default)");
 
@@ -152,6 +156,14 @@ namespace mongo {
             }
         }
 
+        if (params.count("routingTableCacheDir")) {
+            Status status = routingTableCache.setDirectory(
+                    params["routingTableCacheDir"].as<std::string>());
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+
         if (params.count( "port" ) ) {
             int port = params["port"].as<int>();
             if ( port <= 0 || port > 65535 ) {
@@ -40,6 +40,7 @@ namespace mongo {
      *
      * The commands are first registered with an endpoint and serializable request.  Commands are
      * sent out without waiting for responses, and then responses are read later one-at-a-time.
+     * More commands may be added and sent while earlier ones are still outstanding.
      *
      * If context must be tracked alongside these requests, it can be associated with the endpoint
      * object.
@@ -61,9 +62,9 @@ namespace mongo {
                                  const BSONSerializable& request ) = 0;
 
         /**
-         * Sends all the commands in this dispatch to their endpoints, in undefined order and
-         * without waiting for responses.  May block on full send queue (though this should be
-         * rare).
+         * Sends all the commands added since the last sendAll to their endpoints, in undefined
+         * order and without waiting for responses.  May block on full send queue (though this
+         * should be rare).
          *
          * Any error which occurs during sendAll will be reported on recvAny, *does not throw.*
          */
@@ -76,7 +77,8 @@ namespace mongo {
 
         /**
          * Blocks until a command response has come back.  Any outstanding command response may be
-         * returned with associated endpoint.
+         * returned with associated endpoint, but responses from the same endpoint are always
+         * returned in the order the commands were sent.
          *
          * Returns !OK on send/recv/parse failure, otherwise command-level errors are returned in
          * the response object itself.
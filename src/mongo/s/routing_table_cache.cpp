@@ -0,0 +1,262 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/s/routing_table_cache.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/s/type_chunk.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using mongoutils::str::stream;
+
+    RoutingTableCache routingTableCache;
+
+    namespace {
+
+        const char kNsField[] = "ns";
+        const char kEpochField[] = "epoch";
+        const char kNumChunksField[] = "numChunks";
+
+        // Chunk documents are at most a couple of shard keys, anything bigger is corruption
+        const int kMaxDocSize = BSONObjMaxInternalSize;
+
+        // Distinguishes concurrent writers of the same entry
+        AtomicUInt32 saveCounter;
+
+        bool writeDoc( std::ofstream& out, const BSONObj& doc ) {
+            out.write( doc.objdata(), doc.objsize() );
+            return out.good();
+        }
+    }
+
+    RoutingTableCache::RoutingTableCache()
+        : _minSaveIntervalMillis( DefaultMinSaveIntervalMillis ),
+          _mutex( "RoutingTableCache" ) {
+    }
+
+    Status RoutingTableCache::setDirectory( const string& dir ) {
+        {
+            scoped_lock lk( _mutex );
+            _lastSaved.clear();
+        }
+
+        if ( dir.empty() ) {
+            _dir.clear();
+            return Status::OK();
+        }
+
+        try {
+            boost::filesystem::create_directories( dir );
+        }
+        catch ( const boost::filesystem::filesystem_error& e ) {
+            return Status( ErrorCodes::FileNotOpen,
+                           stream() << "couldn't create routing table cache directory "
+                                         << dir << causedBy( e.what() ) );
+        }
+
+        if ( !boost::filesystem::is_directory( dir ) ) {
+            return Status( ErrorCodes::BadValue,
+                           stream() << "routing table cache path " << dir
+                                         << " is not a directory" );
+        }
+
+        _dir = dir;
+        return Status::OK();
+    }
+
+    bool RoutingTableCache::shouldSave( const string& ns, Date_t now ) {
+        if ( !isEnabled() ) return false;
+
+        scoped_lock lk( _mutex );
+
+        map<string, Date_t>::iterator it = _lastSaved.find( ns );
+        if ( it != _lastSaved.end() &&
+             now.millis < it->second.millis + _minSaveIntervalMillis ) {
+            return false;
+        }
+
+        _lastSaved[ns] = now;
+        return true;
+    }
+
+    string RoutingTableCache::pathFor( const string& ns ) const {
+        static const char hex[] = "0123456789abcdef";
+
+        StringBuilder fileName;
+        for ( size_t i = 0; i < ns.size(); i++ ) {
+            unsigned char c = ns[i];
+            if ( isalnum( c ) || c == '.' || c == '_' || c == '-' ) {
+                fileName << static_cast<char>( c );
+            }
+            else {
+                fileName << '%' << hex[c >> 4] << hex[c & 0xf];
+            }
+        }
+        fileName << ".bson";
+
+        return ( boost::filesystem::path( _dir ) / fileName.str() ).string();
+    }
+
+    bool RoutingTableCache::load( const string& ns,
+                                  const OID& epoch,
+                                  vector<BSONObj>* chunks ) const {
+        chunks->clear();
+        if ( !isEnabled() ) return false;
+
+        string path = pathFor( ns );
+        std::ifstream in( path.c_str(), std::ios::in | std::ios::binary );
+        if ( !in.is_open() ) return false;
+
+        vector<char> buf;
+        int numChunks = -1;
+        while ( numChunks < 0 || static_cast<int>( chunks->size() ) < numChunks ) {
+
+            int size = 0;
+            in.read( reinterpret_cast<char*>( &size ), sizeof( size ) );
+            if ( !in.good() || size < 5 || size > kMaxDocSize ) break;
+
+            buf.resize( size );
+            memcpy( &buf[0], &size, sizeof( size ) );
+            in.read( &buf[sizeof( size )], size - sizeof( size ) );
+            if ( !in.good() ) break;
+
+            BSONObj doc( &buf[0] );
+            if ( !doc.valid() ) break;
+
+            if ( numChunks < 0 ) {
+                // Header
+                if ( doc[kNsField].str() != ns ||
+                     doc[kEpochField].type() != jstOID ||
+                     doc[kEpochField].OID() != epoch ||
+                     !doc[kNumChunksField].isNumber() ) {
+                    LOG(1) << "routing table cache entry for " << ns << " is out of date: "
+                           << doc << endl;
+                    break;
+                }
+                numChunks = doc[kNumChunksField].numberInt();
+                chunks->reserve( numChunks );
+                continue;
+            }
+
+            if ( doc[ChunkType::ns()].str() != ns ) break;
+            chunks->push_back( doc.getOwned() );
+        }
+
+        if ( numChunks <= 0 || static_cast<int>( chunks->size() ) != numChunks ) {
+            if ( numChunks > 0 ) {
+                warning() << "ignoring truncated or corrupt routing table cache file "
+                          << path << endl;
+            }
+            chunks->clear();
+            return false;
+        }
+
+        return true;
+    }
+
+    Status RoutingTableCache::save( const string& ns,
+                                    const OID& epoch,
+                                    const vector<BSONObj>& chunks ) {
+        if ( !isEnabled() ) return Status::OK();
+
+        Status status = _write( ns, epoch, chunks );
+        if ( !status.isOK() ) {
+            // Don't hold off the retry for a whole save interval
+            scoped_lock lk( _mutex );
+            _lastSaved.erase( ns );
+        }
+
+        return status;
+    }
+
+    Status RoutingTableCache::_write( const string& ns,
+                                      const OID& epoch,
+                                      const vector<BSONObj>& chunks ) const {
+        string path = pathFor( ns );
+        string tmpPath = stream() << path << ".tmp." << saveCounter.fetchAndAdd( 1 );
+
+        {
+            std::ofstream out( tmpPath.c_str(),
+                               std::ios::out | std::ios::binary | std::ios::trunc );
+            if ( !out.is_open() ) {
+                return Status( ErrorCodes::FileNotOpen,
+                               stream() << "couldn't open " << tmpPath );
+            }
+
+            bool ok = writeDoc( out, BSON( kNsField << ns
+                                           << kEpochField << epoch
+                                           << kNumChunksField
+                                           << static_cast<int>( chunks.size() ) ) );
+
+            for ( vector<BSONObj>::const_iterator it = chunks.begin();
+                  ok && it != chunks.end(); ++it ) {
+                ok = writeDoc( out, *it );
+            }
+
+            out.close();
+            if ( !ok || out.fail() ) {
+                boost::filesystem::remove( tmpPath );
+                return Status( ErrorCodes::FileStreamFailed,
+                               stream() << "couldn't write " << tmpPath );
+            }
+        }
+
+        try {
+            boost::filesystem::rename( tmpPath, path );
+        }
+        catch ( const boost::filesystem::filesystem_error& e ) {
+            boost::system::error_code ec;
+            boost::filesystem::remove( tmpPath, ec );
+            return Status( ErrorCodes::FileStreamFailed,
+                           stream() << "couldn't rename " << tmpPath << " to " << path
+                                         << causedBy( e.what() ) );
+        }
+
+        return Status::OK();
+    }
+
+    void RoutingTableCache::remove( const string& ns ) {
+        if ( !isEnabled() ) return;
+
+        {
+            scoped_lock lk( _mutex );
+            _lastSaved.erase( ns );
+        }
+
+        boost::system::error_code ec;
+        boost::filesystem::remove( pathFor( ns ), ec );
+    }
+
+} // namespace mongo
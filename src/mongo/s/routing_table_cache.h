@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/bson/oid.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    /**
+     * Optional on-disk copy of the chunk metadata mongos has loaded from the config servers.
+     *
+     * Each sharded collection is stored in its own file in the cache directory, tagged with the
+     * collection epoch.  When a ChunkManager is built from scratch (e.g. at startup), it seeds
+     * its chunk map from the cached chunks of the same epoch and then only asks the config
+     * servers for chunks newer than the cached version, the same way a refresh does from an
+     * older ChunkManager.  The cache is never authoritative - a missing, corrupt or mismatched
+     * file just means a full load.
+     *
+     * File format is a header document { ns, epoch, numChunks } followed by numChunks chunk
+     * documents in config.chunks format, all written back-to-back as raw BSON.
+     *
+     * Rewriting an entry costs a pass over every chunk of the collection, so writers are
+     * expected to ask shouldSave() first - an entry is rewritten at most once per save interval.
+     */
+    class RoutingTableCache {
+        MONGO_DISALLOW_COPYING(RoutingTableCache);
+    public:
+
+        static const long long DefaultMinSaveIntervalMillis = 30 * 1000;
+
+        RoutingTableCache();
+
+        /**
+         * Sets the directory the cache lives in, creating it if needed.  An empty path disables
+         * the cache.  Only meant to be called at startup.
+         */
+        Status setDirectory( const std::string& dir );
+
+        bool isEnabled() const { return !_dir.empty(); }
+
+        void setMinSaveIntervalMillis( long long millis ) { _minSaveIntervalMillis = millis; }
+
+        /**
+         * Returns true if the entry of ns hasn't been written in the last save interval, and
+         * if so counts now as its last write, unless the save() that follows fails.  A skipped
+         * save only leaves the entry behind; loads seeded from it fetch the newer chunks from
+         * the config servers.
+         */
+        bool shouldSave( const std::string& ns, Date_t now );
+
+        /**
+         * Reads the cached chunk documents of ns into chunks.
+         *
+         * Returns false if there is no usable cache entry for ns with the given epoch, in which
+         * case chunks is left empty.
+         */
+        bool load( const std::string& ns,
+                   const OID& epoch,
+                   std::vector<BSONObj>* chunks ) const;
+
+        /**
+         * Replaces the cache entry of ns with the given chunk documents.  The new file is
+         * written aside and renamed into place, so readers never see a partial entry.  If the
+         * write fails, the next save of ns isn't throttled.
+         */
+        Status save( const std::string& ns,
+                     const OID& epoch,
+                     const std::vector<BSONObj>& chunks );
+
+        /**
+         * Drops the cache entry of ns, if any.  The next save of ns isn't throttled.
+         */
+        void remove( const std::string& ns );
+
+        /**
+         * Path of the cache file for ns - namespaces are escaped so they're safe as file names.
+         */
+        std::string pathFor( const std::string& ns ) const;
+
+    private:
+        Status _write( const std::string& ns,
+                       const OID& epoch,
+                       const std::vector<BSONObj>& chunks ) const;
+
+        std::string _dir;
+        long long _minSaveIntervalMillis;
+
+        // protects _lastSaved
+        mongo::mutex _mutex;
+        std::map<std::string, Date_t> _lastSaved;
+    };
+
+    // The cache used by mongos ChunkManagers, set up from --routingTableCacheDir
+    extern RoutingTableCache routingTableCache;
+
+} // namespace mongo
@@ -0,0 +1,215 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+
+#include "mongo/s/routing_table_cache.h"
+#include "mongo/s/type_chunk.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::ChunkType;
+    using mongo::Date_t;
+    using mongo::OID;
+    using mongo::RoutingTableCache;
+    using mongo::unittest::TempDir;
+    using std::string;
+    using std::vector;
+
+    const string kNs = "foo.bar";
+
+    vector<BSONObj> makeChunks( const OID& epoch, int numChunks ) {
+        vector<BSONObj> chunks;
+        for ( int i = 0; i < numChunks; i++ ) {
+            BSONObjBuilder b;
+            b.append( ChunkType::ns(), kNs );
+            b.append( ChunkType::min(), BSON( "a" << i ) );
+            b.append( ChunkType::max(), BSON( "a" << i + 1 ) );
+            b.append( ChunkType::shard(), i % 2 ? "shard0000" : "shard0001" );
+            b.appendTimestamp( ChunkType::DEPRECATED_lastmod(), ( 1ULL << 32 ) + i );
+            b.append( ChunkType::DEPRECATED_epoch(), epoch );
+            chunks.push_back( b.obj() );
+        }
+        return chunks;
+    }
+
+    TEST(RoutingTableCacheTests, DisabledByDefault) {
+        RoutingTableCache cache;
+        ASSERT_FALSE( cache.isEnabled() );
+
+        OID epoch = OID::gen();
+        ASSERT_OK( cache.save( kNs, epoch, makeChunks( epoch, 2 ) ) );
+
+        vector<BSONObj> loaded;
+        ASSERT_FALSE( cache.load( kNs, epoch, &loaded ) );
+        ASSERT( loaded.empty() );
+    }
+
+    TEST(RoutingTableCacheTests, RoundTrip) {
+        TempDir dir( "routing_table_cache_test" );
+        RoutingTableCache cache;
+        ASSERT_OK( cache.setDirectory( dir.path() ) );
+        ASSERT( cache.isEnabled() );
+
+        OID epoch = OID::gen();
+        vector<BSONObj> chunks = makeChunks( epoch, 100 );
+        ASSERT_OK( cache.save( kNs, epoch, chunks ) );
+
+        vector<BSONObj> loaded;
+        ASSERT( cache.load( kNs, epoch, &loaded ) );
+        ASSERT_EQUALS( chunks.size(), loaded.size() );
+        for ( size_t i = 0; i < chunks.size(); i++ ) {
+            ASSERT_EQUALS( chunks[i], loaded[i] );
+        }
+
+        // Saving again replaces the entry
+        chunks = makeChunks( epoch, 3 );
+        ASSERT_OK( cache.save( kNs, epoch, chunks ) );
+        ASSERT( cache.load( kNs, epoch, &loaded ) );
+        ASSERT_EQUALS( 3U, loaded.size() );
+    }
+
+    TEST(RoutingTableCacheTests, EpochMismatchIsMiss) {
+        TempDir dir( "routing_table_cache_test" );
+        RoutingTableCache cache;
+        ASSERT_OK( cache.setDirectory( dir.path() ) );
+
+        OID epoch = OID::gen();
+        ASSERT_OK( cache.save( kNs, epoch, makeChunks( epoch, 5 ) ) );
+
+        vector<BSONObj> loaded;
+        ASSERT_FALSE( cache.load( kNs, OID::gen(), &loaded ) );
+        ASSERT( loaded.empty() );
+        ASSERT_FALSE( cache.load( "foo.baz", epoch, &loaded ) );
+    }
+
+    TEST(RoutingTableCacheTests, TruncatedFileIsMiss) {
+        TempDir dir( "routing_table_cache_test" );
+        RoutingTableCache cache;
+        ASSERT_OK( cache.setDirectory( dir.path() ) );
+
+        OID epoch = OID::gen();
+        ASSERT_OK( cache.save( kNs, epoch, makeChunks( epoch, 10 ) ) );
+
+        string path = cache.pathFor( kNs );
+        boost::uintmax_t size = boost::filesystem::file_size( path );
+        boost::filesystem::resize_file( path, size - 10 );
+
+        vector<BSONObj> loaded;
+        ASSERT_FALSE( cache.load( kNs, epoch, &loaded ) );
+        ASSERT( loaded.empty() );
+    }
+
+    TEST(RoutingTableCacheTests, GarbageFileIsMiss) {
+        TempDir dir( "routing_table_cache_test" );
+        RoutingTableCache cache;
+        ASSERT_OK( cache.setDirectory( dir.path() ) );
+
+        string path = cache.pathFor( kNs );
+        {
+            std::ofstream out( path.c_str(), std::ios::out | std::ios::binary );
+            out << "this is not bson at all";
+        }
+
+        vector<BSONObj> loaded;
+        ASSERT_FALSE( cache.load( kNs, OID::gen(), &loaded ) );
+    }
+
+    TEST(RoutingTableCacheTests, Remove) {
+        TempDir dir( "routing_table_cache_test" );
+        RoutingTableCache cache;
+        ASSERT_OK( cache.setDirectory( dir.path() ) );
+
+        OID epoch = OID::gen();
+        ASSERT_OK( cache.save( kNs, epoch, makeChunks( epoch, 1 ) ) );
+        cache.remove( kNs );
+
+        vector<BSONObj> loaded;
+        ASSERT_FALSE( cache.load( kNs, epoch, &loaded ) );
+
+        // Removing a missing entry is fine
+        cache.remove( kNs );
+    }
+
+    TEST(RoutingTableCacheTests, SavesAreThrottled) {
+        TempDir dir( "routing_table_cache_test" );
+        RoutingTableCache cache;
+        ASSERT_FALSE( cache.shouldSave( kNs, Date_t( 1000 ) ) );
+
+        ASSERT_OK( cache.setDirectory( dir.path() ) );
+        cache.setMinSaveIntervalMillis( 100 );
+
+        ASSERT( cache.shouldSave( kNs, Date_t( 1000 ) ) );
+        ASSERT_FALSE( cache.shouldSave( kNs, Date_t( 1050 ) ) );
+        ASSERT_FALSE( cache.shouldSave( kNs, Date_t( 1099 ) ) );
+        ASSERT( cache.shouldSave( kNs, Date_t( 1100 ) ) );
+
+        // Namespaces are throttled separately
+        ASSERT( cache.shouldSave( "foo.baz", Date_t( 1100 ) ) );
+
+        // Dropping an entry means the next save goes through
+        cache.remove( kNs );
+        ASSERT( cache.shouldSave( kNs, Date_t( 1101 ) ) );
+        ASSERT_FALSE( cache.shouldSave( kNs, Date_t( 1102 ) ) );
+    }
+
+    TEST(RoutingTableCacheTests, FailedSaveIsNotThrottled) {
+        TempDir dir( "routing_table_cache_test" );
+        RoutingTableCache cache;
+        ASSERT_OK( cache.setDirectory( dir.path() ) );
+        cache.setMinSaveIntervalMillis( 100 );
+
+        // A directory in the way of the entry makes the rename fail
+        boost::filesystem::create_directory( cache.pathFor( kNs ) );
+
+        OID epoch = OID::gen();
+        ASSERT( cache.shouldSave( kNs, Date_t( 1000 ) ) );
+        ASSERT_NOT_OK( cache.save( kNs, epoch, makeChunks( epoch, 2 ) ) );
+        ASSERT( cache.shouldSave( kNs, Date_t( 1001 ) ) );
+
+        boost::filesystem::remove( cache.pathFor( kNs ) );
+        ASSERT_OK( cache.save( kNs, epoch, makeChunks( epoch, 2 ) ) );
+        ASSERT_FALSE( cache.shouldSave( kNs, Date_t( 1002 ) ) );
+    }
+
+    TEST(RoutingTableCacheTests, PathEscapesNamespace) {
+        TempDir dir( "routing_table_cache_test" );
+        RoutingTableCache cache;
+        ASSERT_OK( cache.setDirectory( dir.path() ) );
+
+        string path = cache.pathFor( "foo.a/b c" );
+        ASSERT_EQUALS( dir.path(), boost::filesystem::path( path ).parent_path().string() );
+        ASSERT_EQUALS( "foo.a%2fb%20c.bson", boost::filesystem::path( path ).filename().string() );
+    }
+
+} // namespace
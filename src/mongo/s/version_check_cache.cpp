@@ -0,0 +1,78 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/s/version_check_cache.h"
+
+namespace mongo {
+
+    const size_t VersionCheckCache::MaxConnections;
+
+    boost::thread_specific_ptr<VersionCheckCache> VersionCheckCache::_perThread;
+
+    VersionCheckCache* VersionCheckCache::get() {
+        VersionCheckCache* cache = _perThread.get();
+        if ( ! cache ) {
+            cache = new VersionCheckCache();
+            _perThread.reset( cache );
+        }
+        return cache;
+    }
+
+    bool VersionCheckCache::isUpToDate( long long connectionId,
+                                        const std::string& ns,
+                                        unsigned long long generation,
+                                        unsigned long long sequenceNumber ) const {
+        ConnectionMap::const_iterator i = _connections.find( connectionId );
+        if ( i == _connections.end() ) return false;
+        NSMap::const_iterator j = i->second.find( ns );
+        if ( j == i->second.end() ) return false;
+
+        const Entry& entry = j->second;
+        return entry.generation == generation &&
+               ( sequenceNumber == 0 || sequenceNumber == entry.sequenceNumber );
+    }
+
+    void VersionCheckCache::noteUpToDate( long long connectionId,
+                                          const std::string& ns,
+                                          unsigned long long generation,
+                                          unsigned long long sequenceNumber ) {
+        if ( _connections.size() >= MaxConnections &&
+             _connections.find( connectionId ) == _connections.end() ) {
+            _connections.clear();
+        }
+
+        Entry& entry = _connections[connectionId][ns];
+        entry.generation = generation;
+        entry.sequenceNumber = sequenceNumber;
+    }
+
+    void VersionCheckCache::reset( long long connectionId ) {
+        _connections.erase( connectionId );
+    }
+
+} // namespace mongo
@@ -0,0 +1,97 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/tss.hpp>
+#include <map>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+    /**
+     * Per-thread memo of the connections whose version for a namespace was last found up to
+     * date by checkShardVersion, along with the routing generation and ChunkManager sequence
+     * number at the time.
+     *
+     * A connection is only used by one thread at a time, its version is only changed after a
+     * routing change or a reset (after which the connection is thrown away), and connection ids
+     * are never reused.  So while the routing generation hasn't moved, a hit here means
+     * checkShardVersion would find nothing to do, and can skip its locking and lookups.
+     */
+    class VersionCheckCache {
+        MONGO_DISALLOW_COPYING(VersionCheckCache);
+    public:
+
+        // Entries of connections which were closed elsewhere are never looked up again, so the
+        // cache just starts over once it holds this many connections
+        static const size_t MaxConnections = 1000;
+
+        VersionCheckCache() { }
+
+        /**
+         * The cache of the current thread.
+         */
+        static VersionCheckCache* get();
+
+        /**
+         * @return true if the version of ns on the connection was found up to date at routing
+         * generation 'generation', against the ChunkManager with sequence number
+         * 'sequenceNumber' - or against any manager if sequenceNumber is 0.
+         */
+        bool isUpToDate( long long connectionId,
+                         const std::string& ns,
+                         unsigned long long generation,
+                         unsigned long long sequenceNumber ) const;
+
+        void noteUpToDate( long long connectionId,
+                           const std::string& ns,
+                           unsigned long long generation,
+                           unsigned long long sequenceNumber );
+
+        void reset( long long connectionId );
+
+        size_t numConnections() const { return _connections.size(); }
+
+    private:
+        struct Entry {
+            Entry() : generation( 0 ), sequenceNumber( 0 ) {}
+            unsigned long long generation;
+            unsigned long long sequenceNumber;
+        };
+
+        typedef std::map<std::string,Entry> NSMap;
+        typedef std::map<long long,NSMap> ConnectionMap;
+        ConnectionMap _connections;
+
+        static boost::thread_specific_ptr<VersionCheckCache> _perThread;
+    };
+
+} // namespace mongo
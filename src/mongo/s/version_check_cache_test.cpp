@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/s/version_check_cache.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using mongo::VersionCheckCache;
+    using std::string;
+
+    const string kNs = "foo.bar";
+
+    TEST(VersionCheckCacheTests, HitWhileNothingChanged) {
+        VersionCheckCache cache;
+        ASSERT_FALSE( cache.isUpToDate( 1, kNs, 5, 0 ) );
+
+        cache.noteUpToDate( 1, kNs, 5, 7 );
+        ASSERT( cache.isUpToDate( 1, kNs, 5, 0 ) );
+        ASSERT( cache.isUpToDate( 1, kNs, 5, 7 ) );
+
+        // Other connections and namespaces were never checked
+        ASSERT_FALSE( cache.isUpToDate( 2, kNs, 5, 0 ) );
+        ASSERT_FALSE( cache.isUpToDate( 1, "foo.baz", 5, 0 ) );
+    }
+
+    TEST(VersionCheckCacheTests, RoutingChangeIsMiss) {
+        VersionCheckCache cache;
+        cache.noteUpToDate( 1, kNs, 5, 7 );
+        ASSERT_FALSE( cache.isUpToDate( 1, kNs, 6, 0 ) );
+
+        // Checking again at the new generation is a hit from then on
+        cache.noteUpToDate( 1, kNs, 6, 7 );
+        ASSERT( cache.isUpToDate( 1, kNs, 6, 7 ) );
+        ASSERT_FALSE( cache.isUpToDate( 1, kNs, 5, 7 ) );
+    }
+
+    TEST(VersionCheckCacheTests, DifferentManagerIsMiss) {
+        VersionCheckCache cache;
+        cache.noteUpToDate( 1, kNs, 5, 7 );
+        ASSERT_FALSE( cache.isUpToDate( 1, kNs, 5, 8 ) );
+    }
+
+    TEST(VersionCheckCacheTests, ResetIsMiss) {
+        VersionCheckCache cache;
+        cache.noteUpToDate( 1, kNs, 5, 7 );
+        cache.noteUpToDate( 1, "foo.baz", 5, 8 );
+        cache.noteUpToDate( 2, kNs, 5, 7 );
+
+        cache.reset( 1 );
+        ASSERT_FALSE( cache.isUpToDate( 1, kNs, 5, 7 ) );
+        ASSERT_FALSE( cache.isUpToDate( 1, "foo.baz", 5, 8 ) );
+        ASSERT( cache.isUpToDate( 2, kNs, 5, 7 ) );
+    }
+
+    TEST(VersionCheckCacheTests, StartsOverWhenFull) {
+        VersionCheckCache cache;
+        for ( size_t i = 0; i < VersionCheckCache::MaxConnections; i++ ) {
+            cache.noteUpToDate( i, kNs, 5, 7 );
+        }
+        ASSERT_EQUALS( VersionCheckCache::MaxConnections, cache.numConnections() );
+
+        // Known connections don't count against the limit
+        cache.noteUpToDate( 0, "foo.baz", 5, 7 );
+        ASSERT_EQUALS( VersionCheckCache::MaxConnections, cache.numConnections() );
+
+        cache.noteUpToDate( VersionCheckCache::MaxConnections, kNs, 5, 7 );
+        ASSERT_EQUALS( 1U, cache.numConnections() );
+        ASSERT_FALSE( cache.isUpToDate( 0, kNs, 5, 7 ) );
+        ASSERT( cache.isUpToDate( VersionCheckCache::MaxConnections, kNs, 5, 7 ) );
+    }
+
+    void checkOtherThread( bool* hit ) {
+        *hit = VersionCheckCache::get()->isUpToDate( 1, kNs, 5, 7 );
+    }
+
+    TEST(VersionCheckCacheTests, PerThread) {
+        VersionCheckCache::get()->noteUpToDate( 1, kNs, 5, 7 );
+        ASSERT( VersionCheckCache::get()->isUpToDate( 1, kNs, 5, 7 ) );
+
+        bool hit = true;
+        boost::thread other( checkOtherThread, &hit );
+        other.join();
+        ASSERT_FALSE( hit );
+
+        VersionCheckCache::get()->reset( 1 );
+    }
+
+} // namespace
@@ -36,6 +36,7 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/shard.h"
 #include "mongo/s/stale_exception.h" // for SendStaleConfigException
+#include "mongo/s/version_check_cache.h"
 #include "mongo/s/writeback_listener.h"
 
 namespace mongo {
@@ -76,6 +77,7 @@ namespace mongo {
     } connectionShardStatus;
 
     void VersionManager::resetShardVersionCB( DBClientBase * conn ) {
+        VersionCheckCache::get()->reset( conn->getConnectionId() );
         connectionShardStatus.reset( conn );
     }
 
@@ -176,7 +178,22 @@ namespace mongo {
      * @return true if had to do something
      */
     bool checkShardVersion( DBClientBase * conn_in , const string& ns , ChunkManagerPtr refManager, bool authoritative , int tryNumber ) {
-        // TODO: cache, optimize, etc...
+
+        // Must be read before any of the routing metadata used below
+        const unsigned long long generation = grid.getRoutingGeneration();
+
+        if ( ! authoritative ) {
+            // Fast path - nothing has changed since this connection was last found up to date.
+            // A reference manager with the sequence number we saw then is the current manager.
+            DBClientBase* conn = getVersionable( conn_in );
+            verify( conn ); // errors thrown above
+
+            if ( VersionCheckCache::get()->isUpToDate( conn->getConnectionId(), ns, generation,
+                                                       refManager ?
+                                                           refManager->getSequenceNumber() : 0 ) ) {
+                return false;
+            }
+        }
 
         WriteBackListener::init( *conn_in );
 
@@ -227,6 +244,8 @@ namespace mongo {
         // (ie., last time we issued the setShardVersions below)
         unsigned long long sequenceNumber = connectionShardStatus.getSequence(conn,ns);
         if ( sequenceNumber == officialSequenceNumber ) {
+            VersionCheckCache::get()->noteUpToDate( conn->getConnectionId(), ns, generation,
+                                                    officialSequenceNumber );
             return false;
         }
 
@@ -256,6 +275,8 @@ namespace mongo {
             // success!
             LOG(1) << "      setShardVersion success: " << result << endl;
             connectionShardStatus.setSequence( conn , ns , officialSequenceNumber );
+            VersionCheckCache::get()->noteUpToDate( conn->getConnectionId(), ns, generation,
+                                                    officialSequenceNumber );
             return true;
         }
 
@@ -33,6 +33,7 @@
 #include "mongo/client/dbclientinterface.h" // ConnectionString (header-only)
 #include "mongo/s/write_ops/batch_write_op.h"
 #include "mongo/s/write_ops/batched_error_detail.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -45,12 +46,30 @@ namespace mongo {
             }
         };
 
+        // A child batch out on the network, and how long it has been there
+        struct InFlightBatch {
+
+            explicit InFlightBatch( TargetedWriteBatch* batch ) :
+                batch( batch ) {
+            }
+
+            TargetedWriteBatch* batch;
+            Timer sendTimer;
+        };
+
+        // The child batches for a single host.  The dispatcher returns responses from a host in
+        // the order they were sent, so both are simple queues.
+        struct HostBatches {
+            deque<TargetedWriteBatch*> queued;
+            deque<InFlightBatch> inFlight;
+        };
+
         //
         // Map which allows associating ConnectionString hosts with TargetedWriteBatches
         // This is needed since the dispatcher only returns hosts with responses.
         //
         // TODO: Unordered map?
-        typedef map<ConnectionString, TargetedWriteBatch*, ConnectionStringComp> HostBatchMap;
+        typedef map<ConnectionString, HostBatches, ConnectionStringComp> HostBatchMap;
     }
 
     static void buildErrorFrom( const Status& status, BatchedErrorDetail* error ) {
@@ -67,96 +86,105 @@ namespace mongo {
         }
     }
 
+    void BatchWriteExecStats::noteBatchLatency( const ConnectionString& host, int millis ) {
+        HostWriteStats& stats = hostStats[host.toString()];
+        ++stats.numBatches;
+        stats.totalMillis += millis;
+        if ( millis > stats.maxMillis ) stats.maxMillis = millis;
+    }
+
     void BatchWriteExec::executeBatch( const BatchedCommandRequest& clientRequest,
                                        BatchedCommandResponse* clientResponse ) {
 
         BatchWriteOp batchOp;
         batchOp.initClientRequest( &clientRequest );
 
-        int numTargetErrors = 0;
-        int numStaleBatches = 0;
-        int numResolveFailures = 0;
+        // Split the writes for each host up so they can be pipelined (see header)
+        if ( !clientRequest.getOrdered() ) batchOp.setMaxWritesPerBatch( _maxWritesPerChildBatch );
 
-        for ( int rounds = 0; !batchOp.isFinished(); rounds++ ) {
+        HostBatchMap hostBatches;
+        int numInFlight = 0;
 
-            //
-            // Refresh the targeter if we need to (no-op if nothing stale)
-            //
+        //
+        // Write ops are targeted in rounds.  A new round starts once everything outstanding has
+        // come back, or - for unordered batches - as soon as a host reports stale ops, so they
+        // can be retried without waiting on the slowest host.  Ordered batches only ever have
+        // one child batch outstanding, since each op depends on the result of the last.
+        //
 
-            Status refreshStatus = _targeter->refreshIfNeeded();
+        bool needsTargeting = true;
 
-            if ( !refreshStatus.isOK() ) {
+        while ( numInFlight > 0 || !batchOp.isFinished() ) {
 
-                // It's okay if we can't refresh, we'll just record errors for the ops if
-                // needed.
-                warning() << "could not refresh targeter" << causedBy( refreshStatus.reason() )
-                          << endl;
-            }
+            if ( needsTargeting && !batchOp.isFinished() ) {
 
-            //
-            // Get child batches to send
-            //
+                needsTargeting = false;
+                ++_stats.numRounds;
+
+                //
+                // Refresh the targeter if we need to (no-op if nothing stale)
+                //
 
-            vector<TargetedWriteBatch*> childBatches;
+                Status refreshStatus = _targeter->refreshIfNeeded();
 
-            //
-            // Targeting errors can be caused by remote metadata changing (the collection could have
-            // been dropped and recreated, for example with a new shard key).  If a remote metadata
-            // change occurs *before* a client sends us a batch, we need to make sure that we don't
-            // error out just because we're staler than the client - otherwise mongos will be have
-            // unpredictable behavior.
-            //
-            // (If a metadata change happens *during* or *after* a client sends us a batch, however,
-            // we make no guarantees about delivery.)
-            //
-            // For this reason, we don't record targeting errors until we've refreshed our targeting
-            // metadata at least once *after* receiving the client batch - at that point, we know:
-            //
-            // 1) our new metadata is the same as the metadata when the client sent a batch, and so
-            //    targeting errors are real.
-            // OR
-            // 2) our new metadata is a newer version than when the client sent a batch, and so
-            //    the metadata must have changed after the client batch was sent.  We don't need to
-            //    deliver in this case, since for all the client knows we may have gotten the batch
-            //    exactly when the metadata changed.
-            //
-            // If we've had a targeting error or stale error, we've refreshed the metadata once and
-            // can record target errors.
-            bool recordTargetErrors = numTargetErrors > 0 || numStaleBatches > 0;
-            Status targetStatus = batchOp.targetBatch( *_targeter,
-                                                       recordTargetErrors,
-                                                       &childBatches );
-            if ( !targetStatus.isOK() ) {
-                _targeter->noteCouldNotTarget();
-                ++numTargetErrors;
-                continue;
-            }
+                if ( !refreshStatus.isOK() ) {
 
-            //
-            // Send all child batches
-            //
+                    // It's okay if we can't refresh, we'll just record errors for the ops if
+                    // needed.
+                    warning() << "could not refresh targeter" << causedBy( refreshStatus.reason() )
+                              << endl;
+                }
 
-            size_t numSent = 0;
-            while ( numSent != childBatches.size() ) {
+                //
+                // Get child batches to send
+                //
 
-                // Collect batches out on the network, mapped by endpoint
-                HostBatchMap pendingBatches;
+                vector<TargetedWriteBatch*> childBatches;
 
                 //
-                // Send side
+                // Targeting errors can be caused by remote metadata changing (the collection could
+                // have been dropped and recreated, for example with a new shard key).  If a remote
+                // metadata change occurs *before* a client sends us a batch, we need to make sure
+                // that we don't error out just because we're staler than the client - otherwise
+                // mongos will be have unpredictable behavior.
+                //
+                // (If a metadata change happens *during* or *after* a client sends us a batch,
+                // however, we make no guarantees about delivery.)
+                //
+                // For this reason, we don't record targeting errors until we've refreshed our
+                // targeting metadata at least once *after* receiving the client batch - at that
+                // point, we know:
+                //
+                // 1) our new metadata is the same as the metadata when the client sent a batch,
+                //    and so targeting errors are real.
+                // OR
+                // 2) our new metadata is a newer version than when the client sent a batch, and so
+                //    the metadata must have changed after the client batch was sent.  We don't need
+                //    to deliver in this case, since for all the client knows we may have gotten the
+                //    batch exactly when the metadata changed.
+                //
+                // If we've had a targeting error or stale error, we've refreshed the metadata once
+                // and can record target errors.
+                bool recordTargetErrors = _stats.numTargetErrors > 0
+                                          || _stats.numStaleBatches > 0;
+                Status targetStatus = batchOp.targetBatch( *_targeter,
+                                                           recordTargetErrors,
+                                                           &childBatches );
+                if ( !targetStatus.isOK() ) {
+                    _targeter->noteCouldNotTarget();
+                    ++_stats.numTargetErrors;
+                    needsTargeting = true;
+                    continue;
+                }
+
+                //
+                // Queue the child batches by host
                 //
 
-                // Get as many batches as we can at once
                 for ( vector<TargetedWriteBatch*>::iterator it = childBatches.begin();
                     it != childBatches.end(); ++it ) {
 
-                    //
-                    // Collect the info needed to dispatch our targeted batch
-                    //
-
                     TargetedWriteBatch* nextBatch = *it;
-                    // If the batch is NULL, we sent it previously, so skip
-                    if ( nextBatch == NULL ) continue;
 
                     // Figure out what host we need to dispatch our targeted batch
                     ConnectionString shardHost;
@@ -165,27 +193,40 @@ namespace mongo {
                                                                        &shardHost );
                     if ( !resolveStatus.isOK() ) {
 
-                        ++numResolveFailures;
+                        ++_stats.numResolveErrors;
 
                         // Record a resolve failure
                         // TODO: It may be necessary to refresh the cache if stale, or maybe just
                         // cancel and retarget the batch
+                        scoped_ptr<TargetedWriteBatch> batch( nextBatch );
                         BatchedErrorDetail error;
                         buildErrorFrom( resolveStatus, &error );
-                        batchOp.noteBatchError( *nextBatch, error );
-
-                        // We're done with this batch
-                        *it = NULL;
+                        batchOp.noteBatchError( *batch, error );
                         continue;
                     }
 
-                    // If we already have a batch for this host, wait until the next time
-                    HostBatchMap::iterator pendingIt = pendingBatches.find( shardHost );
-                    if ( pendingIt != pendingBatches.end() ) continue;
+                    // We get several batches for the same host if its writes didn't fit in one
+                    // child batch, if we have broadcast and non-broadcast endpoints for the host,
+                    // or if we retargeted while the host still had batches outstanding.
+                    hostBatches[shardHost].queued.push_back( nextBatch );
+                }
+            }
 
-                    //
-                    // We now have all the info needed to dispatch the batch
-                    //
+            //
+            // Send side
+            //
+
+            // Top up each host with as many batches as its window allows
+            for ( HostBatchMap::iterator it = hostBatches.begin(); it != hostBatches.end(); ++it ) {
+
+                const ConnectionString& shardHost = it->first;
+                HostBatches& batches = it->second;
+
+                while ( !batches.queued.empty()
+                        && static_cast<int>( batches.inFlight.size() ) < _maxInFlightPerHost ) {
+
+                    TargetedWriteBatch* nextBatch = batches.queued.front();
+                    batches.queued.pop_front();
 
                     BatchedCommandRequest request( clientRequest.getBatchType() );
                     batchOp.buildBatchRequest( *nextBatch, &request );
@@ -197,62 +238,70 @@ namespace mongo {
 
                     _dispatcher->addCommand( shardHost, nss.db(), request );
 
-                    // Indicate we're done by setting the batch to NULL
-                    // We'll only get duplicate hostEndpoints if we have broadcast and non-broadcast
-                    // endpoints for the same host, so this should be pretty efficient without
-                    // moving stuff around.
-                    *it = NULL;
-
                     // Recv-side is responsible for cleaning up the nextBatch when used
-                    pendingBatches.insert( make_pair( shardHost, nextBatch ) );
+                    batches.inFlight.push_back( InFlightBatch( nextBatch ) );
+                    ++numInFlight;
                 }
+            }
 
-                // Send them all out
-                _dispatcher->sendAll();
-                numSent += pendingBatches.size();
+            // Send them all out
+            _dispatcher->sendAll();
 
-                //
-                // Recv side
-                //
+            if ( numInFlight == 0 ) {
+                // Nothing outstanding, so the round is over
+                needsTargeting = true;
+                continue;
+            }
 
-                while ( _dispatcher->numPending() > 0 ) {
+            //
+            // Recv side
+            //
 
-                    // Get the response
-                    ConnectionString shardHost;
-                    BatchedCommandResponse response;
-                    Status dispatchStatus = _dispatcher->recvAny( &shardHost, &response );
+            // Get the response
+            ConnectionString shardHost;
+            BatchedCommandResponse response;
+            Status dispatchStatus = _dispatcher->recvAny( &shardHost, &response );
 
-                    // Get the TargetedWriteBatch to find where to put the response
-                    dassert( pendingBatches.find( shardHost ) != pendingBatches.end() );
-                    TargetedWriteBatch* batchRaw = pendingBatches.find( shardHost )->second;
-                    scoped_ptr<TargetedWriteBatch> batch( batchRaw );
+            // Get the TargetedWriteBatch to find where to put the response
+            HostBatchMap::iterator hostIt = hostBatches.find( shardHost );
+            dassert( hostIt != hostBatches.end() && !hostIt->second.inFlight.empty() );
+            InFlightBatch& inFlight = hostIt->second.inFlight.front();
 
-                    if ( dispatchStatus.isOK() ) {
+            scoped_ptr<TargetedWriteBatch> batch( inFlight.batch );
+            _stats.noteBatchLatency( shardHost, inFlight.sendTimer.millis() );
 
-                        TrackedErrors trackedErrors;
-                        trackedErrors.startTracking( ErrorCodes::StaleShardVersion );
+            hostIt->second.inFlight.pop_front();
+            --numInFlight;
 
-                        // Dispatch was ok, note response
-                        batchOp.noteBatchResponse( *batch, response, &trackedErrors );
+            if ( dispatchStatus.isOK() ) {
 
-                        // Note if anything was stale
-                        const vector<ShardError*>& staleErrors =
-                            trackedErrors.getErrors( ErrorCodes::StaleShardVersion );
+                TrackedErrors trackedErrors;
+                trackedErrors.startTracking( ErrorCodes::StaleShardVersion );
 
-                        if ( staleErrors.size() > 0 ) {
-                            noteStaleResponses( staleErrors, _targeter );
-                            ++numStaleBatches;
-                        }
-                    }
-                    else {
+                // Dispatch was ok, note response
+                batchOp.noteBatchResponse( *batch, response, &trackedErrors );
 
-                        // Error occurred dispatching, note it
-                        BatchedErrorDetail error;
-                        buildErrorFrom( dispatchStatus, &error );
-                        batchOp.noteBatchError( *batch, error );
-                    }
+                // Note if anything was stale
+                const vector<ShardError*>& staleErrors =
+                    trackedErrors.getErrors( ErrorCodes::StaleShardVersion );
+
+                if ( staleErrors.size() > 0 ) {
+                    noteStaleResponses( staleErrors, _targeter );
+                    ++_stats.numStaleBatches;
+
+                    // Retry the stale ops now rather than waiting on the other hosts
+                    if ( !clientRequest.getOrdered() ) needsTargeting = true;
                 }
             }
+            else {
+
+                // Error occurred dispatching, note it
+                BatchedErrorDetail error;
+                buildErrorFrom( dispatchStatus, &error );
+                batchOp.noteBatchError( *batch, error );
+            }
+
+            if ( numInFlight == 0 ) needsTargeting = true;
         }
 
         batchOp.buildClientResponse( clientResponse );
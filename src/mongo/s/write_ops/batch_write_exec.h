@@ -29,6 +29,8 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <map>
+#include <string>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/s/ns_targeter.h"
@@ -39,6 +41,39 @@
 
 namespace mongo {
 
+    /**
+     * Round-trip latency of the child batches sent to a single host.
+     */
+    struct HostWriteStats {
+
+        HostWriteStats() :
+            numBatches( 0 ), totalMillis( 0 ), maxMillis( 0 ) {
+        }
+
+        int numBatches;
+        long long totalMillis;
+        int maxMillis;
+    };
+
+    /**
+     * Stats for the execution of a single client batch write, keyed by host connection string.
+     */
+    struct BatchWriteExecStats {
+
+        BatchWriteExecStats() :
+            numRounds( 0 ), numTargetErrors( 0 ), numResolveErrors( 0 ), numStaleBatches( 0 ) {
+        }
+
+        void noteBatchLatency( const ConnectionString& host, int millis );
+
+        std::map<std::string, HostWriteStats> hostStats;
+
+        int numRounds;
+        int numTargetErrors;
+        int numResolveErrors;
+        int numStaleBatches;
+    };
+
     /**
      * The BatchWriteExec is able to execute client batch write requests, resulting in a batch
      * response to send back to the client.
@@ -53,6 +88,12 @@ namespace mongo {
      * Both the targeter and dispatcher are assumed to be dedicated to this particular
      * BatchWriteExec instance.
      *
+     * Child batches are pipelined per host - as soon as a host responds to one batch, the next
+     * batch queued for that host is sent, without waiting on the other hosts.  At most
+     * maxInFlightPerHost batches are outstanding to any single host.  A host only has several
+     * batches queued if the writes for it are split up, so unordered writes are sent in child
+     * batches of at most maxWritesPerChildBatch writes.
+     *
      */
     class BatchWriteExec {
     MONGO_DISALLOW_COPYING (BatchWriteExec);
@@ -61,9 +102,16 @@ namespace mongo {
         BatchWriteExec( NSTargeter* targeter,
                         ShardResolver* resolver,
                         MultiCommandDispatch* dispatcher ) :
-            _targeter( targeter ), _resolver( resolver ), _dispatcher( dispatcher ) {
+            _targeter( targeter ),
+            _resolver( resolver ),
+            _dispatcher( dispatcher ),
+            _maxInFlightPerHost( DefaultMaxInFlightPerHost ),
+            _maxWritesPerChildBatch( DefaultMaxWritesPerChildBatch ) {
         }
 
+        static const int DefaultMaxInFlightPerHost = 2;
+        static const int DefaultMaxWritesPerChildBatch = 100;
+
         /**
          * Executes a client batch write request by sending child batches to several shard
          * endpoints, and returns a client batch write response.
@@ -71,12 +119,34 @@ namespace mongo {
          * Several network round-trips are generally required to execute a write batch.
          *
          * This function does not throw, any errors are reported via the clientResponse.
-         *
-         * TODO: Stats?
          */
         void executeBatch( const BatchedCommandRequest& clientRequest,
                            BatchedCommandResponse* clientResponse );
 
+        /**
+         * Sets the maximum number of child batches outstanding to a single host at once.
+         */
+        void setMaxInFlightPerHost( int maxInFlightPerHost ) {
+            dassert( maxInFlightPerHost > 0 );
+            _maxInFlightPerHost = maxInFlightPerHost;
+        }
+
+        /**
+         * Sets the maximum number of writes in one child batch of an unordered write.  0 sends
+         * all the writes for a shard endpoint in one child batch.
+         */
+        void setMaxWritesPerChildBatch( int maxWritesPerChildBatch ) {
+            dassert( maxWritesPerChildBatch >= 0 );
+            _maxWritesPerChildBatch = maxWritesPerChildBatch;
+        }
+
+        /**
+         * Returns the stats for the batches executed so far.
+         */
+        const BatchWriteExecStats& getStats() const {
+            return _stats;
+        }
+
     private:
 
         // Not owned here
@@ -87,5 +157,11 @@ namespace mongo {
 
         // Not owned here
         MultiCommandDispatch* _dispatcher;
+
+        int _maxInFlightPerHost;
+
+        int _maxWritesPerChildBatch;
+
+        BatchWriteExecStats _stats;
     };
 }
@@ -189,4 +189,142 @@ namespace {
         ASSERT( response.getOk() );
     }
 
+    //
+    // Test pipelined dispatch
+    //
+
+    // Records how many commands were outstanding each time a command was added
+    class RecordingMultiCommand : public MockMultiCommand {
+    public:
+
+        void addCommand( const ConnectionString& endpoint,
+                         const StringData& dbName,
+                         const BSONSerializable& request ) {
+            numPendingOnAdd.push_back( numPending() );
+            MockMultiCommand::addCommand( endpoint, dbName, request );
+        }
+
+        vector<int> numPendingOnAdd;
+    };
+
+    TEST(BatchWriteExecTests, RetryStaleWithoutWaiting) {
+
+        //
+        // Stale ops on one shard are retried while the other shard is still outstanding
+        //
+
+        NamespaceString nss( "foo.bar" );
+
+        ShardEndpoint endpointA( "shardA", ChunkVersion::IGNORED() );
+        ShardEndpoint endpointB( "shardB", ChunkVersion::IGNORED() );
+
+        vector<MockRange*> mockRanges;
+        mockRanges.push_back( new MockRange( endpointA,
+                                             nss,
+                                             BSON( "x" << MINKEY ),
+                                             BSON( "x" << 0 ) ) );
+        mockRanges.push_back( new MockRange( endpointB,
+                                             nss,
+                                             BSON( "x" << 0 ),
+                                             BSON( "x" << MAXKEY ) ) );
+
+        MockShardResolver resolver;
+        ConnectionString shardHostA;
+        resolver.chooseWriteHost( endpointA.shardName, &shardHostA );
+        ConnectionString shardHostB;
+        resolver.chooseWriteHost( endpointB.shardName, &shardHostB );
+
+        vector<MockEndpoint*> mockEndpoints;
+        BatchedErrorDetail error;
+        error.setErrCode( ErrorCodes::StaleShardVersion );
+        error.setErrInfo( BSONObj() ); // Needed for correct handling
+        error.setErrMessage( "mock stale error" );
+        mockEndpoints.push_back( new MockEndpoint( shardHostA, error ) );
+
+        BatchedCommandRequest request( BatchedCommandRequest::BatchType_Insert );
+        request.setNS( nss.ns() );
+        request.setOrdered( false );
+        request.setWriteConcern( BSONObj() );
+
+        // Do multi-target, multi-doc batch write op
+
+        request.getInsertRequest()->addToDocuments( BSON( "x" << -1 ) );
+        request.getInsertRequest()->addToDocuments( BSON( "x" << 1 ) );
+
+        MockNSTargeter targeter;
+        targeter.init( mockRanges );
+
+        RecordingMultiCommand dispatcher;
+        dispatcher.init( mockEndpoints );
+
+        BatchWriteExec exec( &targeter, &resolver, &dispatcher );
+
+        BatchedCommandResponse response;
+        exec.executeBatch( request, &response );
+
+        ASSERT( response.getOk() );
+
+        // The retry to shardA was sent before shardB responded
+        ASSERT_EQUALS( dispatcher.numPendingOnAdd.size(), 3u );
+        ASSERT_EQUALS( dispatcher.numPendingOnAdd.back(), 1 );
+
+        const BatchWriteExecStats& stats = exec.getStats();
+        ASSERT_EQUALS( stats.numStaleBatches, 1 );
+        ASSERT_EQUALS( stats.hostStats.find( shardHostA.toString() )->second.numBatches, 2 );
+        ASSERT_EQUALS( stats.hostStats.find( shardHostB.toString() )->second.numBatches, 1 );
+    }
+
+    TEST(BatchWriteExecTests, PipelineSplitBatches) {
+
+        //
+        // Writes for one shard split into several child batches are pipelined to its host
+        //
+
+        NamespaceString nss( "foo.bar" );
+
+        ShardEndpoint endpoint( "shard", ChunkVersion::IGNORED() );
+
+        vector<MockRange*> mockRanges;
+        mockRanges.push_back( new MockRange( endpoint,
+                                             nss,
+                                             BSON( "x" << MINKEY ),
+                                             BSON( "x" << MAXKEY ) ) );
+
+        MockShardResolver resolver;
+        ConnectionString shardHost;
+        resolver.chooseWriteHost( endpoint.shardName, &shardHost );
+
+        BatchedCommandRequest request( BatchedCommandRequest::BatchType_Insert );
+        request.setNS( nss.ns() );
+        request.setOrdered( false );
+        request.setWriteConcern( BSONObj() );
+
+        for ( int i = 0; i < 5; ++i )
+            request.getInsertRequest()->addToDocuments( BSON( "x" << i ) );
+
+        MockNSTargeter targeter;
+        targeter.init( mockRanges );
+
+        RecordingMultiCommand dispatcher;
+
+        BatchWriteExec exec( &targeter, &resolver, &dispatcher );
+        exec.setMaxWritesPerChildBatch( 2 );
+        exec.setMaxInFlightPerHost( 2 );
+
+        BatchedCommandResponse response;
+        exec.executeBatch( request, &response );
+
+        ASSERT( response.getOk() );
+
+        // Two batches went out together, the third once the first came back
+        ASSERT_EQUALS( dispatcher.numPendingOnAdd.size(), 3u );
+        ASSERT_EQUALS( dispatcher.numPendingOnAdd[0], 0 );
+        ASSERT_EQUALS( dispatcher.numPendingOnAdd[1], 1 );
+        ASSERT_EQUALS( dispatcher.numPendingOnAdd[2], 1 );
+
+        const BatchWriteExecStats& stats = exec.getStats();
+        ASSERT_EQUALS( stats.numRounds, 1 );
+        ASSERT_EQUALS( stats.hostStats.find( shardHost.toString() )->second.numBatches, 3 );
+    }
+
 } // unnamed namespace
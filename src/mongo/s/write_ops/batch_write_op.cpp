@@ -37,7 +37,8 @@ namespace mongo {
     }
 
     BatchWriteOp::BatchWriteOp() :
-        _clientRequest( NULL ), _writeOps( NULL ), _stats( new BatchWriteStats ) {
+        _clientRequest( NULL ), _writeOps( NULL ), _maxWritesPerBatch( 0 ),
+        _stats( new BatchWriteStats ) {
     }
 
     void BatchWriteOp::initClientRequest( const BatchedCommandRequest* clientRequest ) {
@@ -89,29 +90,37 @@ namespace mongo {
         typedef std::map<const ShardEndpoint*, TargetedWriteBatch*, EndpointComp> TargetedBatchMap;
     }
 
-    // Helper function to cancel all the write ops of targeted batches in a map
-    static void cancelBatches( const BatchedErrorDetail& why,
-                               WriteOp* writeOps,
-                               TargetedBatchMap* batchMap ) {
+    // Helper function to cancel the write ops of a targeted batch
+    static void cancelBatchWrites( const BatchedErrorDetail& why,
+                                   WriteOp* writeOps,
+                                   const TargetedWriteBatch& batch ) {
 
-        set<WriteOp*> targetedWriteOps;
+        const vector<TargetedWrite*>& writes = batch.getWrites();
 
-        // Collect all the writeOps that are currently targeted
-        for ( TargetedBatchMap::iterator it = batchMap->begin(); it != batchMap->end(); ) {
+        for ( vector<TargetedWrite*>::const_iterator writeIt = writes.begin();
+            writeIt != writes.end(); ++writeIt ) {
 
-            TargetedWriteBatch* batch = it->second;
-            const vector<TargetedWrite*>& writes = batch->getWrites();
+            TargetedWrite* write = *writeIt;
+
+            // NOTE: We may repeatedly cancel a write op here, but that's fast and we want to
+            // cancel before erasing the TargetedWrite* (which owns the cancelled targeting
+            // info) for reporting reasons.
+            writeOps[write->writeOpRef.first].cancelWrites( &why );
+        }
+    }
 
-            for ( vector<TargetedWrite*>::const_iterator writeIt = writes.begin();
-                writeIt != writes.end(); ++writeIt ) {
+    // Helper function to cancel all the write ops of targeted batches in a map, and of batches
+    // already filled up
+    static void cancelBatches( const BatchedErrorDetail& why,
+                               WriteOp* writeOps,
+                               TargetedBatchMap* batchMap,
+                               OwnedPointerVector<TargetedWriteBatch>* fullBatches ) {
 
-                TargetedWrite* write = *writeIt;
+        // Cancel all the writeOps that are currently targeted
+        for ( TargetedBatchMap::iterator it = batchMap->begin(); it != batchMap->end(); ) {
 
-                // NOTE: We may repeatedly cancel a write op here, but that's fast and we want to
-                // cancel before erasing the TargetedWrite* (which owns the cancelled targeting
-                // info) for reporting reasons.
-                writeOps[write->writeOpRef.first].cancelWrites( &why );
-            }
+            TargetedWriteBatch* batch = it->second;
+            cancelBatchWrites( why, writeOps, *batch );
 
             // Note that we need to *erase* first, *then* delete, since the map keys are ptrs from
             // the values
@@ -119,6 +128,12 @@ namespace mongo {
             delete batch;
         }
         batchMap->clear();
+
+        for ( vector<TargetedWriteBatch*>::const_iterator it = fullBatches->vector().begin();
+            it != fullBatches->vector().end(); ++it ) {
+            cancelBatchWrites( why, writeOps, **it );
+        }
+        fullBatches->clear();
     }
 
     Status BatchWriteOp::targetBatch( const NSTargeter& targeter,
@@ -126,6 +141,8 @@ namespace mongo {
                                       vector<TargetedWriteBatch*>* targetedBatches ) {
 
         TargetedBatchMap batchMap;
+        // Batches that reached _maxWritesPerBatch, and so were taken out of batchMap
+        OwnedPointerVector<TargetedWriteBatch> fullBatches;
         int numTargetErrors = 0;
 
         size_t numWriteOps = _clientRequest->sizeWriteOps();
@@ -167,7 +184,7 @@ namespace mongo {
                 }
                 else {
                     // Cancel current batch state with an error
-                    cancelBatches( targetError, _writeOps, &batchMap );
+                    cancelBatches( targetError, _writeOps, &batchMap, &fullBatches );
                     dassert( batchMap.empty() );
                     return targetStatus;
                 }
@@ -190,6 +207,12 @@ namespace mongo {
 
                 TargetedWriteBatch* batch = seenIt->second;
                 batch->addWrite( write );
+
+                // Start a new batch for this endpoint once this one is full
+                if ( _maxWritesPerBatch > 0 && batch->getWrites().size() >= _maxWritesPerBatch ) {
+                    batchMap.erase( seenIt );
+                    fullBatches.mutableVector().push_back( batch );
+                }
             }
 
             // Relinquish ownership of TargetedWrites, now the TargetedBatches own them
@@ -200,6 +223,18 @@ namespace mongo {
         // Send back our targeted batches
         //
 
+        for ( vector<TargetedWriteBatch*>::const_iterator it = fullBatches.vector().begin();
+            it != fullBatches.vector().end(); ++it ) {
+
+            TargetedWriteBatch* batch = *it;
+
+            // Remember targeted batch for reporting
+            _targeted.insert( batch );
+            // Send the handle back to caller
+            targetedBatches->push_back( batch );
+        }
+        fullBatches.mutableVector().clear();
+
         for ( TargetedBatchMap::iterator it = batchMap.begin(); it != batchMap.end(); ++it ) {
 
             TargetedWriteBatch* batch = it->second;
@@ -101,12 +101,22 @@ namespace mongo {
          * (The idea here is that if we are sure our NSTargeter is up-to-date we should record
          * targeting errors, but if not we should refresh once first.)
          *
-         * Returned TargetedWriteBatches are owned by the caller.
+         * Returned TargetedWriteBatches are owned by the caller.  An endpoint gets several of them
+         * if it has more writes than the limit set with setMaxWritesPerBatch.
          */
         Status targetBatch( const NSTargeter& targeter,
                             bool recordTargetErrors,
                             vector<TargetedWriteBatch*>* targetedBatches );
 
+        /**
+         * Limits the number of writes targetBatch puts in one TargetedWriteBatch, so the writes
+         * for a single endpoint can be sent as several child batches.  0 means no limit, which
+         * is the default.
+         */
+        void setMaxWritesPerBatch( size_t maxWrites ) {
+            _maxWritesPerBatch = maxWrites;
+        }
+
         /**
          * Fills a BatchCommandRequest from a TargetedWriteBatch for this BatchWriteOp.
          */
@@ -150,6 +160,9 @@ namespace mongo {
         // Array of ops being processed from the client request
         WriteOp* _writeOps;
 
+        // Most writes targeted into one batch, 0 for no limit
+        size_t _maxWritesPerBatch;
+
         // Current outstanding batch op write requests
         // Not owned here but tracked for reporting
         std::set<const TargetedWriteBatch*> _targeted;
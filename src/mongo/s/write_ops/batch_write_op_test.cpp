@@ -228,6 +228,68 @@ namespace {
         ASSERT( clientResponse.getOk() );
     }
 
+    TEST(WriteOpTests, TargetMultiOpSameShardSplit) {
+
+        //
+        // Multi-op targeting test, writes for one shard split up over several batches
+        //
+
+        NamespaceString nss( "foo.bar" );
+
+        ShardEndpoint endpoint( "shard", ChunkVersion::IGNORED() );
+
+        vector<MockRange*> mockRanges;
+        mockRanges.push_back( new MockRange( endpoint,
+                                             nss,
+                                             BSON( "x" << MINKEY ),
+                                             BSON( "x" << MAXKEY ) ) );
+
+        BatchedCommandRequest request( BatchedCommandRequest::BatchType_Insert );
+        request.setNS( nss.ns() );
+        request.setOrdered( false );
+        request.setWriteConcern( BSONObj() );
+
+        // Do single-target, multi-doc batch write op, at most two writes per batch
+
+        for ( int i = 0; i < 5; ++i )
+            request.getInsertRequest()->addToDocuments( BSON( "x" << i ) );
+
+        BatchWriteOp batchOp;
+        batchOp.initClientRequest( &request );
+        batchOp.setMaxWritesPerBatch( 2 );
+        ASSERT( !batchOp.isFinished() );
+
+        MockNSTargeter targeter;
+        targeter.init( mockRanges );
+
+        OwnedPointerVector<TargetedWriteBatch> targetedOwned;
+        vector<TargetedWriteBatch*>& targeted = targetedOwned.mutableVector();
+        Status status = batchOp.targetBatch( targeter, false, &targeted );
+
+        ASSERT( status.isOK() );
+        ASSERT_EQUALS( targeted.size(), 3u );
+        ASSERT_EQUALS( targeted[0]->getWrites().size(), 2u );
+        ASSERT_EQUALS( targeted[1]->getWrites().size(), 2u );
+        ASSERT_EQUALS( targeted[2]->getWrites().size(), 1u );
+        for ( size_t i = 0; i < targeted.size(); ++i )
+            assertEndpointsEqual( targeted[i]->getEndpoint(), endpoint );
+
+        BatchedCommandResponse response;
+        response.setOk( true );
+        response.setN( 0 );
+        ASSERT( response.isValid( NULL ) );
+
+        for ( size_t i = 0; i < targeted.size(); ++i ) {
+            ASSERT( !batchOp.isFinished() );
+            batchOp.noteBatchResponse( *targeted[i], response, NULL );
+        }
+        ASSERT( batchOp.isFinished() );
+
+        BatchedCommandResponse clientResponse;
+        batchOp.buildClientResponse( &clientResponse );
+        ASSERT( clientResponse.getOk() );
+    }
+
     struct EndpointComp {
         bool operator()( const TargetedWriteBatch* writeA,
                          const TargetedWriteBatch* writeB ) const {
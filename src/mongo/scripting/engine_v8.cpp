@@ -68,6 +68,30 @@ namespace mongo {
         return obj->GetInternalField(1).As<v8::Object>();
     }
 
+    /**
+     * A lazy object is modified if a property was set or deleted on it, or on any lazy
+     * subobject that has been decoded into its backing object.
+     */
+    static bool lazyObjectModified(V8Scope* scope, const v8::Handle<v8::Object>& obj) {
+        BSONHolder* holder = unwrapHolder(scope, obj);
+        if (!holder || holder->_modified)
+            return true;
+
+        v8::Handle<v8::Object> realObject = unwrapObject(scope, obj);
+        if (realObject.IsEmpty())
+            return true;
+
+        v8::Local<v8::Array> names = realObject->GetOwnPropertyNames();
+        for (unsigned int i = 0; i < names->Length(); i++) {
+            v8::Local<v8::Value> value = realObject->Get(names->Get(i));
+            if (value->IsObject() && scope->LazyBsonFT()->HasInstance(value) &&
+                    lazyObjectModified(scope, value.As<v8::Object>())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     void V8Scope::wrapBSONObject(v8::Handle<v8::Object> obj, BSONObj data, bool readOnly) {
         verify(LazyBsonFT()->HasInstance(obj));
 
@@ -111,9 +135,10 @@ namespace mongo {
                 realObject->Set(name, val);
             }
 
-            if (elmt.type() == mongo::Object || elmt.type() == mongo::Array) {
-              // if accessing a subobject, it may get modified and base obj would not know
-              // have to set base as modified, which means some optim is lost
+            if (elmt.type() == mongo::Array ||
+                    (elmt.type() == mongo::Object && !scope->LazyBsonFT()->HasInstance(val))) {
+              // arrays and non-lazy subobjects don't track their own changes, so set base as
+              // modified.  Lazy subobjects are checked by lazyObjectModified() instead.
               holder->_modified = true;
             }
         }
@@ -224,9 +249,10 @@ namespace mongo {
             val = scope->mongoToV8Element(elmt, holder->_readOnly);
             realObject->Set(index, val);
 
-            if (elmt.type() == mongo::Object || elmt.type() == mongo::Array) {
-                // if accessing a subobject, it may get modified and base obj would not know
-                // have to set base as modified, which means some optim is lost
+            if (elmt.type() == mongo::Array ||
+                    (elmt.type() == mongo::Object && !scope->LazyBsonFT()->HasInstance(val))) {
+                // arrays and non-lazy subobjects don't track their own changes, so set base as
+                // modified.  Lazy subobjects are checked by lazyObjectModified() instead.
                 holder->_modified = true;
             }
         }
@@ -344,15 +370,19 @@ namespace mongo {
 
      void V8ScriptEngine::interrupt(unsigned opId) {
          mongo::mutex::scoped_lock intLock(_globalInterruptLock);
-         OpIdToScopeMap::iterator iScope = _opToScopeMap.find(opId);
-         if (iScope == _opToScopeMap.end()) {
+         std::pair<OpIdToScopeMap::iterator, OpIdToScopeMap::iterator> range =
+                 _opToScopeMap.equal_range(opId);
+         if (range.first == range.second) {
              // got interrupt request for a scope that no longer exists
              LOG(1) << "received interrupt request for unknown op: " << opId
                     << printKnownOps_inlock() << endl;
              return;
          }
          LOG(1) << "interrupting op: " << opId << printKnownOps_inlock() << endl;
-         iScope->second->kill();
+         // an operation may run several scopes at once (e.g. parallel map/reduce)
+         for (OpIdToScopeMap::iterator iScope = range.first; iScope != range.second; ++iScope) {
+             iScope->second->kill();
+         }
      }
 
      void V8ScriptEngine::interruptAll() {
@@ -368,7 +398,7 @@ namespace mongo {
          if (_engine->haveGetCurrentOpIdCallback()) {
              // this scope has an associated operation
              _opId = _engine->getCurrentOpId();
-             _engine->_opToScopeMap[_opId] = this;
+             _engine->_opToScopeMap.insert(std::make_pair(_opId, this));
          }
          else
              // no associated op id (e.g. running from shell)
@@ -381,9 +411,16 @@ namespace mongo {
          LOG(2) << "V8Scope " << static_cast<const void*>(this) << " unregistered for op " << _opId << endl;
         if (_engine->haveGetCurrentOpIdCallback() || _opId != 0) {
             // scope is currently associated with an operation id
-            V8ScriptEngine::OpIdToScopeMap::iterator it = _engine->_opToScopeMap.find(_opId);
-            if (it != _engine->_opToScopeMap.end())
-                _engine->_opToScopeMap.erase(it);
+            std::pair<V8ScriptEngine::OpIdToScopeMap::iterator,
+                      V8ScriptEngine::OpIdToScopeMap::iterator> range =
+                    _engine->_opToScopeMap.equal_range(_opId);
+            for (V8ScriptEngine::OpIdToScopeMap::iterator it = range.first; it != range.second;
+                    ++it) {
+                if (it->second == this) {
+                    _engine->_opToScopeMap.erase(it);
+                    break;
+                }
+            }
         }
     }
 
@@ -1634,14 +1671,30 @@ namespace mongo {
                                    << sname);
     }
 
+    /**
+     * Finishes an object converted by v8ToMongo() or v8LazyToMongo(), checking its size first
+     */
+    static BSONObj objFromV8Builder(BSONObjBuilder& b) {
+        const int sizeWithEOO = b.len() + 1/*EOO*/ - 4/*BSONObj::Holder ref count*/;
+        uassert(17260, str::stream() << "Converting from JavaScript to BSON failed: "
+                                     << "Object size " << sizeWithEOO << " exceeds limit of "
+                                     << BSONObjMaxUserSize << " bytes.",
+                sizeWithEOO <= BSONObjMaxUserSize);
+
+        return b.obj(); // Would give an uglier error than above for oversized objects.
+    }
+
     BSONObj V8Scope::v8ToMongo(v8::Handle<v8::Object> o, int depth) {
         BSONObj originalBSON;
         if (LazyBsonFT()->HasInstance(o)) {
             originalBSON = unwrapBSONObj(this, o);
             BSONHolder* holder = unwrapHolder(this, o);
-            if (holder && !holder->_modified) {
-                // object was not modified, use bson as is
-                return originalBSON;
+            if (holder) {
+                if (!lazyObjectModified(this, o)) {
+                    // neither the object nor a decoded subobject was modified, use bson as is
+                    return originalBSON;
+                }
+                return v8LazyToMongo(o, holder, depth);
             }
         }
 
@@ -1667,13 +1720,54 @@ namespace mongo {
             v8ToMongoElement(b, sname, value, depth + 1, &originalBSON);
         }
 
-        const int sizeWithEOO = b.len() + 1/*EOO*/ - 4/*BSONObj::Holder ref count*/;
-        uassert(17260, str::stream() << "Converting from JavaScript to BSON failed: "
-                                     << "Object size " << sizeWithEOO << " exceeds limit of "
-                                     << BSONObjMaxUserSize << " bytes.",
-                sizeWithEOO <= BSONObjMaxUserSize);
+        return objFromV8Builder(b);
+    }
 
-        return b.obj(); // Would give an uglier error than above for oversized objects.
+    BSONObj V8Scope::v8LazyToMongo(v8::Handle<v8::Object> o, BSONHolder* holder, int depth) {
+        BSONObj originalBSON = holder->_obj;
+        v8::Handle<v8::Object> realObject = unwrapObject(this, o);
+        BSONObjBuilder b(originalBSON.objsize());
+
+        // move the _id field to the front of top-level objects, as v8ToMongo() does
+        const bool idFirst = depth == 0 && !holder->_removed.count("_id");
+        if (idFirst) {
+            v8::Handle<v8::String> idName = strLitToV8("_id");
+            BSONElement id = originalBSON["_id"];
+            if (realObject->HasOwnProperty(idName))
+                v8ToMongoElement(b, "_id", realObject->Get(idName), 0, &originalBSON);
+            else if (!id.eoo())
+                b.append(id);
+        }
+
+        // Original fields keep their order.  Only those decoded into or assigned on the backing
+        // object are converted from v8, the others are copied from the BSON without decoding.
+        unordered_set<StringData, StringData::Hasher> original;
+        BSONForEach(elem, originalBSON) {
+            StringData name(elem.fieldName(), elem.fieldNameSize() - 1);
+            original.insert(name);
+            if (idFirst && name == "_id")
+                continue;
+            if (holder->_removed.count(name.toString()))
+                continue;
+
+            v8::Handle<v8::String> v8name = v8StringData(name);
+            if (realObject->HasOwnProperty(v8name))
+                v8ToMongoElement(b, name, realObject->Get(v8name), depth + 1, &originalBSON);
+            else
+                b.append(elem);
+        }
+
+        // then properties added by the script
+        v8::Local<v8::Array> names = realObject->GetOwnPropertyNames();
+        for (unsigned int i = 0; i < names->Length(); i++) {
+            v8::Local<v8::String> name = names->Get(i)->ToString();
+            V8String sname(name);
+            if (original.count(sname) || (idFirst && StringData(sname) == "_id"))
+                continue;
+            v8ToMongoElement(b, sname, realObject->Get(name), depth + 1, &originalBSON);
+        }
+
+        return objFromV8Builder(b);
     }
 
     // --- random utils ----
@@ -237,6 +237,13 @@ namespace mongo {
          * Convert v8 Javascript types to BSON types
          */
         mongo::BSONObj v8ToMongo(v8::Handle<v8::Object> obj, int depth = 0);
+
+        /**
+         * Convert a modified lazy object back to BSON, copying the fields that were never
+         * decoded straight from the original BSON
+         */
+        mongo::BSONObj v8LazyToMongo(v8::Handle<v8::Object> obj, BSONHolder* holder, int depth);
+
         void v8ToMongoElement(BSONObjBuilder& b,
                               const StringData& sname,
                               v8::Handle<v8::Value> value,
@@ -487,7 +494,7 @@ namespace mongo {
         bool utf8Ok() const { return true; }
 
         /**
-         * Interrupt a single active v8 execution context
+         * Interrupt every active v8 execution context registered for an operation
          * NB: To interrupt a context, we must acquire the following locks (in order):
          *       - mutex to protect the the map of all scopes (_globalInterruptLock)
          *       - mutex to protect the scope that's being interrupted (_interruptLock)
@@ -511,9 +518,9 @@ namespace mongo {
          */
         DeadlineMonitor<V8Scope>* getDeadlineMonitor() { return &_deadlineMonitor; }
 
-        typedef map<unsigned, V8Scope*> OpIdToScopeMap;
+        typedef multimap<unsigned, V8Scope*> OpIdToScopeMap;
         mongo::mutex _globalInterruptLock;  // protects map of all operation ids -> scope
-        OpIdToScopeMap _opToScopeMap;       // map of mongo op ids to scopes (protected by
+        OpIdToScopeMap _opToScopeMap;       // multimap of mongo op ids to scopes (protected by
                                             // _globalInterruptLock).
         DeadlineMonitor<V8Scope> _deadlineMonitor;
     };
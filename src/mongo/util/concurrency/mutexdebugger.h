@@ -55,6 +55,7 @@ namespace mongo {
         typedef std::map<mid,int> Preceeding;
         std::map< mid, int > maxNest;
         boost::thread_specific_ptr< Preceeding > us;
+        boost::thread_specific_ptr< unsigned long long > acquired;
         std::map< mid, std::set<mid> > followers;
         boost::mutex &x;
         unsigned magic;
@@ -73,6 +74,12 @@ namespace mongo {
 
         MutexDebugger();
 
+        /** number of mutexes locked by the current thread so far, recursive locks included */
+        unsigned long long acquisitionsThisThread() const {
+            unsigned long long *n = acquired.get();
+            return n ? *n : 0;
+        }
+
         std::string currentlyLocked() const { 
             Preceeding *_preceeding = us.get();
             if( _preceeding == 0 )
@@ -95,6 +102,11 @@ namespace mongo {
                 us.reset( _preceeding = new Preceeding() );
             Preceeding &preceeding = *_preceeding;
 
+            unsigned long long *n = acquired.get();
+            if( n == 0 )
+                acquired.reset( n = new unsigned long long(0) );
+            ++*n;
+
             if( a == m ) {
                 aBreakPoint();
                 if( preceeding[b.c_str()] ) {
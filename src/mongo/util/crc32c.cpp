@@ -0,0 +1,257 @@
+// crc32c.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/util/crc32c.h"
+
+#include <cstring>
+
+#include "mongo/base/init.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define MONGO_CRC32C_HW 1
+#include <cpuid.h>
+#elif defined(_M_X64) && defined(_MSC_VER)
+#define MONGO_CRC32C_HW 1
+#include <intrin.h>
+#include <nmmintrin.h>
+#endif
+
+namespace mongo {
+
+    namespace {
+
+        const uint32_t Poly = 0x82f63b78; // Castagnoli, bit reflected
+
+        /** tables for the software version, which handles 8 bytes per step ("slicing by 8") */
+        uint32_t sliceTables[8][256];
+
+        uint32_t softwareImpl(uint32_t crc, const unsigned char* p, size_t len) {
+            uint32_t c = crc;
+            while (len && (reinterpret_cast<size_t>(p) & 7)) {
+                c = sliceTables[0][(c ^ *p++) & 0xff] ^ (c >> 8);
+                len--;
+            }
+            while (len >= 8) {
+                uint32_t lo, hi;
+                memcpy(&lo, p, 4);
+                memcpy(&hi, p + 4, 4);
+                lo ^= c;
+                c = sliceTables[7][lo & 0xff] ^ sliceTables[6][(lo >> 8) & 0xff] ^
+                    sliceTables[5][(lo >> 16) & 0xff] ^ sliceTables[4][lo >> 24] ^
+                    sliceTables[3][hi & 0xff] ^ sliceTables[2][(hi >> 8) & 0xff] ^
+                    sliceTables[1][(hi >> 16) & 0xff] ^ sliceTables[0][hi >> 24];
+                p += 8;
+                len -= 8;
+            }
+            while (len--) {
+                c = sliceTables[0][(c ^ *p++) & 0xff] ^ (c >> 8);
+            }
+            return c;
+        }
+
+#if defined(MONGO_CRC32C_HW)
+        bool useHardware = false;
+
+        // The crc32 instruction has a latency of 3 cycles but a throughput of one per cycle, so
+        // we run three independent streams over adjacent blocks and then stitch the results
+        // together by "appending" the zeros the later blocks stand in for.  Appending n zero
+        // bytes to a crc is linear, so it is done with a lookup per byte of the crc.
+        const size_t LongBlock = 8192;
+        const size_t ShortBlock = 256;
+        uint32_t longShift[4][256];
+        uint32_t shortShift[4][256];
+
+        uint32_t gf2MatrixTimes(const uint32_t* mat, uint32_t vec) {
+            uint32_t sum = 0;
+            while (vec) {
+                if (vec & 1)
+                    sum ^= *mat;
+                vec >>= 1;
+                mat++;
+            }
+            return sum;
+        }
+
+        void gf2MatrixSquare(uint32_t* square, const uint32_t* mat) {
+            for (int n = 0; n < 32; n++)
+                square[n] = gf2MatrixTimes(mat, mat[n]);
+        }
+
+        /** operator that appends len zero bytes to a crc.  len must be a power of two. */
+        void zerosOperator(uint32_t* even, size_t len) {
+            uint32_t odd[32];
+            odd[0] = Poly; // one zero bit
+            uint32_t row = 1;
+            for (int n = 1; n < 32; n++) {
+                odd[n] = row;
+                row <<= 1;
+            }
+            gf2MatrixSquare(even, odd); // two zero bits
+            gf2MatrixSquare(odd, even); // four zero bits
+            // the first square gives one zero byte in even, the next two in odd, and so on
+            do {
+                gf2MatrixSquare(even, odd);
+                len >>= 1;
+                if (len == 0)
+                    return;
+                gf2MatrixSquare(odd, even);
+                len >>= 1;
+            } while (len);
+            memcpy(even, odd, sizeof(odd));
+        }
+
+        void makeShiftTable(uint32_t table[4][256], size_t len) {
+            uint32_t op[32];
+            zerosOperator(op, len);
+            for (uint32_t n = 0; n < 256; n++) {
+                table[0][n] = gf2MatrixTimes(op, n);
+                table[1][n] = gf2MatrixTimes(op, n << 8);
+                table[2][n] = gf2MatrixTimes(op, n << 16);
+                table[3][n] = gf2MatrixTimes(op, n << 24);
+            }
+        }
+
+        inline uint32_t shift(const uint32_t table[4][256], uint32_t crc) {
+            return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^
+                   table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+        }
+
+#if defined(_MSC_VER)
+        inline uint64_t crc32q(uint64_t crc, const unsigned char* p) {
+            uint64_t v;
+            memcpy(&v, p, 8);
+            return _mm_crc32_u64(crc, v);
+        }
+        inline uint64_t crc32b(uint64_t crc, unsigned char b) {
+            return _mm_crc32_u8(static_cast<uint32_t>(crc), b);
+        }
+        bool cpuHasCrc32() {
+            int info[4];
+            __cpuid(info, 1);
+            return (info[2] & (1 << 20)) != 0; // SSE4.2
+        }
+#else
+        // written as asm so this file doesn't need to be built with -msse4.2
+        inline uint64_t crc32q(uint64_t crc, const unsigned char* p) {
+            uint64_t v;
+            memcpy(&v, p, 8);
+            __asm__("crc32q %1, %0" : "+r"(crc) : "rm"(v));
+            return crc;
+        }
+        inline uint64_t crc32b(uint64_t crc, unsigned char b) {
+            uint32_t c = static_cast<uint32_t>(crc);
+            __asm__("crc32b %1, %0" : "+r"(c) : "rm"(b));
+            return c;
+        }
+        bool cpuHasCrc32() {
+            unsigned int a, b, c, d;
+            if (!__get_cpuid(1, &a, &b, &c, &d))
+                return false;
+            return (c & (1 << 20)) != 0; // SSE4.2
+        }
+#endif
+
+        /** three streams of blockSize bytes at a time while there is enough input */
+        inline const unsigned char* interleaved(uint64_t& crc,
+                                                const unsigned char* p,
+                                                size_t& len,
+                                                size_t blockSize,
+                                                const uint32_t table[4][256]) {
+            while (len >= blockSize * 3) {
+                uint64_t c0 = crc;
+                uint64_t c1 = 0;
+                uint64_t c2 = 0;
+                const unsigned char* end = p + blockSize;
+                do {
+                    c0 = crc32q(c0, p);
+                    c1 = crc32q(c1, p + blockSize);
+                    c2 = crc32q(c2, p + blockSize * 2);
+                    p += 8;
+                } while (p < end);
+                uint32_t c = shift(table, static_cast<uint32_t>(c0)) ^ static_cast<uint32_t>(c1);
+                crc = shift(table, c) ^ static_cast<uint32_t>(c2);
+                p += blockSize * 2;
+                len -= blockSize * 3;
+            }
+            return p;
+        }
+
+        uint32_t hardwareImpl(uint32_t crc, const unsigned char* p, size_t len) {
+            uint64_t c = crc;
+            while (len && (reinterpret_cast<size_t>(p) & 7)) {
+                c = crc32b(c, *p++);
+                len--;
+            }
+            p = interleaved(c, p, len, LongBlock, longShift);
+            p = interleaved(c, p, len, ShortBlock, shortShift);
+            while (len >= 8) {
+                c = crc32q(c, p);
+                p += 8;
+                len -= 8;
+            }
+            while (len--) {
+                c = crc32b(c, *p++);
+            }
+            return static_cast<uint32_t>(c);
+        }
+#endif // MONGO_CRC32C_HW
+
+    } // namespace
+
+    MONGO_INITIALIZER(Crc32cTables)(InitializerContext* context) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? (c >> 1) ^ Poly : c >> 1;
+            sliceTables[0][n] = c;
+        }
+        for (uint32_t n = 0; n < 256; n++) {
+            for (int k = 1; k < 8; k++) {
+                uint32_t prev = sliceTables[k - 1][n];
+                sliceTables[k][n] = (prev >> 8) ^ sliceTables[0][prev & 0xff];
+            }
+        }
+#if defined(MONGO_CRC32C_HW)
+        makeShiftTable(longShift, LongBlock);
+        makeShiftTable(shortShift, ShortBlock);
+        useHardware = cpuHasCrc32();
+#endif
+        return Status::OK();
+    }
+
+    uint32_t crc32c(uint32_t crc, const void* buf, size_t len) {
+        const unsigned char* p = static_cast<const unsigned char*>(buf);
+#if defined(MONGO_CRC32C_HW)
+        if (useHardware)
+            return ~hardwareImpl(~crc, p, len);
+#endif
+        return ~softwareImpl(~crc, p, len);
+    }
+
+    uint32_t crc32cSoftware(uint32_t crc, const void* buf, size_t len) {
+        return ~softwareImpl(~crc, static_cast<const unsigned char*>(buf), len);
+    }
+
+    bool crc32cHardwareEnabled() {
+#if defined(MONGO_CRC32C_HW)
+        return useHardware;
+#else
+        return false;
+#endif
+    }
+
+} // namespace mongo
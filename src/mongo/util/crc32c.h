@@ -0,0 +1,41 @@
+// crc32c.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    /**
+     * CRC-32C (Castagnoli polynomial, as used by iSCSI and ext4) of len bytes at buf.
+     *
+     * Pass the result of a previous call as crc to continue a checksum over more data, or 0 to
+     * start one.  Uses the SSE4.2 crc32 instruction when the cpu has it, and a table driven
+     * implementation otherwise; both give the same result.
+     */
+    uint32_t crc32c(uint32_t crc, const void* buf, size_t len);
+
+    /** the table driven implementation, regardless of cpu.  for tests and benchmarks. */
+    uint32_t crc32cSoftware(uint32_t crc, const void* buf, size_t len);
+
+    /** @return true if crc32c() is using the cpu's crc32 instruction */
+    bool crc32cHardwareEnabled();
+
+} // namespace mongo
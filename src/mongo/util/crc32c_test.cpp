@@ -0,0 +1,64 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/crc32c.h"
+
+namespace mongo {
+
+    TEST(Crc32c, KnownValues) {
+        // check values from RFC 3720 (iSCSI), appendix B.4
+        std::vector<unsigned char> buf(32, 0);
+        ASSERT_EQUALS(0x8a9136aaU, crc32c(0, &buf[0], buf.size()));
+        std::memset(&buf[0], 0xff, buf.size());
+        ASSERT_EQUALS(0x62a8ab43U, crc32c(0, &buf[0], buf.size()));
+        for (size_t i = 0; i < buf.size(); i++)
+            buf[i] = i;
+        ASSERT_EQUALS(0x46dd794eU, crc32c(0, &buf[0], buf.size()));
+
+        ASSERT_EQUALS(0xe3069283U, crc32c(0, "123456789", 9));
+        ASSERT_EQUALS(0U, crc32c(0, "", 0));
+    }
+
+    TEST(Crc32c, SoftwareMatches) {
+        // lengths and alignments that exercise every path of the hardware version
+        std::vector<unsigned char> buf(3 * 8192 * 2 + 100);
+        for (size_t i = 0; i < buf.size(); i++)
+            buf[i] = std::rand();
+
+        const size_t lens[] = { 0, 1, 7, 8, 9, 255, 768, 769, 3 * 8192, 3 * 8192 + 13,
+                                buf.size() - 8 };
+        for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+            for (size_t ofs = 0; ofs < 8; ofs++) {
+                ASSERT_EQUALS(crc32cSoftware(0, &buf[ofs], lens[i]),
+                              crc32c(0, &buf[ofs], lens[i]));
+            }
+        }
+    }
+
+    TEST(Crc32c, Continuation) {
+        const char* s = "the quick brown fox jumps over the lazy dog";
+        const size_t len = std::strlen(s);
+        const uint32_t whole = crc32c(0, s, len);
+        for (size_t split = 0; split <= len; split++) {
+            ASSERT_EQUALS(whole, crc32c(crc32c(0, s, split), s + split, len - split));
+        }
+    }
+
+} // namespace mongo
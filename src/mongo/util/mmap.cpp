@@ -38,6 +38,10 @@ namespace mongo {
         fassert( 16327, (minOSPageSizeBytes & (minOSPageSizeBytes - 1)) == 0);
     }
 
+    bool g_mmapHugePages = false;
+    Counter64 g_mmapHugePageViews;
+    Counter64 g_mmapHugePageFailures;
+
 namespace {
     set<MongoFile*> mmfiles;
     map<string,MongoFile*> pathToFile;
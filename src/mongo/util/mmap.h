@@ -23,6 +23,7 @@
 
 #include <boost/thread/xtime.hpp>
 
+#include "mongo/base/counter.h"
 #include "mongo/util/concurrency/rwlock.h"
 #include "mongo/util/goodies.h"
 
@@ -31,6 +32,13 @@ namespace mongo {
     extern const size_t g_minOSPageSizeBytes;
     void minOSPageSizeBytesTest(size_t minOSPageSizeBytes);  // lame-o
 
+    /** set at startup: map data files and private views at 2MB aligned addresses and ask the
+        kernel to back them with transparent huge pages (linux only) */
+    extern bool g_mmapHugePages;
+    /** views madvised for huge pages, and how many of those the kernel refused */
+    extern Counter64 g_mmapHugePageViews;
+    extern Counter64 g_mmapHugePageFailures;
+
     class MAdvise { 
         void *_p;
         unsigned _len;
@@ -228,6 +236,15 @@ namespace mongo {
 
         /** close the current private view and open a new replacement */
         void* remapPrivateView(void *oldPrivateAddr);
+
+#if !defined(_WIN32)
+        /** replace [offset, offset+length) of the private view with a fresh mapping of the file.
+            offset must be page aligned.  the rest of the view, and any copy on write pages in it,
+            is left alone.
+            @return the start of the view, which is unchanged
+        */
+        void* remapPrivateView(void *oldPrivateAddr, unsigned long long offset, unsigned long long length);
+#endif
     };
 
     /** p is called from within a mutex that MongoFile uses.  so be careful not to deadlock. */
@@ -39,6 +39,63 @@ namespace mongo {
     }
     const size_t g_minOSPageSizeBytes = fetchMinOSPageSizeBytes();
 
+#if defined(MADV_HUGEPAGE)
+    // transparent huge pages only back 2MB aligned ranges of a mapping
+    static const uintptr_t hugePageSize = 2 * 1024 * 1024;
+
+    /** like mmap(NULL, ...), but when huge pages are on the view starts on a huge page boundary */
+    static void* mmapView(size_t length, int prot, int flags, int fd) {
+        if ( !g_mmapHugePages )
+            return mmap(NULL, length, prot, flags, fd, 0);
+
+        // reserve enough address space to find an aligned start in, map over it, then give
+        // back the slack on either side
+        const size_t reserved = length + hugePageSize;
+        char* p = static_cast<char*>( mmap(NULL, reserved, PROT_NONE,
+                                           MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0) );
+        if ( p == MAP_FAILED )
+            return MAP_FAILED;
+        char* start = reinterpret_cast<char*>(
+            ( reinterpret_cast<uintptr_t>(p) + hugePageSize - 1 ) & ~( hugePageSize - 1 ) );
+        void* x = mmap(start, length, prot, flags|MAP_FIXED, fd, 0);
+        if ( x == MAP_FAILED ) {
+            int err = errno;
+            munmap(p, reserved);
+            errno = err;
+            return MAP_FAILED;
+        }
+        char* end = start + ( ( length + g_minOSPageSizeBytes - 1 ) & ~( g_minOSPageSizeBytes - 1 ) );
+        if ( start > p )
+            munmap(p, start - p);
+        if ( p + reserved > end )
+            munmap(end, p + reserved - end);
+        return x;
+    }
+
+    /** a view loses its advice when it is mapped over, so this is also needed after a remap */
+    static void adviseHugePages(void* view, size_t length, const string& filename) {
+        if ( !g_mmapHugePages )
+            return;
+        g_mmapHugePageViews.increment();
+        if ( madvise(view, length, MADV_HUGEPAGE) ) {
+            g_mmapHugePageFailures.increment();
+            LOG(1) << "madvise(MADV_HUGEPAGE) failed for " << filename << ' '
+                   << errnoWithDescription() << endl;
+        }
+    }
+#else
+    static void* mmapView(size_t length, int prot, int flags, int fd) {
+        return mmap(NULL, length, prot, flags, fd, 0);
+    }
+
+    static void adviseHugePages(void* view, size_t length, const string& filename) {
+        if ( !g_mmapHugePages )
+            return;
+        g_mmapHugePageViews.increment();
+        g_mmapHugePageFailures.increment();
+    }
+#endif
+
     MemoryMappedFile::MemoryMappedFile() {
         fd = 0;
         maphandle = 0;
@@ -113,7 +170,7 @@ namespace mongo {
         uassert(10447,  str::stream() << "map file alloc failed, wanted: " << length << " filelen: " << filelen << ' ' << sizeof(size_t), filelen == length );
         lseek( fd, 0, SEEK_SET );
 
-        void * view = mmap(NULL, length, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        void * view = mmapView(length, PROT_READ|PROT_WRITE, MAP_SHARED, fd);
         if ( view == MAP_FAILED ) {
             error() << "  mmap() failed for " << filename << " len:" << length << " " << errnoWithDescription() << endl;
             if ( errno == ENOMEM ) {
@@ -135,6 +192,7 @@ namespace mongo {
             }
         }
 #endif
+        adviseHugePages( view, length, filename );
 
         views.push_back( view );
 
@@ -156,7 +214,7 @@ namespace mongo {
     }
 
     void* MemoryMappedFile::createPrivateMap() {
-        void * x = mmap( /*start*/0 , len , PROT_READ|PROT_WRITE , MAP_PRIVATE|MAP_NORESERVE , fd , 0 );
+        void * x = mmapView( len , PROT_READ|PROT_WRITE , MAP_PRIVATE|MAP_NORESERVE , fd );
         if( x == MAP_FAILED ) {
             if ( errno == ENOMEM ) {
                 if( sizeof(void*) == 4 ) {
@@ -171,6 +229,7 @@ namespace mongo {
             }
             return 0;
         }
+        adviseHugePages( x, len, filename() );
 
         views.push_back(x);
         return x;
@@ -192,9 +251,32 @@ namespace mongo {
             abort();
         }
         verify( x == oldPrivateAddr );
+        adviseHugePages( x, len, filename() );
         return x;
     }
 
+    void* MemoryMappedFile::remapPrivateView(void *oldPrivateAddr, unsigned long long offset, unsigned long long length) {
+#if defined(__sunos__) // SERVER-8795
+        verify( Lock::isW() );
+        LockMongoFilesExclusive lockMongoFiles;
+#endif
+        verify( offset + length <= len );
+        verify( offset % g_minOSPageSizeBytes == 0 );
+
+        char *p = static_cast<char*>(oldPrivateAddr) + offset;
+        void * x = mmap( p, length, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_NORESERVE|MAP_FIXED, fd, offset );
+        if( x == MAP_FAILED ) {
+            int err = errno;
+            error()  << "13601 Couldn't remap private view: " << errnoWithDescription(err) << endl;
+            log() << "aborting" << endl;
+            printMemInfo();
+            abort();
+        }
+        verify( x == p );
+        adviseHugePages( x, length, filename() );
+        return oldPrivateAddr;
+    }
+
     void MemoryMappedFile::flush(bool sync) {
         if ( views.empty() || fd == 0 )
             return;
@@ -97,6 +97,12 @@ namespace mongo {
          */
         void getExtraInfo( BSONObjBuilder& info );
 
+        /**
+         * Append page table size and transparent huge page counters, where the platform
+         * reports them
+         */
+        void getHugePageInfo( BSONObjBuilder& info );
+
         bool supported();
 
         static bool blockCheckSupported();
@@ -108,6 +108,9 @@ namespace mongo {
         info.append("page_faults", taskInfo.pageins);
     }
 
+    void ProcessInfo::getHugePageInfo(BSONObjBuilder& info) {
+    }
+
     /**
      * Get a sysctl string value by name.  Use string specialization by default.
      */
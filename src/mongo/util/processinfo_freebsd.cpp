@@ -142,6 +142,9 @@ namespace mongo {
     void ProcessInfo::getExtraInfo( BSONObjBuilder& info ) {
     }
 
+    void ProcessInfo::getHugePageInfo( BSONObjBuilder& info ) {
+    }
+
     bool ProcessInfo::supported() {
         return true;
     }
@@ -215,6 +215,30 @@ namespace mongo {
             return fstr;
         }
 
+        /**
+        * Read the value of a "key: value" or "key value" line, as in /proc/meminfo and
+        * /proc/vmstat.  Units such as "kB" are dropped.
+        * @return -1 if the file or the key can't be found
+        */
+        static long long readKeyedValue( const char* fname, const char* key ) {
+            FILE* f = fopen( fname, "r" );
+            if ( f == NULL )
+                return -1;
+
+            const size_t keyLen = strlen( key );
+            char fstr[1024];
+            long long value = -1;
+            while ( fgets( fstr, sizeof( fstr ), f ) != NULL ) {
+                if ( strncmp( fstr, key, keyLen ) == 0 &&
+                     ( fstr[keyLen] == ':' || fstr[keyLen] == ' ' ) ) {
+                    value = strtoll( fstr + keyLen + 1, NULL, 10 );
+                    break;
+                }
+            }
+            fclose( f );
+            return value;
+        }
+
         /**
         * Get some details about the CPU
         */
@@ -387,6 +411,35 @@ namespace mongo {
         info.appendNumber("page_faults", static_cast<long long>(p._maj_flt) );
     }
 
+    void ProcessInfo::getHugePageInfo( BSONObjBuilder& info ) {
+        // sizes in /proc/<pid>/status and /proc/meminfo are in kB
+        char status[128];
+        sprintf( status, "/proc/%d/status", _pid.asUInt32() );
+        long long pageTables = LinuxSysHelper::readKeyedValue( status, "VmPTE" );
+        if ( pageTables >= 0 )
+            info.appendNumber( "pageTableBytes", pageTables * 1024 );
+
+        long long anonHugePages = LinuxSysHelper::readKeyedValue( "/proc/meminfo", "AnonHugePages" );
+        if ( anonHugePages >= 0 )
+            info.appendNumber( "systemAnonHugePageBytes", anonHugePages * 1024 );
+
+        // e.g. "always [madvise] never"
+        string mode = LinuxSysHelper::readLineFromFile( "/sys/kernel/mm/transparent_hugepage/enabled" );
+        size_t open = mode.find( '[' );
+        size_t close = mode.find( ']' );
+        if ( open != string::npos && close != string::npos && close > open )
+            info.append( "kernelMode", mode.substr( open + 1, close - open - 1 ) );
+
+        // system wide event counts
+        static const char* const vmstats[] = { "thp_fault_alloc", "thp_fault_fallback",
+                                               "thp_collapse_alloc", "thp_split" };
+        for ( size_t i = 0; i < sizeof( vmstats ) / sizeof( vmstats[0] ); i++ ) {
+            long long n = LinuxSysHelper::readKeyedValue( "/proc/vmstat", vmstats[i] );
+            if ( n >= 0 )
+                info.appendNumber( vmstats[i], n );
+        }
+    }
+
     /**
     * Save a BSON obj representing the host system's details
     */
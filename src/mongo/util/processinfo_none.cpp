@@ -59,6 +59,9 @@ namespace mongo {
         
     }
 
+    void ProcessInfo::getHugePageInfo( BSONObjBuilder& info ) {
+    }
+
     bool ProcessInfo::blockInMemory(const void* start) {
         verify(0);
     }
@@ -102,6 +102,9 @@ namespace mongo {
         info.appendNumber("page_faults", static_cast<long long>(p.prusage.pr_majf));
     }
 
+    void ProcessInfo::getHugePageInfo(BSONObjBuilder& info) {
+    }
+
     /**
      * Save a BSON obj representing the host system's details
      */
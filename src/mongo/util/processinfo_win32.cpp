@@ -95,6 +95,9 @@ namespace mongo {
         }
     }
 
+    void ProcessInfo::getHugePageInfo(BSONObjBuilder& info) {
+    }
+
     void ProcessInfo::SystemInfo::collectSystemInfo() {
         BSONObjBuilder bExtra;
         stringstream verstr;